@@ -78,6 +78,7 @@ set_property CONFIG.CONST_VAL {0} $xlconstant_0
 # S_AXI_GP1 is HPC1
 # S_AXI_GP2 is HP0
 # S_AXI_GP3 is HP1
+# S_AXI_GP4 is HP2
 # M_AXI_GP0 is HPM0
 # M_AXI_GP1 is HPM1
 set_property -dict [ list \
@@ -86,14 +87,16 @@ set_property -dict [ list \
 	CONFIG.PSU__EXPAND__LOWER_LPS_SLAVES {1} \
 	CONFIG.PSU__EXPAND__UPPER_LPS_SLAVES {1} \
 	CONFIG.PSU__IRQ_P2F_ENT3__INT {1} \
-	CONFIG.PSU__PROTECTION__MASTERS {USB1:NonSecure;0|USB0:NonSecure;1|S_AXI_LPD:NA;0|S_AXI_HPC1_FPD:NA;0|S_AXI_HPC0_FPD:NA;0|S_AXI_HP3_FPD:NA;0|S_AXI_HP2_FPD:NA;0|S_AXI_HP1_FPD:NA;1|S_AXI_HP0_FPD:NA;1|S_AXI_ACP:NA;0|S_AXI_ACE:NA;0|SD1:NonSecure;1|SD0:NonSecure;0|SATA1:NonSecure;1|SATA0:NonSecure;1|RPU1:Secure;1|RPU0:Secure;1|QSPI:NonSecure;1|PMU:NA;1|PCIe:NonSecure;1|NAND:NonSecure;0|LDMA:NonSecure;1|GPU:NonSecure;1|GEM3:NonSecure;1|GEM2:NonSecure;0|GEM1:NonSecure;0|GEM0:NonSecure;0|FDMA:NonSecure;1|DP:NonSecure;1|DAP:NA;1|Coresight:NA;1|CSU:NA;1|APU:NA;1} \
+	CONFIG.PSU__PROTECTION__MASTERS {USB1:NonSecure;0|USB0:NonSecure;1|S_AXI_LPD:NA;0|S_AXI_HPC1_FPD:NA;0|S_AXI_HPC0_FPD:NA;0|S_AXI_HP3_FPD:NA;0|S_AXI_HP2_FPD:NA;1|S_AXI_HP1_FPD:NA;1|S_AXI_HP0_FPD:NA;1|S_AXI_ACP:NA;0|S_AXI_ACE:NA;0|SD1:NonSecure;1|SD0:NonSecure;0|SATA1:NonSecure;1|SATA0:NonSecure;1|RPU1:Secure;1|RPU0:Secure;1|QSPI:NonSecure;1|PMU:NA;1|PCIe:NonSecure;1|NAND:NonSecure;0|LDMA:NonSecure;1|GPU:NonSecure;1|GEM3:NonSecure;1|GEM2:NonSecure;0|GEM1:NonSecure;0|GEM0:NonSecure;0|FDMA:NonSecure;1|DP:NonSecure;1|DAP:NA;1|Coresight:NA;1|CSU:NA;1|APU:NA;1} \
 	CONFIG.PSU__SAXIGP0__DATA_WIDTH {128} \
 	CONFIG.PSU__SAXIGP2__DATA_WIDTH {128} \
+	CONFIG.PSU__SAXIGP4__DATA_WIDTH {128} \
 	CONFIG.PSU__MAXIGP0__DATA_WIDTH {128} \
 	CONFIG.PSU__USE__S_AXI_GP0 {0} \
 	CONFIG.PSU__USE__S_AXI_GP1 {0} \
 	CONFIG.PSU__USE__S_AXI_GP2 {1} \
 	CONFIG.PSU__USE__S_AXI_GP3 {1} \
+	CONFIG.PSU__USE__S_AXI_GP4 {1} \
 	CONFIG.PSU__USE__M_AXI_GP0 {1} \
 	CONFIG.PSU__USE__M_AXI_GP1 {0} \
   	CONFIG.PSU__USE__S_AXI_ACP {1} \
@@ -118,6 +121,9 @@ connect_bd_intf_net [get_bd_intf_pins prism_sp_aohw_gem3/m_axi_acp_1] [get_bd_in
 # Connect the SP's DMA interface
 connect_bd_intf_net [get_bd_intf_pins prism_sp_aohw_gem3/m_axi_dma_0] [get_bd_intf_pins zynq_ultra_ps_e_0/S_AXI_HP1_FPD]
 
+# Connect the SP's RX spill buffer interface
+connect_bd_intf_net [get_bd_intf_pins prism_sp_aohw_gem3/m_axi_spill_0] [get_bd_intf_pins zynq_ultra_ps_e_0/S_AXI_HP2_FPD]
+
 # Connect the I/O Smartconnect
 connect_bd_intf_net [get_bd_intf_pins smartconnect_sp_io/M00_AXI] [get_bd_intf_pins zynq_ultra_ps_e_0/S_AXI_HP0_FPD]
 connect_bd_intf_net [get_bd_intf_pins prism_sp_aohw_gem3/m_axi_ma_0] [get_bd_intf_pins smartconnect_sp_io/S00_AXI]
@@ -164,6 +170,7 @@ connect_bd_net [get_bd_pins zynq_ultra_ps_e_0/pl_clk0] \
 	[get_bd_pins zynq_ultra_ps_e_0/maxihpm0_fpd_aclk] \
 	[get_bd_pins zynq_ultra_ps_e_0/saxihp0_fpd_aclk] \
 	[get_bd_pins zynq_ultra_ps_e_0/saxihp1_fpd_aclk] \
+	[get_bd_pins zynq_ultra_ps_e_0/saxihp2_fpd_aclk] \
 	[get_bd_pins zynq_ultra_ps_e_0/saxiacp_fpd_aclk]
 
 # Connect the PL reset.
@@ -183,6 +190,10 @@ assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_acp_1 [get_bd_
 assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_dma_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP0/HP1_DDR_LOW] -force
 assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_dma_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP3/HP1_DDR_HIGH] -force
 
+# Make the raw DDR region available to the RX spill buffer interface.
+assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_spill_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP4/HP2_DDR_LOW] -force
+assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_spill_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP4/HP2_DDR_HIGH] -force
+
 # Make the necessary regions available to the SP I/O interface.
 assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_ma_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP2/HP0_DDR_LOW] -force
 assign_bd_address -target_address_space /prism_sp_aohw_gem3/m_axi_ma_0 [get_bd_addr_segs zynq_ultra_ps_e_0/SAXIGP2/HP0_DDR_HIGH] -force
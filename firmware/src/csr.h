@@ -73,4 +73,39 @@ static inline uint64_t csr_read_instret()
 	return (uint64_t)x << 32 | y;
 }
 
+/*
+ * Reads mhartid, the index of the processor in its worker pool
+ * (see prism_sp_processor_pool).
+ */
+static inline uint32_t csr_read_mhartid()
+{
+	uint32_t x;
+	asm volatile (
+		"		csrr		%0, mhartid\n"
+		: "=r" (x)
+		:
+		:
+	);
+	return x;
+}
+
+/*
+ * Reads hpmcounter<n> (n is a literal between 3 and 31).
+ * The SP unit event counters start at hpmcounter3 (see SP_HPM_*).
+ */
+#define csr_read_hpmcounter(n) ({ \
+	uint32_t x, y, z; \
+	asm volatile ( \
+		"csr_read_hpmcounter_again_%=:\n" \
+		"		csrr		%0, hpmcounter" #n "h\n" \
+		"		csrr		%1, hpmcounter" #n "\n" \
+		"		csrr		%2, hpmcounter" #n "h\n" \
+		"       bne			%0, %2, csr_read_hpmcounter_again_%=\n" \
+		: "=r" (x), "=r" (y), "=r" (z) \
+		: \
+		: \
+	); \
+	(uint64_t)x << 32 | y; \
+})
+
 #endif
@@ -53,9 +53,40 @@ chksum_enc_to_str(int x)
 	}
 }
 
+/*
+ * The other processors of the worker pool only share the stage FIFOs
+ * (1 and 2) with processor 0 (see prism_sp_processor_pool). They leave
+ * the UART and the configuration to it and forward the cookies silently.
+ */
+static void
+worker_main(void)
+{
+	for (;;) {
+		while (sp_puzzle_fifo_1_empty()) {
+		}
+		uint32_t x0 = sp_puzzle_fifo_1_pop_uint32();
+		uint32_t x1 = sp_puzzle_fifo_1_pop_uint32();
+		uint32_t x2 = sp_puzzle_fifo_1_pop_uint32();
+		uint32_t x3 = sp_puzzle_fifo_1_pop_uint32();
+		uint32_t x4 = sp_puzzle_fifo_1_pop_uint32();
+
+		while (sp_puzzle_fifo_2_full()) {
+		}
+		sp_puzzle_fifo_2_push_uint32(x0);
+		sp_puzzle_fifo_2_push_uint32(x1);
+		sp_puzzle_fifo_2_push_uint32(x2);
+		sp_puzzle_fifo_2_push_uint32(x3);
+		sp_puzzle_fifo_2_push_uint32(x4);
+	}
+}
+
 int
 main()
 {
+	if (csr_read_mhartid() != 0) {
+		worker_main();
+	}
+
 	int core_index = sp_load_reg(SP_REGN_INFO) & 0xf;
 
 	/*
@@ -99,8 +130,9 @@ main()
 		uint32_t x1 = sp_puzzle_fifo_1_pop_uint32();
 		uint32_t x2 = sp_puzzle_fifo_1_pop_uint32();
 		uint32_t x3 = sp_puzzle_fifo_1_pop_uint32();
+		uint32_t x4 = sp_puzzle_fifo_1_pop_uint32();
 
-		printf("[0x%08x %08x %08x %08x]\n", x3, x2, x1, x0);
+		printf("[0x%08x %08x %08x %08x %08x]\n", x4, x3, x2, x1, x0);
 		printf("RX job %06d: addr[%02x%08x] data_addr[%04x%06x] size[%03d]",
 			pkt,
 			x1 & 0xff, x0,
@@ -113,18 +145,25 @@ main()
 			(x3 & 0x1) ? " sof" : "",
 			(x3 & 0x2) ? " eof" : "",
 			(x3 & 0x4) ? " cfi" : "",
-			(x3 & 0x8) ? " prty" : "",
-			(x3 & 0x10) ? " vlan" : "",
-			chksum_enc_to_str((x3 & 0x60)>>5)
+			(x3 & 0x40) ? " prty" : "",
+			(x3 & 0x80) ? " vlan" : "",
+			chksum_enc_to_str((x3 & 0x300)>>8)
 		);
-		printf(" match=%d%s%s%s%s%s\n",
-			((x3 & 0x180)>>7)+1,
-			(x3 & 0x200) ? " add_match" : "",
-			(x3 & 0x400) ? " ext_match" : "",
-			(x3 & 0x800) ? " uni_hash_match" : "",
-			(x3 & 0x1000) ? " mult_hash_match" : "",
-			(x3 & 0x2000) ? " broadcast" : ""
+		printf(" prio=%d match=%d%s%s%s%s%s",
+			(x3 & 0x38)>>3,
+			((x3 & 0xc00)>>10)+1,
+			(x3 & 0x1000) ? " add_match" : "",
+			(x3 & 0x2000) ? " ext_match" : "",
+			(x3 & 0x4000) ? " uni_hash_match" : "",
+			(x3 & 0x8000) ? " mult_hash_match" : "",
+			(x3 & 0x10000) ? " broadcast" : ""
 		);
+		if (x3 & 0x200000) {
+			printf(" tunnel inner_chksum=%s inner_hash=%08x",
+				chksum_enc_to_str((x3 & 0xc00000)>>22),
+				(x4 << 8) | (x3 >> 24));
+		}
+		printf("\n");
 		pkt++;
 
 		while (sp_puzzle_fifo_2_full()) {
@@ -133,6 +172,7 @@ main()
 		sp_puzzle_fifo_2_push_uint32(x1);
 		sp_puzzle_fifo_2_push_uint32(x2);
 		sp_puzzle_fifo_2_push_uint32(x3);
+		sp_puzzle_fifo_2_push_uint32(x4);
 	}
 
 	return 0;
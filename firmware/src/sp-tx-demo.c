@@ -39,12 +39,109 @@
 #define TX_COOKIE_NOCRC_BITN			(TX_COOKIE_NOCRC_WIDTH + TX_COOKIE_NOCRC_WIDTH)
 #define TX_COOKIE_NOCRC_WIDTH			1
 
+/*
+ * Define HDR_DEMO to send the frames that fit into the header window
+ * through it and to decrement the TTL of IPv4 frames on the way (see
+ * hdr_demo_send()). This needs USE_HDR_WINDOW and NTXWORKERS = 1, as the
+ * cookies of other processors could be read into the window.
+ */
+//#define HDR_DEMO
+
 void prism_print_caching(void);
 void load_tx_config(void);
 
+#ifdef HDR_DEMO
+/*
+ * RFC 1624: HC' = ~(~HC + ~m + m')
+ */
+static uint16_t
+csum_update16(uint16_t hc, uint16_t m, uint16_t m_new)
+{
+	uint32_t x = (uint16_t)~hc + (uint16_t)~m + m_new;
+
+	x = (x & 0xffff) + (x >> 16);
+	x = (x & 0xffff) + (x >> 16);
+	return (uint16_t)~x;
+}
+
+/*
+ * The frame of cookie x consists of this cookie only and has size bytes,
+ * at most SP_HDR_WINDOW_SIZE. The window is loaded before the cookie is
+ * pushed, so the DMA of the frame goes to the window. Byte n of the frame
+ * is at bits [8*(n%4) +: 8] of sp_hdr_peek(n).
+ */
+static void
+hdr_demo_send(const uint32_t x[6], uint32_t size)
+{
+	sp_hdr_load(size);
+	while (!sp_hdr_loading()) {
+	}
+
+	while (sp_puzzle_fifo_1_full()) {
+	}
+	for (int i = 0; i < 6; i++) {
+		sp_puzzle_fifo_1_push_uint32(x[i]);
+	}
+
+	while (sp_hdr_status()) {
+	}
+
+	uint32_t w12 = sp_hdr_peek(12);
+	uint32_t w20 = sp_hdr_peek(20);
+	uint32_t w24 = sp_hdr_peek(24);
+	uint32_t ethertype = (w12 & 0xff) << 8 | ((w12 >> 8) & 0xff);
+	uint32_t version = (w12 >> 20) & 0xf;
+	uint32_t ttl = (w20 >> 16) & 0xff;
+	uint32_t proto = (w20 >> 24) & 0xff;
+
+	if (size >= 34 && ethertype == 0x0800 && version == 4 && ttl > 1) {
+		uint16_t hc = (w24 & 0xff) << 8 | ((w24 >> 8) & 0xff);
+
+		hc = csum_update16(hc, ttl << 8 | proto, (ttl - 1) << 8 | proto);
+		sp_hdr_poke(20, (w20 & 0xff00ffff) | (ttl - 1) << 16);
+		sp_hdr_poke(24, (w24 & 0xffff0000) | (hc & 0xff) << 8 | hc >> 8);
+	}
+
+	sp_hdr_commit();
+}
+#endif
+
+/*
+ * The other processors of the worker pool only share the stage FIFOs
+ * (0 and 1) with processor 0 (see prism_sp_processor_pool). They leave
+ * the UART and the configuration to it and forward the cookies silently.
+ */
+static void
+worker_main(void)
+{
+	for (;;) {
+		while (sp_puzzle_fifo_0_empty()) {
+		}
+		uint32_t x0 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x1 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x2 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x3 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x4 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x5 = sp_puzzle_fifo_0_pop_uint32();
+
+		while (sp_puzzle_fifo_1_full()) {
+		}
+		sp_puzzle_fifo_1_push_uint32(x0);
+		sp_puzzle_fifo_1_push_uint32(x1);
+		sp_puzzle_fifo_1_push_uint32(x2);
+		sp_puzzle_fifo_1_push_uint32(x3);
+		sp_puzzle_fifo_1_push_uint32(x4);
+		sp_puzzle_fifo_1_push_uint32(x5);
+	}
+}
+
 int
 main()
 {
+	if (csr_read_mhartid() != 0) {
+		worker_main();
+	}
+
 	int core_index = sp_load_reg(SP_REGN_INFO) & 0xf;
 
 	/*
@@ -77,6 +174,9 @@ main()
 	load_tx_config();
 
 	int pkt = 0;
+#ifdef HDR_DEMO
+	bool sof = true;
+#endif
 	for (;;) {
 		while (sp_puzzle_fifo_0_empty()) {
 		}
@@ -84,8 +184,10 @@ main()
 		uint32_t x1 = sp_puzzle_fifo_0_pop_uint32();
 		uint32_t x2 = sp_puzzle_fifo_0_pop_uint32();
 		uint32_t x3 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x4 = sp_puzzle_fifo_0_pop_uint32();
+		uint32_t x5 = sp_puzzle_fifo_0_pop_uint32();
 
-		printf("[0x%08x %08x %08x %08x]\n", x3, x2, x1, x0);
+		printf("[0x%08x %08x %08x %08x %08x %08x]\n", x5, x4, x3, x2, x1, x0);
 		printf("TX job %06d: addr[%02x%08x] data_addr[%04x%06x] size[%03d]%s%s%s\n",
 			pkt,
 			x1 & 0xff, x0,
@@ -96,12 +198,28 @@ main()
 			(x3 & 0x1) ? " nocrc" : "");
 		pkt++;
 
+#ifdef HDR_DEMO
+		uint32_t size = (x2 >> 16) & ((1 << TX_COOKIE_SIZE_WIDTH) - 1);
+		bool eof = ((x2 >> (16 + TX_COOKIE_SIZE_WIDTH)) & 0x2) != 0;
+		bool whole = sof && eof && size <= SP_HDR_WINDOW_SIZE;
+
+		sof = eof;
+		if (whole) {
+			const uint32_t x[6] = { x0, x1, x2, x3, x4, x5 };
+
+			hdr_demo_send(x, size);
+			continue;
+		}
+#endif
+
 		while (sp_puzzle_fifo_1_full()) {
 		}
 		sp_puzzle_fifo_1_push_uint32(x0);
 		sp_puzzle_fifo_1_push_uint32(x1);
 		sp_puzzle_fifo_1_push_uint32(x2);
 		sp_puzzle_fifo_1_push_uint32(x3);
+		sp_puzzle_fifo_1_push_uint32(x4);
+		sp_puzzle_fifo_1_push_uint32(x5);
 	}
 
 	return 0;
@@ -30,6 +30,12 @@
 /*
  * These identifiers are found in the funct7 field of the instruction.
  * The SP unit decodes them to find out which instruction to execute.
+ *
+ * In a worker pool (see prism_sp_processor_pool), only hart 0 is wired
+ * to the RX, TX, HDR and ACP units and may use their instructions, or
+ * store to MMRs and raise interrupts. The other harts may only use the
+ * puzzle FIFO instructions and load MMRs, so adding workers does not
+ * speed up DMA, header window or ACP work.
  */
 #define SP_FUNCT7_PUZZLE_FIFO_R_EMPTY	"0x0"
 #define SP_FUNCT7_PUZZLE_FIFO_R_POP		"0x1"
@@ -60,6 +66,14 @@
 #define SP_FUNCT7_ACP_WRITE_STATUS		"0x1b"
 #define SP_FUNCT7_ACP_SET_LOCAL_WSTRB	"0x1c"
 #define SP_FUNCT7_ACP_SET_REMOTE_WSTRB	"0x1d"
+#define SP_FUNCT7_ACP_SUBMIT			"0x1e"
+#define SP_FUNCT7_ACP_COMPLETE			"0x1f"
+
+#define SP_FUNCT7_HDR_LOAD				"0x20"
+#define SP_FUNCT7_HDR_STATUS			"0x21"
+#define SP_FUNCT7_HDR_PEEK				"0x22"
+#define SP_FUNCT7_HDR_POKE				"0x23"
+#define SP_FUNCT7_HDR_COMMIT			"0x24"
 
 #define SP_RX_IRQ_DONE					(1 << 0)
 #define SP_TX_IRQ_DONE					(1 << 0)
@@ -78,7 +92,108 @@ enum {
 	SP_MMR_R_REGN_QP_MSB,
 	SP_MMR_R_REGN_DATA_FIFO_SIZE,
 	SP_MMR_R_REGN_DATA_FIFO_WIDTH,
-	SP_MMR_R_REGN_INFO
+	SP_MMR_R_REGN_INFO,
+	SP_MMR_R_REGN_TX_CUT_THROUGH,
+	SP_MMR_R_REGN_TX_UNDERFLOWS,
+	SP_MMR_R_REGN_QUEUE_CONTROL,
+	SP_MMR_R_REGN_QUEUE_WEIGHTS,
+	SP_MMR_R_REGN_RX_PRIO_MAP,
+	SP_MMR_R_REGN_QP1_LSB,
+	SP_MMR_R_REGN_QP1_MSB,
+	SP_MMR_R_REGN_QP2_LSB,
+	SP_MMR_R_REGN_QP2_MSB,
+	SP_MMR_R_REGN_QP3_LSB,
+	SP_MMR_R_REGN_QP3_MSB,
+	SP_MMR_R_REGN_TX_PORT_RATE,
+	SP_MMR_R_REGN_TX_PORT_BURST,
+	SP_MMR_R_REGN_TX_TIME,
+	SP_MMR_R_REGN_TX_Q0_RATE,
+	SP_MMR_R_REGN_TX_Q0_BURST,
+	SP_MMR_R_REGN_TX_Q1_RATE,
+	SP_MMR_R_REGN_TX_Q1_BURST,
+	SP_MMR_R_REGN_TX_Q2_RATE,
+	SP_MMR_R_REGN_TX_Q2_BURST,
+	SP_MMR_R_REGN_TX_Q3_RATE,
+	SP_MMR_R_REGN_TX_Q3_BURST,
+	SP_MMR_R_REGN_BYPASS_CONTROL,
+	SP_MMR_R_REGN_BYPASS_MASK,
+	SP_MMR_R_REGN_BYPASS_MATCH,
+	SP_MMR_R_REGN_CQ_CONTROL,
+	SP_MMR_R_REGN_CQ_LSB,
+	SP_MMR_R_REGN_CQ_MSB,
+	SP_MMR_R_REGN_RING_SIZE,
+	SP_MMR_R_REGN_VIRTQ_EVENT_LSB,
+	SP_MMR_R_REGN_VIRTQ_EVENT_MSB,
+	SP_MMR_R_REGN_TRACE_CONTROL,
+	SP_MMR_R_REGN_TRACE_TRIG_MASK,
+	SP_MMR_R_REGN_TRACE_TRIG_MATCH,
+	SP_MMR_R_REGN_TRACE_ADDR,
+	SP_MMR_R_REGN_TRACE_STATUS,
+	SP_MMR_R_REGN_TRACE_DATA,
+	SP_MMR_R_REGN_PERF_SELECT,
+	SP_MMR_R_REGN_PERF_LSB,
+	SP_MMR_R_REGN_PERF_MSB,
+	SP_MMR_R_REGN_LOAD_SRC_LSB,
+	SP_MMR_R_REGN_LOAD_SRC_MSB,
+	SP_MMR_R_REGN_LOAD_DST,
+	SP_MMR_R_REGN_LOAD_SIZE,
+	SP_MMR_R_REGN_LOAD_CRC,
+	SP_MMR_R_REGN_LOAD_CONTROL,
+	SP_MMR_R_REGN_RX_STRIDE,
+	SP_MMR_R_REGN_POLL_CONTROL,
+	SP_MMR_R_REGN_TGEN_CONTROL,
+	SP_MMR_R_REGN_TGEN_SIZE,
+	SP_MMR_R_REGN_TGEN_COUNT,
+	SP_MMR_R_REGN_TGEN_SENT,
+	SP_MMR_R_REGN_TCHK_CONTROL,
+	SP_MMR_R_REGN_TCHK_FRAMES,
+	SP_MMR_R_REGN_TCHK_LOST,
+	SP_MMR_R_REGN_TCHK_REORDERED,
+	SP_MMR_R_REGN_TCHK_CORRUPT,
+	SP_MMR_R_REGN_TCHK_LAT_MIN,
+	SP_MMR_R_REGN_TCHK_LAT_MAX,
+	SP_MMR_R_REGN_RX_DIGEST,
+	SP_MMR_R_REGN_ESP_SA_KEY0,
+	SP_MMR_R_REGN_ESP_SA_KEY1,
+	SP_MMR_R_REGN_ESP_SA_KEY2,
+	SP_MMR_R_REGN_ESP_SA_KEY3,
+	SP_MMR_R_REGN_ESP_SA_SALT,
+	SP_MMR_R_REGN_ESP_SA_SPI,
+	SP_MMR_R_REGN_ESP_SA_CONTROL,
+	SP_MMR_R_REGN_TUNNEL_CONTROL,
+	SP_MMR_R_REGN_TUNNEL_TMPL,
+	SP_MMR_R_REGN_TUNNEL_TMPL_ADDR,
+	SP_MMR_R_REGN_FLOW_CONTROL,
+	SP_MMR_R_REGN_FLOW_TIMEOUT,
+	SP_MMR_R_REGN_FLOW_LSB,
+	SP_MMR_R_REGN_FLOW_MSB,
+	SP_MMR_R_REGN_FLOW_DROPS,
+	SP_MMR_R_REGN_CAPTURE_CONTROL,
+	SP_MMR_R_REGN_CAPTURE_MASK,
+	SP_MMR_R_REGN_CAPTURE_MATCH,
+	SP_MMR_R_REGN_CAPTURE_LSB,
+	SP_MMR_R_REGN_CAPTURE_MSB,
+	SP_MMR_R_REGN_CAPTURE_TAIL,
+	SP_MMR_R_REGN_CAPTURE_HEAD,
+	SP_MMR_R_REGN_CAPTURE_DROPS,
+	SP_MMR_R_REGN_ADMIT_CONTROL,
+	SP_MMR_R_REGN_ADMIT_THRESH,
+	SP_MMR_R_REGN_ADMIT_DROPS,
+	SP_MMR_R_REGN_PAUSE_CONTROL,
+	SP_MMR_R_REGN_PAUSE_SA_LSB,
+	SP_MMR_R_REGN_PAUSE_SA_MSB,
+	SP_MMR_R_REGN_AXATTR_DESC_RD,
+	SP_MMR_R_REGN_AXATTR_DESC_WR,
+	SP_MMR_R_REGN_AXATTR_HDR,
+	SP_MMR_R_REGN_AXATTR_DATA,
+	SP_MMR_R_REGN_SPILL_CONTROL,
+	SP_MMR_R_REGN_SPILL_LSB,
+	SP_MMR_R_REGN_SPILL_MSB,
+	SP_MMR_R_REGN_SPILL_LEVEL,
+	SP_MMR_R_REGN_SPILL_BURSTS,
+	SP_MMR_R_REGN_AXATTR_SPILL,
+	SP_MMR_R_REGN_AXATTR_FLOW,
+	SP_MMR_R_REGN_AXATTR_CAPTURE
 };
 #define SP_REGN_IO_AXI_AXCACHE			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_IO_AXI_AXCACHE)
 #define SP_REGN_DMA_AXI_AXCACHE			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_DMA_AXI_AXCACHE)
@@ -89,8 +204,162 @@ enum {
 #define SP_REGN_DATA_FIFO_SIZE			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_DATA_FIFO_SIZE)
 #define SP_REGN_DATA_FIFO_WIDTH			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_DATA_FIFO_WIDTH)
 #define SP_REGN_INFO					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_INFO)
+#define SP_REGN_TX_CUT_THROUGH			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_CUT_THROUGH)
+#define SP_REGN_TX_UNDERFLOWS			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_UNDERFLOWS)
+#define SP_REGN_QUEUE_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QUEUE_CONTROL)
+#define SP_REGN_QUEUE_WEIGHTS			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QUEUE_WEIGHTS)
+#define SP_REGN_RX_PRIO_MAP				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_RX_PRIO_MAP)
+#define SP_REGN_QP1_LSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP1_LSB)
+#define SP_REGN_QP1_MSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP1_MSB)
+#define SP_REGN_QP2_LSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP2_LSB)
+#define SP_REGN_QP2_MSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP2_MSB)
+#define SP_REGN_QP3_LSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP3_LSB)
+#define SP_REGN_QP3_MSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_QP3_MSB)
+#define SP_REGN_TX_PORT_RATE			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_PORT_RATE)
+#define SP_REGN_TX_PORT_BURST			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_PORT_BURST)
+#define SP_REGN_TX_TIME					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_TIME)
+#define SP_REGN_TX_Q0_RATE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q0_RATE)
+#define SP_REGN_TX_Q0_BURST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q0_BURST)
+#define SP_REGN_TX_Q1_RATE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q1_RATE)
+#define SP_REGN_TX_Q1_BURST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q1_BURST)
+#define SP_REGN_TX_Q2_RATE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q2_RATE)
+#define SP_REGN_TX_Q2_BURST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q2_BURST)
+#define SP_REGN_TX_Q3_RATE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q3_RATE)
+#define SP_REGN_TX_Q3_BURST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TX_Q3_BURST)
+#define SP_REGN_BYPASS_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_BYPASS_CONTROL)
+#define SP_REGN_BYPASS_MASK				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_BYPASS_MASK)
+#define SP_REGN_BYPASS_MATCH			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_BYPASS_MATCH)
+#define SP_REGN_CQ_CONTROL				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CQ_CONTROL)
+#define SP_REGN_CQ_LSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CQ_LSB)
+#define SP_REGN_CQ_MSB					(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CQ_MSB)
+#define SP_REGN_RING_SIZE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_RING_SIZE)
+#define SP_REGN_VIRTQ_EVENT_LSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_VIRTQ_EVENT_LSB)
+#define SP_REGN_VIRTQ_EVENT_MSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_VIRTQ_EVENT_MSB)
+#define SP_REGN_TRACE_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_CONTROL)
+#define SP_REGN_TRACE_TRIG_MASK			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_TRIG_MASK)
+#define SP_REGN_TRACE_TRIG_MATCH		(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_TRIG_MATCH)
+#define SP_REGN_TRACE_ADDR				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_ADDR)
+#define SP_REGN_TRACE_STATUS			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_STATUS)
+#define SP_REGN_TRACE_DATA				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TRACE_DATA)
+#define SP_REGN_PERF_SELECT				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PERF_SELECT)
+#define SP_REGN_PERF_LSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PERF_LSB)
+#define SP_REGN_PERF_MSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PERF_MSB)
+#define SP_REGN_LOAD_SRC_LSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_SRC_LSB)
+#define SP_REGN_LOAD_SRC_MSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_SRC_MSB)
+#define SP_REGN_LOAD_DST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_DST)
+#define SP_REGN_LOAD_SIZE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_SIZE)
+#define SP_REGN_LOAD_CRC				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_CRC)
+#define SP_REGN_LOAD_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_LOAD_CONTROL)
+#define SP_REGN_RX_STRIDE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_RX_STRIDE)
+#define SP_REGN_POLL_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_POLL_CONTROL)
+#define SP_REGN_TGEN_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TGEN_CONTROL)
+#define SP_REGN_TGEN_SIZE				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TGEN_SIZE)
+#define SP_REGN_TGEN_COUNT				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TGEN_COUNT)
+#define SP_REGN_TGEN_SENT				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TGEN_SENT)
+#define SP_REGN_TCHK_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_CONTROL)
+#define SP_REGN_TCHK_FRAMES				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_FRAMES)
+#define SP_REGN_TCHK_LOST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_LOST)
+#define SP_REGN_TCHK_REORDERED			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_REORDERED)
+#define SP_REGN_TCHK_CORRUPT			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_CORRUPT)
+#define SP_REGN_TCHK_LAT_MIN			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_LAT_MIN)
+#define SP_REGN_TCHK_LAT_MAX			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TCHK_LAT_MAX)
+#define SP_REGN_RX_DIGEST				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_RX_DIGEST)
+#define SP_REGN_ESP_SA_KEY0				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_KEY0)
+#define SP_REGN_ESP_SA_KEY1				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_KEY1)
+#define SP_REGN_ESP_SA_KEY2				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_KEY2)
+#define SP_REGN_ESP_SA_KEY3				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_KEY3)
+#define SP_REGN_ESP_SA_SALT				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_SALT)
+#define SP_REGN_ESP_SA_SPI				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_SPI)
+#define SP_REGN_ESP_SA_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ESP_SA_CONTROL)
+#define SP_REGN_TUNNEL_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TUNNEL_CONTROL)
+#define SP_REGN_TUNNEL_TMPL				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TUNNEL_TMPL)
+#define SP_REGN_TUNNEL_TMPL_ADDR		(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_TUNNEL_TMPL_ADDR)
+#define SP_REGN_FLOW_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_FLOW_CONTROL)
+#define SP_REGN_FLOW_TIMEOUT			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_FLOW_TIMEOUT)
+#define SP_REGN_FLOW_LSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_FLOW_LSB)
+#define SP_REGN_FLOW_MSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_FLOW_MSB)
+#define SP_REGN_FLOW_DROPS				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_FLOW_DROPS)
+#define SP_REGN_CAPTURE_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_CONTROL)
+#define SP_REGN_CAPTURE_MASK			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_MASK)
+#define SP_REGN_CAPTURE_MATCH			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_MATCH)
+#define SP_REGN_CAPTURE_LSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_LSB)
+#define SP_REGN_CAPTURE_MSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_MSB)
+#define SP_REGN_CAPTURE_TAIL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_TAIL)
+#define SP_REGN_CAPTURE_HEAD			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_HEAD)
+#define SP_REGN_CAPTURE_DROPS			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_CAPTURE_DROPS)
+#define SP_REGN_ADMIT_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ADMIT_CONTROL)
+#define SP_REGN_ADMIT_THRESH			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ADMIT_THRESH)
+#define SP_REGN_ADMIT_DROPS				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_ADMIT_DROPS)
+#define SP_REGN_PAUSE_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PAUSE_CONTROL)
+#define SP_REGN_PAUSE_SA_LSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PAUSE_SA_LSB)
+#define SP_REGN_PAUSE_SA_MSB			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_PAUSE_SA_MSB)
+#define SP_REGN_AXATTR_DESC_RD			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_DESC_RD)
+#define SP_REGN_AXATTR_DESC_WR			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_DESC_WR)
+#define SP_REGN_AXATTR_HDR				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_HDR)
+#define SP_REGN_AXATTR_DATA				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_DATA)
+#define SP_REGN_SPILL_CONTROL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_SPILL_CONTROL)
+#define SP_REGN_SPILL_LSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_SPILL_LSB)
+#define SP_REGN_SPILL_MSB				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_SPILL_MSB)
+#define SP_REGN_SPILL_LEVEL				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_SPILL_LEVEL)
+#define SP_REGN_SPILL_BURSTS			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_SPILL_BURSTS)
+#define SP_REGN_AXATTR_SPILL			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_SPILL)
+#define SP_REGN_AXATTR_FLOW				(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_FLOW)
+#define SP_REGN_AXATTR_CAPTURE			(1 << SP_MMR_R_BITN | SP_MMR_R_REGN_AXATTR_CAPTURE)
+
+/*
+ * SP unit event counters (read with csr_read_hpmcounter())
+ * The event index for PERF_SELECT is SP_HPM_x - 3.
+ */
+#define SP_HPM_PUZZLE_EMPTY_WAIT		3
+#define SP_HPM_PUZZLE_FULL_WAIT			4
+#define SP_HPM_UNIT_BUSY				5
+#define SP_HPM_DMA_WAIT					6
+#define SP_HPM_ACP_WAIT					7
+#define SP_HPM_COOKIE_POP				8
 
 #define SP_CONTROL_ENABLE_BITN			0
+#define SP_QUEUE_CONTROL_WRR_BITN		16
+#define SP_BYPASS_CONTROL_KEY_BITN		1
+#define SP_BYPASS_CONTROL_WORD_BITN		8
+#define SP_BYPASS_CONTROL_KEY_WORD_BITN	12
+#define SP_BYPASS_CONTROL_KEY_SHIFT_BITN	16
+#define SP_CQ_CONTROL_SIZE_BITN			8
+#define SP_TRACE_CONTROL_FORCE_BITN		1
+#define SP_TRACE_CONTROL_WINDOW_BITN	4
+#define SP_TRACE_CONTROL_POST_BITN		16
+#define SP_RX_STRIDE_SHIFT_BITN			4
+#define SP_RX_STRIDE_BUF_SHIFT_BITN		8
+#define SP_RX_STRIDE_RESERVE_BITN		16
+#define SP_POLL_CONTROL_MIN_SHIFT_BITN	8
+#define SP_POLL_CONTROL_MAX_SHIFT_BITN	16
+#define SP_TGEN_CONTROL_PATTERN_BITN	1
+#define SP_TGEN_CONTROL_FLOWS_BITN		8
+#define SP_TGEN_CONTROL_GAP_BITN		16
+#define SP_TGEN_SIZE_LAST_BITN			16
+#define SP_RX_DIGEST_END_BITN			16
+#define SP_ESP_SA_CONTROL_VALID_BITN	8
+#define SP_TUNNEL_CONTROL_RX_BITN		16
+#define SP_TUNNEL_CONTROL_STRIP_BITN	17
+#define SP_TUNNEL_TMPL_ADDR_SIZE_BITN	8
+#define SP_FLOW_CONTROL_EXPORT_BITN		1
+#define SP_FLOW_CONTROL_SIZE_BITN		8
+#define SP_FLOW_TIMEOUT_ACTIVE_BITN		16
+#define SP_CAPTURE_CONTROL_FILTER_BITN	1
+#define SP_CAPTURE_CONTROL_SIZE_BITN	3
+#define SP_CAPTURE_CONTROL_WORD_BITN	8
+#define SP_CAPTURE_CONTROL_SNAP_BITN	16
+#define SP_ADMIT_CONTROL_DSCP_BITN		1
+#define SP_ADMIT_CONTROL_PRIO_BITN		2
+#define SP_ADMIT_CONTROL_LEVEL_BITN		16
+#define SP_PAUSE_CONTROL_PFC_BITN		1
+#define SP_PAUSE_CONTROL_HEADROOM_BITN	8
+#define SP_PAUSE_CONTROL_QUANTA_BITN	16
+#define SP_AXATTR_CACHE_BITN			0
+#define SP_AXATTR_PROT_BITN				4
+#define SP_AXATTR_USER_BITN				7
+#define SP_AXATTR_HDR_LEN_BITN			16
+#define SP_AXATTR_OVERRIDE_BITN			31
+#define SP_SPILL_CONTROL_SIZE_BITN		8
 
 /*
  * A custom instruction with
@@ -171,136 +440,79 @@ struct sp_config {
 };
 
 /*
- * Puzzle FIFO <N> empty
+ * Accessors for puzzle FIFO <N>, which is selected by funct3:
+ * sp_puzzle_fifo_<N>_empty(), sp_puzzle_fifo_<N>_pop_uint32(),
+ * sp_puzzle_fifo_<N>_full() and sp_puzzle_fifo_<N>_push_uint32().
+ *
+ * A cookie of a FIFO that is wider than 32 bits is popped and pushed
+ * as consecutive 32-bit words, least significant word first.
  */
-static inline bool
-sp_puzzle_fifo_0_empty(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("0", SP_FUNCT7_PUZZLE_FIFO_R_EMPTY, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_1_empty(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("1", SP_FUNCT7_PUZZLE_FIFO_R_EMPTY, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_2_empty(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("2", SP_FUNCT7_PUZZLE_FIFO_R_EMPTY, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_3_empty(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("3", SP_FUNCT7_PUZZLE_FIFO_R_EMPTY, x);
-	return (bool)x;
+#define SP_PUZZLE_FIFO_ACCESSORS(n) \
+static inline bool \
+sp_puzzle_fifo_##n##_empty(void) \
+{ \
+	uint32_t x; \
+\
+	EMIT_INSN_100(#n, SP_FUNCT7_PUZZLE_FIFO_R_EMPTY, x); \
+	return (bool)x; \
+} \
+static inline uint32_t \
+sp_puzzle_fifo_##n##_pop_uint32(void) \
+{ \
+	uint32_t x; \
+\
+	EMIT_INSN_100(#n, SP_FUNCT7_PUZZLE_FIFO_R_POP, x); \
+	return x; \
+} \
+static inline bool \
+sp_puzzle_fifo_##n##_full(void) \
+{ \
+	uint32_t x; \
+\
+	EMIT_INSN_100(#n, SP_FUNCT7_PUZZLE_FIFO_W_FULL, x); \
+	return (bool)x; \
+} \
+static inline void \
+sp_puzzle_fifo_##n##_push_uint32(uint32_t x) \
+{ \
+	EMIT_INSN_010(#n, SP_FUNCT7_PUZZLE_FIFO_W_PUSH, x); \
 }
 
 /*
- * Puzzle FIFO <N> empty
+ * funct3 selects one of up to eight puzzle FIFOs. How many of them
+ * exist is given by NRXPUZZLEFIFOS and NTXPUZZLEFIFOS in
+ * prism_sp_config.sv, from which the Makefile sets SP_NPUZZLEFIFOS.
+ * Only the accessors of existing FIFOs are declared, so that using
+ * another FIFO fails to compile.
  */
-static inline uint32_t
-sp_puzzle_fifo_0_pop_uint32(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("0", SP_FUNCT7_PUZZLE_FIFO_R_POP, x);
-	return x;
-}
-static inline uint32_t
-sp_puzzle_fifo_1_pop_uint32(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("1", SP_FUNCT7_PUZZLE_FIFO_R_POP, x);
-	return x;
-}
-static inline uint32_t
-sp_puzzle_fifo_2_pop_uint32(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("2", SP_FUNCT7_PUZZLE_FIFO_R_POP, x);
-	return x;
-}
-static inline uint32_t
-sp_puzzle_fifo_3_pop_uint32(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("3", SP_FUNCT7_PUZZLE_FIFO_R_POP, x);
-	return x;
-}
-
-/*
- * Puzzle FIFO <N> full
- */
-static inline bool
-sp_puzzle_fifo_0_full(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("0", SP_FUNCT7_PUZZLE_FIFO_W_FULL, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_1_full(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("1", SP_FUNCT7_PUZZLE_FIFO_W_FULL, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_2_full(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("2", SP_FUNCT7_PUZZLE_FIFO_W_FULL, x);
-	return (bool)x;
-}
-static inline bool
-sp_puzzle_fifo_3_full(void)
-{
-	uint32_t x;
-
-	EMIT_INSN_100("3", SP_FUNCT7_PUZZLE_FIFO_W_FULL, x);
-	return (bool)x;
-}
+#ifndef SP_NPUZZLEFIFOS
+#error "SP_NPUZZLEFIFOS is not set"
+#endif
+_Static_assert(SP_NPUZZLEFIFOS >= 1 && SP_NPUZZLEFIFOS <= 8,
+	"funct3 selects one of up to eight puzzle FIFOs");
 
-/*
- * Puzzle FIFO <N> push
- */
-static inline void
-sp_puzzle_fifo_0_push_uint32(uint32_t x)
-{
-	EMIT_INSN_010("0", SP_FUNCT7_PUZZLE_FIFO_W_PUSH, x);
-}
-static inline void
-sp_puzzle_fifo_1_push_uint32(uint32_t x)
-{
-	EMIT_INSN_010("1", SP_FUNCT7_PUZZLE_FIFO_W_PUSH, x);
-}
-static inline void
-sp_puzzle_fifo_2_push_uint32(uint32_t x)
-{
-	EMIT_INSN_010("2", SP_FUNCT7_PUZZLE_FIFO_W_PUSH, x);
-}
-static inline void
-sp_puzzle_fifo_3_push_uint32(uint32_t x)
-{
-	EMIT_INSN_010("3", SP_FUNCT7_PUZZLE_FIFO_W_PUSH, x);
-}
+SP_PUZZLE_FIFO_ACCESSORS(0)
+#if SP_NPUZZLEFIFOS > 1
+SP_PUZZLE_FIFO_ACCESSORS(1)
+#endif
+#if SP_NPUZZLEFIFOS > 2
+SP_PUZZLE_FIFO_ACCESSORS(2)
+#endif
+#if SP_NPUZZLEFIFOS > 3
+SP_PUZZLE_FIFO_ACCESSORS(3)
+#endif
+#if SP_NPUZZLEFIFOS > 4
+SP_PUZZLE_FIFO_ACCESSORS(4)
+#endif
+#if SP_NPUZZLEFIFOS > 5
+SP_PUZZLE_FIFO_ACCESSORS(5)
+#endif
+#if SP_NPUZZLEFIFOS > 6
+SP_PUZZLE_FIFO_ACCESSORS(6)
+#endif
+#if SP_NPUZZLEFIFOS > 7
+SP_PUZZLE_FIFO_ACCESSORS(7)
+#endif
 
 /*
  * This function gives the number of elements in the RX meta FIFO.
@@ -524,6 +736,107 @@ sp_acp_busy(void)
 	return sp_acp_write_status();
 }
 
+/*
+ * Queued ACP transfers of nwords (1 to 256) 16-byte words.
+ * The submit functions return a tag, or 0 if too many transfers
+ * are in flight. sp_acp_complete() returns the tag of a finished
+ * transfer (with SP_ACP_COMPLETE_ERROR set on an AXI error), or 0.
+ */
+#define SP_ACP_COMPLETE_ERROR			(1u << 31)
+#define SP_ACP_COMPLETE_TAG_MASK		0xff
+
+static inline uint32_t
+sp_acp_submit_read(uint32_t int_addr, uint32_t ext_addr, uint32_t nwords)
+{
+	uint32_t x;
+	uint32_t rs1 = int_addr | (((nwords - 1) >> 4) & 0xf);
+	uint32_t rs2 = ext_addr | ((nwords - 1) & 0xf);
+
+	EMIT_INSN_111("0", SP_FUNCT7_ACP_SUBMIT, x, rs1, rs2);
+	return x;
+}
+
+static inline uint32_t
+sp_acp_submit_write(uint32_t int_addr, uint32_t ext_addr, uint32_t nwords)
+{
+	uint32_t x;
+	uint32_t rs1 = int_addr | (((nwords - 1) >> 4) & 0xf);
+	uint32_t rs2 = ext_addr | ((nwords - 1) & 0xf);
+
+	EMIT_INSN_111("1", SP_FUNCT7_ACP_SUBMIT, x, rs1, rs2);
+	return x;
+}
+
+static inline uint32_t
+sp_acp_complete(void)
+{
+	uint32_t x;
+	EMIT_INSN_100("0", SP_FUNCT7_ACP_COMPLETE, x);
+	return x;
+}
+
+/*
+ * Header window functions
+ *
+ * RX: After the DMA of the previous frame has been started,
+ * sp_hdr_load() takes the first bytes of the next frame out of the
+ * RX data FIFO. The DMA of the frame may only be started after
+ * sp_hdr_commit().
+ * TX: After sp_hdr_load(), the header is read by a DMA of its own,
+ * whose length is the length passed to sp_hdr_load() if that is smaller
+ * than the window, or else the size of the window. The DMA may only be
+ * started once sp_hdr_loading() returns true, as the window waits until
+ * the DMA stage is idle. The rest of the frame is read after
+ * sp_hdr_commit() and a final sp_hdr_status().
+ * In both cases, sp_hdr_status() returns true until the window is
+ * loaded.
+ */
+#define SP_HDR_WINDOW_SIZE				128
+#define SP_HDR_STATUS_BUSY_BITN			0
+#define SP_HDR_STATUS_LOADING_BITN		1
+
+static inline void
+sp_hdr_load(uint32_t length)
+{
+	EMIT_INSN_010("0", SP_FUNCT7_HDR_LOAD, length);
+}
+
+static inline bool
+sp_hdr_status(void)
+{
+	uint32_t x;
+	EMIT_INSN_100("0", SP_FUNCT7_HDR_STATUS, x);
+	return (bool)(x & (1 << SP_HDR_STATUS_BUSY_BITN));
+}
+
+static inline bool
+sp_hdr_loading(void)
+{
+	uint32_t x;
+	EMIT_INSN_100("0", SP_FUNCT7_HDR_STATUS, x);
+	return (bool)(x & (1 << SP_HDR_STATUS_LOADING_BITN));
+}
+
+static inline uint32_t
+sp_hdr_peek(uint32_t offset)
+{
+	uint32_t x;
+	EMIT_INSN_110("0", SP_FUNCT7_HDR_PEEK, x, offset);
+	return x;
+}
+
+static inline void
+sp_hdr_poke(uint32_t offset, uint32_t x)
+{
+	EMIT_INSN_011("0", SP_FUNCT7_HDR_POKE, offset, x);
+}
+
+static inline void
+sp_hdr_commit(void)
+{
+	EMIT_INSN_000("0", SP_FUNCT7_HDR_COMMIT);
+}
+
 void prism_hexdump(const void *na, int nbytes);
 
 extern int gem_no;
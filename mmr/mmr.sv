@@ -21,7 +21,10 @@ module axi_lite_mmr #(
 	parameter int DBRAM_SIZE,
 	parameter int DATA_FIFO_SIZE = 0,
 	parameter int DATA_FIFO_WIDTH = 0,
-	parameter int INSTANCE
+	parameter int INSTANCE,
+	parameter int NQUEUES = 1,
+	// ADMIT_CONTROL to PAUSE_SA_MSB read as zero if not set.
+	parameter int USE_ADMIT = 0
 )
 (
 	input wire logic clock,
@@ -43,12 +46,131 @@ module axi_lite_mmr #(
 
 	output var logic [3:0] io_axi_axcache,
 	output var logic [3:0] dma_axi_axcache,
-	output wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base [NQUEUES],
+	output wire logic [NQUEUES-1:0] queue_enable,
+	output wire logic [31:0] queue_weights,
+	output wire logic queue_wrr,
+
+	// Only used by RX instances
+	output wire logic [31:0] rx_prio_map,
+
+	// Only used by TX instances
+	output wire logic [TX_META_DESC_SIZE_WIDTH-1:0] tx_ct_size,
+	input wire logic [31:0] tx_underflows,
+	output wire logic [31:0] tx_queue_rate [NQUEUES],
+	output wire logic [31:0] tx_queue_burst [NQUEUES],
+	output wire logic [31:0] tx_port_rate,
+	output wire logic [31:0] tx_port_burst,
+	input wire logic [31:0] tx_time,
+
+	output wire logic bypass_enable,
+	output wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_word,
+	output wire logic [31:0] bypass_mask,
+	output wire logic [31:0] bypass_match,
+	output wire logic bypass_key_enable,
+	output wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_key_word,
+	output wire logic [4:0] bypass_key_shift,
+
+	output wire logic cq_enable,
+	output wire logic poll_enable,
+	output wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_min_shift,
+	output wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_max_shift,
+	output wire logic [CQ_CONTROL_SIZE_WIDTH-1:0] cq_size,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] cq_base,
+
+	output wire logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] virtq_event_addr,
+
+	// ESP SA table (see prism_sp_esp_gcm)
+	output wire logic [127:0] esp_sa_key,
+	output wire logic [31:0] esp_sa_salt,
+	output wire logic [31:0] esp_sa_spi,
+	output wire logic [31:0] esp_sa_control,
+
+	// Tunnel offload (see REGOFF_TUNNEL_CONTROL)
+	output wire logic [31:0] tunnel_control,
+	output wire logic [31:0] tunnel_tmpl,
+	output wire logic [31:0] tunnel_tmpl_addr,
+
+	// Packet capture (see REGOFF_CAPTURE_CONTROL)
+	output wire logic [31:0] capture_control,
+	output wire logic [31:0] capture_mask,
+	output wire logic [31:0] capture_match,
+	output wire logic capture_enable,
+	output wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0] capture_size,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] capture_base,
+	output wire logic [31:0] capture_tail,
+	input wire logic [31:0] capture_head,
+	input wire logic [31:0] capture_drops,
+
+	// Only used by RX instances
+	output wire logic rx_stride_enable,
+	output wire logic [4:0] rx_stride_shift,
+	output wire logic [RX_STRIDE_BUF_SHIFT_WIDTH-1:0] rx_buf_shift,
+	output wire logic [RX_STRIDE_RESERVE_WIDTH-1:0] rx_buf_reserve,
+	output wire logic [31:0] tgen_control,
+	output wire logic [31:0] tgen_size,
+	output wire logic [31:0] tgen_count,
+	input wire logic [31:0] tgen_sent,
+	output wire logic [31:0] rx_digest_range,
+	// Flow telemetry (see REGOFF_FLOW_CONTROL)
+	output wire logic flow_enable,
+	output wire logic flow_export_enable,
+	output wire logic [FLOW_CONTROL_SIZE_WIDTH-1:0] flow_size,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] flow_base,
+	output wire logic [31:0] flow_timeout,
+	input wire logic [31:0] flow_drops,
+	// Admission control (see REGOFF_ADMIT_CONTROL)
+	output wire logic [31:0] admit_control,
+	output wire logic [31:0] admit_thresh,
+	input wire logic [31:0] admit_drops,
+	output wire logic [31:0] pause_control,
+	output wire logic [47:0] pause_sa,
+	output wire logic [31:0] axattr_desc_rd,
+	output wire logic [31:0] axattr_desc_wr,
+	output wire logic [31:0] axattr_hdr,
+	output wire logic [31:0] axattr_data,
+	output wire logic [31:0] axattr_flow,
+	output wire logic [31:0] axattr_capture,
+	// Spill buffer (see REGOFF_SPILL_CONTROL)
+	output wire logic spill_enable,
+	output wire logic [SPILL_CONTROL_SIZE_WIDTH-1:0] spill_size,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] spill_base,
+	input wire logic [31:0] spill_level,
+	input wire logic [31:0] spill_bursts,
+	output wire logic [31:0] axattr_spill,
+
+	// Only used by TX instances
+	output wire logic [31:0] tchk_control,
+	input traffic_check_t tchk_results,
+
+	output wire logic trace_arm,
+	output wire logic trace_force,
+	output wire logic [TRACE_CONTROL_WINDOW_WIDTH-1:0] trace_window,
+	output wire logic [TRACE_CONTROL_POST_WIDTH-1:0] trace_post,
+	output wire logic [31:0] trace_trig_mask,
+	output wire logic [31:0] trace_trig_match,
+	output wire logic [31:0] trace_addr,
+	input wire logic [31:0] trace_status,
+	input wire logic [31:0] trace_data,
+
+	input wire logic [COUNTER_W-1:0] perf_counters [SP_NPERF_EVENTS],
+
+	output var logic load_start,
+	output wire logic [SYSTEM_ADDR_WIDTH-1:0] load_src,
+	output wire logic [31:0] load_dst,
+	output wire logic [31:0] load_size,
+	output wire logic [31:0] load_crc,
+	input wire logic [31:0] load_status,
 
 	local_memory_interface.master instruction_bram_mmr,
 	local_memory_interface.master data_bram_mmr
 );
 
+if (NQUEUES > MMR_MAX_NQUEUES) begin
+	$error("NQUEUES (%d) must not exceed MMR_MAX_NQUEUES (%d)\n", NQUEUES, MMR_MAX_NQUEUES);
+end
+
 var logic cpu_reset_ff = 1'b1;
 assign cpu_reset = cpu_reset_ff;
 
@@ -88,7 +210,122 @@ assign mmr_r.data[MMR_R_REGN_INFO][3:0] = INSTANCE[3:0];
 assign mmr_r.data[MMR_R_REGN_DATA_FIFO_SIZE] = DATA_FIFO_SIZE;
 assign mmr_r.data[MMR_R_REGN_DATA_FIFO_WIDTH] = DATA_FIFO_WIDTH;
 
-assign dma_desc_base = { mmr_r.data[MMR_R_REGN_QP_MSB], mmr_r.data[MMR_R_REGN_QP_LSB] };
+assign mmr_r.data[MMR_R_REGN_TX_UNDERFLOWS] = tx_underflows;
+assign mmr_r.data[MMR_R_REGN_TX_TIME] = tx_time;
+assign mmr_r.data[MMR_R_REGN_TRACE_STATUS] = trace_status;
+assign mmr_r.data[MMR_R_REGN_TRACE_DATA] = trace_data;
+assign mmr_r.data[MMR_R_REGN_TGEN_SENT] = tgen_sent;
+assign mmr_r.data[MMR_R_REGN_FLOW_DROPS] = flow_drops;
+assign mmr_r.data[MMR_R_REGN_ADMIT_DROPS] = admit_drops;
+assign mmr_r.data[MMR_R_REGN_SPILL_LEVEL] = spill_level;
+assign mmr_r.data[MMR_R_REGN_SPILL_BURSTS] = spill_bursts;
+assign mmr_r.data[MMR_R_REGN_CAPTURE_HEAD] = capture_head;
+assign mmr_r.data[MMR_R_REGN_CAPTURE_DROPS] = capture_drops;
+assign mmr_r.data[MMR_R_REGN_TCHK_FRAMES] = tchk_results.frames;
+assign mmr_r.data[MMR_R_REGN_TCHK_LOST] = tchk_results.lost;
+assign mmr_r.data[MMR_R_REGN_TCHK_REORDERED] = tchk_results.reordered;
+assign mmr_r.data[MMR_R_REGN_TCHK_CORRUPT] = tchk_results.corrupt;
+assign mmr_r.data[MMR_R_REGN_TCHK_LAT_MIN] = tchk_results.lat_min;
+assign mmr_r.data[MMR_R_REGN_TCHK_LAT_MAX] = tchk_results.lat_max;
+
+wire logic [7:0] perf_select = mmr_r.data[MMR_R_REGN_PERF_SELECT][7:0];
+wire logic [63:0] perf_counter = perf_select < SP_NPERF_EVENTS ? 64'(perf_counters[perf_select]) : '0;
+assign mmr_r.data[MMR_R_REGN_PERF_LSB] = perf_counter[31:0];
+assign mmr_r.data[MMR_R_REGN_PERF_MSB] = perf_counter[63:32];
+assign mmr_r.data[MMR_R_REGN_LOAD_CONTROL] = load_status;
+
+assign dma_desc_base[0] = { mmr_r.data[MMR_R_REGN_QP_MSB], mmr_r.data[MMR_R_REGN_QP_LSB] };
+assign queue_enable[0] = enable;
+for (genvar q = 1; q < NQUEUES; q++) begin
+	assign dma_desc_base[q] = {
+		mmr_r.data[MMR_R_REGN_QP1_MSB + 2*(q-1)],
+		mmr_r.data[MMR_R_REGN_QP1_LSB + 2*(q-1)]
+	};
+	assign queue_enable[q] = enable & mmr_r.data[MMR_R_REGN_QUEUE_CONTROL][q];
+end
+assign queue_weights = mmr_r.data[MMR_R_REGN_QUEUE_WEIGHTS];
+assign queue_wrr = mmr_r.data[MMR_R_REGN_QUEUE_CONTROL][QUEUE_CONTROL_WRR_BITN];
+assign rx_prio_map = mmr_r.data[MMR_R_REGN_RX_PRIO_MAP];
+for (genvar q = 0; q < NQUEUES; q++) begin
+	assign tx_queue_rate[q] = mmr_r.data[MMR_R_REGN_TX_Q0_RATE + 2*q];
+	assign tx_queue_burst[q] = mmr_r.data[MMR_R_REGN_TX_Q0_BURST + 2*q];
+end
+assign tx_port_rate = mmr_r.data[MMR_R_REGN_TX_PORT_RATE];
+assign tx_port_burst = mmr_r.data[MMR_R_REGN_TX_PORT_BURST];
+assign tx_ct_size = mmr_r.data[MMR_R_REGN_TX_CUT_THROUGH][TX_META_DESC_SIZE_WIDTH-1:0];
+assign bypass_enable = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL][0];
+assign bypass_word = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL][BYPASS_CONTROL_WORD_BITN +: BYPASS_CONTROL_WORD_WIDTH];
+assign bypass_mask = mmr_r.data[MMR_R_REGN_BYPASS_MASK];
+assign bypass_match = mmr_r.data[MMR_R_REGN_BYPASS_MATCH];
+assign bypass_key_enable = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL][BYPASS_CONTROL_KEY_BITN];
+assign bypass_key_word = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL][BYPASS_CONTROL_KEY_WORD_BITN +: BYPASS_CONTROL_WORD_WIDTH];
+assign bypass_key_shift = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL][BYPASS_CONTROL_KEY_SHIFT_BITN +: 5];
+assign cq_enable = mmr_r.data[MMR_R_REGN_CQ_CONTROL][0];
+assign cq_size = mmr_r.data[MMR_R_REGN_CQ_CONTROL][CQ_CONTROL_SIZE_BITN +: CQ_CONTROL_SIZE_WIDTH];
+assign poll_enable = mmr_r.data[MMR_R_REGN_POLL_CONTROL][0];
+assign poll_min_shift = mmr_r.data[MMR_R_REGN_POLL_CONTROL][POLL_CONTROL_MIN_SHIFT_BITN +: POLL_CONTROL_SHIFT_WIDTH];
+assign poll_max_shift = mmr_r.data[MMR_R_REGN_POLL_CONTROL][POLL_CONTROL_MAX_SHIFT_BITN +: POLL_CONTROL_SHIFT_WIDTH];
+assign cq_base = { mmr_r.data[MMR_R_REGN_CQ_MSB], mmr_r.data[MMR_R_REGN_CQ_LSB] };
+assign ring_size = mmr_r.data[MMR_R_REGN_RING_SIZE][VIRTQ_RING_SIZE_WIDTH-1:0];
+assign virtq_event_addr = { mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_MSB], mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_LSB] };
+assign rx_stride_enable = mmr_r.data[MMR_R_REGN_RX_STRIDE][0] & cq_enable;
+assign rx_stride_shift = 5'(mmr_r.data[MMR_R_REGN_RX_STRIDE][RX_STRIDE_SHIFT_BITN +: RX_STRIDE_SHIFT_WIDTH]) + 5'd6;
+assign rx_buf_shift = mmr_r.data[MMR_R_REGN_RX_STRIDE][RX_STRIDE_BUF_SHIFT_BITN +: RX_STRIDE_BUF_SHIFT_WIDTH];
+assign rx_buf_reserve = mmr_r.data[MMR_R_REGN_RX_STRIDE][RX_STRIDE_RESERVE_BITN +: RX_STRIDE_RESERVE_WIDTH];
+assign tgen_control = mmr_r.data[MMR_R_REGN_TGEN_CONTROL];
+assign tgen_size = mmr_r.data[MMR_R_REGN_TGEN_SIZE];
+assign tgen_count = mmr_r.data[MMR_R_REGN_TGEN_COUNT];
+assign rx_digest_range = mmr_r.data[MMR_R_REGN_RX_DIGEST];
+assign flow_enable = mmr_r.data[MMR_R_REGN_FLOW_CONTROL][0];
+assign flow_export_enable = mmr_r.data[MMR_R_REGN_FLOW_CONTROL][FLOW_CONTROL_EXPORT_BITN];
+assign flow_size = mmr_r.data[MMR_R_REGN_FLOW_CONTROL][FLOW_CONTROL_SIZE_BITN +: FLOW_CONTROL_SIZE_WIDTH];
+assign flow_base = { mmr_r.data[MMR_R_REGN_FLOW_MSB], mmr_r.data[MMR_R_REGN_FLOW_LSB] };
+assign flow_timeout = mmr_r.data[MMR_R_REGN_FLOW_TIMEOUT];
+assign admit_control = mmr_r.data[MMR_R_REGN_ADMIT_CONTROL];
+assign admit_thresh = mmr_r.data[MMR_R_REGN_ADMIT_THRESH];
+assign pause_control = mmr_r.data[MMR_R_REGN_PAUSE_CONTROL];
+assign pause_sa = { mmr_r.data[MMR_R_REGN_PAUSE_SA_MSB][15:0], mmr_r.data[MMR_R_REGN_PAUSE_SA_LSB] };
+assign axattr_desc_rd = mmr_r.data[MMR_R_REGN_AXATTR_DESC_RD];
+assign axattr_desc_wr = mmr_r.data[MMR_R_REGN_AXATTR_DESC_WR];
+assign axattr_hdr = mmr_r.data[MMR_R_REGN_AXATTR_HDR];
+assign axattr_data = mmr_r.data[MMR_R_REGN_AXATTR_DATA];
+assign axattr_flow = mmr_r.data[MMR_R_REGN_AXATTR_FLOW];
+assign axattr_capture = mmr_r.data[MMR_R_REGN_AXATTR_CAPTURE];
+assign spill_enable = mmr_r.data[MMR_R_REGN_SPILL_CONTROL][0];
+assign spill_size = mmr_r.data[MMR_R_REGN_SPILL_CONTROL][SPILL_CONTROL_SIZE_BITN +: SPILL_CONTROL_SIZE_WIDTH];
+assign spill_base = { mmr_r.data[MMR_R_REGN_SPILL_MSB], mmr_r.data[MMR_R_REGN_SPILL_LSB] };
+assign axattr_spill = mmr_r.data[MMR_R_REGN_AXATTR_SPILL];
+assign esp_sa_key = {
+	mmr_r.data[MMR_R_REGN_ESP_SA_KEY0],
+	mmr_r.data[MMR_R_REGN_ESP_SA_KEY1],
+	mmr_r.data[MMR_R_REGN_ESP_SA_KEY2],
+	mmr_r.data[MMR_R_REGN_ESP_SA_KEY3]
+};
+assign esp_sa_salt = mmr_r.data[MMR_R_REGN_ESP_SA_SALT];
+assign esp_sa_spi = mmr_r.data[MMR_R_REGN_ESP_SA_SPI];
+assign esp_sa_control = mmr_r.data[MMR_R_REGN_ESP_SA_CONTROL];
+assign tunnel_control = mmr_r.data[MMR_R_REGN_TUNNEL_CONTROL];
+assign tunnel_tmpl = mmr_r.data[MMR_R_REGN_TUNNEL_TMPL];
+assign tunnel_tmpl_addr = mmr_r.data[MMR_R_REGN_TUNNEL_TMPL_ADDR];
+assign capture_control = mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL];
+assign capture_mask = mmr_r.data[MMR_R_REGN_CAPTURE_MASK];
+assign capture_match = mmr_r.data[MMR_R_REGN_CAPTURE_MATCH];
+assign capture_enable = mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL][0];
+assign capture_size = mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL][CAPTURE_CONTROL_SIZE_BITN +: CAPTURE_CONTROL_SIZE_WIDTH];
+assign capture_base = { mmr_r.data[MMR_R_REGN_CAPTURE_MSB], mmr_r.data[MMR_R_REGN_CAPTURE_LSB] };
+assign capture_tail = mmr_r.data[MMR_R_REGN_CAPTURE_TAIL];
+assign tchk_control = mmr_r.data[MMR_R_REGN_TCHK_CONTROL];
+assign trace_arm = mmr_r.data[MMR_R_REGN_TRACE_CONTROL][0];
+assign trace_force = mmr_r.data[MMR_R_REGN_TRACE_CONTROL][TRACE_CONTROL_FORCE_BITN];
+assign trace_window = mmr_r.data[MMR_R_REGN_TRACE_CONTROL][TRACE_CONTROL_WINDOW_BITN +: TRACE_CONTROL_WINDOW_WIDTH];
+assign trace_post = mmr_r.data[MMR_R_REGN_TRACE_CONTROL][TRACE_CONTROL_POST_BITN +: TRACE_CONTROL_POST_WIDTH];
+assign trace_trig_mask = mmr_r.data[MMR_R_REGN_TRACE_TRIG_MASK];
+assign trace_trig_match = mmr_r.data[MMR_R_REGN_TRACE_TRIG_MATCH];
+assign trace_addr = mmr_r.data[MMR_R_REGN_TRACE_ADDR];
+assign load_src = { mmr_r.data[MMR_R_REGN_LOAD_SRC_MSB], mmr_r.data[MMR_R_REGN_LOAD_SRC_LSB] };
+assign load_dst = mmr_r.data[MMR_R_REGN_LOAD_DST];
+assign load_size = mmr_r.data[MMR_R_REGN_LOAD_SIZE];
+assign load_crc = mmr_r.data[MMR_R_REGN_LOAD_CRC];
 assign enable = mmr_rw.data[MMR_RW_REGN_CONTROL][0];
 
 task mmr_write(
@@ -99,7 +336,8 @@ task mmr_write(
 
 	case (awaddr[MMR_RANGE_WIDTH-1:0])
 	REGOFF_CONTROL: begin
-		cpu_reset_ff <= wdata[31];
+		// The CPU stays in reset while the loader owns its BRAMs.
+		cpu_reset_ff <= wdata[31] | load_start | load_status[0];
 		mmr_rw.data[MMR_RW_REGN_CONTROL] <= wdata[7:0];
 	end
 
@@ -134,6 +372,295 @@ task mmr_write(
 		mmr_r.data[MMR_R_REGN_QP_MSB] <= wdata;
 	end
 
+	REGOFF_TX_CUT_THROUGH: begin
+		mmr_r.data[MMR_R_REGN_TX_CUT_THROUGH] <= 32'(wdata[TX_META_DESC_SIZE_WIDTH-1:0]);
+	end
+
+	REGOFF_QUEUE_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_QUEUE_CONTROL] <= wdata;
+	end
+
+	REGOFF_QUEUE_WEIGHTS: begin
+		mmr_r.data[MMR_R_REGN_QUEUE_WEIGHTS] <= wdata;
+	end
+
+	REGOFF_RX_PRIO_MAP: begin
+		mmr_r.data[MMR_R_REGN_RX_PRIO_MAP] <= wdata;
+	end
+
+	REGOFF_QP1_LSB: begin
+		mmr_r.data[MMR_R_REGN_QP1_LSB] <= wdata;
+	end
+
+	REGOFF_QP1_MSB: begin
+		mmr_r.data[MMR_R_REGN_QP1_MSB] <= wdata;
+	end
+
+	REGOFF_QP2_LSB: begin
+		mmr_r.data[MMR_R_REGN_QP2_LSB] <= wdata;
+	end
+
+	REGOFF_QP2_MSB: begin
+		mmr_r.data[MMR_R_REGN_QP2_MSB] <= wdata;
+	end
+
+	REGOFF_QP3_LSB: begin
+		mmr_r.data[MMR_R_REGN_QP3_LSB] <= wdata;
+	end
+
+	REGOFF_QP3_MSB: begin
+		mmr_r.data[MMR_R_REGN_QP3_MSB] <= wdata;
+	end
+
+	REGOFF_TX_PORT_RATE: begin
+		mmr_r.data[MMR_R_REGN_TX_PORT_RATE] <= wdata;
+	end
+
+	REGOFF_TX_PORT_BURST: begin
+		mmr_r.data[MMR_R_REGN_TX_PORT_BURST] <= wdata;
+	end
+
+	REGOFF_TX_Q0_RATE: begin
+		mmr_r.data[MMR_R_REGN_TX_Q0_RATE] <= wdata;
+	end
+
+	REGOFF_TX_Q0_BURST: begin
+		mmr_r.data[MMR_R_REGN_TX_Q0_BURST] <= wdata;
+	end
+
+	REGOFF_TX_Q1_RATE: begin
+		mmr_r.data[MMR_R_REGN_TX_Q1_RATE] <= wdata;
+	end
+
+	REGOFF_TX_Q1_BURST: begin
+		mmr_r.data[MMR_R_REGN_TX_Q1_BURST] <= wdata;
+	end
+
+	REGOFF_TX_Q2_RATE: begin
+		mmr_r.data[MMR_R_REGN_TX_Q2_RATE] <= wdata;
+	end
+
+	REGOFF_TX_Q2_BURST: begin
+		mmr_r.data[MMR_R_REGN_TX_Q2_BURST] <= wdata;
+	end
+
+	REGOFF_TX_Q3_RATE: begin
+		mmr_r.data[MMR_R_REGN_TX_Q3_RATE] <= wdata;
+	end
+
+	REGOFF_TX_Q3_BURST: begin
+		mmr_r.data[MMR_R_REGN_TX_Q3_BURST] <= wdata;
+	end
+
+	REGOFF_BYPASS_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_BYPASS_CONTROL] <= wdata;
+	end
+
+	REGOFF_BYPASS_MASK: begin
+		mmr_r.data[MMR_R_REGN_BYPASS_MASK] <= wdata;
+	end
+
+	REGOFF_BYPASS_MATCH: begin
+		mmr_r.data[MMR_R_REGN_BYPASS_MATCH] <= wdata;
+	end
+
+	REGOFF_CQ_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_CQ_CONTROL] <= wdata;
+	end
+
+	REGOFF_CQ_LSB: begin
+		mmr_r.data[MMR_R_REGN_CQ_LSB] <= wdata;
+	end
+
+	REGOFF_CQ_MSB: begin
+		mmr_r.data[MMR_R_REGN_CQ_MSB] <= wdata;
+	end
+
+	REGOFF_RING_SIZE: begin
+		mmr_r.data[MMR_R_REGN_RING_SIZE] <= wdata;
+	end
+
+	REGOFF_VIRTQ_EVENT_LSB: begin
+		mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_LSB] <= wdata;
+	end
+
+	REGOFF_VIRTQ_EVENT_MSB: begin
+		mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_MSB] <= wdata;
+	end
+
+	REGOFF_TRACE_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_TRACE_CONTROL] <= wdata;
+	end
+
+	REGOFF_TRACE_TRIG_MASK: begin
+		mmr_r.data[MMR_R_REGN_TRACE_TRIG_MASK] <= wdata;
+	end
+
+	REGOFF_TRACE_TRIG_MATCH: begin
+		mmr_r.data[MMR_R_REGN_TRACE_TRIG_MATCH] <= wdata;
+	end
+
+	REGOFF_TRACE_ADDR: begin
+		mmr_r.data[MMR_R_REGN_TRACE_ADDR] <= wdata;
+	end
+
+	REGOFF_PERF_SELECT: begin
+		mmr_r.data[MMR_R_REGN_PERF_SELECT] <= wdata;
+	end
+
+	REGOFF_LOAD_SRC_LSB: begin
+		mmr_r.data[MMR_R_REGN_LOAD_SRC_LSB] <= wdata;
+	end
+	REGOFF_LOAD_SRC_MSB: begin
+		mmr_r.data[MMR_R_REGN_LOAD_SRC_MSB] <= wdata;
+	end
+	REGOFF_LOAD_DST: begin
+		mmr_r.data[MMR_R_REGN_LOAD_DST] <= wdata;
+	end
+	REGOFF_LOAD_SIZE: begin
+		mmr_r.data[MMR_R_REGN_LOAD_SIZE] <= wdata;
+	end
+	REGOFF_LOAD_CRC: begin
+		mmr_r.data[MMR_R_REGN_LOAD_CRC] <= wdata;
+	end
+	REGOFF_RX_STRIDE: begin
+		mmr_r.data[MMR_R_REGN_RX_STRIDE] <= wdata;
+	end
+	REGOFF_POLL_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_POLL_CONTROL] <= wdata;
+	end
+	REGOFF_TGEN_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_TGEN_CONTROL] <= wdata;
+	end
+	REGOFF_TGEN_SIZE: begin
+		mmr_r.data[MMR_R_REGN_TGEN_SIZE] <= wdata;
+	end
+	REGOFF_TGEN_COUNT: begin
+		mmr_r.data[MMR_R_REGN_TGEN_COUNT] <= wdata;
+	end
+	REGOFF_TCHK_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_TCHK_CONTROL] <= wdata;
+	end
+	REGOFF_RX_DIGEST: begin
+		mmr_r.data[MMR_R_REGN_RX_DIGEST] <= wdata;
+	end
+	REGOFF_ESP_SA_KEY0: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY0] <= wdata;
+	end
+	REGOFF_ESP_SA_KEY1: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY1] <= wdata;
+	end
+	REGOFF_ESP_SA_KEY2: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY2] <= wdata;
+	end
+	REGOFF_ESP_SA_KEY3: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY3] <= wdata;
+	end
+	REGOFF_ESP_SA_SALT: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_SALT] <= wdata;
+	end
+	REGOFF_ESP_SA_SPI: begin
+		mmr_r.data[MMR_R_REGN_ESP_SA_SPI] <= wdata;
+	end
+	REGOFF_ESP_SA_CONTROL: begin
+		// Every write commits the SA (see prism_sp_esp_gcm).
+		mmr_r.data[MMR_R_REGN_ESP_SA_CONTROL] <= { ~mmr_r.data[MMR_R_REGN_ESP_SA_CONTROL][31], wdata[30:0] };
+	end
+	REGOFF_TUNNEL_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_TUNNEL_CONTROL] <= wdata;
+	end
+	REGOFF_TUNNEL_TMPL: begin
+		mmr_r.data[MMR_R_REGN_TUNNEL_TMPL] <= wdata;
+	end
+	REGOFF_TUNNEL_TMPL_ADDR: begin
+		// Every write stores TUNNEL_TMPL (see prism_sp_gem_tx_single).
+		mmr_r.data[MMR_R_REGN_TUNNEL_TMPL_ADDR] <= { ~mmr_r.data[MMR_R_REGN_TUNNEL_TMPL_ADDR][31], wdata[30:0] };
+	end
+	REGOFF_FLOW_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_FLOW_CONTROL] <= wdata;
+	end
+	REGOFF_FLOW_TIMEOUT: begin
+		mmr_r.data[MMR_R_REGN_FLOW_TIMEOUT] <= wdata;
+	end
+	REGOFF_FLOW_LSB: begin
+		mmr_r.data[MMR_R_REGN_FLOW_LSB] <= wdata;
+	end
+	REGOFF_FLOW_MSB: begin
+		mmr_r.data[MMR_R_REGN_FLOW_MSB] <= wdata;
+	end
+	REGOFF_CAPTURE_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL] <= wdata;
+	end
+	REGOFF_CAPTURE_MASK: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_MASK] <= wdata;
+	end
+	REGOFF_CAPTURE_MATCH: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_MATCH] <= wdata;
+	end
+	REGOFF_CAPTURE_LSB: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_LSB] <= wdata;
+	end
+	REGOFF_CAPTURE_MSB: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_MSB] <= wdata;
+	end
+	REGOFF_CAPTURE_TAIL: begin
+		mmr_r.data[MMR_R_REGN_CAPTURE_TAIL] <= wdata;
+	end
+	REGOFF_ADMIT_CONTROL: begin
+		if (USE_ADMIT)
+			mmr_r.data[MMR_R_REGN_ADMIT_CONTROL] <= wdata;
+	end
+	REGOFF_ADMIT_THRESH: begin
+		if (USE_ADMIT)
+			mmr_r.data[MMR_R_REGN_ADMIT_THRESH] <= wdata;
+	end
+	REGOFF_PAUSE_CONTROL: begin
+		if (USE_ADMIT)
+			mmr_r.data[MMR_R_REGN_PAUSE_CONTROL] <= wdata;
+	end
+	REGOFF_PAUSE_SA_LSB: begin
+		if (USE_ADMIT)
+			mmr_r.data[MMR_R_REGN_PAUSE_SA_LSB] <= wdata;
+	end
+	REGOFF_PAUSE_SA_MSB: begin
+		if (USE_ADMIT)
+			mmr_r.data[MMR_R_REGN_PAUSE_SA_MSB] <= wdata;
+	end
+	REGOFF_AXATTR_DESC_RD: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_DESC_RD] <= wdata;
+	end
+	REGOFF_AXATTR_DESC_WR: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_DESC_WR] <= wdata;
+	end
+	REGOFF_AXATTR_HDR: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_HDR] <= wdata;
+	end
+	REGOFF_AXATTR_DATA: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_DATA] <= wdata;
+	end
+	REGOFF_SPILL_CONTROL: begin
+		mmr_r.data[MMR_R_REGN_SPILL_CONTROL] <= wdata;
+	end
+	REGOFF_SPILL_LSB: begin
+		mmr_r.data[MMR_R_REGN_SPILL_LSB] <= wdata;
+	end
+	REGOFF_SPILL_MSB: begin
+		mmr_r.data[MMR_R_REGN_SPILL_MSB] <= wdata;
+	end
+	REGOFF_AXATTR_SPILL: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_SPILL] <= wdata;
+	end
+	REGOFF_AXATTR_FLOW: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_FLOW] <= wdata;
+	end
+	REGOFF_AXATTR_CAPTURE: begin
+		mmr_r.data[MMR_R_REGN_AXATTR_CAPTURE] <= wdata;
+	end
+	REGOFF_LOAD_CONTROL: begin
+		// The loader owns the BRAMs and the IO bus of the CPU.
+		load_start <= wdata[0] & cpu_reset_ff;
+	end
+
 	REGOFF_TER: begin
 		mmr_t.tsr[0] <= mmr_t.tsr[0] | wdata[mmr_t.WIDTH-1:0];
 	end
@@ -170,6 +697,83 @@ always_ff @(posedge clock) begin
 
 		mmr_r.data[MMR_R_REGN_QP_LSB] <= '0;
 		mmr_r.data[MMR_R_REGN_QP_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_TX_CUT_THROUGH] <= '0;
+		mmr_r.data[MMR_R_REGN_QUEUE_CONTROL] <= '0;
+		// One frame per round for every ring.
+		mmr_r.data[MMR_R_REGN_QUEUE_WEIGHTS] <= 32'h11111111;
+		// All priorities go to ring 0.
+		mmr_r.data[MMR_R_REGN_RX_PRIO_MAP] <= '0;
+		for (int i = MMR_R_REGN_QP1_LSB; i <= MMR_R_REGN_QP3_MSB; i++)
+			mmr_r.data[i] <= '0;
+		// The TX shaper is disabled.
+		mmr_r.data[MMR_R_REGN_TX_PORT_RATE] <= '0;
+		mmr_r.data[MMR_R_REGN_TX_PORT_BURST] <= '0;
+		for (int i = MMR_R_REGN_TX_Q0_RATE; i <= MMR_R_REGN_TX_Q3_BURST; i++)
+			mmr_r.data[i] <= '0;
+		// Every cookie goes through the RISC-V core.
+		mmr_r.data[MMR_R_REGN_BYPASS_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_BYPASS_MASK] <= '0;
+		mmr_r.data[MMR_R_REGN_BYPASS_MATCH] <= '0;
+		// Completions are written back to the descriptors.
+		mmr_r.data[MMR_R_REGN_CQ_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_CQ_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_CQ_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_RING_SIZE] <= '0;
+		mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_MSB] <= '0;
+		// The trace recorder is disarmed.
+		mmr_r.data[MMR_R_REGN_TRACE_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_TRACE_TRIG_MASK] <= '0;
+		mmr_r.data[MMR_R_REGN_TRACE_TRIG_MATCH] <= '0;
+		mmr_r.data[MMR_R_REGN_TRACE_ADDR] <= '0;
+		mmr_r.data[MMR_R_REGN_PERF_SELECT] <= '0;
+		mmr_r.data[MMR_R_REGN_LOAD_SRC_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_LOAD_SRC_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_LOAD_DST] <= '0;
+		mmr_r.data[MMR_R_REGN_LOAD_SIZE] <= '0;
+		mmr_r.data[MMR_R_REGN_LOAD_CRC] <= '0;
+		mmr_r.data[MMR_R_REGN_RX_STRIDE] <= '0;
+		mmr_r.data[MMR_R_REGN_POLL_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_TGEN_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_TGEN_SIZE] <= '0;
+		mmr_r.data[MMR_R_REGN_TGEN_COUNT] <= '0;
+		mmr_r.data[MMR_R_REGN_TCHK_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_RX_DIGEST] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY0] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY1] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY2] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_KEY3] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_SALT] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_SPI] <= '0;
+		mmr_r.data[MMR_R_REGN_ESP_SA_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_TUNNEL_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_TUNNEL_TMPL] <= '0;
+		mmr_r.data[MMR_R_REGN_TUNNEL_TMPL_ADDR] <= '0;
+		mmr_r.data[MMR_R_REGN_FLOW_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_FLOW_TIMEOUT] <= '0;
+		mmr_r.data[MMR_R_REGN_FLOW_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_FLOW_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_MASK] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_MATCH] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_CAPTURE_TAIL] <= '0;
+		mmr_r.data[MMR_R_REGN_ADMIT_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_ADMIT_THRESH] <= '0;
+		mmr_r.data[MMR_R_REGN_PAUSE_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_PAUSE_SA_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_PAUSE_SA_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_DESC_RD] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_DESC_WR] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_HDR] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_DATA] <= '0;
+		mmr_r.data[MMR_R_REGN_SPILL_CONTROL] <= '0;
+		mmr_r.data[MMR_R_REGN_SPILL_LSB] <= '0;
+		mmr_r.data[MMR_R_REGN_SPILL_MSB] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_SPILL] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_FLOW] <= '0;
+		mmr_r.data[MMR_R_REGN_AXATTR_CAPTURE] <= '0;
 		io_axi_axcache <= 4'b0000;
 		dma_axi_axcache <= 4'b0000;
 
@@ -180,11 +784,13 @@ always_ff @(posedge clock) begin
 
 		instruction_bram_mmr.en <= 1'b0;
 		data_bram_mmr.en <= 1'b0;
+		load_start <= 1'b0;
 	end
 	else begin
 		// Unpulse
 		instruction_bram_mmr.en <= 1'b0;
 		data_bram_mmr.en <= 1'b0;
+		load_start <= 1'b0;
 
 		if (mmr_rw.store) begin
 			mmr_rw.data[mmr_rw.store_idx] <= mmr_rw.store_data;
@@ -266,6 +872,409 @@ always_comb begin
 		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP_MSB];
 	end
 
+	REGOFF_TX_CUT_THROUGH: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_CUT_THROUGH];
+	end
+
+	REGOFF_TX_UNDERFLOWS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_UNDERFLOWS];
+	end
+
+	REGOFF_QUEUE_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QUEUE_CONTROL];
+	end
+
+	REGOFF_QUEUE_WEIGHTS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QUEUE_WEIGHTS];
+	end
+
+	REGOFF_RX_PRIO_MAP: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_RX_PRIO_MAP];
+	end
+
+	REGOFF_QP1_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP1_LSB];
+	end
+
+	REGOFF_QP1_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP1_MSB];
+	end
+
+	REGOFF_QP2_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP2_LSB];
+	end
+
+	REGOFF_QP2_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP2_MSB];
+	end
+
+	REGOFF_QP3_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP3_LSB];
+	end
+
+	REGOFF_QP3_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_QP3_MSB];
+	end
+
+	REGOFF_TX_PORT_RATE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_PORT_RATE];
+	end
+
+	REGOFF_TX_PORT_BURST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_PORT_BURST];
+	end
+
+	REGOFF_TX_TIME: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_TIME];
+	end
+
+	REGOFF_TX_Q0_RATE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q0_RATE];
+	end
+
+	REGOFF_TX_Q0_BURST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q0_BURST];
+	end
+
+	REGOFF_TX_Q1_RATE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q1_RATE];
+	end
+
+	REGOFF_TX_Q1_BURST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q1_BURST];
+	end
+
+	REGOFF_TX_Q2_RATE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q2_RATE];
+	end
+
+	REGOFF_TX_Q2_BURST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q2_BURST];
+	end
+
+	REGOFF_TX_Q3_RATE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q3_RATE];
+	end
+
+	REGOFF_TX_Q3_BURST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TX_Q3_BURST];
+	end
+
+	REGOFF_BYPASS_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_BYPASS_CONTROL];
+	end
+
+	REGOFF_BYPASS_MASK: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_BYPASS_MASK];
+	end
+
+	REGOFF_BYPASS_MATCH: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_BYPASS_MATCH];
+	end
+
+	REGOFF_CQ_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CQ_CONTROL];
+	end
+
+	REGOFF_CQ_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CQ_LSB];
+	end
+
+	REGOFF_CQ_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CQ_MSB];
+	end
+
+	REGOFF_RING_SIZE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_RING_SIZE];
+	end
+
+	REGOFF_VIRTQ_EVENT_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_LSB];
+	end
+
+	REGOFF_VIRTQ_EVENT_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_VIRTQ_EVENT_MSB];
+	end
+
+	REGOFF_TRACE_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_CONTROL];
+	end
+
+	REGOFF_TRACE_TRIG_MASK: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_TRIG_MASK];
+	end
+
+	REGOFF_TRACE_TRIG_MATCH: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_TRIG_MATCH];
+	end
+
+	REGOFF_TRACE_ADDR: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_ADDR];
+	end
+
+	REGOFF_TRACE_STATUS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_STATUS];
+	end
+
+	REGOFF_TRACE_DATA: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TRACE_DATA];
+	end
+
+	REGOFF_PERF_SELECT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PERF_SELECT];
+	end
+
+	REGOFF_PERF_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PERF_LSB];
+	end
+
+	REGOFF_PERF_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PERF_MSB];
+	end
+
+	REGOFF_LOAD_SRC_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_SRC_LSB];
+	end
+	REGOFF_LOAD_SRC_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_SRC_MSB];
+	end
+	REGOFF_LOAD_DST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_DST];
+	end
+	REGOFF_LOAD_SIZE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_SIZE];
+	end
+	REGOFF_LOAD_CRC: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_CRC];
+	end
+	REGOFF_LOAD_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_LOAD_CONTROL];
+	end
+
+	REGOFF_RX_STRIDE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_RX_STRIDE];
+	end
+
+	REGOFF_POLL_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_POLL_CONTROL];
+	end
+
+	REGOFF_TGEN_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TGEN_CONTROL];
+	end
+
+	REGOFF_TGEN_SIZE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TGEN_SIZE];
+	end
+
+	REGOFF_TGEN_COUNT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TGEN_COUNT];
+	end
+
+	REGOFF_TGEN_SENT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TGEN_SENT];
+	end
+
+	REGOFF_TCHK_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_CONTROL];
+	end
+
+	REGOFF_TCHK_FRAMES: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_FRAMES];
+	end
+
+	REGOFF_TCHK_LOST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_LOST];
+	end
+
+	REGOFF_TCHK_REORDERED: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_REORDERED];
+	end
+
+	REGOFF_TCHK_CORRUPT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_CORRUPT];
+	end
+
+	REGOFF_TCHK_LAT_MIN: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_LAT_MIN];
+	end
+
+	REGOFF_TCHK_LAT_MAX: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TCHK_LAT_MAX];
+	end
+
+	REGOFF_RX_DIGEST: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_RX_DIGEST];
+	end
+
+	REGOFF_ESP_SA_KEY0: begin
+		// The key is write-only.
+		axi_rdata_next = '0;
+	end
+
+	REGOFF_ESP_SA_KEY1: begin
+		// The key is write-only.
+		axi_rdata_next = '0;
+	end
+
+	REGOFF_ESP_SA_KEY2: begin
+		// The key is write-only.
+		axi_rdata_next = '0;
+	end
+
+	REGOFF_ESP_SA_KEY3: begin
+		// The key is write-only.
+		axi_rdata_next = '0;
+	end
+
+	REGOFF_ESP_SA_SALT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ESP_SA_SALT];
+	end
+
+	REGOFF_ESP_SA_SPI: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ESP_SA_SPI];
+	end
+
+	REGOFF_ESP_SA_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ESP_SA_CONTROL];
+	end
+
+	REGOFF_TUNNEL_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TUNNEL_CONTROL];
+	end
+
+	REGOFF_TUNNEL_TMPL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TUNNEL_TMPL];
+	end
+
+	REGOFF_TUNNEL_TMPL_ADDR: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_TUNNEL_TMPL_ADDR];
+	end
+
+	REGOFF_FLOW_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_FLOW_CONTROL];
+	end
+
+	REGOFF_FLOW_TIMEOUT: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_FLOW_TIMEOUT];
+	end
+
+	REGOFF_FLOW_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_FLOW_LSB];
+	end
+
+	REGOFF_FLOW_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_FLOW_MSB];
+	end
+
+	REGOFF_FLOW_DROPS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_FLOW_DROPS];
+	end
+
+	REGOFF_CAPTURE_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_CONTROL];
+	end
+
+	REGOFF_CAPTURE_MASK: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_MASK];
+	end
+
+	REGOFF_CAPTURE_MATCH: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_MATCH];
+	end
+
+	REGOFF_CAPTURE_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_LSB];
+	end
+
+	REGOFF_CAPTURE_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_MSB];
+	end
+
+	REGOFF_CAPTURE_TAIL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_TAIL];
+	end
+
+	REGOFF_CAPTURE_HEAD: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_HEAD];
+	end
+
+	REGOFF_CAPTURE_DROPS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_CAPTURE_DROPS];
+	end
+
+	REGOFF_ADMIT_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ADMIT_CONTROL];
+	end
+
+	REGOFF_ADMIT_THRESH: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ADMIT_THRESH];
+	end
+
+	REGOFF_ADMIT_DROPS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_ADMIT_DROPS];
+	end
+
+	REGOFF_PAUSE_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PAUSE_CONTROL];
+	end
+
+	REGOFF_PAUSE_SA_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PAUSE_SA_LSB];
+	end
+
+	REGOFF_PAUSE_SA_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_PAUSE_SA_MSB];
+	end
+
+	REGOFF_AXATTR_DESC_RD: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_DESC_RD];
+	end
+
+	REGOFF_AXATTR_DESC_WR: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_DESC_WR];
+	end
+
+	REGOFF_AXATTR_HDR: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_HDR];
+	end
+
+	REGOFF_AXATTR_DATA: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_DATA];
+	end
+
+	REGOFF_SPILL_CONTROL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_SPILL_CONTROL];
+	end
+
+	REGOFF_SPILL_LSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_SPILL_LSB];
+	end
+
+	REGOFF_SPILL_MSB: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_SPILL_MSB];
+	end
+
+	REGOFF_SPILL_LEVEL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_SPILL_LEVEL];
+	end
+
+	REGOFF_SPILL_BURSTS: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_SPILL_BURSTS];
+	end
+
+	REGOFF_AXATTR_SPILL: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_SPILL];
+	end
+
+	REGOFF_AXATTR_FLOW: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_FLOW];
+	end
+
+	REGOFF_AXATTR_CAPTURE: begin
+		axi_rdata_next = mmr_r.data[MMR_R_REGN_AXATTR_CAPTURE];
+	end
+
 	REGOFF_TSR: begin
 		axi_rdata_next = 32'(mmr_t.tsr[0]);
 	end
@@ -28,32 +28,495 @@ typedef enum int {
 	MMR_R_REGN_QP_MSB,
 	MMR_R_REGN_DATA_FIFO_SIZE,
 	MMR_R_REGN_DATA_FIFO_WIDTH,
-	MMR_R_REGN_INFO
+	MMR_R_REGN_INFO,
+	MMR_R_REGN_TX_CUT_THROUGH,
+	MMR_R_REGN_TX_UNDERFLOWS,
+	MMR_R_REGN_QUEUE_CONTROL,
+	MMR_R_REGN_QUEUE_WEIGHTS,
+	MMR_R_REGN_RX_PRIO_MAP,
+	MMR_R_REGN_QP1_LSB,
+	MMR_R_REGN_QP1_MSB,
+	MMR_R_REGN_QP2_LSB,
+	MMR_R_REGN_QP2_MSB,
+	MMR_R_REGN_QP3_LSB,
+	MMR_R_REGN_QP3_MSB,
+	MMR_R_REGN_TX_PORT_RATE,
+	MMR_R_REGN_TX_PORT_BURST,
+	MMR_R_REGN_TX_TIME,
+	MMR_R_REGN_TX_Q0_RATE,
+	MMR_R_REGN_TX_Q0_BURST,
+	MMR_R_REGN_TX_Q1_RATE,
+	MMR_R_REGN_TX_Q1_BURST,
+	MMR_R_REGN_TX_Q2_RATE,
+	MMR_R_REGN_TX_Q2_BURST,
+	MMR_R_REGN_TX_Q3_RATE,
+	MMR_R_REGN_TX_Q3_BURST,
+	MMR_R_REGN_BYPASS_CONTROL,
+	MMR_R_REGN_BYPASS_MASK,
+	MMR_R_REGN_BYPASS_MATCH,
+	MMR_R_REGN_CQ_CONTROL,
+	MMR_R_REGN_CQ_LSB,
+	MMR_R_REGN_CQ_MSB,
+	MMR_R_REGN_RING_SIZE,
+	MMR_R_REGN_VIRTQ_EVENT_LSB,
+	MMR_R_REGN_VIRTQ_EVENT_MSB,
+	MMR_R_REGN_TRACE_CONTROL,
+	MMR_R_REGN_TRACE_TRIG_MASK,
+	MMR_R_REGN_TRACE_TRIG_MATCH,
+	MMR_R_REGN_TRACE_ADDR,
+	MMR_R_REGN_TRACE_STATUS,
+	MMR_R_REGN_TRACE_DATA,
+	MMR_R_REGN_PERF_SELECT,
+	MMR_R_REGN_PERF_LSB,
+	MMR_R_REGN_PERF_MSB,
+	MMR_R_REGN_LOAD_SRC_LSB,
+	MMR_R_REGN_LOAD_SRC_MSB,
+	MMR_R_REGN_LOAD_DST,
+	MMR_R_REGN_LOAD_SIZE,
+	MMR_R_REGN_LOAD_CRC,
+	MMR_R_REGN_LOAD_CONTROL,
+	MMR_R_REGN_RX_STRIDE,
+	MMR_R_REGN_POLL_CONTROL,
+	MMR_R_REGN_TGEN_CONTROL,
+	MMR_R_REGN_TGEN_SIZE,
+	MMR_R_REGN_TGEN_COUNT,
+	MMR_R_REGN_TGEN_SENT,
+	MMR_R_REGN_TCHK_CONTROL,
+	MMR_R_REGN_TCHK_FRAMES,
+	MMR_R_REGN_TCHK_LOST,
+	MMR_R_REGN_TCHK_REORDERED,
+	MMR_R_REGN_TCHK_CORRUPT,
+	MMR_R_REGN_TCHK_LAT_MIN,
+	MMR_R_REGN_TCHK_LAT_MAX,
+	MMR_R_REGN_RX_DIGEST,
+	MMR_R_REGN_ESP_SA_KEY0,
+	MMR_R_REGN_ESP_SA_KEY1,
+	MMR_R_REGN_ESP_SA_KEY2,
+	MMR_R_REGN_ESP_SA_KEY3,
+	MMR_R_REGN_ESP_SA_SALT,
+	MMR_R_REGN_ESP_SA_SPI,
+	MMR_R_REGN_ESP_SA_CONTROL,
+	MMR_R_REGN_TUNNEL_CONTROL,
+	MMR_R_REGN_TUNNEL_TMPL,
+	MMR_R_REGN_TUNNEL_TMPL_ADDR,
+	MMR_R_REGN_FLOW_CONTROL,
+	MMR_R_REGN_FLOW_TIMEOUT,
+	MMR_R_REGN_FLOW_LSB,
+	MMR_R_REGN_FLOW_MSB,
+	MMR_R_REGN_FLOW_DROPS,
+	MMR_R_REGN_CAPTURE_CONTROL,
+	MMR_R_REGN_CAPTURE_MASK,
+	MMR_R_REGN_CAPTURE_MATCH,
+	MMR_R_REGN_CAPTURE_LSB,
+	MMR_R_REGN_CAPTURE_MSB,
+	MMR_R_REGN_CAPTURE_TAIL,
+	MMR_R_REGN_CAPTURE_HEAD,
+	MMR_R_REGN_CAPTURE_DROPS,
+	MMR_R_REGN_ADMIT_CONTROL,
+	MMR_R_REGN_ADMIT_THRESH,
+	MMR_R_REGN_ADMIT_DROPS,
+	MMR_R_REGN_PAUSE_CONTROL,
+	MMR_R_REGN_PAUSE_SA_LSB,
+	MMR_R_REGN_PAUSE_SA_MSB,
+	MMR_R_REGN_AXATTR_DESC_RD,
+	MMR_R_REGN_AXATTR_DESC_WR,
+	MMR_R_REGN_AXATTR_HDR,
+	MMR_R_REGN_AXATTR_DATA,
+	MMR_R_REGN_SPILL_CONTROL,
+	MMR_R_REGN_SPILL_LSB,
+	MMR_R_REGN_SPILL_MSB,
+	MMR_R_REGN_SPILL_LEVEL,
+	MMR_R_REGN_SPILL_BURSTS,
+	MMR_R_REGN_AXATTR_SPILL,
+	MMR_R_REGN_AXATTR_FLOW,
+	MMR_R_REGN_AXATTR_CAPTURE
 } mmr_r_n;
 
 localparam int SIZEOF_REG = 4;
-// 8 = 2**8/256 bytes of MMR addresses
-localparam int MMR_RANGE_WIDTH = 8;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CONTROL			= 8'h000;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_STATUS			= 8'h004;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_INFO				= 8'h008;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BRAM_ADDR			= 8'h010;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BRAM_DATA			= 8'h014;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IO_AXI_AXCACHE	= 8'h020;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_DMA_AXI_AXCACHE	= 8'h024;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RESERVED0			= 8'h028;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RESERVED1			= 8'h02c;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP_LSB			= 8'h030;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP_MSB			= 8'h034;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TER				= 8'h040;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TSR				= 8'h04c;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IER				= 8'h050;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IDR				= 8'h054;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IMR				= 8'h058;
-localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ISR				= 8'h05c;
+// 9 = 2**9/512 bytes of MMR addresses
+localparam int MMR_RANGE_WIDTH = 9;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CONTROL			= 9'h000;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_STATUS			= 9'h004;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_INFO				= 9'h008;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BRAM_ADDR			= 9'h010;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BRAM_DATA			= 9'h014;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IO_AXI_AXCACHE	= 9'h020;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_DMA_AXI_AXCACHE	= 9'h024;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RESERVED0			= 9'h028;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RESERVED1			= 9'h02c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP_LSB			= 9'h030;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP_MSB			= 9'h034;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TER				= 9'h040;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TSR				= 9'h04c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IER				= 9'h050;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IDR				= 9'h054;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_IMR				= 9'h058;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ISR				= 9'h05c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_CUT_THROUGH	= 9'h060;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_UNDERFLOWS		= 9'h064;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QUEUE_CONTROL		= 9'h068;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QUEUE_WEIGHTS		= 9'h06c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RX_PRIO_MAP		= 9'h070;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP1_LSB			= 9'h078;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP1_MSB			= 9'h07c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP2_LSB			= 9'h080;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP2_MSB			= 9'h084;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP3_LSB			= 9'h088;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_QP3_MSB			= 9'h08c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_PORT_RATE		= 9'h090;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_PORT_BURST		= 9'h094;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_TIME			= 9'h098;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q0_RATE		= 9'h0a0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q0_BURST		= 9'h0a4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q1_RATE		= 9'h0a8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q1_BURST		= 9'h0ac;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q2_RATE		= 9'h0b0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q2_BURST		= 9'h0b4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q3_RATE		= 9'h0b8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TX_Q3_BURST		= 9'h0bc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BYPASS_CONTROL	= 9'h0c0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BYPASS_MASK		= 9'h0c4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_BYPASS_MATCH		= 9'h0c8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CQ_CONTROL		= 9'h0cc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CQ_LSB			= 9'h0d0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CQ_MSB			= 9'h0d4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RING_SIZE			= 9'h0d8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_VIRTQ_EVENT_LSB	= 9'h0dc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_VIRTQ_EVENT_MSB	= 9'h0e0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_CONTROL		= 9'h0e4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_TRIG_MASK	= 9'h0e8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_TRIG_MATCH	= 9'h0ec;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_ADDR		= 9'h0f0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_STATUS		= 9'h0f4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TRACE_DATA		= 9'h0f8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PERF_SELECT		= 9'h0fc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PERF_LSB			= 9'h100;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PERF_MSB			= 9'h104;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_SRC_LSB		= 9'h108;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_SRC_MSB		= 9'h10c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_DST			= 9'h110;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_SIZE			= 9'h114;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_CRC			= 9'h118;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_LOAD_CONTROL		= 9'h11c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RX_STRIDE			= 9'h120;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_POLL_CONTROL		= 9'h124;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TGEN_CONTROL		= 9'h128;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TGEN_SIZE			= 9'h12c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TGEN_COUNT		= 9'h130;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TGEN_SENT			= 9'h134;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_CONTROL		= 9'h138;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_FRAMES		= 9'h13c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_LOST			= 9'h140;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_REORDERED	= 9'h144;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_CORRUPT		= 9'h148;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_LAT_MIN		= 9'h14c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TCHK_LAT_MAX		= 9'h150;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_RX_DIGEST			= 9'h154;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_KEY0		= 9'h158;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_KEY1		= 9'h15c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_KEY2		= 9'h160;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_KEY3		= 9'h164;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_SALT		= 9'h168;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_SPI		= 9'h16c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ESP_SA_CONTROL	= 9'h170;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TUNNEL_CONTROL	= 9'h174;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TUNNEL_TMPL		= 9'h178;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_TUNNEL_TMPL_ADDR	= 9'h17c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_FLOW_CONTROL		= 9'h180;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_FLOW_TIMEOUT		= 9'h184;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_FLOW_LSB			= 9'h188;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_FLOW_MSB			= 9'h18c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_FLOW_DROPS		= 9'h190;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_CONTROL	= 9'h194;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_MASK		= 9'h198;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_MATCH		= 9'h19c;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_LSB		= 9'h1a0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_MSB		= 9'h1a4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_TAIL		= 9'h1a8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_HEAD		= 9'h1ac;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_CAPTURE_DROPS		= 9'h1b0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ADMIT_CONTROL		= 9'h1b4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ADMIT_THRESH		= 9'h1b8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_ADMIT_DROPS		= 9'h1bc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PAUSE_CONTROL		= 9'h1c0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PAUSE_SA_LSB		= 9'h1c4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_PAUSE_SA_MSB		= 9'h1c8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_DESC_RD	= 9'h1cc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_DESC_WR	= 9'h1d0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_HDR		= 9'h1d4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_DATA		= 9'h1d8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_SPILL_CONTROL		= 9'h1dc;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_SPILL_LSB			= 9'h1e0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_SPILL_MSB			= 9'h1e4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_SPILL_LEVEL		= 9'h1e8;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_SPILL_BURSTS		= 9'h1ec;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_SPILL		= 9'h1f0;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_FLOW		= 9'h1f4;
+localparam logic [MMR_RANGE_WIDTH-1:0] REGOFF_AXATTR_CAPTURE	= 9'h1f8;
+
+/*
+ * QUEUE_CONTROL
+ *   [MMR_MAX_NQUEUES-1:1]	enable ring 1..N-1 (ring 0 follows CONTROL)
+ *   [16]					TX: weighted round-robin instead of strict priority
+ * QUEUE_WEIGHTS
+ *   [4*q +: 4]				TX: number of frames per round of ring q
+ * RX_PRIO_MAP
+ *   [4*p +: 4]				RX: ring for frames of priority p; a frame
+ *							whose ring has no buffer for 1024 cycles
+ *							goes to ring 0
+ * TX_PORT_RATE, TX_Qn_RATE
+ *   [15:0]					TX shaper: 1/256 bytes per clock cycle, 0 disables
+ * TX_PORT_BURST, TX_Qn_BURST
+ *   [23:0]					TX shaper: bucket size in bytes
+ * BYPASS_CONTROL
+ *   [0]					enable the puzzle FIFO bypass lane
+ *   [1]					keep the order per key instead of for all
+ *							cookies
+ *   [11:8]					32-bit word of the cookie the rule applies to
+ *   [15:12]				32-bit word of the cookie holding the key
+ *   [20:16]				position of the key (PUZZLE_BYPASS_KEY_WIDTH
+ *							bits, e.g., the TX ring) in that word
+ * BYPASS_MASK, BYPASS_MATCH
+ *   [31:0]					cookies with (word & MASK) == MATCH go to the
+ *							RISC-V core, all others bypass it
+ * CQ_CONTROL
+ *   [0]					SQ/CQ ring mode: completions go to the
+ *							completion queue at CQ_MSB:CQ_LSB (64-byte
+ *							aligned) instead of the descriptors
+ *   [12:8]					log2 of the number of completion queue entries
+ *							(3 to 16)
+ * RING_SIZE
+ *   [15:0]					virtqueue: number of descriptors of the ring
+ * VIRTQ_EVENT_MSB, VIRTQ_EVENT_LSB
+ *   [31:0]					virtqueue: address of the driver event
+ *							suppression structure
+ * TRACE_CONTROL
+ *   [0]					arm the trace recorder (0 clears it)
+ *   [1]					trigger now
+ *   [15:4]					first 32-bit word of the recorded trace window
+ *   [31:16]				number of entries recorded after the trigger
+ * TRACE_TRIG_MASK, TRACE_TRIG_MATCH
+ *   [31:0]					trigger if (word & MASK) == MATCH for the
+ *							first word of the trace window
+ * TRACE_ADDR
+ *   [17:0]					word of the trace buffer read through
+ *							TRACE_DATA (see prism_sp_trace_recorder)
+ * TRACE_STATUS
+ *   [3:0]					wrapped, done, triggered, armed
+ *   [31:16]				index of the next entry
+ * PERF_SELECT
+ *   [7:0]					SP unit event counter read through
+ *							PERF_MSB:PERF_LSB (see SP_PERF_EVENT_*)
+ * LOAD_SRC_MSB, LOAD_SRC_LSB
+ *   [31:0]					address of the firmware image
+ * LOAD_DST
+ *   [31:2]					BRAM address of the image (like BRAM_ADDR)
+ * LOAD_SIZE
+ *   [31:2]					size of the image in bytes
+ * LOAD_CRC
+ *   [31:0]					expected CRC-32 of the image
+ * LOAD_CONTROL
+ *   write [0]				start the BRAM loader (only while the CPU
+ *							is in reset)
+ *   read [3:0]				CRC error, AXI error, done, busy
+ *							(see prism_sp_bram_loader)
+ * RX_STRIDE
+ *   [0]					RX: pack frames into buffers (needs CQ_CONTROL[0])
+ *   [7:4]					RX: log2(stride) - 6
+ *   [12:8]					RX: log2(buffer size)
+ *   [31:16]				RX: a buffer is returned once fewer bytes than
+ *							this (at least the maximum frame size) are left,
+ *							after 2**16 cycles without a frame, or when [0]
+ *							is cleared
+ * POLL_CONTROL
+ *   [0]					Re-read empty rings without a doorbell
+ *   [12:8]					log2 of the first poll interval (clock cycles)
+ *   [20:16]				log2 of the maximum poll interval (clock cycles)
+ *							(see prism_sp_puzzle_hw_gem_ring_acquire)
+ * TGEN_CONTROL, TGEN_SIZE, TGEN_COUNT
+ *							RX: traffic generator configuration
+ *							(see prism_sp_traffic_gen)
+ * TGEN_SENT				RX: number of generated frames
+ * TCHK_CONTROL
+ *   [0]					TX: enable the traffic checker; clearing it
+ *							clears the results (see prism_sp_traffic_check)
+ * TCHK_FRAMES, TCHK_LOST, TCHK_REORDERED, TCHK_CORRUPT,
+ * TCHK_LAT_MIN, TCHK_LAT_MAX
+ *							TX: results of the traffic checker
+ * RX_DIGEST
+ *   [13:0]					RX: first byte covered by the CRC32C data digest
+ *   [29:16]				RX: offset of the digest (0 disables the check)
+ * ESP_SA_KEY0..ESP_SA_KEY3	AES-128 key of an ESP SA, KEY0 holds the
+ *							first 4 bytes (first byte in [31:24]);
+ *							write-only, reads return 0
+ * ESP_SA_SALT				salt of an ESP SA (first byte in [31:24])
+ * ESP_SA_SPI				SPI of an ESP SA
+ * ESP_SA_CONTROL
+ *   [1:0]					index of the SA
+ *   [8]					the SA is valid
+ *   [31]					toggled by every write, which commits the
+ *							other ESP_SA registers to the SA
+ *							(see prism_sp_esp_gcm)
+ * TUNNEL_CONTROL
+ *   [3:0]					TX: prepend the tunnel template of queue n to
+ *							the frames of queue n
+ *   [16]					RX: recognize VXLAN/GENEVE frames
+ *   [17]					RX: strip the outer headers of these frames
+ *							(see prism_sp_rx_tunnel)
+ * TUNNEL_TMPL				4 bytes of a tunnel template (first byte in
+ *							[31:24]). In the template, the IPv4 total
+ *							length and the UDP length must be zero, the
+ *							IPv4 header checksum must be computed over
+ *							that. The UDP checksum field holds the sum
+ *							(not inverted) over the addresses, the protocol,
+ *							the ports and the tunnel header. Zero sends
+ *							frames without UDP checksum.
+ * TUNNEL_TMPL_ADDR
+ *   [5:0]					queue * 16 + index of the template word
+ *   [14:8]					size of the template of that queue in bytes
+ *							(even, at most 64)
+ *   [31]					toggled by every write, which stores
+ *							TUNNEL_TMPL
+ * FLOW_CONTROL
+ *   [0]					RX: count frames per flow. Clearing it exports
+ *							all flows (see prism_sp_flow_meter).
+ *   [1]					write flow records to the export ring at
+ *							FLOW_MSB:FLOW_LSB (aligned to FLOW_BATCH
+ *							records)
+ *   [12:8]					log2 of the number of records of the export
+ *							ring (3 to 16)
+ * FLOW_TIMEOUT
+ *   [15:0]					idle timeout of a flow in ticks (0: none)
+ *   [31:16]				active timeout of a flow in ticks (0: none)
+ * FLOW_DROPS				number of flow records lost because the export
+ *							was too slow
+ * CAPTURE_CONTROL			RX: received frames, TX: sent frames
+ *   [0]					capture frames to the capture ring at
+ *							CAPTURE_MSB:CAPTURE_LSB (aligned to
+ *							CAPTURE_SLOT_SIZE)
+ *   [1]					only capture frames whose filter word ANDed
+ *							with CAPTURE_MASK equals CAPTURE_MATCH
+ *   [7:3]					log2 of the number of slots of the ring
+ *   [13:8]					index of the filter word (bytes 4n to 4n+3 of
+ *							the frame, the first byte in [31:24])
+ *   [24:16]				snap length in bytes (0: as much as fits into
+ *							a slot)
+ * CAPTURE_TAIL				number of slots the host has consumed
+ * CAPTURE_HEAD				number of slots written (wraps). Slots are only
+ *							written while CAPTURE_HEAD - CAPTURE_TAIL is
+ *							less than the size of the ring.
+ * CAPTURE_DROPS			number of frames that passed the filter but
+ *							could not be captured
+ * ADMIT_CONTROL			RX: admission control of received frames
+ *							(see prism_sp_gem_rx_single)
+ *							ADMIT_* and PAUSE_* read as zero on the TX
+ *							cores and if there is more than one RX core
+ *   [0]					drop frames early by their drop level
+ *   [1]					classify untagged IPv4/IPv6 frames by the IP
+ *							precedence (the 3 MSBs of the DSCP)
+ *   [4:2]					priority of other untagged frames
+ *   [31:16]				drop level (0 to 3) of priority n in
+ *							bits [2n+17:2n+16]
+ * ADMIT_THRESH
+ *   [8n+7:8n]				fill level of the RX buffers in 1/256 from
+ *							which on frames of drop level n are dropped
+ *							(0: never)
+ * ADMIT_DROPS				number of frames dropped early
+ * PAUSE_CONTROL			RX: flow control frames sent on the TX path
+ *   [0]					send PAUSE frames
+ *   [1]					send 802.1Qbb PFC frames instead of 802.3x
+ *							PAUSE frames
+ *   [15:8]					headroom in 1/256: priority n is paused from
+ *							the threshold of its drop level minus the
+ *							headroom on and resumed below the threshold
+ *							minus twice the headroom
+ *   [31:16]				pause time in quanta of 512 bit times
+ * PAUSE_SA_LSB				source MAC address of the PAUSE frames,
+ * PAUSE_SA_MSB				the first byte in PAUSE_SA_LSB[7:0]
+ * AXATTR_DESC_RD			AXI attributes of descriptor reads
+ * AXATTR_DESC_WR			AXI attributes of descriptor write-backs and
+ *							completion queue entries
+ * AXATTR_HDR				AXI attributes of the first bytes of every
+ *							frame buffer
+ * AXATTR_DATA				AXI attributes of the rest of every frame
+ *							buffer
+ *   [3:0]					AxCACHE
+ *   [6:4]					AxPROT
+ *   [8:7]					AxUSER
+ *   [27:16]				AXATTR_HDR: number of bytes that are written or
+ *							read with the header attributes (0: none)
+ *   [31]					use these attributes instead of the built-in
+ *							ones of the stream
+ * SPILL_CONTROL			RX: spill buffer in memory behind the RX data
+ *							FIFO (see prism_sp_rx_spill)
+ *   [0]					spill the RX data stream to the ring at
+ *							SPILL_MSB:SPILL_LSB under congestion.
+ *							Clearing it only stops further spilling.
+ *							While it is clear and the ring is empty, the
+ *							staging FIFO is bypassed.
+ *   [12:8]					log2 of the size of the ring in bytes (9 to 31)
+ * SPILL_LSB				address of the ring (aligned to 256 bytes)
+ * SPILL_MSB
+ * SPILL_LEVEL				number of bytes in the ring
+ * SPILL_BURSTS				number of bursts written to the ring
+ * AXATTR_SPILL				AXI attributes of the spill ring accesses
+ *							(see AXATTR_DESC_RD)
+ * AXATTR_FLOW				RX: AXI attributes of the flow record writes
+ *							(see AXATTR_DESC_RD)
+ * AXATTR_CAPTURE			AXI attributes of the capture ring writes
+ *							(see AXATTR_DESC_RD)
+ */
+localparam int MMR_MAX_NQUEUES = 4;
+localparam int QUEUE_CONTROL_WRR_BITN = 16;
+localparam int BYPASS_CONTROL_WORD_BITN = 8;
+localparam int BYPASS_CONTROL_WORD_WIDTH = 4;
+localparam int BYPASS_CONTROL_KEY_BITN = 1;
+localparam int BYPASS_CONTROL_KEY_WORD_BITN = 12;
+localparam int BYPASS_CONTROL_KEY_SHIFT_BITN = 16;
+localparam int CQ_CONTROL_SIZE_BITN = 8;
+localparam int CQ_CONTROL_SIZE_WIDTH = 5;
+localparam int TRACE_CONTROL_FORCE_BITN = 1;
+localparam int TRACE_CONTROL_WINDOW_BITN = 4;
+localparam int TRACE_CONTROL_WINDOW_WIDTH = 12;
+localparam int TRACE_CONTROL_POST_BITN = 16;
+localparam int TRACE_CONTROL_POST_WIDTH = 16;
+localparam int RX_STRIDE_SHIFT_BITN = 4;
+localparam int RX_STRIDE_SHIFT_WIDTH = 4;
+localparam int RX_STRIDE_BUF_SHIFT_BITN = 8;
+localparam int RX_STRIDE_BUF_SHIFT_WIDTH = 5;
+localparam int RX_STRIDE_RESERVE_BITN = 16;
+localparam int RX_STRIDE_RESERVE_WIDTH = 16;
+localparam int POLL_CONTROL_MIN_SHIFT_BITN = 8;
+localparam int POLL_CONTROL_MAX_SHIFT_BITN = 16;
+localparam int POLL_CONTROL_SHIFT_WIDTH = 5;
+localparam int TUNNEL_TMPL_ADDR_SIZE_BITN = 8;
+localparam int TUNNEL_TMPL_ADDR_SIZE_WIDTH = 7;
+localparam int TUNNEL_CONTROL_RX_BITN = 16;
+localparam int TUNNEL_CONTROL_STRIP_BITN = 17;
+localparam int FLOW_CONTROL_EXPORT_BITN = 1;
+localparam int FLOW_CONTROL_SIZE_BITN = 8;
+localparam int FLOW_CONTROL_SIZE_WIDTH = 5;
+localparam int CAPTURE_CONTROL_FILTER_BITN = 1;
+localparam int CAPTURE_CONTROL_SIZE_BITN = 3;
+localparam int CAPTURE_CONTROL_SIZE_WIDTH = 5;
+localparam int CAPTURE_CONTROL_WORD_BITN = 8;
+localparam int CAPTURE_CONTROL_WORD_WIDTH = 6;
+localparam int CAPTURE_CONTROL_SNAP_BITN = 16;
+localparam int CAPTURE_CONTROL_SNAP_WIDTH = 9;
+localparam int ADMIT_CONTROL_DSCP_BITN = 1;
+localparam int ADMIT_CONTROL_PRIO_BITN = 2;
+localparam int ADMIT_CONTROL_LEVEL_BITN = 16;
+localparam int PAUSE_CONTROL_PFC_BITN = 1;
+localparam int PAUSE_CONTROL_HEADROOM_BITN = 8;
+localparam int PAUSE_CONTROL_QUANTA_BITN = 16;
+localparam int AXATTR_HDR_LEN_BITN = 16;
+localparam int AXATTR_HDR_LEN_WIDTH = 12;
+localparam int AXATTR_OVERRIDE_BITN = 31;
+localparam int SPILL_CONTROL_SIZE_BITN = 8;
+localparam int SPILL_CONTROL_SIZE_WIDTH = 5;
 
 localparam int MMR_RW_NREGS = 1;
-localparam int MMR_R_NREGS = 8;
+localparam int MMR_R_NREGS = 110;
 localparam int MMR_R_BITN = 8;
 
 endpackage
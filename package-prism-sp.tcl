@@ -582,6 +582,44 @@ ipx::infer_bus_interface { \
 	m_axi_dma_0_rready } \
 	xilinx.com:interface:aximm_rtl:1.0 [ipx::current_core]
 
+ipx::infer_bus_interface { \
+	m_axi_spill_0_awid \
+	m_axi_spill_0_awaddr \
+	m_axi_spill_0_awlen \
+	m_axi_spill_0_awsize \
+	m_axi_spill_0_awburst \
+	m_axi_spill_0_awlock \
+	m_axi_spill_0_awcache \
+	m_axi_spill_0_awprot \
+	m_axi_spill_0_awvalid \
+	m_axi_spill_0_awready \
+	m_axi_spill_0_wdata \
+	m_axi_spill_0_wstrb \
+	m_axi_spill_0_wlast \
+	m_axi_spill_0_wvalid \
+	m_axi_spill_0_wready \
+	m_axi_spill_0_bid \
+	m_axi_spill_0_bresp \
+	m_axi_spill_0_bvalid \
+	m_axi_spill_0_bready \
+	m_axi_spill_0_arid \
+	m_axi_spill_0_araddr \
+	m_axi_spill_0_arlen \
+	m_axi_spill_0_arsize \
+	m_axi_spill_0_arburst \
+	m_axi_spill_0_arlock \
+	m_axi_spill_0_arcache \
+	m_axi_spill_0_arprot \
+	m_axi_spill_0_arvalid \
+	m_axi_spill_0_arready \
+	m_axi_spill_0_rid \
+	m_axi_spill_0_rdata \
+	m_axi_spill_0_rresp \
+	m_axi_spill_0_rlast \
+	m_axi_spill_0_rvalid \
+	m_axi_spill_0_rready } \
+	xilinx.com:interface:aximm_rtl:1.0 [ipx::current_core]
+
 #
 # Create the GEM port
 #
@@ -651,6 +689,7 @@ set mbusifs [list \
 	"m_axi_mx_0" \
 	"m_axi_mx_1" \
 	"m_axi_dma_0" \
+	"m_axi_spill_0" \
 	"m_axi_acp_0" \
 	"m_axi_acp_1" \
 	]
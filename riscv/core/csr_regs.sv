@@ -27,6 +27,9 @@ module csr_regs
     import taiga_types::*;
     import csr_types::*;
 
+    #(
+        parameter int HART_ID = CPU_ID
+    )
     (
         input logic clk,
         input logic rst,
@@ -56,6 +59,9 @@ module csr_regs
         //WB
         input logic [$clog2(MAX_COMPLETE_COUNT)-1:0] retire_inc,
 
+        //SP unit event counters
+        input logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS],
+
         //External
         input logic interrupt,
         input logic timer_interrupt,
@@ -155,7 +161,7 @@ module csr_regs
     const logic [XLEN-1:0] mvendorid = 0;
     const logic [XLEN-1:0] marchid = 0;
     const logic [XLEN-1:0] mimpid = MACHINE_IMPLEMENTATION_ID;
-    const logic [XLEN-1:0] mhartid = CPU_ID;
+    const logic [XLEN-1:0] mhartid = HART_ID;
 
     ////////////////////////////////////////////////////
     //MSTATUS
@@ -547,7 +553,21 @@ endgenerate
             TIMEH : selected_csr = 32'(mcycle[COUNTER_W-1:XLEN]);
             INSTRETH : selected_csr = 32'(minst_ret[COUNTER_W-1:XLEN]);
 
-            default : begin selected_csr = 0; invalid_addr = 1; end
+            default : begin
+                selected_csr = 0;
+                invalid_addr = 1;
+                //SP unit event counters (read-only)
+                for (int i = 0; i < SP_NPERF_EVENTS; i++) begin
+                    if (csr_addr == 12'(HPMCOUNTER3 + i) || (ENABLE_M_MODE && csr_addr == 12'(MHPMCOUNTER3 + i))) begin
+                        selected_csr = sp_perf_counters[i][XLEN-1:0];
+                        invalid_addr = 0;
+                    end
+                    if (csr_addr == 12'(HPMCOUNTER3H + i) || (ENABLE_M_MODE && csr_addr == 12'(MHPMCOUNTER3H + i))) begin
+                        selected_csr = 32'(sp_perf_counters[i][COUNTER_W-1:XLEN]);
+                        invalid_addr = 0;
+                    end
+                end
+            end
         endcase
     end
     always_ff @(posedge clk) begin
@@ -86,8 +86,8 @@ interface axi_interface
 
     modport slave (input arvalid, araddr, arlen, arsize, arburst, arcache, arprot,
             rready,
-            awvalid, awaddr, awlen, awsize, awburst, awcache, awprot, arid,
-            wvalid, wdata, wstrb, wlast, awid,
+            awvalid, awaddr, awlen, awsize, awburst, awcache, awprot, arid, arlock,
+            wvalid, wdata, wstrb, wlast, awid, awlock,
             bready,
             output arready, rvalid, rdata, rresp, rlast, rid,
             awready,
@@ -25,7 +25,10 @@ import riscv_types::*;
 import taiga_types::*;
 import csr_types::*;
 
-module gc_unit(
+module gc_unit #(
+        parameter int HART_ID = CPU_ID
+    )
+    (
         input logic clk,
         input logic rst,
 
@@ -66,6 +69,7 @@ module gc_unit(
         //WB
         input logic [$clog2(MAX_COMPLETE_COUNT)-1:0] retire_inc,
         input logic instruction_retired,
+        input logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS],
         //unit_writeback_interface.unit gc_wb,
 
         //External
@@ -312,7 +316,7 @@ module gc_unit(
     assign csr_inputs.rs1_is_zero = (rs1_addr == 0);
     assign csr_inputs.rd_is_zero = (rd_addr == 0);
 
-    csr_regs csr_registers (
+    csr_regs #(.HART_ID(HART_ID)) csr_registers (
         .clk(clk), .rst(rst),
         .csr_inputs(csr_inputs),
         .new_request(stage1.is_csr),
@@ -329,6 +333,7 @@ module gc_unit(
         .immu(immu),
         .dmmu(dmmu),
         .retire_inc(retire_inc),
+        .sp_perf_counters(sp_perf_counters),
         .interrupt(interrupt),
         .timer_interrupt(timer_interrupt),
         .wb_csr(wb_csr),
@@ -146,6 +146,8 @@ package riscv_types;
         MINSTRET = 12'hB02,
         MCYCLEH = 12'hB80,
         MINSTRETH = 12'hB82,
+        MHPMCOUNTER3 = 12'hB03,
+        MHPMCOUNTER3H = 12'hB83,
 
         //Supervisor regs
         //Supervisor Trap Setup
@@ -177,6 +179,8 @@ package riscv_types;
         CYCLEH = 12'hC80,
         TIMEH = 12'hC81,
         INSTRETH = 12'hC82,
+        HPMCOUNTER3 = 12'hC03,
+        HPMCOUNTER3H = 12'hC83,
 
         //Debug regs
         DCSR = 12'h7B0,
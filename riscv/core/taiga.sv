@@ -31,7 +31,8 @@ import taiga_types::*;
 module taiga #(
 	parameter int USE_SP_UNIT_RX = 0,
 	parameter int USE_SP_UNIT_TX = 0,
-	parameter int NPUZZLEFIFOS
+	parameter int NPUZZLEFIFOS,
+	parameter int HART_ID = CPU_ID
 )
 (
 	input wire logic clk,
@@ -53,14 +54,8 @@ module taiga #(
  * ---- Begin SP unit signals ----------------------------------------
  */
 	// Interfaces used by the puzzle unit
-	fifo_read_interface.master puzzle_sw_fifo_r_0,
-	fifo_write_interface.master puzzle_sw_fifo_w_0,
-	fifo_read_interface.master puzzle_sw_fifo_r_1,
-	fifo_write_interface.master puzzle_sw_fifo_w_1,
-	fifo_read_interface.master puzzle_sw_fifo_r_2,
-	fifo_write_interface.master puzzle_sw_fifo_w_2,
-	fifo_read_interface.master puzzle_sw_fifo_r_3,
-	fifo_write_interface.master puzzle_sw_fifo_w_3,
+	fifo_read_interface.master puzzle_sw_fifo_r [NPUZZLEFIFOS],
+	fifo_write_interface.master puzzle_sw_fifo_w [NPUZZLEFIFOS],
 
 	// Interfaces used by the RX unit
 	memory_write_interface.master rx_data_mem_w,
@@ -76,6 +71,9 @@ module taiga #(
 	mmr_trigger_interface.master mmr_t,
 	mmr_intr_interface.master mmr_i,
 
+	// Interface used by the HDR unit
+	header_window_interface.master hdr_w,
+
 	// Interfaces used by the ACP unit
 	axi_write_address_channel.master m_axi_acp_aw,
 	axi_write_channel.master m_axi_acp_w,
@@ -83,7 +81,9 @@ module taiga #(
 	axi_read_address_channel.master m_axi_acp_ar,
 	axi_read_channel.master m_axi_acp_r,
 
-	output trace_sp_unit_t trace_sp_unit
+	output trace_sp_unit_t trace_sp_unit,
+	// Event counters, also readable as hpmcounter3 and up
+	output logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS]
 /*
  * ---- End SP unit signals ------------------------------------------
  */
@@ -112,6 +112,7 @@ module taiga #(
     div_inputs_t div_inputs;
     gc_inputs_t gc_inputs;
 	sp_inputs_t sp_inputs;
+	logic [SP_NPERF_EVENTS-1:0] sp_perf_events;
 
     unit_issue_interface unit_issue [NUM_UNITS]();
     logic alu_issued;
@@ -264,14 +265,8 @@ module taiga #(
 			.sp_inputs,
 			.issue(unit_issue[SP_UNIT_WB_ID]),
 			.wb(unit_wb[SP_UNIT_WB_ID]),
-			.puzzle_sw_fifo_r_0,
-			.puzzle_sw_fifo_w_0,
-			.puzzle_sw_fifo_r_1,
-			.puzzle_sw_fifo_w_1,
-			.puzzle_sw_fifo_r_2,
-			.puzzle_sw_fifo_w_2,
-			.puzzle_sw_fifo_r_3,
-			.puzzle_sw_fifo_w_3,
+			.puzzle_sw_fifo_r,
+			.puzzle_sw_fifo_w,
 			.rx_data_mem_w,
 			.rx_meta_fifo_r,
 			.tx_data_fifo_w,
@@ -281,6 +276,7 @@ module taiga #(
 			.mmr_r,
 			.mmr_t,
 			.mmr_i,
+			.hdr_w,
 
 			.m_axi_acp_aw,
 			.m_axi_acp_w,
@@ -288,8 +284,22 @@ module taiga #(
 			.m_axi_acp_ar,
 			.m_axi_acp_r,
 			.acpram_port_i(acp_bram_port_b_i),
-			.trace_sp_unit
+			.trace_sp_unit,
+			.sp_perf_events
+		);
+
+		prism_sp_perf_counters #(
+			.NEVENTS(SP_NPERF_EVENTS),
+			.WIDTH(COUNTER_W)
+		) prism_sp_perf_counters_inst(
+			.clk,
+			.rst,
+			.events(sp_perf_events),
+			.counters(sp_perf_counters)
 		);
+	end
+	else begin
+		assign sp_perf_counters = '{default: '0};
 	end endgenerate
 
     ////////////////////////////////////////////////////
@@ -345,7 +355,7 @@ module taiga #(
             assign dtlb.physical_address = dtlb.virtual_address;
         end
     endgenerate
-    gc_unit gc_unit_block (.*, .issue(unit_issue[GC_UNIT_ID]));
+    gc_unit #(.HART_ID(HART_ID)) gc_unit_block (.*, .issue(unit_issue[GC_UNIT_ID]));
 
     generate if (USE_MUL)
             mul_unit mul_unit_block (.*, .issue(unit_issue[MUL_UNIT_WB_ID]), .wb(unit_wb[MUL_UNIT_WB_ID]));
@@ -54,6 +54,8 @@ package taiga_config;
 
 	// SP Unit 
 	localparam USE_SP = 1;
+	// Number of SP unit events, counted by hpmcounter3 and up
+	localparam SP_NPERF_EVENTS = 6;
 
     //Division algorithm selection
     typedef enum {
@@ -102,7 +104,7 @@ package taiga_config;
 	// Scratch memory    |
 	// 0000 0000 0000 0011 xxxx xxxx xxxx xxxx
     localparam ACP_RAM_ADDR_L = 32'h00030000;
-    localparam ACP_RAM_ADDR_H = 32'h00030080;
+    localparam ACP_RAM_ADDR_H = 32'h00030FFF;
     localparam ACP_RAM_BIT_CHECK = 16;
 
 	// Bus memory (inv.) |
@@ -0,0 +1,116 @@
+# Checks the data path at data FIFO widths other than the default.
+#
+#   vivado -mode batch -source sim/check-datapath.tcl
+#
+# For every width, the top-level wrapper is elaborated with the data
+# FIFOs and the DMA and spill ports at that width. Then prism_sp_dma_tb
+# runs frames through the RX and TX DMA data paths, once with the DMA
+# port at the FIFO width and once with a 64-bit DMA port (downsizing
+# on RX and upsizing on TX), and prism_sp_gem_tx_tb sends cut-through
+# and store-and-forward frames through the GEM TX interface.
+# Finally, the wrapper is elaborated with RX and TX worker pools of 2
+# processors.
+set src_path [file normalize [file join [file dirname [info script]] ..]]
+set fpga_part "xczu9eg-ffvb1156-2-e"
+set widths {256 512}
+set failures 0
+
+proc add_sources {src_path fileset} {
+	add_files -fileset $fileset "${src_path}/riscv/core"
+	add_files -fileset $fileset "${src_path}/riscv/l2_arbiter/l2_external_interfaces.sv"
+	add_files -fileset $fileset "${src_path}/riscv/local_memory/local_memory_interface.sv"
+	add_files -fileset $fileset "${src_path}/sp"
+	add_files -fileset $fileset "${src_path}/mmr"
+}
+
+foreach width $widths {
+	create_project -force -part ${fpga_part} check_datapath_${width} /tmp/check_datapath_${width}
+	set_property -name "xpm_libraries" -value "XPM_FIFO XPM_MEMORY" -objects [current_project]
+	add_sources $src_path sources_1
+	set_property top prism_sp_duo_wrapper [get_filesets sources_1]
+	update_compile_order -fileset sources_1
+
+	if {[catch {
+		synth_design -rtl -top prism_sp_duo_wrapper -part ${fpga_part} \
+			-verilog_define PRISM_SP_DATA_FIFO_WIDTH=${width} \
+			-generic C_M_AXI_DMA_DATA_WIDTH=${width} \
+			-generic C_M_AXI_SPILL_DATA_WIDTH=${width}
+	} msg]} {
+		puts "ELABORATION FAILED at ${width} bits: $msg"
+		incr failures
+	} else {
+		puts "ELABORATION PASSED at ${width} bits"
+	}
+	close_design
+
+	add_files -fileset sim_1 "${src_path}/sim/prism_sp_dma_tb.sv"
+	add_files -fileset sim_1 "${src_path}/sim/prism_sp_gem_tx_tb.sv"
+	set_property top prism_sp_dma_tb [get_filesets sim_1]
+	set_property xsim.simulate.runtime all [get_filesets sim_1]
+
+	foreach dma_width [list $width 64] {
+		set_property verilog_define \
+			[list PRISM_SP_DATA_FIFO_WIDTH=${width} PRISM_SP_DMA_WIDTH=${dma_width}] \
+			[get_filesets sim_1]
+		update_compile_order -fileset sim_1
+
+		if {[catch {
+			launch_simulation -simset sim_1 -mode behavioral
+			set errors [get_value -radix unsigned /prism_sp_dma_tb/errors]
+			close_sim -force
+		} msg]} {
+			puts "SIMULATION FAILED at ${width}/${dma_width} bits: $msg"
+			incr failures
+		} elseif {$errors != 0} {
+			puts "SIMULATION FAILED at ${width}/${dma_width} bits: ${errors} errors"
+			incr failures
+		} else {
+			puts "SIMULATION PASSED at ${width}/${dma_width} bits"
+		}
+	}
+
+	set_property top prism_sp_gem_tx_tb [get_filesets sim_1]
+	set_property verilog_define [list PRISM_SP_DATA_FIFO_WIDTH=${width}] [get_filesets sim_1]
+	update_compile_order -fileset sim_1
+
+	if {[catch {
+		launch_simulation -simset sim_1 -mode behavioral
+		set errors [get_value -radix unsigned /prism_sp_gem_tx_tb/errors]
+		close_sim -force
+	} msg]} {
+		puts "GEM TX SIMULATION FAILED at ${width} bits: $msg"
+		incr failures
+	} elseif {$errors != 0} {
+		puts "GEM TX SIMULATION FAILED at ${width} bits: ${errors} errors"
+		incr failures
+	} else {
+		puts "GEM TX SIMULATION PASSED at ${width} bits"
+	}
+
+	close_project
+}
+
+create_project -force -part ${fpga_part} check_datapath_workers /tmp/check_datapath_workers
+set_property -name "xpm_libraries" -value "XPM_FIFO XPM_MEMORY" -objects [current_project]
+add_sources $src_path sources_1
+set_property top prism_sp_duo_wrapper [get_filesets sources_1]
+update_compile_order -fileset sources_1
+
+if {[catch {
+	synth_design -rtl -top prism_sp_duo_wrapper -part ${fpga_part} \
+		-verilog_define PRISM_SP_NWORKERS=2
+} msg]} {
+	puts "ELABORATION FAILED with 2 workers: $msg"
+	incr failures
+} else {
+	puts "ELABORATION PASSED with 2 workers"
+}
+close_design
+close_project
+
+if {$failures != 0} {
+	puts "${failures} checks failed"
+	exit 1
+}
+puts "All checks passed"
+exit 0
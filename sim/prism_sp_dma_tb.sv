@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+`timescale 1ns / 1ps
+
+import prism_sp_config::*;
+
+/*
+ * Runs frames through the width-generic DMA data path.
+ *
+ * RX: The words of a frame are put into a FIFO of RX_DATA_FIFO_WIDTH
+ * bits and written to memory by fifo_to_axi_v5 over a DMA bus of
+ * DMA_WIDTH bits, like in prism_sp_rx_core.
+ * TX: The frame is read back by axi_to_fifo_v5 into a FIFO of
+ * TX_DATA_FIFO_WIDTH bits and checksummed, like in prism_sp_tx_core.
+ *
+ * The frames are UDP/IPv4 frames of different lengths, some of which
+ * cross a 4KB boundary. The memory stalls the write and read data
+ * channels at random. errors counts the mismatches and is read by
+ * sim/check-datapath.tcl.
+ */
+module prism_sp_dma_tb;
+
+`ifdef PRISM_SP_DMA_WIDTH
+localparam int DMA_WIDTH = `PRISM_SP_DMA_WIDTH;
+`else
+localparam int DMA_WIDTH = RX_DATA_FIFO_WIDTH;
+`endif
+localparam int DMA_BYTES = DMA_WIDTH/8;
+localparam int RX_BYTES = RX_DATA_FIFO_WIDTH/8;
+localparam int TX_BYTES = TX_DATA_FIFO_WIDTH/8;
+localparam int AXI_ADDR_WIDTH = 40;
+localparam int MEM_SIZE = 2**16;
+localparam int NFRAMES = 4;
+localparam int FRAME_LEN [NFRAMES] = '{ 60, 1514, 333, 4001 };
+localparam int FRAME_ADDR [NFRAMES] = '{ 'h0000, 'h0fc0, 'h1f00, 'h3ec0 };
+
+var logic clock = 1'b0;
+var logic resetn = 1'b0;
+int errors = 0;
+
+always #2 clock = !clock;
+
+var logic [7:0] mem [MEM_SIZE];
+var logic [7:0] frame [NFRAMES][];
+
+/*
+ * --------  --------  --------  --------
+ * RX path
+ * --------  --------  --------  --------
+ */
+fifo_write_interface #(
+	.DATA_WIDTH(RX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) rx_data_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(RX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) rx_data_fifo_r();
+fifo_read_interface #(
+	.DATA_WIDTH(DMA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) dma_rx_data_fifo_r();
+memory_write_interface #(
+	.DATA_WIDTH(RX_DATA_FIFO_WIDTH),
+	.ADDR_WIDTH(SYSTEM_ADDR_WIDTH)
+) rx_data_mem_w();
+
+axi_write_address_channel #(
+	.AXI_AWADDR_WIDTH(AXI_ADDR_WIDTH),
+	.AXI_AWUSER_WIDTH(2)
+) axi_aw();
+axi_write_channel #(
+	.AXI_WDATA_WIDTH(DMA_WIDTH)
+) axi_w();
+axi_write_response_channel axi_b();
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(RX_DATA_FIFO_DEPTH)
+) rx_data_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(rx_data_fifo_r),
+	.fifo_w(rx_data_fifo_w)
+);
+
+if (DMA_WIDTH == RX_DATA_FIFO_WIDTH) begin
+	fifo_read_interface_connect fifo_read_interface_connect_0(.m(rx_data_fifo_r), .s(dma_rx_data_fifo_r));
+end
+else begin
+	fifo_read_interface_downsize fifo_read_interface_downsize_0(
+		.clock,
+		.resetn,
+		.s_flush(rx_data_mem_w.done),
+		.m(rx_data_fifo_r),
+		.s(dma_rx_data_fifo_r)
+	);
+end
+
+fifo_to_axi_v5 fifo_to_axi_0(
+	.clock,
+	.resetn,
+	.mem_w(rx_data_mem_w),
+	.fifo_r(dma_rx_data_fifo_r),
+	.hdr_len(16'd64),
+	.axi_hdr_attr('{ user: 2'b00, prot: 3'b000, cache: 4'b0011 }),
+	.axi_attr('{ user: 2'b01, prot: 3'b000, cache: 4'b0011 }),
+	.axi_aw,
+	.axi_w,
+	.axi_b
+);
+
+/*
+ * --------  --------  --------  --------
+ * TX path
+ * --------  --------  --------  --------
+ */
+fifo_write_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) tx_data_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) tx_data_fifo_r();
+fifo_write_interface #(
+	.DATA_WIDTH(DMA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) dma_tx_data_fifo_w();
+fifo_write_interface #(
+	.DATA_WIDTH(TX_CSUM_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_CSUM_FIFO_DATA_COUNT_WIDTH)
+) tx_csum_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_CSUM_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_CSUM_FIFO_DATA_COUNT_WIDTH)
+) tx_csum_fifo_r();
+memory_read_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.ADDR_WIDTH(SYSTEM_ADDR_WIDTH)
+) tx_data_mem_r();
+
+axi_read_address_channel #(
+	.AXI_ARADDR_WIDTH(AXI_ADDR_WIDTH),
+	.AXI_ARUSER_WIDTH(2)
+) axi_ar();
+axi_read_channel #(
+	.AXI_RDATA_WIDTH(DMA_WIDTH)
+) axi_r();
+
+wire logic csum_i_valid;
+wire logic [DMA_WIDTH-1:0] csum_i_data;
+wire logic csum_i_sof;
+wire logic csum_i_eof;
+trace_checksum_t trace_csum;
+trace_atf_t trace_atf;
+trace_atf_bds_t trace_atf_bds;
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_DATA_FIFO_DEPTH)
+) tx_data_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_data_fifo_r),
+	.fifo_w(tx_data_fifo_w)
+);
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_CSUM_FIFO_DEPTH)
+) tx_csum_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_csum_fifo_r),
+	.fifo_w(tx_csum_fifo_w)
+);
+
+if (DMA_WIDTH == TX_DATA_FIFO_WIDTH) begin
+	fifo_write_interface_connect fifo_write_interface_connect_0(.m(tx_data_fifo_w), .s(dma_tx_data_fifo_w));
+end
+else begin
+	fifo_write_interface_upsize fifo_write_interface_upsize_0(
+		.clock,
+		.resetn,
+		.s_last(csum_i_eof),
+		.m(tx_data_fifo_w),
+		.s(dma_tx_data_fifo_w)
+	);
+end
+
+if (DMA_WIDTH == 128) begin
+	prism_sp_tx_checksum #(
+		.DATA_WIDTH(DMA_WIDTH)
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+else begin
+	prism_sp_tx_checksum_generic #(
+		.DATA_WIDTH(DMA_WIDTH)
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+
+axi_to_fifo_v5#(
+	.FIFO_SIZE(TX_DATA_FIFO_SIZE)
+) axi_to_fifo_0(
+	.clock,
+	.resetn,
+	.mem_r(tx_data_mem_r),
+	.fifo_w(dma_tx_data_fifo_w),
+
+	.ext_valid(csum_i_valid),
+	.ext_data(csum_i_data),
+	.ext_sof(csum_i_sof),
+	.ext_eof(csum_i_eof),
+
+	.hdr_len(16'd64),
+	.axi_hdr_attr('{ user: 2'b00, prot: 3'b000, cache: 4'b0011 }),
+	.axi_attr('{ user: 2'b01, prot: 3'b000, cache: 4'b0011 }),
+	.axi_ar,
+	.axi_r,
+
+	.trace_atf,
+	.trace_atf_bds
+);
+
+/*
+ * --------  --------  --------  --------
+ * Memory
+ * --------  --------  --------  --------
+ * Bursts are INCR bursts of full beats. Write and read bursts are
+ * queued in the order of their addresses.
+ */
+typedef struct {
+	logic [AXI_ADDR_WIDTH-1:0] addr;
+	logic [7:0] len;
+} burst_t;
+
+burst_t aw_q [$];
+burst_t ar_q [$];
+int w_beat = 0;
+int r_beat = 0;
+int nresps = 0;
+
+function automatic logic [AXI_ADDR_WIDTH-1:0] beat_addr(input burst_t b, input int beat);
+	return (b.addr & ~AXI_ADDR_WIDTH'(DMA_BYTES-1)) + AXI_ADDR_WIDTH'(beat * DMA_BYTES);
+endfunction
+
+function automatic logic [DMA_WIDTH-1:0] mem_word(input logic [AXI_ADDR_WIDTH-1:0] addr);
+	logic [DMA_WIDTH-1:0] word;
+
+	for (int i = 0; i < DMA_BYTES; i++) begin
+		word[i*8 +: 8] = mem[(addr + i) % MEM_SIZE];
+	end
+	return word;
+endfunction
+
+assign axi_aw.awready = 1'b1;
+assign axi_ar.arready = 1'b1;
+assign axi_b.bid = '0;
+assign axi_b.bresp = 2'b00;
+assign axi_b.bvalid = nresps != 0;
+assign axi_r.rid = '0;
+assign axi_r.rresp = 2'b00;
+assign axi_r.rdata = ar_q.size() != 0 ? mem_word(beat_addr(ar_q[0], r_beat)) : '0;
+assign axi_r.rlast = ar_q.size() != 0 && r_beat == ar_q[0].len;
+
+always @(posedge clock) begin
+	automatic int nresps_next = nresps;
+	automatic logic [AXI_ADDR_WIDTH-1:0] addr;
+
+	if (!resetn) begin
+		axi_w.wready <= 1'b0;
+		axi_r.rvalid <= 1'b0;
+	end
+	else begin
+		if (axi_aw.awvalid && axi_aw.awready) begin
+			aw_q.push_back('{ addr: axi_aw.awaddr, len: axi_aw.awlen });
+		end
+		if (axi_ar.arvalid && axi_ar.arready) begin
+			ar_q.push_back('{ addr: axi_ar.araddr, len: axi_ar.arlen });
+		end
+
+		if (axi_w.wvalid && axi_w.wready) begin
+			addr = beat_addr(aw_q[0], w_beat);
+
+			for (int i = 0; i < DMA_BYTES; i++) begin
+				if (axi_w.wstrb[i]) begin
+					mem[(addr + i) % MEM_SIZE] = axi_w.wdata[i*8 +: 8];
+				end
+			end
+			if ((w_beat == aw_q[0].len) != axi_w.wlast) begin
+				$display("WLAST at beat %0d of a burst of %0d beats", w_beat, aw_q[0].len + 1);
+				errors++;
+			end
+			if (((aw_q[0].addr % 4096) + (aw_q[0].len + 1) * DMA_BYTES) > 4096) begin
+				$display("Write burst at %h crosses a 4KB boundary", aw_q[0].addr);
+				errors++;
+			end
+			if (axi_w.wlast) begin
+				void'(aw_q.pop_front());
+				w_beat = 0;
+				nresps_next++;
+			end
+			else begin
+				w_beat++;
+			end
+		end
+		if (axi_b.bvalid && axi_b.bready) begin
+			nresps_next--;
+		end
+		nresps <= nresps_next;
+
+		if (axi_r.rvalid && axi_r.rready) begin
+			if (((ar_q[0].addr % 4096) + (ar_q[0].len + 1) * DMA_BYTES) > 4096) begin
+				$display("Read burst at %h crosses a 4KB boundary", ar_q[0].addr);
+				errors++;
+			end
+			if (axi_r.rlast) begin
+				void'(ar_q.pop_front());
+				r_beat <= 0;
+			end
+			else begin
+				r_beat <= r_beat + 1;
+			end
+		end
+
+		// Stall the data channels now and then.
+		axi_w.wready <= aw_q.size() != 0 && $urandom_range(3) != 0;
+		axi_r.rvalid <= ar_q.size() != 0 && $urandom_range(3) != 0;
+	end
+end
+
+/*
+ * --------  --------  --------  --------
+ * Frames
+ * --------  --------  --------  --------
+ */
+function automatic logic [15:0] csum_add(input logic [31:0] sum);
+	while (sum[31:16] != 0) begin
+		sum = sum[15:0] + sum[31:16];
+	end
+	return sum[15:0];
+endfunction
+
+// Sum of the big-endian 16-bit words of bytes [start, stop) of frame f
+function automatic logic [31:0] csum_bytes(input int f, input int start, input int stop);
+	logic [31:0] sum = 0;
+
+	for (int i = start; i < stop; i += 2) begin
+		sum += { frame[f][i], i + 1 < stop ? frame[f][i+1] : 8'h00 };
+	end
+	return sum;
+endfunction
+
+task automatic make_frame(input int f);
+	automatic int len = FRAME_LEN[f];
+	automatic int ip_len = len - 14;
+	automatic int udp_len = len - 34;
+
+	frame[f] = new[len];
+	foreach (frame[f][i]) begin
+		frame[f][i] = 8'($urandom);
+	end
+	// Ethernet II
+	frame[f][12] = 8'h08;
+	frame[f][13] = 8'h00;
+	// IPv4 without options
+	frame[f][14] = 8'h45;
+	frame[f][16] = 8'(ip_len >> 8);
+	frame[f][17] = 8'(ip_len);
+	frame[f][20] = 8'h00;
+	frame[f][21] = 8'h00;
+	frame[f][23] = 8'h11;
+	frame[f][24] = 8'h00;
+	frame[f][25] = 8'h00;
+	// UDP
+	frame[f][38] = 8'(udp_len >> 8);
+	frame[f][39] = 8'(udp_len);
+	frame[f][40] = 8'h00;
+	frame[f][41] = 8'h00;
+endtask
+
+task automatic rx_frame(input int f);
+	automatic int len = FRAME_LEN[f];
+
+	for (int w = 0; w < (len + RX_BYTES - 1) / RX_BYTES; w++) begin
+		for (int i = 0; i < RX_BYTES; i++) begin
+			rx_data_fifo_w.wr_data[i*8 +: 8] <= w*RX_BYTES + i < len ? frame[f][w*RX_BYTES + i] : 8'h00;
+		end
+		rx_data_fifo_w.wr_en <= 1'b1;
+		@(posedge clock);
+	end
+	rx_data_fifo_w.wr_en <= 1'b0;
+	repeat (8) @(posedge clock);
+
+	rx_data_mem_w.addr <= SYSTEM_ADDR_WIDTH'(FRAME_ADDR[f]);
+	rx_data_mem_w.len <= 16'(len);
+	rx_data_mem_w.start <= 1'b1;
+	@(posedge clock);
+	rx_data_mem_w.start <= 1'b0;
+	do @(posedge clock); while (!rx_data_mem_w.done);
+	wait (nresps == 0);
+
+	for (int i = 0; i < len; i++) begin
+		if (mem[FRAME_ADDR[f] + i] !== frame[f][i]) begin
+			$display("RX frame %0d: byte %0d is %h instead of %h", f, i, mem[FRAME_ADDR[f] + i], frame[f][i]);
+			errors++;
+			break;
+		end
+	end
+	if (rx_data_fifo_r.rd_data_count != 0) begin
+		$display("RX frame %0d: %0d words left in the FIFO", f, rx_data_fifo_r.rd_data_count);
+		errors++;
+	end
+endtask
+
+task automatic tx_frame(input int f);
+	automatic int len = FRAME_LEN[f];
+	automatic logic [15:0] ip_csum = ~csum_add(csum_bytes(f, 14, 24) + csum_bytes(f, 26, 34));
+	automatic logic [15:0] l4_csum = ~csum_add(csum_bytes(f, 26, 34) + 32'h11 + 32'(len - 34) +
+		csum_bytes(f, 34, 40) + csum_bytes(f, 42, len));
+	automatic logic [TX_CSUM_FIFO_WIDTH-1:0] csum;
+
+	tx_data_mem_r.addr <= SYSTEM_ADDR_WIDTH'(FRAME_ADDR[f]);
+	tx_data_mem_r.len <= 16'(len);
+	tx_data_mem_r.cont <= 1'b0;
+	tx_data_mem_r.start <= 1'b1;
+	@(posedge clock);
+	tx_data_mem_r.start <= 1'b0;
+	do @(posedge clock); while (!tx_data_mem_r.done);
+	repeat (16) @(posedge clock);
+
+	for (int w = 0; w < (len + TX_BYTES - 1) / TX_BYTES; w++) begin
+		if (tx_data_fifo_r.empty) begin
+			$display("TX frame %0d: only %0d words", f, w);
+			errors++;
+			break;
+		end
+		for (int i = 0; i < TX_BYTES && w*TX_BYTES + i < len; i++) begin
+			if (tx_data_fifo_r.rd_data[i*8 +: 8] !== frame[f][w*TX_BYTES + i]) begin
+				$display("TX frame %0d: byte %0d is %h instead of %h", f, w*TX_BYTES + i,
+					tx_data_fifo_r.rd_data[i*8 +: 8], frame[f][w*TX_BYTES + i]);
+				errors++;
+				break;
+			end
+		end
+		tx_data_fifo_r.rd_en <= 1'b1;
+		@(posedge clock);
+		tx_data_fifo_r.rd_en <= 1'b0;
+		repeat (2) @(posedge clock);
+	end
+	if (!tx_data_fifo_r.empty) begin
+		$display("TX frame %0d: words left in the FIFO", f);
+		errors++;
+	end
+
+	if (tx_csum_fifo_r.empty) begin
+		$display("TX frame %0d: no checksum", f);
+		errors++;
+	end
+	else begin
+		csum = tx_csum_fifo_r.rd_data;
+		if (csum[0 +: 2] != 2'b01 || csum[2 +: 16] != ip_csum) begin
+			$display("TX frame %0d: IPv4 checksum %h/%b instead of %h", f, csum[2 +: 16], csum[0 +: 2], ip_csum);
+			errors++;
+		end
+		if (csum[18 +: 2] != 2'b10 || csum[20 +: 16] != l4_csum) begin
+			$display("TX frame %0d: UDP checksum %h/%b instead of %h", f, csum[20 +: 16], csum[18 +: 2], l4_csum);
+			errors++;
+		end
+		tx_csum_fifo_r.rd_en <= 1'b1;
+		@(posedge clock);
+		tx_csum_fifo_r.rd_en <= 1'b0;
+		repeat (2) @(posedge clock);
+	end
+endtask
+
+initial begin
+	rx_data_fifo_w.wr_en = 1'b0;
+	rx_data_mem_w.start = 1'b0;
+	tx_data_mem_r.start = 1'b0;
+	tx_data_fifo_r.rd_en = 1'b0;
+	tx_csum_fifo_r.rd_en = 1'b0;
+	foreach (mem[i]) begin
+		mem[i] = 8'h00;
+	end
+
+	repeat (16) @(posedge clock);
+	resetn <= 1'b1;
+	// The FIFOs are busy for some cycles after the reset.
+	repeat (64) @(posedge clock);
+
+	for (int f = 0; f < NFRAMES; f++) begin
+		make_frame(f);
+		rx_frame(f);
+	end
+	for (int f = 0; f < NFRAMES; f++) begin
+		tx_frame(f);
+	end
+
+	$display("RX/TX FIFO width %0d/%0d, DMA width %0d: %0d errors",
+		RX_DATA_FIFO_WIDTH, TX_DATA_FIFO_WIDTH, DMA_WIDTH, errors);
+	$finish;
+end
+
+// Give up on a hanging data path.
+initial begin
+	#2ms;
+	$display("Timeout");
+	errors++;
+	$finish;
+end
+
+endmodule
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+`timescale 1ns / 1ps
+
+import prism_sp_config::*;
+
+/*
+ * Sends frames through prism_sp_gem_tx_single.
+ *
+ * The words of a frame are written to the TX data FIFO and, like in
+ * prism_sp_tx_core, watched by the checksum and digest units, which
+ * fill the checksum and digest FIFOs. The meta descriptor of a
+ * cut-through frame is written before its data, the one of a
+ * store-and-forward frame after its data, like prism_sp_puzzle_hw_gem_dma_read
+ * does. The data is written faster than the GEM model reads it, and a
+ * cut-through frame is only written once the previous frames are out.
+ *
+ * The frames are not IPv4 and have no digest, so a cut-through frame
+ * has to start before its last word has been written.
+ * The writer stalls in the middle of one cut-through frame until the
+ * GEM has run out of data. That frame has to be aborted with an
+ * underflow, its remaining words have to be drained when they arrive
+ * (TX_STATE_DRAIN), and the frame after it has to be sent intact.
+ * errors counts the violations and mismatches and is read by
+ * sim/check-datapath.tcl.
+ */
+module prism_sp_gem_tx_tb;
+
+localparam int TX_BYTES = TX_DATA_FIFO_WIDTH/8;
+localparam int NFRAMES = 5;
+localparam int FRAME_LEN [NFRAMES] = '{ 1514, 60, 1000, 600, 60 };
+// Cut-through size of the frames, 0 for store-and-forward
+localparam int FRAME_CT [NFRAMES] = '{ 64, 0, 128, 64, 0 };
+// Word after which the writer stalls until the GEM is done, 0 for none
+localparam int FRAME_STALL [NFRAMES] = '{ 0, 0, 0, 4, 0 };
+
+var logic clock = 1'b0;
+var logic resetn = 1'b0;
+int errors = 0;
+
+always #2 clock = !clock;
+
+var logic [7:0] frame [NFRAMES][];
+// Set when the last word of a frame has been written.
+var logic frame_written [NFRAMES];
+
+fifo_write_interface #(
+	.DATA_WIDTH(TX_META_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_META_FIFO_DATA_COUNT_WIDTH)
+) tx_meta_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_META_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_META_FIFO_DATA_COUNT_WIDTH)
+) tx_meta_fifo_r[1]();
+fifo_write_interface #(
+	.DATA_WIDTH(TX_CSUM_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_CSUM_FIFO_DATA_COUNT_WIDTH)
+) tx_csum_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_CSUM_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_CSUM_FIFO_DATA_COUNT_WIDTH)
+) tx_csum_fifo_r[1]();
+fifo_write_interface #(
+	.DATA_WIDTH(TX_DIGEST_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DIGEST_FIFO_DATA_COUNT_WIDTH)
+) tx_digest_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_DIGEST_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DIGEST_FIFO_DATA_COUNT_WIDTH)
+) tx_digest_fifo_r[1]();
+fifo_write_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) tx_data_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) tx_data_fifo_r[1]();
+
+gem_tx_interface gem_tx();
+
+var logic [31:0] tx_underflows [1];
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_META_FIFO_DEPTH)
+) tx_meta_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_meta_fifo_r[0]),
+	.fifo_w(tx_meta_fifo_w)
+);
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_CSUM_FIFO_DEPTH)
+) tx_csum_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_csum_fifo_r[0]),
+	.fifo_w(tx_csum_fifo_w)
+);
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_DIGEST_FIFO_DEPTH)
+) tx_digest_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_digest_fifo_r[0]),
+	.fifo_w(tx_digest_fifo_w)
+);
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(TX_DATA_FIFO_DEPTH)
+) tx_data_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(tx_data_fifo_r[0]),
+	.fifo_w(tx_data_fifo_w)
+);
+
+var logic csum_i_valid;
+var logic [TX_DATA_FIFO_WIDTH-1:0] csum_i_data;
+var logic csum_i_sof;
+var logic csum_i_eof;
+trace_checksum_t trace_csum;
+
+assign tx_data_fifo_w.wr_en = csum_i_valid;
+assign tx_data_fifo_w.wr_data = csum_i_data;
+
+if (TX_DATA_FIFO_WIDTH == 128) begin
+	prism_sp_tx_checksum #(
+		.DATA_WIDTH(TX_DATA_FIFO_WIDTH)
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+else begin
+	prism_sp_tx_checksum_generic #(
+		.DATA_WIDTH(TX_DATA_FIFO_WIDTH)
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+
+prism_sp_tx_digest #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH)
+) prism_sp_tx_digest_0 (
+	.clock,
+	.resetn,
+	.digest_start('0),
+	.digest_end('0),
+	.i_valid(csum_i_valid),
+	.i_data(csum_i_data),
+	.i_sof(csum_i_sof),
+	.i_eof(csum_i_eof),
+	.tx_digest_fifo_w
+);
+
+prism_sp_gem_tx_single #(
+	.NTXCORES(1)
+) prism_sp_gem_tx_single_0(
+	.tx_meta_fifo_r,
+	.tx_csum_fifo_r,
+	.tx_digest_fifo_r,
+	.tx_data_fifo_r,
+	.tx_underflows,
+	.esp_sa_key('0),
+	.esp_sa_salt('0),
+	.esp_sa_spi('0),
+	.esp_sa_control('0),
+	.tunnel_control('0),
+	.tunnel_tmpl('0),
+	.tunnel_tmpl_addr('0),
+	.gem_tx
+);
+
+/*
+ * --------  --------  --------  --------
+ * GEM
+ * --------  --------  --------  --------
+ * The GEM model requests a byte in every cycle and checks the frames
+ * in the order in which they were written.
+ */
+assign gem_tx.tx_clock = clock;
+assign gem_tx.tx_resetn = resetn;
+assign gem_tx.tx_r_rd = resetn;
+assign gem_tx.tx_r_status = '0;
+assign gem_tx.tx_r_fixed_lat = 1'b0;
+assign gem_tx.dma_tx_end_tog = 1'b0;
+
+int rx_f = 0;
+int rx_len = 0;
+
+always @(posedge clock) begin
+	if (resetn && gem_tx.tx_r_valid) begin
+		if (rx_f == NFRAMES) begin
+			$display("GEM: byte after the last frame");
+			errors++;
+		end
+		else begin
+			if (gem_tx.tx_r_sop) begin
+				rx_len = 0;
+				if (FRAME_CT[rx_f] != 0 && frame_written[rx_f]) begin
+					$display("TX frame %0d: cut-through frame started after its last word was written", rx_f);
+					errors++;
+				end
+			end
+			if (rx_len < FRAME_LEN[rx_f] && gem_tx.tx_r_data !== frame[rx_f][rx_len]) begin
+				$display("TX frame %0d: byte %0d is %h instead of %h", rx_f, rx_len,
+					gem_tx.tx_r_data, frame[rx_f][rx_len]);
+				errors++;
+			end
+			rx_len++;
+			if (gem_tx.tx_r_eop) begin
+				if (FRAME_STALL[rx_f] != 0) begin
+					if (rx_len >= FRAME_LEN[rx_f] || !gem_tx.tx_r_err || !gem_tx.tx_r_underflow) begin
+						$display("TX frame %0d: %0d bytes, err %b, underflow %b instead of an abort",
+							rx_f, rx_len, gem_tx.tx_r_err, gem_tx.tx_r_underflow);
+						errors++;
+					end
+				end
+				else if (rx_len != FRAME_LEN[rx_f] || gem_tx.tx_r_err || gem_tx.tx_r_underflow) begin
+					$display("TX frame %0d: %0d bytes, err %b, underflow %b", rx_f, rx_len,
+						gem_tx.tx_r_err, gem_tx.tx_r_underflow);
+					errors++;
+				end
+				rx_f++;
+			end
+		end
+	end
+end
+
+/*
+ * --------  --------  --------  --------
+ * Frames
+ * --------  --------  --------  --------
+ */
+task automatic make_frame(input int f);
+	frame[f] = new[FRAME_LEN[f]];
+	foreach (frame[f][i]) begin
+		frame[f][i] = 8'($urandom);
+	end
+	// Local experimental Ethernet type
+	frame[f][12] = 8'h88;
+	frame[f][13] = 8'hb5;
+	frame_written[f] = 1'b0;
+endtask
+
+task automatic write_meta(input int f);
+	automatic tx_meta_desc_t desc = '0;
+
+	desc.size = TX_META_DESC_SIZE_WIDTH'(FRAME_LEN[f]);
+	desc.ct_size = TX_META_DESC_SIZE_WIDTH'(FRAME_CT[f]);
+	tx_meta_fifo_w.wr_data <= desc;
+	tx_meta_fifo_w.wr_en <= 1'b1;
+	@(posedge clock);
+	tx_meta_fifo_w.wr_en <= 1'b0;
+endtask
+
+task automatic tx_frame(input int f);
+	automatic int len = FRAME_LEN[f];
+	automatic int nwords = (len + TX_BYTES - 1) / TX_BYTES;
+
+	if (FRAME_CT[f] != 0) begin
+		// Do not write ahead of the GEM, so that the frame can only
+		// start before its end by cut-through.
+		wait (rx_f == f);
+		write_meta(f);
+	end
+	for (int w = 0; w < nwords; w++) begin
+		for (int i = 0; i < TX_BYTES; i++) begin
+			csum_i_data[i*8 +: 8] <= w*TX_BYTES + i < len ? frame[f][w*TX_BYTES + i] : 8'h00;
+		end
+		csum_i_valid <= 1'b1;
+		csum_i_sof <= w == 0;
+		csum_i_eof <= w == nwords - 1;
+		@(posedge clock);
+		csum_i_valid <= 1'b0;
+		repeat (3) @(posedge clock);
+		if (FRAME_STALL[f] != 0 && w == FRAME_STALL[f]) begin
+			wait (rx_f == f + 1);
+			repeat (16) @(posedge clock);
+		end
+	end
+	frame_written[f] = 1'b1;
+	if (FRAME_CT[f] == 0) begin
+		write_meta(f);
+	end
+endtask
+
+initial begin
+	automatic int nstalls;
+
+	csum_i_valid = 1'b0;
+	csum_i_sof = 1'b0;
+	csum_i_eof = 1'b0;
+	tx_meta_fifo_w.wr_en = 1'b0;
+
+	repeat (16) @(posedge clock);
+	resetn <= 1'b1;
+	// The FIFOs are busy for some cycles after the reset.
+	repeat (64) @(posedge clock);
+
+	for (int f = 0; f < NFRAMES; f++) begin
+		make_frame(f);
+		tx_frame(f);
+	end
+	wait (rx_f == NFRAMES);
+	repeat (64) @(posedge clock);
+
+	nstalls = 0;
+	foreach (FRAME_STALL[f]) begin
+		nstalls += FRAME_STALL[f] != 0;
+	end
+	if (tx_underflows[0] != 32'(nstalls)) begin
+		$display("%0d underflows instead of %0d", tx_underflows[0], nstalls);
+		errors++;
+	end
+	if (!tx_data_fifo_r[0].empty) begin
+		$display("Words left in the TX data FIFO");
+		errors++;
+	end
+	$display("TX FIFO width %0d: %0d errors", TX_DATA_FIFO_WIDTH, errors);
+	$finish;
+end
+
+// Give up on a hanging data path.
+initial begin
+	#2ms;
+	$display("Timeout");
+	errors++;
+	$finish;
+end
+
+endmodule
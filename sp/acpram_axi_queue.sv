@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Queued transfers between the ACP memory and the ACP port.
+ *
+ * A transfer (segment) of up to 256 16-byte words is submitted with
+ * submit. It is assigned a tag between 1 and NTAGS-1, which is returned
+ * in submit_tag (0 if all tags are in use and the segment was dropped).
+ * Segments are started in order. Each one is split into the bursts the
+ * ACP port supports, i.e., 64-byte aligned 4-beat bursts and single
+ * 16-byte beats. The tag of a segment is used as the AXI ID of all its
+ * bursts, so reads of different segments may be outstanding and complete
+ * out of order. Write data is sent for one burst at a time.
+ * A finished segment is reported in complete_tag (0 if none) and removed
+ * (its tag is freed) with a pulse on complete.
+ *
+ * Tag 0 is reserved for the single-transfer commands of acpram_axi_i,
+ * which also use the local and remote write strobes.
+ */
+module acpram_axi_queue #(
+	parameter int NTAGS
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [15:0] acp_local_wstrb [4],
+	input wire logic [15:0] acp_remote_wstrb_0,
+	input wire logic [3:0] acp_remote_wstrb_0123,
+
+	acpram_axi_interface.slave acpram_axi_i,
+
+	input wire logic submit,
+	input wire logic submit_write,
+	// Number of 16-byte words - 1
+	input wire logic [7:0] submit_len,
+	input wire logic [$bits(acpram_port_i.addr)-1:0] submit_acpram_addr,
+	input wire logic [$bits(acpram_axi_i.axi_addr)-1:0] submit_axi_addr,
+	output var logic [$clog2(NTAGS)-1:0] submit_tag,
+
+	input wire logic complete,
+	output var logic [$clog2(NTAGS)-1:0] complete_tag,
+	output wire logic complete_error,
+
+	// Interface to access the acpram.
+	xpm_memory_tdpram_port_interface.master acpram_port_i,
+
+	// AXI
+	axi_write_address_channel.master axi_aw,
+	axi_write_channel.master axi_w,
+	axi_write_response_channel.master axi_b,
+	axi_read_address_channel.master axi_ar,
+	axi_read_channel.master axi_r
+);
+
+localparam int TAG_WIDTH = $clog2(NTAGS);
+localparam int ACPRAM_ADDR_WIDTH = $bits(acpram_port_i.addr);
+localparam int AXI_ADDR_WIDTH = $bits(acpram_axi_i.axi_addr);
+// Number of 16-byte words
+localparam int WORDS_WIDTH = 9;
+
+if (axi_ar.AXI_ARID_WIDTH < TAG_WIDTH || axi_aw.AXI_AWID_WIDTH < TAG_WIDTH) begin
+	$error("The ACP AXI IDs are too narrow for NTAGS (%d).", NTAGS);
+end
+
+// ------- ------- ------- ------- ------- ------- ------- -------
+// AXI constants
+// ------- ------- ------- ------- ------- ------- ------- -------
+assign axi_aw.awlen[7:2] = '0;
+// The ACP port only allows a size of 128 bits (16 byte).
+assign axi_aw.awsize = 3'h4;
+// INCR burst type
+assign axi_aw.awburst = 2'b01;
+assign axi_aw.awlock = 0;
+assign axi_aw.awcache = 4'b1111;
+assign axi_aw.awprot = 3'b010;
+assign axi_aw.awqos = 4'h0;
+assign axi_aw.awuser = 2'b10;
+assign axi_w.wuser = 0;
+assign axi_b.bready = 1'b1;
+
+assign axi_ar.arlen[7:2] = '0;
+assign axi_ar.arsize = 3'h4;
+assign axi_ar.arburst = 2'b01;
+assign axi_ar.arlock = 1'b0;
+assign axi_ar.arcache = 4'b1111;
+assign axi_ar.arprot = 3'b010;
+assign axi_ar.arqos = 4'h0;
+assign axi_ar.aruser = 2'b10;
+
+wire logic ar_hshake = axi_ar.arvalid && axi_ar.arready;
+wire logic aw_hshake = axi_aw.awvalid && axi_aw.awready;
+wire logic w_hshake = axi_w.wvalid && axi_w.wready;
+wire logic w_hshake_last = w_hshake && axi_w.wlast;
+wire logic w_hshake_not_last = w_hshake && !axi_w.wlast;
+wire logic r_hshake = axi_r.rvalid && axi_r.rready;
+wire logic b_hshake = axi_b.bvalid && axi_b.bready;
+
+wire logic [TAG_WIDTH-1:0] r_tag = TAG_WIDTH'(axi_r.rid);
+wire logic [TAG_WIDTH-1:0] b_tag = TAG_WIDTH'(axi_b.bid);
+
+// ------- ------- ------- ------- ------- ------- ------- -------
+// Tags
+// ------- ------- ------- ------- ------- ------- ------- -------
+var logic [NTAGS-1:0] tag_busy;
+// All bursts of the segment have been started.
+var logic [NTAGS-1:0] tag_issued;
+var logic [NTAGS-1:0] tag_done;
+var logic [NTAGS-1:0] tag_error;
+// Bursts of the segment in flight
+var logic [WORDS_WIDTH-1:0] tag_pending [NTAGS];
+var logic tag_write [NTAGS];
+var logic [7:0] tag_len [NTAGS];
+var logic [ACPRAM_ADDR_WIDTH-1:0] tag_acpram_addr [NTAGS];
+var logic [AXI_ADDR_WIDTH-1:0] tag_axi_addr [NTAGS];
+// Where the next read beat of the segment goes
+var logic [ACPRAM_ADDR_WIDTH-1:0] tag_raddr [NTAGS];
+var logic [1:0] tag_rbeat [NTAGS];
+
+always_comb begin
+	submit_tag = '0;
+	complete_tag = '0;
+	for (int t = NTAGS - 1; t > 0; t--) begin
+		if (!tag_busy[t]) begin
+			submit_tag = TAG_WIDTH'(t);
+		end
+		if (tag_done[t]) begin
+			complete_tag = TAG_WIDTH'(t);
+		end
+	end
+end
+assign complete_error = tag_error[complete_tag];
+
+wire logic do_submit = submit && submit_tag != '0;
+wire logic do_legacy = !acpram_axi_i.busy && (acpram_axi_i.read || acpram_axi_i.write);
+
+// ------- ------- ------- ------- ------- ------- ------- -------
+// Segment FIFO (of tags)
+// ------- ------- ------- ------- ------- ------- ------- -------
+var logic [TAG_WIDTH-1:0] seg_fifo [NTAGS];
+var logic [TAG_WIDTH:0] seg_wr_ptr;
+var logic [TAG_WIDTH:0] seg_rd_ptr;
+wire logic seg_empty = seg_wr_ptr == seg_rd_ptr;
+wire logic [TAG_WIDTH-1:0] seg_head = seg_fifo[seg_rd_ptr[TAG_WIDTH-1:0]];
+
+// ------- ------- ------- ------- ------- ------- ------- -------
+// Issue
+// ------- ------- ------- ------- ------- ------- ------- -------
+var logic cur_valid;
+var logic [TAG_WIDTH-1:0] cur_tag;
+var logic cur_write;
+var logic [AXI_ADDR_WIDTH-1:0] cur_axi_addr;
+var logic [ACPRAM_ADDR_WIDTH-1:0] cur_acpram_addr;
+var logic [WORDS_WIDTH-1:0] cur_words;
+
+var logic w_busy;
+wire logic cur_burst4 = cur_axi_addr[5:4] == 2'b00 && cur_words >= 4;
+wire logic [WORDS_WIDTH-1:0] cur_n = cur_burst4 ? 4 : 1;
+wire logic issue_read = cur_valid && !cur_write && !axi_ar.arvalid;
+wire logic issue_write = cur_valid && cur_write && !axi_aw.awvalid && !w_busy;
+wire logic issue = issue_read || issue_write;
+
+// ------- ------- ------- ------- ------- ------- ------- -------
+// Write data
+// ------- ------- ------- ------- ------- ------- ------- -------
+var logic w_pre;
+var logic w_start;
+var logic w_single;
+var logic [1:0] w_remaining;
+var logic [TAG_WIDTH-1:0] w_tag;
+var logic [ACPRAM_ADDR_WIDTH-1:0] w_addr;
+
+// We need to refill acpram_port_i.dout by reading exactly at the clock
+// cycles in which we consume it. dout holds the next beat in between.
+wire logic w_read = w_pre || w_start || w_hshake_not_last;
+
+// The read channel must not write to the ACP memory while write data
+// is being read from it.
+assign axi_r.rready = !w_busy;
+
+always_comb begin
+	if (w_busy) begin
+		acpram_port_i.addr = w_addr;
+		acpram_port_i.en = w_read;
+		acpram_port_i.we = '0;
+		acpram_port_i.din = axi_r.rdata;
+	end
+	else begin
+		acpram_port_i.addr = tag_raddr[r_tag];
+		acpram_port_i.en = r_hshake;
+		acpram_port_i.we = r_tag == '0 ? acp_local_wstrb[tag_rbeat[r_tag]] : '1;
+		acpram_port_i.din = axi_r.rdata;
+	end
+end
+
+wire logic [1:0] w_beat = 2'd3 - w_remaining;
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	acpram_axi_i.done <= 1'b0;
+	w_pre <= 1'b0;
+	w_start <= 1'b0;
+
+	if (!resetn) begin
+		tag_busy <= '0;
+		tag_issued <= '0;
+		tag_done <= '0;
+		tag_error <= '0;
+		for (int t = 0; t < NTAGS; t++) begin
+			tag_pending[t] <= '0;
+		end
+		seg_wr_ptr <= '0;
+		seg_rd_ptr <= '0;
+		cur_valid <= 1'b0;
+		w_busy <= 1'b0;
+		axi_ar.arvalid <= 1'b0;
+		axi_aw.awvalid <= 1'b0;
+		axi_w.wvalid <= 1'b0;
+		acpram_axi_i.busy <= 1'b0;
+		acpram_axi_i.error <= 1'b0;
+	end
+	else begin
+		/*
+		 * Submission
+		 */
+		if (do_submit) begin
+			tag_busy[submit_tag] <= 1'b1;
+			tag_issued[submit_tag] <= 1'b0;
+			tag_error[submit_tag] <= 1'b0;
+			tag_write[submit_tag] <= submit_write;
+			tag_len[submit_tag] <= submit_len;
+			tag_acpram_addr[submit_tag] <= submit_acpram_addr;
+			tag_axi_addr[submit_tag] <= submit_axi_addr;
+			tag_raddr[submit_tag] <= submit_acpram_addr;
+			tag_rbeat[submit_tag] <= '0;
+			seg_fifo[seg_wr_ptr[TAG_WIDTH-1:0]] <= submit_tag;
+			seg_wr_ptr <= seg_wr_ptr + 1;
+		end
+		else if (do_legacy) begin
+			// len selects 1 or 4 beats.
+			tag_busy[0] <= 1'b1;
+			tag_issued[0] <= 1'b0;
+			tag_error[0] <= 1'b0;
+			tag_write[0] <= acpram_axi_i.write;
+			tag_len[0] <= { 6'b000000, acpram_axi_i.len, acpram_axi_i.len };
+			tag_acpram_addr[0] <= ACPRAM_ADDR_WIDTH'(acpram_axi_i.acpram_addr);
+			tag_axi_addr[0] <= acpram_axi_i.axi_addr;
+			tag_raddr[0] <= ACPRAM_ADDR_WIDTH'(acpram_axi_i.acpram_addr);
+			tag_rbeat[0] <= '0;
+			seg_fifo[seg_wr_ptr[TAG_WIDTH-1:0]] <= '0;
+			seg_wr_ptr <= seg_wr_ptr + 1;
+			acpram_axi_i.busy <= 1'b1;
+		end
+
+		/*
+		 * Issue
+		 */
+		if (!cur_valid && !seg_empty) begin
+			cur_valid <= 1'b1;
+			cur_tag <= seg_head;
+			cur_write <= tag_write[seg_head];
+			cur_axi_addr <= tag_axi_addr[seg_head];
+			cur_acpram_addr <= tag_acpram_addr[seg_head];
+			cur_words <= WORDS_WIDTH'(tag_len[seg_head]) + 1;
+			seg_rd_ptr <= seg_rd_ptr + 1;
+		end
+		if (issue) begin
+			cur_axi_addr <= cur_axi_addr + AXI_ADDR_WIDTH'({cur_n, 4'b0000});
+			cur_acpram_addr <= cur_acpram_addr + ACPRAM_ADDR_WIDTH'(cur_n);
+			cur_words <= cur_words - cur_n;
+			if (cur_words == cur_n) begin
+				cur_valid <= 1'b0;
+				tag_issued[cur_tag] <= 1'b1;
+			end
+		end
+		if (issue_read) begin
+			axi_ar.araddr <= cur_axi_addr;
+			axi_ar.arlen[1:0] <= { cur_burst4, cur_burst4 };
+			axi_ar.arid <= cur_tag;
+			axi_ar.arvalid <= 1'b1;
+		end
+		else if (ar_hshake) begin
+			axi_ar.arvalid <= 1'b0;
+		end
+		if (issue_write) begin
+			axi_aw.awaddr <= cur_axi_addr;
+			axi_aw.awlen[1:0] <= { cur_burst4, cur_burst4 };
+			axi_aw.awid <= cur_tag;
+			axi_aw.awvalid <= 1'b1;
+			w_busy <= 1'b1;
+			w_pre <= 1'b1;
+			w_single <= !cur_burst4;
+			w_remaining <= cur_burst4 ? 2'd3 : 2'd0;
+			w_tag <= cur_tag;
+			w_addr <= cur_acpram_addr;
+		end
+		else if (aw_hshake) begin
+			axi_aw.awvalid <= 1'b0;
+		end
+
+		/*
+		 * Write data
+		 */
+		if (w_busy && w_read) begin
+			w_addr <= w_addr + 1;
+		end
+		if (w_pre) begin
+			// We need this extra cycle to preload from ACPRAM.
+			w_start <= 1'b1;
+		end
+		if (w_start || w_hshake_not_last) begin
+			axi_w.wvalid <= 1'b1;
+			axi_w.wdata <= acpram_port_i.dout;
+			if (w_start) begin
+				axi_w.wlast <= w_remaining == 2'd0;
+			end
+			else begin
+				w_remaining <= w_remaining - 1;
+				axi_w.wlast <= w_remaining == 2'd1;
+			end
+			if (w_tag != '0) begin
+				axi_w.wstrb <= '1;
+			end
+			else if (w_single) begin
+				axi_w.wstrb <= acp_remote_wstrb_0;
+			end
+			else begin
+				axi_w.wstrb <= {16{acp_remote_wstrb_0123[w_start ? 2'd0 : w_beat + 2'd1]}};
+			end
+		end
+		if (w_hshake_last) begin
+			axi_w.wvalid <= 1'b0;
+			w_busy <= 1'b0;
+		end
+
+		/*
+		 * Read data and write responses
+		 */
+		if (r_hshake) begin
+			tag_raddr[r_tag] <= tag_raddr[r_tag] + 1;
+			tag_rbeat[r_tag] <= tag_rbeat[r_tag] + 1;
+			if (axi_r.rresp != 2'b00) begin
+				tag_error[r_tag] <= 1'b1;
+			end
+		end
+		if (b_hshake && axi_b.bresp != 2'b00) begin
+			tag_error[b_tag] <= 1'b1;
+		end
+		for (int t = 0; t < NTAGS; t++) begin
+			tag_pending[t] <= tag_pending[t]
+				+ WORDS_WIDTH'(issue && cur_tag == t)
+				- WORDS_WIDTH'(r_hshake && axi_r.rlast && r_tag == t)
+				- WORDS_WIDTH'(b_hshake && b_tag == t);
+		end
+
+		/*
+		 * Completion
+		 */
+		if (tag_busy[0] && tag_issued[0] && tag_pending[0] == '0) begin
+			tag_busy[0] <= 1'b0;
+			tag_issued[0] <= 1'b0;
+			acpram_axi_i.error <= tag_error[0];
+			// done is pulsed for 1 cycle.
+			acpram_axi_i.done <= 1'b1;
+			acpram_axi_i.busy <= 1'b0;
+		end
+		for (int t = 1; t < NTAGS; t++) begin
+			if (tag_busy[t] && tag_issued[t] && tag_pending[t] == '0) begin
+				tag_done[t] <= 1'b1;
+			end
+		end
+		if (complete && complete_tag != '0) begin
+			tag_busy[complete_tag] <= 1'b0;
+			tag_issued[complete_tag] <= 1'b0;
+			tag_done[complete_tag] <= 1'b0;
+		end
+	end
+end
+
+endmodule
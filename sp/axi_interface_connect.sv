@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+module axi_interface_connect(
+	axi_interface.master m,
+	axi_interface.slave s
+);
+
+assign m.arvalid = s.arvalid;
+assign m.araddr = s.araddr;
+assign m.arlen = s.arlen;
+assign m.arsize = s.arsize;
+assign m.arburst = s.arburst;
+assign m.arcache = s.arcache;
+assign m.arprot = s.arprot;
+assign m.arid = s.arid;
+assign m.arlock = s.arlock;
+assign s.arready = m.arready;
+
+assign m.rready = s.rready;
+assign s.rvalid = m.rvalid;
+assign s.rdata = m.rdata;
+assign s.rresp = m.rresp;
+assign s.rlast = m.rlast;
+assign s.rid = m.rid;
+
+assign m.awvalid = s.awvalid;
+assign m.awaddr = s.awaddr;
+assign m.awlen = s.awlen;
+assign m.awsize = s.awsize;
+assign m.awburst = s.awburst;
+assign m.awcache = s.awcache;
+assign m.awprot = s.awprot;
+assign m.awid = s.awid;
+assign m.awlock = s.awlock;
+assign s.awready = m.awready;
+
+assign m.wvalid = s.wvalid;
+assign m.wdata = s.wdata;
+assign m.wstrb = s.wstrb;
+assign m.wlast = s.wlast;
+assign s.wready = m.wready;
+
+assign m.bready = s.bready;
+assign s.bvalid = m.bvalid;
+assign s.bresp = m.bresp;
+assign s.bid = m.bid;
+
+endmodule
@@ -34,7 +34,10 @@ module axi_to_fifo_v5#(
 	output wire logic ext_eof,
 
 	// Actual AXI memory interface for reading
-	input wire logic [3:0] axi_arcache,
+	// The first hdr_len bytes are read with axi_hdr_attr.
+	input wire logic [15:0] hdr_len,
+	input wire axi_attr_t axi_hdr_attr,
+	input wire axi_attr_t axi_attr,
 	axi_read_address_channel.master axi_ar,
 	axi_read_channel.master axi_r,
 
@@ -58,11 +61,7 @@ assign axi_ar.arsize = ARSIZE[2:0];
 // INCR burst type
 assign axi_ar.arburst = 2'b01;
 assign axi_ar.arlock = 1'b0;
-assign axi_ar.arcache = axi_arcache;
-// XXX make this configurable for standalone use.
-assign axi_ar.arprot = 3'b010;
 assign axi_ar.arqos = 4'h0;
-assign axi_ar.aruser = '1;
 
 prism_axi_calc_interface #(
 	.AXI_ADDR_WIDTH(AXI_ADDR_WIDTH),
@@ -71,6 +70,7 @@ prism_axi_calc_interface #(
 assign axi_calc.i_valid = mem_r.start;
 assign axi_calc.i_address = mem_r.addr;
 assign axi_calc.i_length = mem_r.len;
+assign axi_calc.i_head_length = hdr_len;
 assign axi_calc.i_axhshake = axi_ar.arvalid & axi_ar.arready;
 var logic is_last_burst;
 var logic [OFFSET_WIDTH-1:0] last_beat_size;
@@ -101,6 +101,9 @@ always_ff @(posedge clock) begin
 			axi_ar.arvalid <= 1'b1;
 			axi_ar.araddr <= axi_calc.o_axaddr;
 			axi_ar.arlen <= axi_calc.o_axlen;
+			axi_ar.arcache <= axi_calc.o_is_head ? axi_hdr_attr.cache : axi_attr.cache;
+			axi_ar.arprot <= axi_calc.o_is_head ? axi_hdr_attr.prot : axi_attr.prot;
+			axi_ar.aruser <= axi_calc.o_is_head ? axi_hdr_attr.user : axi_attr.user;
 			is_last_burst <= axi_calc.o_is_last_burst;
 			last_beat_size <= axi_calc.o_last_beat_size;
 		end
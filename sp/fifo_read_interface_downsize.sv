@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Connects a narrow FIFO reader (s) to a wide FIFO (m).
+ *
+ * The words of m are handed out to s least significant word first.
+ * s_flush drops the rest of the current word of m, e.g. at the end
+ * of a frame, so that the next frame starts with a new word of m.
+ */
+module fifo_read_interface_downsize(
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic s_flush,
+
+	fifo_read_interface.master m,
+	fifo_read_interface.slave s
+);
+
+localparam int RATIO = m.DATA_WIDTH / s.DATA_WIDTH;
+localparam int IDX_WIDTH = RATIO > 1 ? $clog2(RATIO) : 1;
+
+if (m.DATA_WIDTH % s.DATA_WIDTH != 0) begin
+	$error("The width of m (%d) is not a multiple of the width of s (%d).",
+		m.DATA_WIDTH, s.DATA_WIDTH);
+end
+
+var logic [IDX_WIDTH-1:0] idx;
+
+assign m.clock = s.clock;
+assign m.reset = s.reset;
+assign s.rd_data = m.rd_data[idx*s.DATA_WIDTH +: s.DATA_WIDTH];
+assign m.rd_en = (s.rd_en && idx == RATIO - 1) || (s_flush && idx != 0);
+assign s.empty = m.empty;
+assign s.almost_empty = m.almost_empty;
+assign s.rd_data_count = m.rd_data_count;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		idx <= '0;
+	end
+	else begin
+		if (s.rd_en) begin
+			if (idx == RATIO - 1) begin
+				idx <= '0;
+			end
+			else begin
+				idx <= idx + 1;
+			end
+		end
+		else if (s_flush) begin
+			idx <= '0;
+		end
+	end
+end
+
+endmodule
@@ -13,6 +13,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+import prism_sp_config::*;
+
 //
 // FIFO -> AXI[w]
 //
@@ -26,7 +28,10 @@ module fifo_to_axi_v5 (
 	fifo_read_interface.master fifo_r,
 
 	// Interface of the actual AXI writing channel(s)
-	input wire logic [3:0] axi_awcache,
+	// The first hdr_len bytes are written with axi_hdr_attr.
+	input wire logic [15:0] hdr_len,
+	input wire axi_attr_t axi_hdr_attr,
+	input wire axi_attr_t axi_attr,
 	axi_write_address_channel.master axi_aw,
 	axi_write_channel.master axi_w,
 	axi_write_response_channel.master axi_b
@@ -47,10 +52,7 @@ assign axi_aw.awsize = AWSIZE[2:0];
 // INCR burst type
 assign axi_aw.awburst = 2'b01;
 assign axi_aw.awlock = 0;
-assign axi_aw.awcache = axi_awcache;
-assign axi_aw.awprot = 3'h0;
 assign axi_aw.awqos = 4'h0;
-assign axi_aw.awuser = 1;
 assign axi_w.wuser = 0;
 
 prism_axi_calc_interface #(
@@ -60,6 +62,7 @@ prism_axi_calc_interface #(
 assign axi_calc.i_valid = mem_w.start;
 assign axi_calc.i_address = mem_w.addr;
 assign axi_calc.i_length = mem_w.len;
+assign axi_calc.i_head_length = hdr_len;
 assign axi_calc.i_axhshake = axi_aw.awvalid & axi_aw.awready;
 var logic is_last_burst;
 var logic [OFFSET_WIDTH-1:0] first_beat_offset;
@@ -97,6 +100,9 @@ always_ff @(posedge clock) begin
 			axi_aw.awvalid <= 1'b1;
 			axi_aw.awaddr <= axi_calc.o_axaddr;
 			axi_aw.awlen <= axi_calc.o_axlen;
+			axi_aw.awcache <= axi_calc.o_is_head ? axi_hdr_attr.cache : axi_attr.cache;
+			axi_aw.awprot <= axi_calc.o_is_head ? axi_hdr_attr.prot : axi_attr.prot;
+			axi_aw.awuser <= axi_calc.o_is_head ? axi_hdr_attr.user : axi_attr.user;
 			nbeats <= axi_calc.o_axlen;
 			is_last_burst <= axi_calc.o_is_last_burst;
 			last_beat_size <= axi_calc.o_last_beat_size;
@@ -164,6 +170,11 @@ else if (AXI_DATA_WIDTH == 128) begin
 	4'hf: axi_w_wstrb_comb = 16'b1111111111111111;
 	endcase
 end
+else begin
+	for (int i = 0; i < AXI_DATA_WIDTH/8; i++) begin
+		axi_w_wstrb_comb[i] = i <= last_beat_size;
+	end
+end
 end
 /*
  * This can be used if we one day support unaligned AXI write transactions.
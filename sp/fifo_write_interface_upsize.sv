@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Connects a narrow FIFO writer (s) to a wide FIFO (m).
+ *
+ * The words of s are packed into a word of m, least significant
+ * word first. A word of m is written when it is full or when s_last
+ * marks the last word of a frame. In the latter case, the upper part
+ * of the word is zero. Every frame thus starts with a new word of m.
+ */
+module fifo_write_interface_upsize(
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic s_last,
+
+	fifo_write_interface.master m,
+	fifo_write_interface.slave s
+);
+
+localparam int RATIO = m.DATA_WIDTH / s.DATA_WIDTH;
+localparam int IDX_WIDTH = RATIO > 1 ? $clog2(RATIO) : 1;
+
+if (m.DATA_WIDTH % s.DATA_WIDTH != 0) begin
+	$error("The width of m (%d) is not a multiple of the width of s (%d).",
+		m.DATA_WIDTH, s.DATA_WIDTH);
+end
+
+assign m.clock = s.clock;
+assign m.reset = s.reset;
+assign s.full = m.full;
+assign s.almost_full = m.almost_full;
+assign s.wr_data_count = m.wr_data_count;
+
+var logic [IDX_WIDTH-1:0] idx;
+var logic [m.DATA_WIDTH-1:0] buffer;
+var logic [m.DATA_WIDTH-1:0] buffer_comb;
+
+always_comb begin
+	buffer_comb = buffer;
+	buffer_comb[idx*s.DATA_WIDTH +: s.DATA_WIDTH] = s.wr_data;
+end
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	m.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		idx <= '0;
+		buffer <= '0;
+	end
+	else begin
+		if (s.wr_en) begin
+			if (idx == RATIO - 1 || s_last) begin
+				m.wr_en <= 1'b1;
+				m.wr_data <= buffer_comb;
+				buffer <= '0;
+				idx <= '0;
+			end
+			else begin
+				buffer <= buffer_comb;
+				idx <= idx + 1;
+			end
+		end
+	end
+end
+
+endmodule
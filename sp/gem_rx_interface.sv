@@ -37,4 +37,17 @@ interface gem_rx_interface;
 		output rx_w_overflow,
 		input rx_w_flush
 	);
+
+	modport master(
+		output rx_clock,
+		output rx_resetn,
+		output rx_w_wr,
+		output rx_w_data,
+		output rx_w_sop,
+		output rx_w_eop,
+		output rx_w_status,
+		output rx_w_err,
+		input rx_w_overflow,
+		output rx_w_flush
+	);
 endinterface
@@ -16,6 +16,8 @@
 module gem_rx_w_status_encoder(
 	input wire logic [44:0] rx_w_status,
 	input wire logic [12:0] frame_length,
+	// IP precedence of untagged IPv4/IPv6 frames, zero otherwise.
+	input wire logic [2:0] ip_prio,
 	output wire logic [31:0] out
 );
 
@@ -141,13 +143,13 @@ assign out = {
 	rx_w_vlan_tagged,
 	// 20
 	rx_w_prty_tagged,
-	// 19:17 VLAN priority. Not supported for now, because the GEM FIFO interface
-	//       provides 4 bits of VLAN priority information and the DMA descriptor
-	//       provides 3 bits of VLAN priority information and it's unclear to me
-	//       how to map them.
-	3'b000,
-	// 16 see previous comment
-	1'b0,
+	// 19:17 VLAN priority. The GEM FIFO interface provides the 4 MSBs of
+	//       the TCI, i.e. the PCP followed by the CFI/DEI bit.
+	//       Untagged frames carry the IP precedence instead, which is
+	//       only used for mapping the frame to a RX ring.
+	(rx_w_vlan_tagged | rx_w_prty_tagged) ? rx_w_tci[3:1] : ip_prio,
+	// 16
+	(rx_w_vlan_tagged | rx_w_prty_tagged) & rx_w_tci[0],
 	// 15 end of frame
 	1'b1,
 	// 14 start of frame
@@ -50,4 +50,22 @@ interface gem_tx_interface;
 		input dma_tx_end_tog,
 		output dma_tx_status_tog
 	);
+	modport slave(
+		output tx_clock,
+		output tx_resetn,
+		input tx_r_data_rdy,
+		output tx_r_rd,
+		input tx_r_valid,
+		input tx_r_data,
+		input tx_r_sop,
+		input tx_r_eop,
+		input tx_r_err,
+		input tx_r_underflow,
+		input tx_r_flushed,
+		input tx_r_control,
+		output tx_r_status,
+		output tx_r_fixed_lat,
+		output dma_tx_end_tog,
+		input dma_tx_status_tog
+	);
 endinterface
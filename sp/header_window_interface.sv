@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Connects the header window commands of the SP unit (master) to the
+ * header window of the RX or TX data stream (slave).
+ */
+interface header_window_interface;
+
+// Take the header of the next frame (len bytes) into the window.
+logic load;
+logic [15:0] len;
+// Asserted while the window is being loaded.
+logic busy;
+// Asserted while the window takes the next words of the data stream.
+logic loading;
+// Byte offsets; the two least significant bits are ignored.
+logic [HDR_WINDOW_ADDR_WIDTH-1:0] peek_addr;
+logic [31:0] peek_data;
+logic poke;
+logic [HDR_WINDOW_ADDR_WIDTH-1:0] poke_addr;
+logic [31:0] poke_data;
+// Put the window back into the data stream.
+logic commit;
+
+modport master (
+	output load,
+	output len,
+	input busy,
+	input loading,
+	output peek_addr,
+	input peek_data,
+	output poke,
+	output poke_addr,
+	output poke_data,
+	output commit
+);
+modport slave (
+	input load,
+	input len,
+	output busy,
+	output loading,
+	input peek_addr,
+	output peek_data,
+	input poke,
+	input poke_addr,
+	input poke_data,
+	input commit
+);
+endinterface
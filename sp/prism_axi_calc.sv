@@ -23,8 +23,15 @@ module prism_axi_calc (
 localparam int AXI_ADDR_WIDTH = axi_calc.AXI_ADDR_WIDTH;
 localparam int AXI_DATA_WIDTH = axi_calc.AXI_DATA_WIDTH;
 
-localparam int MAXBYTESPERBURST = 256 * (AXI_DATA_WIDTH / 8);
 localparam int OFFSET_WIDTH = $clog2(AXI_DATA_WIDTH/8);
+/*
+ * A burst must not cross a 4KB boundary. Up to 128 bits, this
+ * is implied by the maximum burst length of 256 beats.
+ * Wider data buses have to use shorter bursts.
+ */
+localparam int MAXBEATSPERBURST = (4096 / (AXI_DATA_WIDTH / 8)) < 256 ? 4096 / (AXI_DATA_WIDTH / 8) : 256;
+localparam int MAXBYTESPERBURST = MAXBEATSPERBURST * (AXI_DATA_WIDTH / 8);
+localparam int BURST_WIDTH = $clog2(MAXBEATSPERBURST);
 
 localparam int LENGTH_WIDTH = $bits(axi_calc.i_length);
 localparam int TOTAL_BEATS_WIDTH = LENGTH_WIDTH - OFFSET_WIDTH;
@@ -49,6 +56,33 @@ var logic [LENGTH_WIDTH-1:0] len_plus_off;
 var logic [AXI_ADDR_WIDTH-1:0] addr_plus_len;
 var logic [8:0] align_beats;
 
+/*
+ * Number of beats of the head that are not yet covered by a burst.
+ * A burst that would run past the end of the head is cut there. The
+ * burst after it starts unaligned, so every burst ends at the next
+ * MAXBYTESPERBURST boundary at the latest.
+ */
+var logic [TOTAL_BEATS_WIDTH-1:0] head_beats;
+wire logic [LENGTH_WIDTH-1:0] _head_beats_comb = axi_calc.i_head_length +
+	LENGTH_WIDTH'(axi_calc.i_address[OFFSET_WIDTH-1:0]) + ((1 << OFFSET_WIDTH) - 1);
+wire logic [8:0] room_beats_comb = 9'(MAXBEATSPERBURST) - 9'(axi_calc.o_axaddr[OFFSET_WIDTH +: BURST_WIDTH]);
+var logic [8:0] burst_beats_comb;
+
+always_comb begin
+	if (state == STATE_ALIGN) begin
+		burst_beats_comb = align_beats;
+	end
+	else if (total_beats > TOTAL_BEATS_WIDTH'(room_beats_comb)) begin
+		burst_beats_comb = room_beats_comb;
+	end
+	else begin
+		burst_beats_comb = 9'(total_beats);
+	end
+	if (head_beats != '0 && head_beats < TOTAL_BEATS_WIDTH'(burst_beats_comb)) begin
+		burst_beats_comb = 9'(head_beats);
+	end
+end
+
 assign axi_calc.o_axaddr[OFFSET_WIDTH-1:0] = '0;
 
 always_ff @(posedge clock) begin
@@ -66,7 +100,9 @@ always_ff @(posedge clock) begin
 				/*
 				 * Stores how many beats we need for alignment.
 				 */
-				align_beats <= 9'h100 - axi_calc.i_address[OFFSET_WIDTH +: 8];
+				align_beats <= 9'(MAXBEATSPERBURST) - axi_calc.i_address[OFFSET_WIDTH +: BURST_WIDTH];
+				head_beats <= axi_calc.i_head_length == '0 ? '0 :
+					_head_beats_comb[LENGTH_WIDTH-1:OFFSET_WIDTH];
 				state <= STATE_CALC0;
 			end
 		end
@@ -74,7 +110,7 @@ always_ff @(posedge clock) begin
 			total_beats <= total_beats_comb;
 			axi_calc.o_last_beat_size <= len_plus_off[OFFSET_WIDTH-1:0] - 1;
 
-			if (addr_plus_len[AXI_ADDR_WIDTH-1:8+OFFSET_WIDTH] != axi_calc.o_axaddr[AXI_ADDR_WIDTH-1:8+OFFSET_WIDTH]) begin
+			if (addr_plus_len[AXI_ADDR_WIDTH-1:BURST_WIDTH+OFFSET_WIDTH] != axi_calc.o_axaddr[AXI_ADDR_WIDTH-1:BURST_WIDTH+OFFSET_WIDTH]) begin
 				state <= STATE_ALIGN;
 			end
 			else begin
@@ -86,20 +122,18 @@ always_ff @(posedge clock) begin
 			 * We need to align first.
 			 */
 			axi_calc.o_valid <= 1'b1;
-			axi_calc.o_axlen <= align_beats - 1;
-			axi_calc.o_is_last_burst <= align_beats == total_beats;
+			axi_calc.o_axlen <= 8'(burst_beats_comb - 1);
+			axi_calc.o_is_last_burst <= TOTAL_BEATS_WIDTH'(burst_beats_comb) == total_beats;
+			axi_calc.o_is_head <= head_beats != '0;
+			head_beats <= head_beats - TOTAL_BEATS_WIDTH'(head_beats != '0 ? burst_beats_comb : 9'd0);
 			state <= STATE_RUNNING;
 		end
 		STATE_RECALC: begin
 			axi_calc.o_valid <= 1'b1;
-			if (total_beats > 256) begin
-				axi_calc.o_axlen <= 255;
-				axi_calc.o_is_last_burst <= 1'b0;
-			end
-			else begin
-				axi_calc.o_axlen <= total_beats - 1;
-				axi_calc.o_is_last_burst <= 1'b1;
-			end
+			axi_calc.o_axlen <= 8'(burst_beats_comb - 1);
+			axi_calc.o_is_last_burst <= TOTAL_BEATS_WIDTH'(burst_beats_comb) == total_beats;
+			axi_calc.o_is_head <= head_beats != '0;
+			head_beats <= head_beats - TOTAL_BEATS_WIDTH'(head_beats != '0 ? burst_beats_comb : 9'd0);
 			state <= STATE_RUNNING;
 		end
 		STATE_RUNNING: begin
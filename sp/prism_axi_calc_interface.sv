@@ -23,6 +23,11 @@ localparam OFFSET_WIDTH = $clog2(AXI_DATA_WIDTH/8);
 logic i_valid;
 logic [AXI_ADDR_WIDTH-1:0] i_address;
 logic [15:0] i_length;
+/*
+ * Bursts are split after the first i_head_length bytes. o_is_head is set
+ * for the bursts that hold them.
+ */
+logic [15:0] i_head_length;
 logic i_axhshake;
 
 logic o_valid;
@@ -33,28 +38,33 @@ logic [7:0] o_axlen;
  */
 logic [OFFSET_WIDTH-1:0] o_last_beat_size;
 logic o_is_last_burst;
+logic o_is_head;
 
 modport master(
 	output i_valid,
 	output i_address,
 	output i_length,
+	output i_head_length,
 	output i_axhshake,
 	input o_valid,
 	input o_axaddr,
 	input o_axlen,
 	input o_last_beat_size,
-	input o_is_last_burst
+	input o_is_last_burst,
+	input o_is_head
 );
 modport slave(
 	input i_valid,
 	input i_address,
 	input i_length,
+	input i_head_length,
 	input i_axhshake,
 	output o_valid,
 	output o_axaddr,
 	output o_axlen,
 	output o_last_beat_size,
-	output o_is_last_burst
+	output o_is_last_burst,
+	output o_is_head
 );
 
 endinterface
@@ -113,6 +113,11 @@ else if (DATA_WIDTH == 128) begin
 		endcase
 	end
 end
+else begin
+	always_comb begin
+		stage0_data_shr_comb = stage0_data_ff >> { stage0_lsbyte_ff, 3'b000 };
+	end
+end
 
 var logic [DATA_WIDTH/8-1:0] stage0_bytemask_comb;
 if (DATA_WIDTH == 32) begin
@@ -161,6 +166,13 @@ else if (DATA_WIDTH == 128) begin
 		endcase
 	end
 end
+else begin
+	always_comb begin
+		for (int i = 0; i < DATA_WIDTH/8; i++) begin
+			stage0_bytemask_comb[i] = i <= stage0_size_ff;
+		end
+	end
+end
 
 var logic stage1_valid_ff;
 var logic [DATA_WIDTH-1:0] stage1_data_ff;
@@ -254,6 +266,11 @@ else if (DATA_WIDTH == 128) begin
 		endcase
 	end
 end
+else begin
+	always_comb begin
+		stage2_data_shl_comb = ($bits(stage2_data_shl_comb))'(stage2_data_ff) << { stage3_size_ff[SIZE_WIDTH-1:0], 3'b000 };
+	end
+end
 
 var logic stage3_valid_ff;
 var logic [DATA_WIDTH*2-8-1:0] stage3_data_ff;
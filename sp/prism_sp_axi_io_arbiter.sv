@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Shares the IO AXI port of a processor between NPORTS processors.
+ *
+ * Transactions are granted round-robin on their read or write address.
+ * The grant is held until the last read data beat or the write response
+ * has been passed back, so there is only one transaction in flight.
+ * This suits the processors, which have at most one outstanding IO
+ * access, and keeps the IDs of the masters intact.
+ * A master with both a read and a write address pending is granted the
+ * write first.
+ */
+module prism_sp_axi_io_arbiter #(
+	parameter int NPORTS = 2
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	axi_interface.slave s_axi_io [NPORTS],
+	axi_interface.master m_axi_io
+);
+
+localparam int PORT_WIDTH = NPORTS > 1 ? $clog2(NPORTS) : 1;
+localparam int AR_WIDTH = $bits({
+	m_axi_io.araddr, m_axi_io.arlen, m_axi_io.arsize, m_axi_io.arburst,
+	m_axi_io.arcache, m_axi_io.arprot, m_axi_io.arid, m_axi_io.arlock
+});
+localparam int AW_WIDTH = $bits({
+	m_axi_io.awaddr, m_axi_io.awlen, m_axi_io.awsize, m_axi_io.awburst,
+	m_axi_io.awcache, m_axi_io.awprot, m_axi_io.awid, m_axi_io.awlock
+});
+localparam int W_WIDTH = $bits({
+	m_axi_io.wdata, m_axi_io.wstrb, m_axi_io.wlast
+});
+
+wire logic [NPORTS-1:0] arvalid;
+wire logic [NPORTS-1:0] awvalid;
+wire logic [NPORTS-1:0] wvalid;
+wire logic [NPORTS-1:0] rready;
+wire logic [NPORTS-1:0] bready;
+wire logic [AR_WIDTH-1:0] ar [NPORTS];
+wire logic [AW_WIDTH-1:0] aw [NPORTS];
+wire logic [W_WIDTH-1:0] w [NPORTS];
+
+var logic busy;
+var logic write;
+var logic [PORT_WIDTH-1:0] grant;
+var logic a_done;
+var logic w_done;
+
+for (genvar i = 0; i < NPORTS; i++) begin
+	assign arvalid[i] = s_axi_io[i].arvalid;
+	assign ar[i] = {
+		s_axi_io[i].araddr, s_axi_io[i].arlen, s_axi_io[i].arsize, s_axi_io[i].arburst,
+		s_axi_io[i].arcache, s_axi_io[i].arprot, s_axi_io[i].arid, s_axi_io[i].arlock
+	};
+	assign s_axi_io[i].arready = busy && !write && !a_done && grant == i && m_axi_io.arready;
+
+	assign awvalid[i] = s_axi_io[i].awvalid;
+	assign aw[i] = {
+		s_axi_io[i].awaddr, s_axi_io[i].awlen, s_axi_io[i].awsize, s_axi_io[i].awburst,
+		s_axi_io[i].awcache, s_axi_io[i].awprot, s_axi_io[i].awid, s_axi_io[i].awlock
+	};
+	assign s_axi_io[i].awready = busy && write && !a_done && grant == i && m_axi_io.awready;
+
+	assign wvalid[i] = s_axi_io[i].wvalid;
+	assign w[i] = {
+		s_axi_io[i].wdata, s_axi_io[i].wstrb, s_axi_io[i].wlast
+	};
+	assign s_axi_io[i].wready = busy && write && !w_done && grant == i && m_axi_io.wready;
+
+	assign rready[i] = s_axi_io[i].rready;
+	assign s_axi_io[i].rid = m_axi_io.rid;
+	assign s_axi_io[i].rdata = m_axi_io.rdata;
+	assign s_axi_io[i].rresp = m_axi_io.rresp;
+	assign s_axi_io[i].rlast = m_axi_io.rlast;
+	assign s_axi_io[i].rvalid = busy && !write && grant == i && m_axi_io.rvalid;
+
+	assign bready[i] = s_axi_io[i].bready;
+	assign s_axi_io[i].bid = m_axi_io.bid;
+	assign s_axi_io[i].bresp = m_axi_io.bresp;
+	assign s_axi_io[i].bvalid = busy && write && grant == i && m_axi_io.bvalid;
+end
+
+assign {
+	m_axi_io.araddr, m_axi_io.arlen, m_axi_io.arsize, m_axi_io.arburst,
+	m_axi_io.arcache, m_axi_io.arprot, m_axi_io.arid, m_axi_io.arlock
+} = ar[grant];
+assign m_axi_io.arvalid = busy && !write && !a_done && arvalid[grant];
+assign m_axi_io.rready = busy && !write && rready[grant];
+
+assign {
+	m_axi_io.awaddr, m_axi_io.awlen, m_axi_io.awsize, m_axi_io.awburst,
+	m_axi_io.awcache, m_axi_io.awprot, m_axi_io.awid, m_axi_io.awlock
+} = aw[grant];
+assign m_axi_io.awvalid = busy && write && !a_done && awvalid[grant];
+
+assign {
+	m_axi_io.wdata, m_axi_io.wstrb, m_axi_io.wlast
+} = w[grant];
+assign m_axi_io.wvalid = busy && write && !w_done && wvalid[grant];
+assign m_axi_io.bready = busy && write && bready[grant];
+
+// The next port after the last grant that has a transaction
+var logic sel_valid;
+var logic [PORT_WIDTH-1:0] sel;
+always_comb begin
+	sel_valid = 1'b0;
+	sel = grant;
+
+	for (int k = NPORTS; k >= 1; k--) begin
+		if (arvalid[(32'(grant) + k) % NPORTS] || awvalid[(32'(grant) + k) % NPORTS]) begin
+			sel_valid = 1'b1;
+			sel = PORT_WIDTH'((32'(grant) + k) % NPORTS);
+		end
+	end
+end
+
+wire logic r_last = m_axi_io.rvalid && m_axi_io.rready && m_axi_io.rlast;
+wire logic b_hshake = m_axi_io.bvalid && m_axi_io.bready;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		busy <= 1'b0;
+		grant <= '0;
+	end
+	else if (!busy) begin
+		if (sel_valid) begin
+			busy <= 1'b1;
+			write <= awvalid[sel];
+			grant <= sel;
+			a_done <= 1'b0;
+			w_done <= 1'b0;
+		end
+	end
+	else if (write ? b_hshake : r_last) begin
+		busy <= 1'b0;
+	end
+	else begin
+		if ((m_axi_io.arvalid && m_axi_io.arready) || (m_axi_io.awvalid && m_axi_io.awready)) begin
+			a_done <= 1'b1;
+		end
+		if (m_axi_io.wvalid && m_axi_io.wready && m_axi_io.wlast) begin
+			w_done <= 1'b1;
+		end
+	end
+end
+
+endmodule
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Shares the write channels of one AXI port between NPORTS masters.
+ *
+ * Bursts are granted round-robin on their write address. The grant is
+ * held until both the address and the last data beat of the burst have
+ * been passed on, so the data of a burst is never interleaved with the
+ * data of another. The ID of a burst is replaced by the index of its
+ * master, which routes the write response back. Hence, the masters may
+ * not rely on the ID.
+ */
+module prism_sp_axi_write_arbiter #(
+	parameter int NPORTS = 2
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	axi_write_address_channel.slave		s_axi_aw [NPORTS],
+	axi_write_channel.slave				s_axi_w [NPORTS],
+	axi_write_response_channel.slave	s_axi_b [NPORTS],
+
+	axi_write_address_channel.master	m_axi_aw,
+	axi_write_channel.master			m_axi_w,
+	axi_write_response_channel.master	m_axi_b
+);
+
+localparam int PORT_WIDTH = NPORTS > 1 ? $clog2(NPORTS) : 1;
+localparam int AW_WIDTH = $bits({
+	m_axi_aw.awaddr, m_axi_aw.awlen, m_axi_aw.awsize, m_axi_aw.awburst,
+	m_axi_aw.awlock, m_axi_aw.awcache, m_axi_aw.awprot, m_axi_aw.awqos,
+	m_axi_aw.awuser
+});
+localparam int W_WIDTH = $bits({
+	m_axi_w.wdata, m_axi_w.wstrb, m_axi_w.wlast, m_axi_w.wuser
+});
+
+if ($bits(m_axi_aw.awid) < PORT_WIDTH) begin
+	$error("The ID of the AXI port (%d bits) cannot tell %d masters apart\n",
+		$bits(m_axi_aw.awid), NPORTS);
+end
+
+wire logic [NPORTS-1:0] awvalid;
+wire logic [NPORTS-1:0] wvalid;
+wire logic [NPORTS-1:0] bready;
+wire logic [AW_WIDTH-1:0] aw [NPORTS];
+wire logic [W_WIDTH-1:0] w [NPORTS];
+
+var logic busy;
+var logic [PORT_WIDTH-1:0] grant;
+var logic aw_done;
+var logic w_done;
+
+wire logic [PORT_WIDTH-1:0] bport = m_axi_b.bid[PORT_WIDTH-1:0];
+
+for (genvar i = 0; i < NPORTS; i++) begin
+	assign awvalid[i] = s_axi_aw[i].awvalid;
+	assign aw[i] = {
+		s_axi_aw[i].awaddr, s_axi_aw[i].awlen, s_axi_aw[i].awsize, s_axi_aw[i].awburst,
+		s_axi_aw[i].awlock, s_axi_aw[i].awcache, s_axi_aw[i].awprot, s_axi_aw[i].awqos,
+		s_axi_aw[i].awuser
+	};
+	assign s_axi_aw[i].awready = busy && !aw_done && grant == i && m_axi_aw.awready;
+
+	assign wvalid[i] = s_axi_w[i].wvalid;
+	assign w[i] = {
+		s_axi_w[i].wdata, s_axi_w[i].wstrb, s_axi_w[i].wlast, s_axi_w[i].wuser
+	};
+	assign s_axi_w[i].wready = busy && !w_done && grant == i && m_axi_w.wready;
+
+	assign bready[i] = s_axi_b[i].bready;
+	assign s_axi_b[i].bid = m_axi_b.bid;
+	assign s_axi_b[i].bresp = m_axi_b.bresp;
+	assign s_axi_b[i].buser = m_axi_b.buser;
+	assign s_axi_b[i].bvalid = m_axi_b.bvalid && bport == i;
+end
+
+assign m_axi_aw.awid = $bits(m_axi_aw.awid)'(grant);
+assign {
+	m_axi_aw.awaddr, m_axi_aw.awlen, m_axi_aw.awsize, m_axi_aw.awburst,
+	m_axi_aw.awlock, m_axi_aw.awcache, m_axi_aw.awprot, m_axi_aw.awqos,
+	m_axi_aw.awuser
+} = aw[grant];
+assign m_axi_aw.awvalid = busy && !aw_done && awvalid[grant];
+
+assign {
+	m_axi_w.wdata, m_axi_w.wstrb, m_axi_w.wlast, m_axi_w.wuser
+} = w[grant];
+assign m_axi_w.wvalid = busy && !w_done && wvalid[grant];
+
+assign m_axi_b.bready = bready[bport];
+
+// The next port after the last grant that has a burst
+var logic sel_valid;
+var logic [PORT_WIDTH-1:0] sel;
+always_comb begin
+	sel_valid = 1'b0;
+	sel = grant;
+
+	for (int k = NPORTS; k >= 1; k--) begin
+		if (awvalid[(32'(grant) + k) % NPORTS]) begin
+			sel_valid = 1'b1;
+			sel = PORT_WIDTH'((32'(grant) + k) % NPORTS);
+		end
+	end
+end
+
+wire logic aw_done_next = aw_done || (m_axi_aw.awvalid && m_axi_aw.awready);
+wire logic w_done_next = w_done || (m_axi_w.wvalid && m_axi_w.wready && m_axi_w.wlast);
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		busy <= 1'b0;
+		grant <= '0;
+	end
+	else if (!busy) begin
+		if (sel_valid) begin
+			busy <= 1'b1;
+			grant <= sel;
+			aw_done <= 1'b0;
+			w_done <= 1'b0;
+		end
+	end
+	else if (aw_done_next && w_done_next) begin
+		busy <= 1'b0;
+	end
+	else begin
+		aw_done <= aw_done_next;
+		w_done <= w_done_next;
+	end
+end
+
+endmodule
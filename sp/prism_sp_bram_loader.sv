@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Copies a firmware image from system memory into the instruction and
+ * data BRAMs of the processor(s).
+ *
+ * A pulse on start copies size bytes from src to the BRAM word address
+ * dst, which is interpreted like BRAM_ADDR: the first IBRAM_SIZE bytes
+ * are the IBRAM, the next DBRAM_SIZE bytes are the DBRAM.
+ * The image is read in INCR bursts of up to 256 beats that do not cross
+ * a 4 KiB boundary. While busy, the loader owns the read channels of
+ * m_axi_io and the write ports of m_ibram and m_dbram. Otherwise, they
+ * are driven by s_axi_io, s_ibram and s_dbram.
+ * The processor must be held in reset while the loader is started.
+ * mmr keeps it in reset until the loader is no longer busy.
+ *
+ * CRC-32 (IEEE 802.3) is computed over the image, which is compared to
+ * expected_crc at the end.
+ *   status[0]	busy
+ *   status[1]	done
+ *   status[2]	an AXI read returned an error
+ *   status[3]	the CRC did not match expected_crc
+ */
+module prism_sp_bram_loader #(
+	parameter int IBRAM_SIZE,
+	parameter int DBRAM_SIZE
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic start,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] src,
+	input wire logic [31:0] dst,
+	input wire logic [31:0] size,
+	input wire logic [31:0] expected_crc,
+	input wire logic [3:0] axcache,
+	output wire logic [31:0] status,
+
+	axi_interface.slave s_axi_io,
+	axi_interface.master m_axi_io,
+
+	local_memory_interface.slave s_ibram,
+	local_memory_interface.slave s_dbram,
+	local_memory_interface.master m_ibram,
+	local_memory_interface.master m_dbram
+);
+
+localparam int BRAM_SIZE = IBRAM_SIZE + DBRAM_SIZE;
+localparam int WORD_ADDR_WIDTH = $clog2(BRAM_SIZE) - 2;
+localparam int DBRAM_BITN = $clog2(IBRAM_SIZE) - 2;
+// Words per 4 KiB
+localparam int PAGE_WORDS = 4096 / 4;
+
+if (m_axi_io.C_M_AXI_DATA_WIDTH != 32) begin
+	$error("The BRAM loader needs a 32-bit wide m_axi_io.");
+end
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_AR,
+	STATE_R
+} state_t;
+
+var state_t state;
+var logic [SYSTEM_ADDR_WIDTH-1:0] addr;
+var logic [WORD_ADDR_WIDTH-1:0] bram_addr;
+// Number of words still to be requested
+var logic [29:0] words;
+var logic [31:0] crc;
+var logic done;
+var logic rresp_error;
+var logic crc_error;
+
+wire logic busy = state != STATE_IDLE;
+assign status = { 28'h0000000, crc_error, rresp_error, done, busy };
+
+/*
+ * CRC-32 of one little-endian 32-bit word (reflected, polynomial 0x04c11db7)
+ */
+function automatic logic [31:0] crc32_word(input logic [31:0] c, input logic [31:0] data);
+	logic [31:0] r;
+
+	r = c ^ data;
+	for (int i = 0; i < 32; i++) begin
+		r = r[0] ? (r >> 1) ^ 32'hedb88320 : r >> 1;
+	end
+	return r;
+endfunction
+
+// Words up to the next 4 KiB boundary
+wire logic [10:0] page_words = 11'(PAGE_WORDS) - 11'(addr[11:2]);
+var logic [8:0] burst_words;
+always_comb begin
+	burst_words = 9'd256;
+	if (page_words < 11'(burst_words)) begin
+		burst_words = 9'(page_words);
+	end
+	if (words < 30'(burst_words)) begin
+		burst_words = 9'(words);
+	end
+end
+
+/*
+ * Read channels
+ */
+var logic arvalid;
+wire logic r_hshake = m_axi_io.rvalid && m_axi_io.rready;
+
+assign m_axi_io.arvalid = busy ? arvalid : s_axi_io.arvalid;
+assign m_axi_io.araddr = busy ? m_axi_io.C_M_AXI_ADDR_WIDTH'(addr) : s_axi_io.araddr;
+assign m_axi_io.arlen = busy ? 8'(burst_words - 1) : s_axi_io.arlen;
+assign m_axi_io.arsize = busy ? 3'b010 : s_axi_io.arsize;
+assign m_axi_io.arburst = busy ? 2'b01 : s_axi_io.arburst;
+assign m_axi_io.arcache = busy ? axcache : s_axi_io.arcache;
+assign m_axi_io.arprot = busy ? 3'b010 : s_axi_io.arprot;
+assign m_axi_io.arid = busy ? '0 : s_axi_io.arid;
+assign m_axi_io.arlock = busy ? 1'b0 : s_axi_io.arlock;
+assign m_axi_io.rready = busy ? 1'b1 : s_axi_io.rready;
+assign s_axi_io.arready = busy ? 1'b0 : m_axi_io.arready;
+assign s_axi_io.rvalid = busy ? 1'b0 : m_axi_io.rvalid;
+assign s_axi_io.rdata = m_axi_io.rdata;
+assign s_axi_io.rresp = m_axi_io.rresp;
+assign s_axi_io.rlast = m_axi_io.rlast;
+assign s_axi_io.rid = m_axi_io.rid;
+
+/*
+ * Write channels
+ */
+assign m_axi_io.awvalid = s_axi_io.awvalid;
+assign m_axi_io.awaddr = s_axi_io.awaddr;
+assign m_axi_io.awlen = s_axi_io.awlen;
+assign m_axi_io.awsize = s_axi_io.awsize;
+assign m_axi_io.awburst = s_axi_io.awburst;
+assign m_axi_io.awcache = s_axi_io.awcache;
+assign m_axi_io.awprot = s_axi_io.awprot;
+assign m_axi_io.awid = s_axi_io.awid;
+assign m_axi_io.awlock = s_axi_io.awlock;
+assign m_axi_io.wvalid = s_axi_io.wvalid;
+assign m_axi_io.wdata = s_axi_io.wdata;
+assign m_axi_io.wstrb = s_axi_io.wstrb;
+assign m_axi_io.wlast = s_axi_io.wlast;
+assign m_axi_io.bready = s_axi_io.bready;
+assign s_axi_io.awready = m_axi_io.awready;
+assign s_axi_io.wready = m_axi_io.wready;
+assign s_axi_io.bvalid = m_axi_io.bvalid;
+assign s_axi_io.bresp = m_axi_io.bresp;
+assign s_axi_io.bid = m_axi_io.bid;
+
+/*
+ * BRAM write ports
+ */
+var logic bram_en;
+var logic [31:0] bram_data;
+
+assign m_ibram.addr = busy ? 30'(bram_addr) : s_ibram.addr;
+assign m_ibram.en = busy ? bram_en && !bram_addr[DBRAM_BITN] : s_ibram.en;
+assign m_ibram.be = busy ? 4'hf : s_ibram.be;
+assign m_ibram.data_in = busy ? bram_data : s_ibram.data_in;
+assign s_ibram.data_out = m_ibram.data_out;
+assign m_dbram.addr = busy ? 30'(bram_addr) : s_dbram.addr;
+assign m_dbram.en = busy ? bram_en && bram_addr[DBRAM_BITN] : s_dbram.en;
+assign m_dbram.be = busy ? 4'hf : s_dbram.be;
+assign m_dbram.data_in = busy ? bram_data : s_dbram.data_in;
+assign s_dbram.data_out = m_dbram.data_out;
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	bram_en <= 1'b0;
+
+	if (!resetn) begin
+		arvalid <= 1'b0;
+		done <= 1'b0;
+		rresp_error <= 1'b0;
+		crc_error <= 1'b0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		if (bram_en) begin
+			bram_addr <= bram_addr + 1;
+		end
+
+		case (state)
+		STATE_IDLE: begin
+			if (start) begin
+				addr <= src;
+				bram_addr <= dst[2 +: WORD_ADDR_WIDTH];
+				words <= size[31:2];
+				crc <= '1;
+				done <= 1'b0;
+				rresp_error <= 1'b0;
+				crc_error <= 1'b0;
+				state <= STATE_AR;
+			end
+		end
+		STATE_AR: begin
+			if (words == '0) begin
+				done <= 1'b1;
+				crc_error <= ~crc != expected_crc;
+				state <= STATE_IDLE;
+			end
+			else if (arvalid && m_axi_io.arready) begin
+				arvalid <= 1'b0;
+				addr <= addr + SYSTEM_ADDR_WIDTH'({burst_words, 2'b00});
+				words <= words - 30'(burst_words);
+				state <= STATE_R;
+			end
+			else begin
+				arvalid <= 1'b1;
+			end
+		end
+		STATE_R: begin
+			if (r_hshake) begin
+				bram_data <= m_axi_io.rdata;
+				bram_en <= 1'b1;
+				crc <= crc32_word(crc, m_axi_io.rdata);
+				if (m_axi_io.rresp != 2'b00) begin
+					rresp_error <= 1'b1;
+				end
+				if (m_axi_io.rlast) begin
+					state <= STATE_AR;
+				end
+			end
+		end
+		endcase
+	end
+end
+
+endmodule
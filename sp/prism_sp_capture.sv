@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Captures the frames of a GEM interface into slots of the capture ring
+ * (see USE_CAPTURE and REGOFF_CAPTURE_CONTROL).
+ *
+ * The first bytes of a frame, up to the snap length, are stored in one
+ * of two slot buffers. If the frame has been received without error and
+ * passes the filter, the pcap record header is added and the whole slot
+ * is written to slot_fifo_w while the next frame is stored in the other
+ * buffer. If the copy of the previous slot has not finished or the FIFO
+ * lacks the room for a slot, the frame is counted in drops.
+ * A copy takes CAPTURE_SLOT_WORDS + 2 clock cycles, which is less than
+ * the shortest frame plus the gap between two frames.
+ *
+ * control, filter_mask and filter_match are written in another clock
+ * domain.
+ */
+module prism_sp_capture (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [31:0] control,
+	input wire logic [31:0] filter_mask,
+	input wire logic [31:0] filter_match,
+
+	input wire logic valid,
+	input wire logic [7:0] data,
+	input wire logic sop,
+	input wire logic eop,
+	input wire logic err,
+
+	fifo_write_interface.master slot_fifo_w,
+	output var logic [31:0] drops
+);
+
+localparam int BYTES = CAPTURE_WORD_WIDTH/8;
+localparam int LANE_WIDTH = $clog2(BYTES);
+localparam int WORD_WIDTH = $clog2(CAPTURE_SLOT_WORDS);
+localparam int HDR_WORDS = CAPTURE_HDR_SIZE / BYTES;
+localparam int MAX_SNAP = CAPTURE_SLOT_SIZE - CAPTURE_HDR_SIZE;
+localparam int LEN_WIDTH = 16;
+// Leaves room for the words that are still on their way into the FIFO.
+localparam int FIFO_MARGIN = 8;
+
+if (CAPTURE_HDR_SIZE % BYTES != 0) begin
+	$error("The width of a capture word (%d) must divide the pcap header\n",
+		CAPTURE_WORD_WIDTH);
+end
+
+assign slot_fifo_w.clock = clock;
+assign slot_fifo_w.reset = ~resetn;
+
+var logic [1:0] enable_sync;
+wire logic enabled = enable_sync[1];
+wire logic filter_enable = control[CAPTURE_CONTROL_FILTER_BITN];
+wire logic [CAPTURE_CONTROL_WORD_WIDTH-1:0] filter_word =
+	control[CAPTURE_CONTROL_WORD_BITN +: CAPTURE_CONTROL_WORD_WIDTH];
+wire logic [CAPTURE_CONTROL_SNAP_WIDTH-1:0] snap_ctl =
+	control[CAPTURE_CONTROL_SNAP_BITN +: CAPTURE_CONTROL_SNAP_WIDTH];
+wire logic [LEN_WIDTH-1:0] snap =
+	snap_ctl == '0 || 32'(snap_ctl) > MAX_SNAP ? LEN_WIDTH'(MAX_SNAP) : LEN_WIDTH'(snap_ctl);
+
+/*
+ * Time
+ */
+var logic [31:0] ts_sec;
+var logic [31:0] ts_nsec;
+
+always_ff @(posedge clock) begin
+	enable_sync <= { enable_sync[0], control[0] };
+
+	if (!resetn) begin
+		ts_sec <= '0;
+		ts_nsec <= '0;
+	end
+	else if (ts_nsec >= 32'(1000000000 - CAPTURE_CLOCK_NS)) begin
+		ts_sec <= ts_sec + 1;
+		ts_nsec <= ts_nsec + CAPTURE_CLOCK_NS - 1000000000;
+	end
+	else begin
+		ts_nsec <= ts_nsec + CAPTURE_CLOCK_NS;
+	end
+end
+
+/*
+ * Slot buffers
+ */
+var logic [CAPTURE_WORD_WIDTH-1:0] slot_mem [2*CAPTURE_SLOT_WORDS];
+var logic slot_we;
+var logic [WORD_WIDTH:0] slot_waddr;
+var logic [BYTES-1:0] slot_be;
+var logic [7:0] slot_wdata;
+var logic [WORD_WIDTH:0] slot_raddr;
+var logic [CAPTURE_WORD_WIDTH-1:0] slot_rdata;
+
+always_ff @(posedge clock) begin
+	if (slot_we) begin
+		for (int i = 0; i < BYTES; i++) begin
+			if (slot_be[i]) begin
+				slot_mem[slot_waddr][8*i +: 8] <= slot_wdata;
+			end
+		end
+	end
+	slot_rdata <= slot_mem[slot_raddr];
+end
+
+/*
+ * Frames
+ */
+// Buffer that receives the current frame
+var logic fill_buf;
+var logic [LEN_WIDTH-1:0] len;
+var logic [31:0] frame_sec;
+var logic [31:0] frame_nsec;
+var logic [31:0] fword;
+var logic fword_seen;
+
+wire logic [LEN_WIDTH-1:0] off = sop ? '0 : len;
+// Offset of the byte in the slot
+wire logic [LEN_WIDTH-1:0] slot_off = off + LEN_WIDTH'(CAPTURE_HDR_SIZE);
+wire logic in_fword = off[LEN_WIDTH-1:2] == (LEN_WIDTH-2)'(filter_word);
+wire logic [31:0] fword_next = in_fword ? { fword[23:0], data } : fword;
+wire logic fword_seen_next = (!sop && fword_seen) || (in_fword && off[1:0] == 2'd3);
+wire logic pass = !filter_enable ||
+	(fword_seen_next && (fword_next & filter_mask) == filter_match);
+
+always_comb begin
+	slot_we = valid && off < snap;
+	slot_waddr = { fill_buf, slot_off[LANE_WIDTH +: WORD_WIDTH] };
+	slot_be = BYTES'(1) << slot_off[LANE_WIDTH-1:0];
+	slot_wdata = data;
+end
+
+/*
+ * Copy
+ */
+var logic copy_busy;
+var logic copy_buf;
+var logic [WORD_WIDTH:0] copy_idx;
+var logic [CAPTURE_HDR_SIZE*8-1:0] copy_hdr;
+// The slot buffer has a latency of one clock cycle.
+var logic rd_valid;
+var logic [WORD_WIDTH-1:0] rd_idx;
+
+wire logic fifo_room =
+	32'(slot_fifo_w.wr_data_count) + CAPTURE_SLOT_WORDS + FIFO_MARGIN <= CAPTURE_FIFO_DEPTH;
+wire logic [LEN_WIDTH-1:0] frame_len = off + 1;
+
+assign slot_raddr = { copy_buf, copy_idx[WORD_WIDTH-1:0] };
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	slot_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		fill_buf <= 1'b0;
+		len <= '0;
+		fword_seen <= 1'b0;
+		copy_busy <= 1'b0;
+		rd_valid <= 1'b0;
+		drops <= '0;
+	end
+	else begin
+		if (valid) begin
+			len <= off + 1;
+			fword <= fword_next;
+			fword_seen <= fword_seen_next;
+			if (sop) begin
+				frame_sec <= ts_sec;
+				frame_nsec <= ts_nsec;
+			end
+
+			if (eop && !err && enabled && pass) begin
+				if (!copy_busy && fifo_room) begin
+					copy_busy <= 1'b1;
+					copy_buf <= fill_buf;
+					copy_idx <= '0;
+					copy_hdr <= {
+						32'(frame_len),
+						32'(frame_len < snap ? frame_len : snap),
+						sop ? ts_nsec : frame_nsec,
+						sop ? ts_sec : frame_sec
+					};
+					fill_buf <= ~fill_buf;
+				end
+				else begin
+					drops <= drops + 1;
+				end
+			end
+		end
+
+		rd_valid <= copy_busy;
+		rd_idx <= copy_idx[WORD_WIDTH-1:0];
+		if (copy_busy) begin
+			copy_idx <= copy_idx + 1;
+			if (copy_idx == (WORD_WIDTH+1)'(CAPTURE_SLOT_WORDS-1)) begin
+				copy_busy <= 1'b0;
+			end
+		end
+
+		if (rd_valid) begin
+			slot_fifo_w.wr_en <= 1'b1;
+			slot_fifo_w.wr_data <= 32'(rd_idx) < HDR_WORDS ?
+				copy_hdr[rd_idx*CAPTURE_WORD_WIDTH +: CAPTURE_WORD_WIDTH] : slot_rdata;
+		end
+	end
+end
+
+endmodule
@@ -30,6 +30,16 @@ localparam int M_AXI_ACP_DATA_WIDTH = 128;
 localparam int USE_RX_RING_ACQUIRE = 1;
 localparam int USE_RX_RING_RELEASE = 1;
 localparam int USE_RX_IRQ = 1;
+/*
+ * The RX rings are virtio 1.1 packed virtqueues instead of GEM descriptor
+ * rings (see virtq_packed_desc_t).
+ */
+localparam int USE_RX_VIRTQ = 0;
+/*
+ * Number of RX descriptor rings.
+ * Frames are mapped to rings by their priority (see rx_meta_desc_t).
+ */
+localparam int NRXQUEUES = 2;
 
 /*
  * TX puzzle configuration
@@ -38,6 +48,22 @@ localparam int USE_TX_HWCOHERENCY = 1;
 localparam int USE_TX_RING_ACQUIRE = 1;
 localparam int USE_TX_RING_RELEASE = 1;
 localparam int USE_TX_IRQ = 1;
+localparam int USE_TX_VIRTQ = 0;
+/*
+ * Number of TX descriptor rings.
+ * Rings are serviced by strict or weighted round-robin priority.
+ */
+localparam int NTXQUEUES = 2;
+/*
+ * The TX scheduler stops forwarding cookies into puzzle FIFO 0 once this
+ * many are queued there. Otherwise, a high priority ring would be stuck
+ * behind a full FIFO of bulk cookies.
+ */
+localparam int TX_SCHED_BACKLOG = 4;
+/*
+ * Token bucket shaper between the RISC-V core and the TX DMA.
+ */
+localparam int USE_TX_SHAPER = 1;
 
 /*
  * Descriptor format:
@@ -145,8 +171,8 @@ typedef struct packed {
 	logic rx_w_vlan_tagged;
 	// output
 	logic rx_w_prty_tagged;
-	// reserved
-	logic [2:0] res1;
+	// output
+	logic [2:0] vlan_prio;
 	// output
 	logic cfi;
 	// output
@@ -167,13 +193,68 @@ typedef struct packed {
 
 localparam int DMA_DESC_64BITADDR = 1;
 
+/*
+ * virtio 1.1 packed virtqueue descriptor
+ *
+ * A descriptor is available to the device if its AVAIL flag equals the
+ * wrap counter of the driver and its USED flag does not. The device
+ * marks a descriptor as used by setting both flags to its own wrap
+ * counter. Both wrap counters start at 1 and flip every time the ring
+ * wraps. A ring has RING_SIZE descriptors.
+ */
+localparam int VIRTQ_DESC_F_NEXT_BITN = 0;
+localparam int VIRTQ_DESC_F_WRITE_BITN = 1;
+localparam int VIRTQ_DESC_F_INDIRECT_BITN = 2;
+localparam int VIRTQ_DESC_F_AVAIL_BITN = 7;
+localparam int VIRTQ_DESC_F_USED_BITN = 15;
+localparam int VIRTQ_RING_SIZE_WIDTH = 16;
+typedef struct packed {
+	logic [15:0] flags;
+	logic [15:0] id;
+	logic [31:0] len;
+	logic [63:0] addr;
+} virtq_packed_desc_t;
+
+/*
+ * virtio 1.1 event suppression structure
+ *
+ * off_wrap[14:0] is a descriptor offset and off_wrap[15] a wrap counter.
+ * They are only used with VIRTQ_EVENT_F_DESC.
+ */
+localparam logic [15:0] VIRTQ_EVENT_F_ENABLE = 16'h0;
+localparam logic [15:0] VIRTQ_EVENT_F_DISABLE = 16'h1;
+localparam logic [15:0] VIRTQ_EVENT_F_DESC = 16'h2;
+typedef struct packed {
+	logic [15:0] flags;
+	logic [15:0] off_wrap;
+} virtq_event_t;
+
 /*
  * Generic TX cookie
+ *
+ * queue is the TX ring the cookie was acquired from.
+ * launch_time is taken from the otherwise unused 4th word of the
+ * descriptor. If it is non-zero, the shaper holds the frame until the
+ * TX time counter (REGOFF_TX_TIME) has reached it.
+ * If digest_end is non-zero, the CRC32C of the frame bytes
+ * [digest_start, digest_end) is inserted at digest_end (least significant
+ * byte first), where the frame has to hold 4 zero bytes. The converters
+ * leave both fields zero; they are set by the firmware.
+ * If esp_sa[2] is set, the frame is encrypted with ESP SA esp_sa[1:0]
+ * (see prism_sp_esp_gcm). It is set by the firmware as well.
  */
 localparam int TX_COOKIE_ADDR_WIDTH = SYSTEM_ADDR_WIDTH;
 localparam int TX_COOKIE_DATA_ADDR_WIDTH = SYSTEM_ADDR_WIDTH;
 localparam int TX_COOKIE_SIZE_WIDTH = 14;
+localparam int TX_COOKIE_QUEUE_WIDTH = 2;
+localparam int TX_COOKIE_LAUNCH_TIME_WIDTH = 32;
+localparam int TX_COOKIE_ESP_SA_WIDTH = 3;
 typedef struct packed {
+	logic [TX_COOKIE_ESP_SA_WIDTH-1:0] esp_sa;
+	logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_end;
+	logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_start;
+	logic [TX_COOKIE_LAUNCH_TIME_WIDTH-1:0] launch_time;
+	logic [TX_COOKIE_QUEUE_WIDTH-1:0] queue;
 	logic nocrc;
 	logic eof;
 	logic wrap;
@@ -185,11 +266,28 @@ typedef tx_cookie_t dma_tx_cookie_t;
 
 /*
  * Generic RX cookie
+ *
+ * In striding mode (see prism_sp_puzzle_hw_gem_dma_write), addr is the
+ * address of the frame within the buffer of the descriptor, and
+ * buf_last marks the last frame written to that buffer.
+ * digest_err is set if the CRC32C data digest selected by RX_DIGEST did
+ * not match.
+ * esp is set if the frame has been decrypted with an ESP SA, esp_auth_err
+ * if its ICV did not match in addition.
+ * tunnel, inner_chksum_enc and inner_hash describe the inner frame of a
+ * VXLAN/GENEVE frame (see prism_sp_rx_tunnel).
  */
 localparam int RX_COOKIE_SIZE_WIDTH = 14;
 localparam int RX_COOKIE_DATA_ADDR_WIDTH = SYSTEM_ADDR_WIDTH;
 localparam int RX_COOKIE_ADDR_WIDTH = SYSTEM_ADDR_WIDTH;
 typedef struct packed {
+	logic [31:0] inner_hash;
+	logic [1:0] inner_chksum_enc;
+	logic tunnel;
+	logic buf_last;
+	logic esp_auth_err;
+	logic esp;
+	logic digest_err;
 	logic w_broadcast_frame;
 	logic w_mult_hash_match;
 	logic w_uni_hash_match;
@@ -199,6 +297,7 @@ typedef struct packed {
 	logic [1:0] chksum_enc;
 	logic rx_w_vlan_tagged;
 	logic rx_w_prty_tagged;
+	logic [2:0] prio;
 	logic cfi;
 	logic eof;
 	logic sof;
@@ -210,31 +309,84 @@ typedef struct packed {
 } rx_cookie_t;
 typedef rx_cookie_t dma_rx_cookie_t;
 
+/*
+ * Completion queue entry (SQ/CQ ring mode)
+ *
+ * desc_addr is the address of the completed descriptor. phase is 1 during
+ * the first pass through the completion queue and flips on every wrap.
+ * flags:
+ *   [0] eof
+ *   [1] RX: sof
+ *   [2] RX: fcs, TX: nocrc
+ *   [4:3] RX: chksum_enc
+ *   [5] RX: VLAN tagged
+ *   [6] RX: priority tagged
+ *   [7] RX: data digest or ESP ICV mismatch
+ * With striding RX, desc_addr is the address of the frame and buf_last
+ * is set for the last frame of a buffer, i.e., the buffer of the
+ * descriptor is returned. A buffer that is returned before it is full
+ * gets an entry of its own with size 0 and buf_last set.
+ */
+localparam int CQ_ENTRY_FLAGS_WIDTH = 8;
+localparam int CQ_ENTRY_SIZE_WIDTH = 14;
+typedef struct packed {
+	logic phase;
+	logic [CQ_ENTRY_FLAGS_WIDTH-1:0] flags;
+	logic buf_last;
+	logic [CQ_ENTRY_SIZE_WIDTH-1:0] size;
+	logic [SYSTEM_ADDR_WIDTH-1:0] desc_addr;
+} cq_entry_t;
+// Entries are written in bursts of at most one line.
+localparam int CQ_LINE_SIZE = 64;
+localparam int CQ_INDEX_WIDTH = 16;
+
 /*
  * TX meta descriptor
+ *
+ * If ct_size is non-zero, the descriptor has been written before the
+ * frame data is completely in the TX data FIFO (cut-through).
+ * The GEM TX interface starts transmission as soon as ct_size bytes are
+ * buffered. A descriptor with ct_size set to zero is handled as before
+ * (store-and-forward).
+ * esp_sa and queue are copied from the TX cookie of the first fragment.
  */
 localparam int TX_META_DESC_SIZE_WIDTH = 14;
 typedef struct packed {
+	logic [TX_COOKIE_QUEUE_WIDTH-1:0] queue;
+	logic [TX_COOKIE_ESP_SA_WIDTH-1:0] esp_sa;
+	logic [TX_META_DESC_SIZE_WIDTH-1:0] ct_size;
 	logic nocrc;
 	logic [TX_META_DESC_SIZE_WIDTH-1:0] size;
 } tx_meta_desc_t;
 
 /*
  * RX meta descriptor
+ *
+ * prio is the VLAN PCP of tagged frames and the IP precedence
+ * (the 3 MSBs of the DSCP) of untagged IPv4/IPv6 frames.
+ * digest_err is set if the CRC32C data digest did not match.
+ * esp and esp_auth_err are set by prism_sp_rx_esp, tunnel,
+ * inner_chksum_enc and inner_hash by prism_sp_rx_tunnel. They are above
+ * the 32 bits that the firmware reads.
  */
 localparam int RX_META_DESC_SIZE_WIDTH = 13;
 typedef struct packed {
+	logic [31:0] inner_hash;
+	logic [1:0] inner_chksum_enc;
+	logic tunnel;
+	logic esp_auth_err;
+	logic esp;
 	logic w_broadcast_frame;
 	logic w_mult_hash_match;
 	logic w_uni_hash_match;
 	logic w_ext_match;
 	logic w_add_match;
 	logic [1:0] add_match;
-	logic res2;
+	logic digest_err;
 	logic [1:0] chksum_enc;
 	logic rx_w_vlan_tagged;
 	logic rx_w_prty_tagged;
-	logic [2:0] res1;
+	logic [2:0] prio;
 	logic cfi;
 	logic eof;
 	logic sof;
@@ -274,6 +426,15 @@ localparam logic [4:0] SP_FUNC7_ACP_WRITE_START = 5'b11010;
 localparam logic [4:0] SP_FUNC7_ACP_WRITE_STATUS = 5'b11011;
 localparam logic [4:0] SP_FUNC7_ACP_SET_LOCAL_WSTRB = 5'b11100;
 localparam logic [4:0] SP_FUNC7_ACP_SET_REMOTE_WSTRB = 5'b11101;
+localparam logic [4:0] SP_FUNC7_ACP_SUBMIT = 5'b11110;
+localparam logic [4:0] SP_FUNC7_ACP_COMPLETE = 5'b11111;
+
+// The header window commands have bit 5 of funct7 set.
+localparam logic [5:0] SP_FUNC7_HDR_LOAD = 6'b100000;
+localparam logic [5:0] SP_FUNC7_HDR_STATUS = 6'b100001;
+localparam logic [5:0] SP_FUNC7_HDR_PEEK = 6'b100010;
+localparam logic [5:0] SP_FUNC7_HDR_POKE = 6'b100011;
+localparam logic [5:0] SP_FUNC7_HDR_COMMIT = 6'b100100;
 
 localparam int CMD_PUZZLE_FIFO_R_EMPTY	= 0;
 localparam int CMD_PUZZLE_FIFO_R_POP	= CMD_PUZZLE_FIFO_R_EMPTY + 1;
@@ -312,14 +473,45 @@ localparam int CMD_ACP_WRITE_START		= CMD_ACP_READ_STATUS + 1;
 localparam int CMD_ACP_WRITE_STATUS		= CMD_ACP_WRITE_START + 1;
 localparam int CMD_ACP_SET_LOCAL_WSTRB	= CMD_ACP_WRITE_STATUS + 1;
 localparam int CMD_ACP_SET_REMOTE_WSTRB	= CMD_ACP_SET_LOCAL_WSTRB + 1;
+localparam int CMD_ACP_SUBMIT			= CMD_ACP_SET_REMOTE_WSTRB + 1;
+localparam int CMD_ACP_COMPLETE			= CMD_ACP_SUBMIT + 1;
 localparam int CMD_ACP_FIRST			= CMD_ACP_READ_START;
-localparam int CMD_ACP_LAST				= CMD_ACP_SET_REMOTE_WSTRB;
+localparam int CMD_ACP_LAST				= CMD_ACP_COMPLETE;
+
+localparam int CMD_HDR_LOAD				= 0;
+localparam int CMD_HDR_STATUS			= CMD_HDR_LOAD + 1;
+localparam int CMD_HDR_PEEK				= CMD_HDR_STATUS + 1;
+localparam int CMD_HDR_POKE				= CMD_HDR_PEEK + 1;
+localparam int CMD_HDR_COMMIT			= CMD_HDR_POKE + 1;
+localparam int CMD_HDR_FIRST			= CMD_HDR_LOAD;
+localparam int CMD_HDR_LAST				= CMD_HDR_COMMIT;
 
 localparam int SP_UNIT_PUZZLE_NCMDS = CMD_PUZZLE_LAST - CMD_PUZZLE_FIRST + 1;
 localparam int SP_UNIT_RX_NCMDS = CMD_RX_LAST - CMD_RX_FIRST + 1;
 localparam int SP_UNIT_TX_NCMDS = CMD_TX_LAST - CMD_TX_FIRST + 1;
 localparam int SP_UNIT_COMMON_NCMDS = CMD_COMMON_LAST - CMD_COMMON_FIRST + 1;
 localparam int SP_UNIT_ACP_NCMDS = CMD_ACP_LAST - CMD_ACP_FIRST + 1;
+localparam int SP_UNIT_HDR_NCMDS = CMD_HDR_LAST - CMD_HDR_FIRST + 1;
+
+/*
+ * Number of ACP transfers in flight, including the one of the
+ * READ START/WRITE START commands (see acpram_axi_queue).
+ */
+localparam int SP_UNIT_ACP_NTAGS = 8;
+
+/*
+ * SP unit events (SP_NPERF_EVENTS), counted by hpmcounter(3 + n).
+ * A "wait" event is set from a status command that returned "not ready"
+ * (FIFO empty/full, DMA/ACP busy) until the next one that returned
+ * "ready", i.e., while the firmware polls.
+ */
+localparam int SP_PERF_EVENT_PUZZLE_EMPTY_WAIT	= 0;
+localparam int SP_PERF_EVENT_PUZZLE_FULL_WAIT	= 1;
+localparam int SP_PERF_EVENT_UNIT_BUSY			= 2;
+localparam int SP_PERF_EVENT_DMA_WAIT			= 3;
+localparam int SP_PERF_EVENT_ACP_WAIT			= 4;
+// Puzzle FIFO entries popped by the firmware
+localparam int SP_PERF_EVENT_COOKIE_POP			= 5;
 
 localparam int SP_RX_IRQ_DONE_BITN = 0;
 localparam int SP_RX_IRQ_NODESC_BITN = 1;
@@ -331,11 +523,23 @@ localparam int SP_TX_IRQ_DONE_BITN = 0;
 /*
  * Main FIFOs configuration
  */
-localparam int RX_META_FIFO_WIDTH = 32;
+localparam int RX_META_FIFO_WIDTH = $bits(rx_meta_desc_t);
 localparam int RX_META_FIFO_DEPTH = 2048;
 localparam int RX_META_FIFO_DATA_COUNT_WIDTH = $clog2(RX_META_FIFO_DEPTH) + 1;
 
+/*
+ * sim/check-datapath.tcl overrides the data FIFO widths through
+ * PRISM_SP_DATA_FIFO_WIDTH.
+ * 128 bits is the only verified width. The data path is written for
+ * wider words, but 256 and 512 bits are experimental: neither has been
+ * elaborated or simulated, and sim/check-datapath.tcl has to pass
+ * before they are used.
+ */
+`ifdef PRISM_SP_DATA_FIFO_WIDTH
+localparam int RX_DATA_FIFO_WIDTH = `PRISM_SP_DATA_FIFO_WIDTH;
+`else
 localparam int RX_DATA_FIFO_WIDTH = 128;
+`endif
 localparam int RX_DATA_FIFO_SIZE = 2**16;
 localparam int RX_DATA_FIFO_DEPTH = RX_DATA_FIFO_SIZE / (RX_DATA_FIFO_WIDTH/8);
 localparam int RX_DATA_FIFO_DATA_COUNT_WIDTH = $clog2(RX_DATA_FIFO_DEPTH) + 1;
@@ -353,6 +557,283 @@ localparam int ENABLE_RX_SW_RX_META_FIFO_R = 0;
 
 localparam int ENABLE_RX_RISCV_PROCESSOR = 1;
 
+/*
+ * Hardware bypass lane between the puzzle FIFO read by the RISC-V core
+ * and the puzzle FIFO written by it (see prism_sp_puzzle_fifo_bypass).
+ * The order of the cookies is kept in 2**PUZZLE_BYPASS_KEY_WIDTH
+ * classes of rings or flows.
+ */
+localparam int USE_PUZZLE_BYPASS = 1;
+localparam int PUZZLE_BYPASS_KEY_WIDTH = 3;
+
+/*
+ * On-chip trace recorder of every core (see prism_sp_trace_recorder).
+ * It keeps the last TRACE_RECORDER_DEPTH changes of a
+ * TRACE_RECORDER_SAMPLE_WIDTH-bit window of the trace structures.
+ */
+localparam int USE_TRACE_RECORDER = 1;
+localparam int TRACE_RECORDER_DEPTH = 1024;
+localparam int TRACE_RECORDER_SAMPLE_WIDTH = 64;
+
+/*
+ * Burst loader of the instruction and data BRAMs
+ * (see prism_sp_bram_loader).
+ */
+localparam int USE_BRAM_LOADER = 1;
+
+/*
+ * Frame generator in front of the GEM RX interface and frame checker
+ * behind the GEM TX interface (see prism_sp_traffic_gen and
+ * prism_sp_traffic_check).
+ *
+ * Generated frames carry this header:
+ *   [0:5]   destination 02:00:00:00:00:01
+ *   [6:11]  source 02:00:00:00:00:00
+ *   [12:13] EtherType TRAFFIC_ETHERTYPE
+ *   [14:17] sequence number
+ *   [18:21] timestamp (GEM RX clock cycles)
+ *   [22:23] flow
+ *   [24]    payload pattern
+ *   [25]    reserved
+ * All fields are big endian. Payload byte i (counted from the start of
+ * the frame) is traffic_payload(pattern, seq, i).
+ */
+localparam int USE_TRAFFIC_GEN = 1;
+localparam logic [15:0] TRAFFIC_ETHERTYPE = 16'h88b5;
+localparam int TRAFFIC_HDR_SIZE = 26;
+
+function automatic logic [7:0] traffic_payload(
+	input logic [1:0] pattern,
+	input logic [31:0] seq,
+	input logic [13:0] offset
+);
+	case (pattern)
+	2'd0: return offset[7:0];
+	2'd1: return offset[7:0] ^ seq[7:0];
+	2'd2: return 8'h00;
+	default: return 8'hff;
+	endcase
+endfunction
+
+/*
+ * Results of the frame checker
+ * The latencies are in GEM RX clock cycles.
+ */
+typedef struct packed {
+	logic [31:0] lat_max;
+	logic [31:0] lat_min;
+	logic [31:0] corrupt;
+	logic [31:0] reordered;
+	logic [31:0] lost;
+	logic [31:0] frames;
+} traffic_check_t;
+
+/*
+ * Inline AES-GCM for IPsec ESP (RFC 4106) at the GEM interfaces
+ * (see prism_sp_esp_gcm).
+ *
+ * Frames are expected to be untagged Ethernet II frames with an IPv4
+ * header of 20 bytes and protocol ESP:
+ *   [34:37] SPI
+ *   [38:41] sequence number
+ *   [42:49] IV
+ *   [50:]   encrypted payload, padding, pad length and next header
+ *   last 16 bytes (as given by the IPv4 total length): ICV
+ * The AAD is the SPI and the sequence number. The nonce is the salt of
+ * the SA followed by the IV.
+ * RX frames pass through a delay line of ESP_RX_DELAY clock cycles
+ * (see prism_sp_rx_esp). RX decryption needs a single RX core: with
+ * NRXCORES > 1, ESP frames are received as they are.
+ */
+localparam int USE_ESP_GCM = 1;
+localparam int ESP_SA_WIDTH = TX_COOKIE_ESP_SA_WIDTH - 1;
+localparam int ESP_NSAS = 2**ESP_SA_WIDTH;
+localparam int ESP_SPI_OFF = 34;
+localparam int ESP_IV_OFF = 42;
+localparam int ESP_DATA_OFF = 50;
+localparam int ESP_ICV_SIZE = 16;
+// IPv4 header, SPI, sequence number, IV, pad length, next header and ICV
+localparam int ESP_MIN_IP_LEN = 20 + 8 + 8 + 2 + ESP_ICV_SIZE;
+localparam int ESP_RX_DELAY = 32;
+
+/*
+ * VXLAN (RFC 7348) and GENEVE (RFC 8926) tunnels over IPv4
+ * (see REGOFF_TUNNEL_CONTROL and prism_sp_rx_tunnel).
+ *
+ * TX: frames of the enabled queues get the template of their queue
+ * prepended by the GEM TX interface. A template consists of an untagged
+ * Ethernet II header, an IPv4 header of 20 bytes, a UDP header and the
+ * tunnel header. The lengths, the IPv4 header checksum and the UDP
+ * checksum are filled in.
+ * RX: frames are delayed by TUNNEL_RX_DELAY clock cycles, which leaves
+ * enough time to find the inner frame before the outer headers are
+ * passed on (or stripped).
+ */
+localparam int USE_TUNNEL = 1;
+localparam int TUNNEL_NTMPLS = 2**TX_COOKIE_QUEUE_WIDTH;
+localparam int TUNNEL_TMPL_SIZE = 64;
+localparam int TUNNEL_TMPL_NWORDS = TUNNEL_NTMPLS * TUNNEL_TMPL_SIZE / 4;
+localparam logic [15:0] TUNNEL_VXLAN_PORT = 16'd4789;
+localparam logic [15:0] TUNNEL_GENEVE_PORT = 16'd6081;
+localparam int TUNNEL_RX_DELAY = 64;
+
+/*
+ * Result of prism_sp_rx_tunnel for a frame.
+ * inner_chksum_enc is encoded like the checksum status of the GEM:
+ *   00: not checked or wrong
+ *   01: IPv4 header checksum correct
+ *   10: IPv4 header and TCP checksum correct
+ *   11: IPv4 header and UDP checksum correct
+ * inner_hash is the CRC32C over the protocol, the addresses and the ports
+ * of the inner IPv4 header (in frame order).
+ */
+typedef struct packed {
+	logic [31:0] inner_hash;
+	logic [1:0] inner_chksum_enc;
+	logic tunnel;
+} rx_tunnel_status_t;
+
+/*
+ * Flow telemetry (see prism_sp_flow_meter and REGOFF_FLOW_CONTROL)
+ *
+ * Received IPv4 frames (20-byte header) are counted per 5-tuple in a
+ * table of FLOW_NENTRIES flows. The ports of protocols other than TCP and
+ * UDP are zero. Times are in ticks of 2**FLOW_TICK_SHIFT GEM RX clock
+ * cycles. Records of expired flows are passed to the core clock domain
+ * through a FIFO of FLOW_FIFO_DEPTH records and written to the export
+ * ring in bursts of up to FLOW_BATCH records
+ * (see prism_sp_puzzle_hw_flow_export).
+ */
+localparam int USE_FLOW_METER = 1;
+localparam int FLOW_NENTRIES = 1024;
+localparam int FLOW_TICK_SHIFT = 17;
+localparam int FLOW_FIFO_DEPTH = 64;
+localparam int FLOW_FIFO_DATA_COUNT_WIDTH = $clog2(FLOW_FIFO_DEPTH) + 1;
+localparam int FLOW_BATCH = 8;
+// A partial batch is written after this many clock cycles.
+localparam int FLOW_BATCH_TIMEOUT = 4096;
+localparam int FLOW_INDEX_WIDTH = 16;
+
+/*
+ * Flow record (32 bytes)
+ *
+ * phase is 1 during the first pass through the export ring and flips on
+ * every wrap. reason:
+ *   0: idle timeout
+ *   1: active timeout (the flow is counted from zero again)
+ *   2: the entry was needed for another flow
+ *   3: TCP FIN or RST
+ *   4: the meter was disabled
+ * tcp_flags is the OR over the TCP flags of all frames. octets counts
+ * the IPv4 total lengths, first and last are the ticks of the first and
+ * the last frame.
+ */
+typedef struct packed {
+	logic [31:0] last;
+	logic [31:0] first;
+	logic [31:0] octets;
+	logic [31:0] packets;
+	logic [6:0] reserved;
+	logic phase;
+	logic [7:0] reason;
+	logic [7:0] tcp_flags;
+	logic [7:0] proto;
+	logic [15:0] dport;
+	logic [15:0] sport;
+	logic [31:0] daddr;
+	logic [31:0] saddr;
+} flow_record_t;
+localparam int FLOW_RECORD_WIDTH = $bits(flow_record_t);
+
+/*
+ * Packet capture (see prism_sp_capture and REGOFF_CAPTURE_CONTROL)
+ *
+ * Captured frames are written to slots of CAPTURE_SLOT_SIZE bytes of
+ * the capture ring. A slot holds a pcap record header (nanosecond
+ * variant, magic 0xa1b23c4d) followed by at most
+ * CAPTURE_SLOT_SIZE - CAPTURE_HDR_SIZE bytes of the frame:
+ *   [0:3]   seconds
+ *   [4:7]   nanoseconds
+ *   [8:11]  number of captured bytes
+ *   [12:15] length of the frame
+ * The header fields are little endian. The timestamps are taken at the
+ * first byte of a frame. They count from the reset of the GEM interface,
+ * which runs with a clock period of CAPTURE_CLOCK_NS.
+ * The slots cross into the core clock domain through a FIFO of
+ * CAPTURE_FIFO_DEPTH words of CAPTURE_WORD_WIDTH bits.
+ */
+localparam int USE_CAPTURE = 1;
+localparam int CAPTURE_SLOT_SIZE = 256;
+localparam int CAPTURE_HDR_SIZE = 16;
+localparam int CAPTURE_WORD_WIDTH = 32;
+localparam int CAPTURE_SLOT_WORDS = CAPTURE_SLOT_SIZE / (CAPTURE_WORD_WIDTH/8);
+localparam int CAPTURE_FIFO_DEPTH = 16 * CAPTURE_SLOT_WORDS;
+localparam int CAPTURE_FIFO_DATA_COUNT_WIDTH = $clog2(CAPTURE_FIFO_DEPTH) + 1;
+localparam int CAPTURE_CLOCK_NS = 8;
+
+/*
+ * Header window (see prism_sp_unit_hdr)
+ *
+ * The first HDR_WINDOW_SIZE bytes of a frame can be taken out of the RX
+ * and TX data streams into the header window of a core, read and
+ * rewritten by the firmware and put back into the stream.
+ * HDR_WINDOW_SIZE must be a multiple of the width of the data FIFOs.
+ */
+localparam int USE_HDR_WINDOW = 1;
+localparam int HDR_WINDOW_SIZE = 128;
+localparam int HDR_WINDOW_ADDR_WIDTH = $clog2(HDR_WINDOW_SIZE);
+
+/*
+ * PAUSE frames (see prism_sp_tx_pause)
+ *
+ * While a priority is paused, the PAUSE frame is repeated after half of
+ * the pause time. A pause quantum takes PAUSE_QUANTUM_CYCLES cycles of
+ * the GEM TX clock (512 bit times at 1 Gbit/s and 125 MHz).
+ */
+localparam int USE_TX_PAUSE = 1;
+localparam int PAUSE_QUANTUM_CYCLES = 64;
+
+/*
+ * AXI attributes of a stream of DMA transactions
+ * (see REGOFF_AXATTR_DESC_RD)
+ *
+ * Descriptor reads, descriptor write-backs, frame headers, frame
+ * payloads, the spill ring, flow records and captured frames each have
+ * their own attributes. Unless they are set in the
+ * MMR, a stream keeps the built-in attributes below. The attributes of
+ * the frame payloads default to DMA_AXI_AXCACHE on RX and to
+ * USE_TX_HWCOHERENCY on TX. The headers default to the payload
+ * attributes.
+ */
+typedef struct packed {
+	logic [1:0] user;
+	logic [2:0] prot;
+	logic [3:0] cache;
+} axi_attr_t;
+localparam axi_attr_t AXI_ATTR_DESC_RD = '{ user: 2'b00, prot: 3'b000, cache: 4'b0011 };
+localparam axi_attr_t AXI_ATTR_DESC_WR = '{ user: 2'b01, prot: 3'b000, cache: 4'b0011 };
+localparam axi_attr_t AXI_ATTR_SPILL = '{ user: 2'b00, prot: 3'b000, cache: 4'b0011 };
+localparam axi_attr_t AXI_ATTR_FLOW = '{ user: 2'b01, prot: 3'b000, cache: 4'b0011 };
+localparam axi_attr_t AXI_ATTR_CAPTURE = '{ user: 2'b01, prot: 3'b000, cache: 4'b0011 };
+
+/*
+ * RX spill buffer (see prism_sp_rx_spill and REGOFF_SPILL_CONTROL)
+ *
+ * Under congestion, the RX data stream is moved out of the RX data FIFO
+ * into a ring in memory in bursts of SPILL_BURST_LEN words and read back
+ * in order into a staging FIFO of SPILL_FIFO_DEPTH words. Spilling starts
+ * when the staging FIFO is full and SPILL_START_WORDS words wait in the
+ * RX data FIFO. The staging FIFO must hold the largest frame.
+ * Without USE_RX_SPILL, neither the staging FIFO nor the spill port is
+ * built and the RX FIFOs are read directly. With it, the staging FIFO is
+ * bypassed while spilling is disabled and the ring is empty.
+ */
+localparam int USE_RX_SPILL = 1;
+localparam int SPILL_BURST_LEN = 16;
+localparam int SPILL_FIFO_DEPTH = 1024;
+localparam int SPILL_FIFO_DATA_COUNT_WIDTH = $clog2(SPILL_FIFO_DEPTH) + 1;
+localparam int SPILL_START_WORDS = RX_DATA_FIFO_DEPTH / 4;
+
 /*
  * RX Puzzle FIFO configuration.
  */
@@ -400,26 +881,81 @@ localparam int RX_PUZZLE_FIFO_WRITE_DEPTH [NRXPUZZLEFIFOS] = {
 	16
 };
 
-localparam int RX_PUZZLE_FIFO_READ_DEPTH [NRXPUZZLEFIFOS] = {
-	RX_PUZZLE_FIFO_WRITE_DEPTH[0] * RX_PUZZLE_FIFO_W_DATA_WIDTH[0] / RX_PUZZLE_FIFO_R_DATA_WIDTH[0],
-	RX_PUZZLE_FIFO_WRITE_DEPTH[1] * RX_PUZZLE_FIFO_W_DATA_WIDTH[1] / RX_PUZZLE_FIFO_R_DATA_WIDTH[1],
-	RX_PUZZLE_FIFO_WRITE_DEPTH[2] * RX_PUZZLE_FIFO_W_DATA_WIDTH[2] / RX_PUZZLE_FIFO_R_DATA_WIDTH[2],
-	RX_PUZZLE_FIFO_WRITE_DEPTH[3] * RX_PUZZLE_FIFO_W_DATA_WIDTH[3] / RX_PUZZLE_FIFO_R_DATA_WIDTH[3]
-};
+/*
+ * Per-FIFO parameters derived from the arrays above. Adding a puzzle
+ * FIFO only requires extending those arrays and NRXPUZZLEFIFOS.
+ */
+typedef int rx_puzzle_fifo_param_t [NRXPUZZLEFIFOS];
+
+function automatic rx_puzzle_fifo_param_t rx_puzzle_fifo_read_depth();
+	for (int i = 0; i < NRXPUZZLEFIFOS; i++) begin
+		rx_puzzle_fifo_read_depth[i] = RX_PUZZLE_FIFO_WRITE_DEPTH[i] *
+			RX_PUZZLE_FIFO_W_DATA_WIDTH[i] / RX_PUZZLE_FIFO_R_DATA_WIDTH[i];
+	end
+endfunction
+
+function automatic rx_puzzle_fifo_param_t rx_puzzle_fifo_count_width(input rx_puzzle_fifo_param_t depth);
+	for (int i = 0; i < NRXPUZZLEFIFOS; i++) begin
+		rx_puzzle_fifo_count_width[i] = $clog2(depth[i]) + 1;
+	end
+endfunction
+
+function automatic int rx_puzzle_fifo_max(input rx_puzzle_fifo_param_t a, input rx_puzzle_fifo_param_t b);
+	rx_puzzle_fifo_max = 0;
+	for (int i = 0; i < NRXPUZZLEFIFOS; i++) begin
+		if (a[i] > rx_puzzle_fifo_max)
+			rx_puzzle_fifo_max = a[i];
+		if (b[i] > rx_puzzle_fifo_max)
+			rx_puzzle_fifo_max = b[i];
+	end
+endfunction
+
+localparam rx_puzzle_fifo_param_t RX_PUZZLE_FIFO_READ_DEPTH = rx_puzzle_fifo_read_depth();
+localparam rx_puzzle_fifo_param_t RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH =
+	rx_puzzle_fifo_count_width(RX_PUZZLE_FIFO_READ_DEPTH);
+localparam rx_puzzle_fifo_param_t RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH =
+	rx_puzzle_fifo_count_width(RX_PUZZLE_FIFO_WRITE_DEPTH);
 
-localparam int RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH [NRXPUZZLEFIFOS] = {
-	$clog2(RX_PUZZLE_FIFO_READ_DEPTH[0]) + 1,
-	$clog2(RX_PUZZLE_FIFO_READ_DEPTH[1]) + 1,
-	$clog2(RX_PUZZLE_FIFO_READ_DEPTH[2]) + 1,
-	$clog2(RX_PUZZLE_FIFO_READ_DEPTH[3]) + 1
-};
+/*
+ * The puzzle FIFO interfaces of a core form arrays and therefore share
+ * the largest width. Each FIFO only stores the lower
+ * RX_PUZZLE_FIFO_[RW]_DATA_WIDTH bits.
+ */
+localparam int RX_PUZZLE_FIFO_DATA_WIDTH =
+	rx_puzzle_fifo_max(RX_PUZZLE_FIFO_R_DATA_WIDTH, RX_PUZZLE_FIFO_W_DATA_WIDTH);
+localparam int RX_PUZZLE_FIFO_DATA_COUNT_WIDTH =
+	rx_puzzle_fifo_max(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH, RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH);
 
-localparam int RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH [NRXPUZZLEFIFOS] = {
-	$clog2(RX_PUZZLE_FIFO_WRITE_DEPTH[0]) + 1,
-	$clog2(RX_PUZZLE_FIFO_WRITE_DEPTH[1]) + 1,
-	$clog2(RX_PUZZLE_FIFO_WRITE_DEPTH[2]) + 1,
-	$clog2(RX_PUZZLE_FIFO_WRITE_DEPTH[3]) + 1
-};
+/*
+ * RX worker pool (see prism_sp_processor_pool).
+ * NRXWORKERS processors share the puzzle stage that reads puzzle FIFO
+ * RX_WORKER_FIFO_R and writes puzzle FIFO RX_WORKER_FIFO_W.
+ * If RX_WORKER_HASH_WORD is negative, frames are dispatched round-robin.
+ * Otherwise, they are dispatched by a hash over that 32-bit cookie word.
+ * PRISM_SP_NWORKERS overrides NRXWORKERS and NTXWORKERS;
+ * sim/check-datapath.tcl elaborates pools of 2 processors with it.
+ */
+`ifdef PRISM_SP_NWORKERS
+localparam int NRXWORKERS = `PRISM_SP_NWORKERS;
+`else
+localparam int NRXWORKERS = 1;
+`endif
+localparam int RX_WORKER_FIFO_R = 1;
+localparam int RX_WORKER_FIFO_W = 2;
+localparam int RX_WORKER_HASH_WORD = -1;
+
+function automatic int rx_cookie_eof_bitn();
+	rx_cookie_t c;
+
+	c = '0;
+	c.eof = 1'b1;
+	for (int i = 0; i < $bits(rx_cookie_t); i++) begin
+		if (c[i])
+			return i;
+	end
+	return -1;
+endfunction
+localparam int RX_COOKIE_EOF_BITN = rx_cookie_eof_bitn();
 
 /*
  * ---- TX portion ---------------------------------------------------
@@ -427,19 +963,50 @@ localparam int RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH [NRXPUZZLEFIFOS] = {
 /*
  * Main FIFOs configuration
  */
-localparam int TX_META_FIFO_WIDTH = 32;
+localparam int TX_META_FIFO_WIDTH = $bits(tx_meta_desc_t);
 localparam int TX_META_FIFO_DEPTH = 2048;
 localparam int TX_META_FIFO_DATA_COUNT_WIDTH = $clog2(TX_META_FIFO_DEPTH) + 1;
 
+`ifdef PRISM_SP_DATA_FIFO_WIDTH
+localparam int TX_DATA_FIFO_WIDTH = `PRISM_SP_DATA_FIFO_WIDTH;
+`else
 localparam int TX_DATA_FIFO_WIDTH = 128;
+`endif
 localparam int TX_DATA_FIFO_SIZE = 2**16;
 localparam int TX_DATA_FIFO_DEPTH = TX_DATA_FIFO_SIZE / (TX_DATA_FIFO_WIDTH/8);
 localparam int TX_DATA_FIFO_DATA_COUNT_WIDTH = $clog2(TX_DATA_FIFO_DEPTH) + 1;
 
-localparam int TX_CSUM_FIFO_WIDTH = 2 + 16 + 2 + 16;
+/*
+ * IP checksum type and checksum, L4 checksum type and checksum and the
+ * sum over the whole frame including the inserted checksums (zero if
+ * unknown, see REGOFF_TUNNEL_CONTROL).
+ */
+localparam int TX_CSUM_FIFO_WIDTH = 2 + 16 + 2 + 16 + 16;
 localparam int TX_CSUM_FIFO_DEPTH = TX_META_FIFO_DEPTH;
 localparam int TX_CSUM_FIFO_DATA_COUNT_WIDTH = TX_META_FIFO_DATA_COUNT_WIDTH;
 
+/*
+ * CRC32C data digest of a frame (see prism_sp_tx_digest)
+ * An offset of zero means that no digest is inserted.
+ */
+localparam int TX_DIGEST_FIFO_WIDTH = 32 + TX_COOKIE_SIZE_WIDTH;
+localparam int TX_DIGEST_FIFO_DEPTH = TX_META_FIFO_DEPTH;
+localparam int TX_DIGEST_FIFO_DATA_COUNT_WIDTH = TX_META_FIFO_DATA_COUNT_WIDTH;
+
+/*
+ * CRC32C (Castagnoli, reflected polynomial 0x82f63b78) of one byte
+ * The CRC starts with all ones and is inverted at the end.
+ */
+function automatic logic [31:0] crc32c_byte(input logic [31:0] c, input logic [7:0] data);
+	logic [31:0] r;
+
+	r = c ^ 32'(data);
+	for (int i = 0; i < 8; i++) begin
+		r = r[0] ? (r >> 1) ^ 32'h82f63b78 : r >> 1;
+	end
+	return r;
+endfunction
+
 localparam int ENABLE_TX_SW_MMR_I = 0;
 localparam int ENABLE_TX_SW_MMR_T = 0;
 /*
@@ -507,26 +1074,103 @@ localparam int TX_PUZZLE_FIFO_WRITE_DEPTH [NTXPUZZLEFIFOS] = {
 	16
 };
 
-localparam int TX_PUZZLE_FIFO_READ_DEPTH [NTXPUZZLEFIFOS] = {
-	TX_PUZZLE_FIFO_WRITE_DEPTH[0] * TX_PUZZLE_FIFO_W_DATA_WIDTH[0] / TX_PUZZLE_FIFO_R_DATA_WIDTH[0],
-	TX_PUZZLE_FIFO_WRITE_DEPTH[1] * TX_PUZZLE_FIFO_W_DATA_WIDTH[1] / TX_PUZZLE_FIFO_R_DATA_WIDTH[1],
-	TX_PUZZLE_FIFO_WRITE_DEPTH[2] * TX_PUZZLE_FIFO_W_DATA_WIDTH[2] / TX_PUZZLE_FIFO_R_DATA_WIDTH[2],
-	TX_PUZZLE_FIFO_WRITE_DEPTH[3] * TX_PUZZLE_FIFO_W_DATA_WIDTH[3] / TX_PUZZLE_FIFO_R_DATA_WIDTH[3]
-};
+/*
+ * Per-FIFO parameters derived from the arrays above. Adding a puzzle
+ * FIFO only requires extending those arrays and NTXPUZZLEFIFOS.
+ */
+typedef int tx_puzzle_fifo_param_t [NTXPUZZLEFIFOS];
+
+function automatic tx_puzzle_fifo_param_t tx_puzzle_fifo_read_depth();
+	for (int i = 0; i < NTXPUZZLEFIFOS; i++) begin
+		tx_puzzle_fifo_read_depth[i] = TX_PUZZLE_FIFO_WRITE_DEPTH[i] *
+			TX_PUZZLE_FIFO_W_DATA_WIDTH[i] / TX_PUZZLE_FIFO_R_DATA_WIDTH[i];
+	end
+endfunction
+
+function automatic tx_puzzle_fifo_param_t tx_puzzle_fifo_count_width(input tx_puzzle_fifo_param_t depth);
+	for (int i = 0; i < NTXPUZZLEFIFOS; i++) begin
+		tx_puzzle_fifo_count_width[i] = $clog2(depth[i]) + 1;
+	end
+endfunction
+
+function automatic int tx_puzzle_fifo_max(input tx_puzzle_fifo_param_t a, input tx_puzzle_fifo_param_t b);
+	tx_puzzle_fifo_max = 0;
+	for (int i = 0; i < NTXPUZZLEFIFOS; i++) begin
+		if (a[i] > tx_puzzle_fifo_max)
+			tx_puzzle_fifo_max = a[i];
+		if (b[i] > tx_puzzle_fifo_max)
+			tx_puzzle_fifo_max = b[i];
+	end
+endfunction
+
+localparam tx_puzzle_fifo_param_t TX_PUZZLE_FIFO_READ_DEPTH = tx_puzzle_fifo_read_depth();
+localparam tx_puzzle_fifo_param_t TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH =
+	tx_puzzle_fifo_count_width(TX_PUZZLE_FIFO_READ_DEPTH);
+localparam tx_puzzle_fifo_param_t TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH =
+	tx_puzzle_fifo_count_width(TX_PUZZLE_FIFO_WRITE_DEPTH);
 
-localparam int TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH [NTXPUZZLEFIFOS] = {
-	$clog2(TX_PUZZLE_FIFO_READ_DEPTH[0]) + 1,
-	$clog2(TX_PUZZLE_FIFO_READ_DEPTH[1]) + 1,
-	$clog2(TX_PUZZLE_FIFO_READ_DEPTH[2]) + 1,
-	$clog2(TX_PUZZLE_FIFO_READ_DEPTH[3]) + 1
-};
+/*
+ * The puzzle FIFO interfaces of a core form arrays and therefore share
+ * the largest width. Each FIFO only stores the lower
+ * TX_PUZZLE_FIFO_[RW]_DATA_WIDTH bits.
+ */
+localparam int TX_PUZZLE_FIFO_DATA_WIDTH =
+	tx_puzzle_fifo_max(TX_PUZZLE_FIFO_R_DATA_WIDTH, TX_PUZZLE_FIFO_W_DATA_WIDTH);
+localparam int TX_PUZZLE_FIFO_DATA_COUNT_WIDTH =
+	tx_puzzle_fifo_max(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH, TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH);
 
-localparam int TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH [NTXPUZZLEFIFOS] = {
-	$clog2(TX_PUZZLE_FIFO_WRITE_DEPTH[0]) + 1,
-	$clog2(TX_PUZZLE_FIFO_WRITE_DEPTH[1]) + 1,
-	$clog2(TX_PUZZLE_FIFO_WRITE_DEPTH[2]) + 1,
-	$clog2(TX_PUZZLE_FIFO_WRITE_DEPTH[3]) + 1
-};
+/*
+ * TX worker pool (see prism_sp_processor_pool).
+ */
+`ifdef PRISM_SP_NWORKERS
+localparam int NTXWORKERS = `PRISM_SP_NWORKERS;
+`else
+localparam int NTXWORKERS = 1;
+`endif
+localparam int TX_WORKER_FIFO_R = 0;
+localparam int TX_WORKER_FIFO_W = 1;
+localparam int TX_WORKER_HASH_WORD = -1;
+
+function automatic int tx_cookie_eof_bitn();
+	tx_cookie_t c;
+
+	c = '0;
+	c.eof = 1'b1;
+	for (int i = 0; i < $bits(tx_cookie_t); i++) begin
+		if (c[i])
+			return i;
+	end
+	return -1;
+endfunction
+localparam int TX_COOKIE_EOF_BITN = tx_cookie_eof_bitn();
+
+/*
+ * Per-FIFO parameters of the RX (rx != 0) or the TX puzzle for modules
+ * that are shared by both.
+ */
+function automatic int puzzle_sw_fifo_r_enabled(input int rx, input int n);
+	if (rx)
+		return ENABLE_RX_PUZZLE_SW_FIFO_R[n];
+	return ENABLE_TX_PUZZLE_SW_FIFO_R[n];
+endfunction
+
+function automatic int puzzle_sw_fifo_w_enabled(input int rx, input int n);
+	if (rx)
+		return ENABLE_RX_PUZZLE_SW_FIFO_W[n];
+	return ENABLE_TX_PUZZLE_SW_FIFO_W[n];
+endfunction
+
+function automatic int puzzle_fifo_r_data_width(input int rx, input int n);
+	if (rx)
+		return RX_PUZZLE_FIFO_R_DATA_WIDTH[n];
+	return TX_PUZZLE_FIFO_R_DATA_WIDTH[n];
+endfunction
+
+function automatic int puzzle_fifo_w_data_width(input int rx, input int n);
+	if (rx)
+		return RX_PUZZLE_FIFO_W_DATA_WIDTH[n];
+	return TX_PUZZLE_FIFO_W_DATA_WIDTH[n];
+endfunction
 
 /*
  * Trace structures
@@ -535,39 +1179,15 @@ typedef struct packed {
 	logic rx_enable;
 	logic rx_trigger;
 
-	logic puzzle_fifo_r_0_empty;
-	logic puzzle_fifo_r_0_rd_en;
-	logic [RX_PUZZLE_FIFO_R_DATA_WIDTH[0] - 1:0] puzzle_fifo_r_0_rd_data;
-	logic [RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0] - 1:0] puzzle_fifo_r_0_rd_data_count;
-	logic puzzle_fifo_r_1_empty;
-	logic puzzle_fifo_r_1_rd_en;
-	logic [RX_PUZZLE_FIFO_R_DATA_WIDTH[1] - 1:0] puzzle_fifo_r_1_rd_data;
-	logic [RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1] - 1:0] puzzle_fifo_r_1_rd_data_count;
-	logic puzzle_fifo_r_2_empty;
-	logic puzzle_fifo_r_2_rd_en;
-	logic [RX_PUZZLE_FIFO_R_DATA_WIDTH[2] - 1:0] puzzle_fifo_r_2_rd_data;
-	logic [RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2] - 1:0] puzzle_fifo_r_2_rd_data_count;
-	logic puzzle_fifo_r_3_empty;
-	logic puzzle_fifo_r_3_rd_en;
-	logic [RX_PUZZLE_FIFO_R_DATA_WIDTH[3] - 1:0] puzzle_fifo_r_3_rd_data;
-	logic [RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3] - 1:0] puzzle_fifo_r_3_rd_data_count;
-
-	logic puzzle_fifo_w_0_full;
-	logic puzzle_fifo_w_0_wr_en;
-	logic [RX_PUZZLE_FIFO_W_DATA_WIDTH[0] - 1:0] puzzle_fifo_w_0_wr_data;
-	logic [RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0] - 1:0] puzzle_fifo_w_0_wr_data_count;
-	logic puzzle_fifo_w_1_full;
-	logic puzzle_fifo_w_1_wr_en;
-	logic [RX_PUZZLE_FIFO_W_DATA_WIDTH[1] - 1:0] puzzle_fifo_w_1_wr_data;
-	logic [RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1] - 1:0] puzzle_fifo_w_1_wr_data_count;
-	logic puzzle_fifo_w_2_full;
-	logic puzzle_fifo_w_2_wr_en;
-	logic [RX_PUZZLE_FIFO_W_DATA_WIDTH[2] - 1:0] puzzle_fifo_w_2_wr_data;
-	logic [RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2] - 1:0] puzzle_fifo_w_2_wr_data_count;
-	logic puzzle_fifo_w_3_full;
-	logic puzzle_fifo_w_3_wr_en;
-	logic [RX_PUZZLE_FIFO_W_DATA_WIDTH[3] - 1:0] puzzle_fifo_w_3_wr_data;
-	logic [RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3] - 1:0] puzzle_fifo_w_3_wr_data_count;
+	logic [NRXPUZZLEFIFOS-1:0] puzzle_fifo_r_empty;
+	logic [NRXPUZZLEFIFOS-1:0] puzzle_fifo_r_rd_en;
+	logic [NRXPUZZLEFIFOS-1:0][RX_PUZZLE_FIFO_DATA_WIDTH-1:0] puzzle_fifo_r_rd_data;
+	logic [NRXPUZZLEFIFOS-1:0][RX_PUZZLE_FIFO_DATA_COUNT_WIDTH-1:0] puzzle_fifo_r_rd_data_count;
+
+	logic [NRXPUZZLEFIFOS-1:0] puzzle_fifo_w_full;
+	logic [NRXPUZZLEFIFOS-1:0] puzzle_fifo_w_wr_en;
+	logic [NRXPUZZLEFIFOS-1:0][RX_PUZZLE_FIFO_DATA_WIDTH-1:0] puzzle_fifo_w_wr_data;
+	logic [NRXPUZZLEFIFOS-1:0][RX_PUZZLE_FIFO_DATA_COUNT_WIDTH-1:0] puzzle_fifo_w_wr_data_count;
 } trace_rx_puzzle_t;
 
 typedef struct packed {
@@ -619,49 +1239,33 @@ typedef struct packed {
 	logic tx_enable;
 	logic tx_trigger;
 
-	logic puzzle_fifo_r_0_empty;
-	logic puzzle_fifo_r_0_rd_en;
-	logic [TX_PUZZLE_FIFO_R_DATA_WIDTH[0] - 1:0] puzzle_fifo_r_0_rd_data;
-	logic [TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0] - 1:0] puzzle_fifo_r_0_rd_data_count;
-	logic puzzle_fifo_r_1_empty;
-	logic puzzle_fifo_r_1_rd_en;
-	logic [TX_PUZZLE_FIFO_R_DATA_WIDTH[1] - 1:0] puzzle_fifo_r_1_rd_data;
-	logic [TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1] - 1:0] puzzle_fifo_r_1_rd_data_count;
-	logic puzzle_fifo_r_2_empty;
-	logic puzzle_fifo_r_2_rd_en;
-	logic [TX_PUZZLE_FIFO_R_DATA_WIDTH[2] - 1:0] puzzle_fifo_r_2_rd_data;
-	logic [TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2] - 1:0] puzzle_fifo_r_2_rd_data_count;
-	logic puzzle_fifo_r_3_empty;
-	logic puzzle_fifo_r_3_rd_en;
-	logic [TX_PUZZLE_FIFO_R_DATA_WIDTH[3] - 1:0] puzzle_fifo_r_3_rd_data;
-	logic [TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3] - 1:0] puzzle_fifo_r_3_rd_data_count;
-
-	logic puzzle_fifo_w_0_full;
-	logic puzzle_fifo_w_0_wr_en;
-	logic [TX_PUZZLE_FIFO_W_DATA_WIDTH[0] - 1:0] puzzle_fifo_w_0_wr_data;
-	logic [TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0] - 1:0] puzzle_fifo_w_0_wr_data_count;
-	logic puzzle_fifo_w_1_full;
-	logic puzzle_fifo_w_1_wr_en;
-	logic [TX_PUZZLE_FIFO_W_DATA_WIDTH[1] - 1:0] puzzle_fifo_w_1_wr_data;
-	logic [TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1] - 1:0] puzzle_fifo_w_1_wr_data_count;
-	logic puzzle_fifo_w_2_full;
-	logic puzzle_fifo_w_2_wr_en;
-	logic [TX_PUZZLE_FIFO_W_DATA_WIDTH[2] - 1:0] puzzle_fifo_w_2_wr_data;
-	logic [TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2] - 1:0] puzzle_fifo_w_2_wr_data_count;
-	logic puzzle_fifo_w_3_full;
-	logic puzzle_fifo_w_3_wr_en;
-	logic [TX_PUZZLE_FIFO_W_DATA_WIDTH[3] - 1:0] puzzle_fifo_w_3_wr_data;
-	logic [TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3] - 1:0] puzzle_fifo_w_3_wr_data_count;
+	logic [NTXPUZZLEFIFOS-1:0] puzzle_fifo_r_empty;
+	logic [NTXPUZZLEFIFOS-1:0] puzzle_fifo_r_rd_en;
+	logic [NTXPUZZLEFIFOS-1:0][TX_PUZZLE_FIFO_DATA_WIDTH-1:0] puzzle_fifo_r_rd_data;
+	logic [NTXPUZZLEFIFOS-1:0][TX_PUZZLE_FIFO_DATA_COUNT_WIDTH-1:0] puzzle_fifo_r_rd_data_count;
+
+	logic [NTXPUZZLEFIFOS-1:0] puzzle_fifo_w_full;
+	logic [NTXPUZZLEFIFOS-1:0] puzzle_fifo_w_wr_en;
+	logic [NTXPUZZLEFIFOS-1:0][TX_PUZZLE_FIFO_DATA_WIDTH-1:0] puzzle_fifo_w_wr_data;
+	logic [NTXPUZZLEFIFOS-1:0][TX_PUZZLE_FIFO_DATA_COUNT_WIDTH-1:0] puzzle_fifo_w_wr_data_count;
 } trace_tx_puzzle_t;
 
+/*
+ * The TX DMA data path (axi_to_fifo and the byte data stuffer) is at most
+ * as wide as the TX data FIFO. Narrower data paths leave the upper bits
+ * of the trace signals zero.
+ */
+localparam int TRACE_ATF_DATA_WIDTH = TX_DATA_FIFO_WIDTH;
+localparam int TRACE_ATF_OFFSET_WIDTH = $clog2(TRACE_ATF_DATA_WIDTH/8);
+
 typedef struct packed {
 	logic stuffer_first;
 	logic stuffer_i_valid;
 	logic stuffer_i_sof;
 	logic stuffer_i_eof;
-	logic [3:0] stuffer_i_lsbyte;
-	logic [3:0] stuffer_i_msbyte;
-	logic [127:0] stuffer_i_data;
+	logic [TRACE_ATF_OFFSET_WIDTH-1:0] stuffer_i_lsbyte;
+	logic [TRACE_ATF_OFFSET_WIDTH-1:0] stuffer_i_msbyte;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stuffer_i_data;
 
 	logic axi_calc_i_valid;
 	logic [127:0] axi_calc_i_address;
@@ -672,7 +1276,7 @@ typedef struct packed {
 	logic [7:0] axi_calc_o_axlen;
 
 	logic stuffer_o_valid;
-	logic [127:0] stuffer_o_data;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stuffer_o_data;
 
 	logic [15:0] mem_r_len_plus_off;
 
@@ -685,37 +1289,37 @@ typedef struct packed {
 	logic [15:0] total_bursts;
 
 	logic [7:0] last_burst_beats;
-	logic [3:0] last_beat_bytes;
+	logic [TRACE_ATF_OFFSET_WIDTH-1:0] last_beat_bytes;
 } trace_atf_t;
 
 typedef struct packed {
 	logic poisoned;
-	logic [127:0] stage0_data_shr_comb;
-	logic [15:0] stage0_bytemask_comb;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stage0_data_shr_comb;
+	logic [TRACE_ATF_DATA_WIDTH/8-1:0] stage0_bytemask_comb;
 
 	logic stage1_valid_ff;
-	logic [127:0] stage1_data_ff;
-	logic [3:0] stage1_size_ff;
-	logic [15:0] stage1_bytemask_ff;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stage1_data_ff;
+	logic [TRACE_ATF_OFFSET_WIDTH-1:0] stage1_size_ff;
+	logic [TRACE_ATF_DATA_WIDTH/8-1:0] stage1_bytemask_ff;
 	logic stage1_sof_ff;
 	logic stage1_eof_ff;
-	logic [127:0] stage1_bitmask_comb;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stage1_bitmask_comb;
 
 	logic stage2_valid_ff;
-	logic [127:0] stage2_data_ff;
-	logic [4:0] stage2_size_ff;
+	logic [TRACE_ATF_DATA_WIDTH-1:0] stage2_data_ff;
+	logic [TRACE_ATF_OFFSET_WIDTH:0] stage2_size_ff;
 	logic stage2_sof_ff;
 	logic stage2_eof_ff;
-	logic [128*2-8-1:0] stage2_data_shl_comb;
+	logic [TRACE_ATF_DATA_WIDTH*2-8-1:0] stage2_data_shl_comb;
 
 	logic stage3_valid_ff;
 	logic stage3_sof_ff;
 	logic stage3_sof_comb;
 	logic stage3_eof_ff;
-	logic [128*2-8-1:0] stage3_data_ff;
-	logic [128*2-8-1:0] stage3_data_comb;
-	logic [4:0] stage3_size_ff;
-	logic [4:0] stage3_size_comb;
+	logic [TRACE_ATF_DATA_WIDTH*2-8-1:0] stage3_data_ff;
+	logic [TRACE_ATF_DATA_WIDTH*2-8-1:0] stage3_data_comb;
+	logic [TRACE_ATF_OFFSET_WIDTH:0] stage3_size_ff;
+	logic [TRACE_ATF_OFFSET_WIDTH:0] stage3_size_comb;
 } trace_atf_bds_t;
 
 localparam SP_CSUM_IP_SUM_WIDTH = 5+16;
@@ -40,7 +40,7 @@ module prism_sp_duo_wrapper #(
 	parameter int NTXCORES = 1,
 	parameter int IBRAM_SIZE = 2**15,
 	parameter int DBRAM_SIZE = 2**15,
-	parameter int ACPBRAM_SIZE = 2*64*8,
+	parameter int ACPBRAM_SIZE = 4096*8,
 
 	parameter int C_S_AXIL_ADDR_WIDTH = 32,
 	parameter int C_S_AXIL_DATA_WIDTH = 32,
@@ -71,7 +71,11 @@ module prism_sp_duo_wrapper #(
 
 	parameter int C_M_AXI_DMA_ID_WIDTH = 6,
 	parameter int C_M_AXI_DMA_ADDR_WIDTH = 40,
-	parameter int C_M_AXI_DMA_DATA_WIDTH = 32
+	parameter int C_M_AXI_DMA_DATA_WIDTH = 32,
+
+	parameter int C_M_AXI_SPILL_ID_WIDTH = 6,
+	parameter int C_M_AXI_SPILL_ADDR_WIDTH = 40,
+	parameter int C_M_AXI_SPILL_DATA_WIDTH = 128
 )
 (
 	input wire clock,
@@ -714,6 +718,49 @@ module prism_sp_duo_wrapper #(
 	input wire m_axi_dma_0_bvalid,
 	output wire m_axi_dma_0_bready,
 
+	/*
+	 * RX spill buffer
+	 */
+	output wire [C_M_AXI_SPILL_ID_WIDTH-1:0] m_axi_spill_0_arid,
+	output wire [C_M_AXI_SPILL_ADDR_WIDTH-1:0] m_axi_spill_0_araddr,
+	output wire [7:0] m_axi_spill_0_arlen,
+	output wire [2:0] m_axi_spill_0_arsize,
+	output wire [1:0] m_axi_spill_0_arburst,
+	output wire m_axi_spill_0_arlock,
+	output wire [3:0] m_axi_spill_0_arcache,
+	output wire [2:0] m_axi_spill_0_arprot,
+	output wire m_axi_spill_0_arvalid,
+	input wire m_axi_spill_0_arready,
+
+	input wire [C_M_AXI_SPILL_ID_WIDTH-1:0] m_axi_spill_0_rid,
+	input wire [C_M_AXI_SPILL_DATA_WIDTH-1:0] m_axi_spill_0_rdata,
+	input wire [1:0] m_axi_spill_0_rresp,
+	input wire m_axi_spill_0_rlast,
+	input wire m_axi_spill_0_rvalid,
+	output wire m_axi_spill_0_rready,
+
+	output wire [C_M_AXI_SPILL_ID_WIDTH-1:0] m_axi_spill_0_awid,
+	output wire [C_M_AXI_SPILL_ADDR_WIDTH-1:0] m_axi_spill_0_awaddr,
+	output wire [7:0] m_axi_spill_0_awlen,
+	output wire [2:0] m_axi_spill_0_awsize,
+	output wire [1:0] m_axi_spill_0_awburst,
+	output wire m_axi_spill_0_awlock,
+	output wire [3:0] m_axi_spill_0_awcache,
+	output wire [2:0] m_axi_spill_0_awprot,
+	output wire m_axi_spill_0_awvalid,
+	input wire m_axi_spill_0_awready,
+
+	output wire [C_M_AXI_SPILL_DATA_WIDTH-1:0] m_axi_spill_0_wdata,
+	output wire [(C_M_AXI_SPILL_DATA_WIDTH/8)-1:0] m_axi_spill_0_wstrb,
+	output wire m_axi_spill_0_wlast,
+	output wire m_axi_spill_0_wvalid,
+	input wire m_axi_spill_0_wready,
+
+	input wire [C_M_AXI_SPILL_ID_WIDTH-1:0] m_axi_spill_0_bid,
+	input wire [1:0] m_axi_spill_0_bresp,
+	input wire m_axi_spill_0_bvalid,
+	output wire m_axi_spill_0_bready,
+
 	/*
 	 * GEM Interface
 	 */
@@ -1027,16 +1074,25 @@ module prism_sp_duo_wrapper #(
  * (Vivado IP integrator seems to be unable to use constants defined
  *  in a package for the top-level signals).
  */
-if (C_M_AXI_DMA_DATA_WIDTH != RX_DATA_FIFO_WIDTH) begin
-	$fatal("C_M_AXI_DMA_DATA_WIDTH (%d) and RX_DATA_FIFO_WIDTH (%d) differ.\n",
+/*
+ * The data FIFOs may be wider than the DMA data bus.
+ * The cores convert between both widths.
+ */
+if (C_M_AXI_DMA_DATA_WIDTH > RX_DATA_FIFO_WIDTH || RX_DATA_FIFO_WIDTH % C_M_AXI_DMA_DATA_WIDTH != 0) begin
+	$fatal("C_M_AXI_DMA_DATA_WIDTH (%d) does not divide RX_DATA_FIFO_WIDTH (%d).\n",
 		C_M_AXI_DMA_DATA_WIDTH, RX_DATA_FIFO_WIDTH);
 end
 
-if (C_M_AXI_DMA_DATA_WIDTH != TX_DATA_FIFO_WIDTH) begin
-	$fatal("C_M_AXI_DMA_DATA_WIDTH (%d) and TX_DATA_FIFO_WIDTH (%d) differ.\n",
+if (C_M_AXI_DMA_DATA_WIDTH > TX_DATA_FIFO_WIDTH || TX_DATA_FIFO_WIDTH % C_M_AXI_DMA_DATA_WIDTH != 0) begin
+	$fatal("C_M_AXI_DMA_DATA_WIDTH (%d) does not divide TX_DATA_FIFO_WIDTH (%d).\n",
 		C_M_AXI_DMA_DATA_WIDTH, TX_DATA_FIFO_WIDTH);
 end
 
+// See prism_sp_config.
+if (RX_DATA_FIFO_WIDTH != 128 || TX_DATA_FIFO_WIDTH != 128) begin
+	$warning("Data FIFO widths other than 128 bits have not been verified.\n");
+end
+
 localparam int NCORES = NRXCORES + NTXCORES;
 
 localparam int IBRAM_WIDTH = 32;
@@ -1768,6 +1824,69 @@ assign m_axi_dma_r[0].rlast =	m_axi_dma_0_rlast;
 assign m_axi_dma_r[0].rvalid =	m_axi_dma_0_rvalid;
 assign m_axi_dma_0_rready =		m_axi_dma_r[0].rready;
 
+/*
+ * AXI RX spill buffer
+ */
+axi_write_address_channel #(
+	.AXI_AWID_WIDTH(C_M_AXI_SPILL_ID_WIDTH),
+	.AXI_AWADDR_WIDTH(C_M_AXI_SPILL_ADDR_WIDTH)
+) m_axi_spill_aw[NRXCORES]();
+axi_write_channel #(
+	.AXI_WDATA_WIDTH(C_M_AXI_SPILL_DATA_WIDTH)
+) m_axi_spill_w[NRXCORES]();
+axi_write_response_channel #(
+	.AXI_BID_WIDTH(C_M_AXI_SPILL_ID_WIDTH)
+) m_axi_spill_b[NRXCORES]();
+axi_read_address_channel #(
+	.AXI_ARID_WIDTH(C_M_AXI_SPILL_ID_WIDTH),
+	.AXI_ARADDR_WIDTH(C_M_AXI_SPILL_ADDR_WIDTH)
+) m_axi_spill_ar[NRXCORES]();
+axi_read_channel #(
+	.AXI_RID_WIDTH(C_M_AXI_SPILL_ID_WIDTH),
+	.AXI_RDATA_WIDTH(C_M_AXI_SPILL_DATA_WIDTH)
+) m_axi_spill_r[NRXCORES]();
+
+// AW
+assign m_axi_spill_0_awid =		m_axi_spill_aw[0].awid;
+assign m_axi_spill_0_awaddr =	m_axi_spill_aw[0].awaddr;
+assign m_axi_spill_0_awlen =	m_axi_spill_aw[0].awlen;
+assign m_axi_spill_0_awsize =	m_axi_spill_aw[0].awsize;
+assign m_axi_spill_0_awburst =	m_axi_spill_aw[0].awburst;
+assign m_axi_spill_0_awlock =	m_axi_spill_aw[0].awlock;
+assign m_axi_spill_0_awcache =	m_axi_spill_aw[0].awcache;
+assign m_axi_spill_0_awprot =	m_axi_spill_aw[0].awprot;
+assign m_axi_spill_0_awvalid =	m_axi_spill_aw[0].awvalid;
+assign m_axi_spill_aw[0].awready = m_axi_spill_0_awready;
+// W
+assign m_axi_spill_0_wdata =	m_axi_spill_w[0].wdata;
+assign m_axi_spill_0_wstrb =	m_axi_spill_w[0].wstrb;
+assign m_axi_spill_0_wlast =	m_axi_spill_w[0].wlast;
+assign m_axi_spill_0_wvalid =	m_axi_spill_w[0].wvalid;
+assign m_axi_spill_w[0].wready = m_axi_spill_0_wready;
+// B
+assign m_axi_spill_b[0].bid =	m_axi_spill_0_bid;
+assign m_axi_spill_b[0].bresp =	m_axi_spill_0_bresp;
+assign m_axi_spill_b[0].bvalid = m_axi_spill_0_bvalid;
+assign m_axi_spill_0_bready =	m_axi_spill_b[0].bready;
+// AR
+assign m_axi_spill_0_arid =		m_axi_spill_ar[0].arid;
+assign m_axi_spill_0_araddr =	m_axi_spill_ar[0].araddr;
+assign m_axi_spill_0_arlen =	m_axi_spill_ar[0].arlen;
+assign m_axi_spill_0_arsize =	m_axi_spill_ar[0].arsize;
+assign m_axi_spill_0_arburst =	m_axi_spill_ar[0].arburst;
+assign m_axi_spill_0_arlock =	m_axi_spill_ar[0].arlock;
+assign m_axi_spill_0_arcache =	m_axi_spill_ar[0].arcache;
+assign m_axi_spill_0_arprot =	m_axi_spill_ar[0].arprot;
+assign m_axi_spill_0_arvalid =	m_axi_spill_ar[0].arvalid;
+assign m_axi_spill_ar[0].arready = m_axi_spill_0_arready;
+// R
+assign m_axi_spill_r[0].rid =	m_axi_spill_0_rid;
+assign m_axi_spill_r[0].rdata =	m_axi_spill_0_rdata;
+assign m_axi_spill_r[0].rresp =	m_axi_spill_0_rresp;
+assign m_axi_spill_r[0].rlast =	m_axi_spill_0_rlast;
+assign m_axi_spill_r[0].rvalid = m_axi_spill_0_rvalid;
+assign m_axi_spill_0_rready =	m_axi_spill_r[0].rready;
+
 /*
  * GEM
  */
@@ -1801,6 +1920,13 @@ assign gem_rx.rx_w_err = gem_rx_w_err;
 assign gem_rx_w_overflow = gem_rx.rx_w_overflow;
 assign gem_rx.rx_w_flush = gem_rx_w_flush;
 
+// Time base of the traffic generator (GEM RX clock domain)
+wire logic [31:0] tgen_now;
+// PAUSE frames requested by the RX admission control
+wire logic [7:0] pause_xoff;
+wire logic [31:0] pause_control;
+wire logic [47:0] pause_sa;
+
 wire logic rx_control_irq;
 wire logic tx_control_irq;
 assign control_irq = rx_control_irq | tx_control_irq;
@@ -1895,39 +2021,39 @@ localparam int TRACE_RX__RX_PUZZLE_IDX = 0;
 assign trace_rx__rxenable =								trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].rx_enable;
 assign trace_rx__rxtrigger =							trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].rx_trigger;
 
-assign trace_rx__rx_puzzle_fifo_r_0_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_0_empty;
-assign trace_rx__rx_puzzle_fifo_r_0_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_0_rd_en;
-assign trace_rx__rx_puzzle_fifo_r_0_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_0_rd_data;
-assign trace_rx__rx_puzzle_fifo_r_0_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_0_rd_data_count;
-assign trace_rx__rx_puzzle_fifo_r_1_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_1_empty;
-assign trace_rx__rx_puzzle_fifo_r_1_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_1_rd_en;
-assign trace_rx__rx_puzzle_fifo_r_1_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_1_rd_data;
-assign trace_rx__rx_puzzle_fifo_r_1_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_1_rd_data_count;
-assign trace_rx__rx_puzzle_fifo_r_2_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_2_empty;
-assign trace_rx__rx_puzzle_fifo_r_2_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_2_rd_en;
-assign trace_rx__rx_puzzle_fifo_r_2_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_2_rd_data;
-assign trace_rx__rx_puzzle_fifo_r_2_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_2_rd_data_count;
-assign trace_rx__rx_puzzle_fifo_r_3_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_3_empty;
-assign trace_rx__rx_puzzle_fifo_r_3_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_3_rd_en;
-assign trace_rx__rx_puzzle_fifo_r_3_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_3_rd_data;
-assign trace_rx__rx_puzzle_fifo_r_3_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_3_rd_data_count;
-
-assign trace_rx__rx_puzzle_fifo_w_0_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_0_full;
-assign trace_rx__rx_puzzle_fifo_w_0_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_0_wr_en;
-assign trace_rx__rx_puzzle_fifo_w_0_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_0_wr_data;
-assign trace_rx__rx_puzzle_fifo_w_0_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_0_wr_data_count;
-assign trace_rx__rx_puzzle_fifo_w_1_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_1_full;
-assign trace_rx__rx_puzzle_fifo_w_1_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_1_wr_data;
-assign trace_rx__rx_puzzle_fifo_w_1_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_1_wr_en;
-assign trace_rx__rx_puzzle_fifo_w_1_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_1_wr_data_count;
-assign trace_rx__rx_puzzle_fifo_w_2_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_2_full;
-assign trace_rx__rx_puzzle_fifo_w_2_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_2_wr_en;
-assign trace_rx__rx_puzzle_fifo_w_2_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_2_wr_data;
-assign trace_rx__rx_puzzle_fifo_w_2_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_2_wr_data_count;
-assign trace_rx__rx_puzzle_fifo_w_3_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_3_full;
-assign trace_rx__rx_puzzle_fifo_w_3_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_3_wr_en;
-assign trace_rx__rx_puzzle_fifo_w_3_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_3_wr_data;
-assign trace_rx__rx_puzzle_fifo_w_3_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_3_wr_data_count;
+assign trace_rx__rx_puzzle_fifo_r_0_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_empty[0];
+assign trace_rx__rx_puzzle_fifo_r_0_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_en[0];
+assign trace_rx__rx_puzzle_fifo_r_0_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data[0];
+assign trace_rx__rx_puzzle_fifo_r_0_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[0];
+assign trace_rx__rx_puzzle_fifo_r_1_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_empty[1];
+assign trace_rx__rx_puzzle_fifo_r_1_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_en[1];
+assign trace_rx__rx_puzzle_fifo_r_1_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data[1];
+assign trace_rx__rx_puzzle_fifo_r_1_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[1];
+assign trace_rx__rx_puzzle_fifo_r_2_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_empty[2];
+assign trace_rx__rx_puzzle_fifo_r_2_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_en[2];
+assign trace_rx__rx_puzzle_fifo_r_2_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data[2];
+assign trace_rx__rx_puzzle_fifo_r_2_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[2];
+assign trace_rx__rx_puzzle_fifo_r_3_empty =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_empty[3];
+assign trace_rx__rx_puzzle_fifo_r_3_rd_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_en[3];
+assign trace_rx__rx_puzzle_fifo_r_3_rd_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data[3];
+assign trace_rx__rx_puzzle_fifo_r_3_rd_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[3];
+
+assign trace_rx__rx_puzzle_fifo_w_0_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_full[0];
+assign trace_rx__rx_puzzle_fifo_w_0_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_en[0];
+assign trace_rx__rx_puzzle_fifo_w_0_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data[0];
+assign trace_rx__rx_puzzle_fifo_w_0_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[0];
+assign trace_rx__rx_puzzle_fifo_w_1_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_full[1];
+assign trace_rx__rx_puzzle_fifo_w_1_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data[1];
+assign trace_rx__rx_puzzle_fifo_w_1_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_en[1];
+assign trace_rx__rx_puzzle_fifo_w_1_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[1];
+assign trace_rx__rx_puzzle_fifo_w_2_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_full[2];
+assign trace_rx__rx_puzzle_fifo_w_2_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_en[2];
+assign trace_rx__rx_puzzle_fifo_w_2_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data[2];
+assign trace_rx__rx_puzzle_fifo_w_2_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[2];
+assign trace_rx__rx_puzzle_fifo_w_3_full =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_full[3];
+assign trace_rx__rx_puzzle_fifo_w_3_wr_en =				trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_en[3];
+assign trace_rx__rx_puzzle_fifo_w_3_wr_data =			trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data[3];
+assign trace_rx__rx_puzzle_fifo_w_3_wr_data_count =		trace_rx__rx_puzzle[TRACE_RX__RX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[3];
 `endif
 
 `ifdef ENABLE_TRACE_RX__RX_FIFO
@@ -1999,39 +2125,39 @@ localparam int TRACE_TX__TX_PUZZLE_IDX = 0;
 assign trace_tx__txenable =								trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].tx_enable;
 assign trace_tx__txtrigger =							trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].tx_trigger;
 
-assign trace_tx__tx_puzzle_fifo_r_0_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_0_empty;
-assign trace_tx__tx_puzzle_fifo_r_0_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_0_rd_en;
-assign trace_tx__tx_puzzle_fifo_r_0_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_0_rd_data;
-assign trace_tx__tx_puzzle_fifo_r_0_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_0_rd_data_count;
-assign trace_tx__tx_puzzle_fifo_r_1_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_1_empty;
-assign trace_tx__tx_puzzle_fifo_r_1_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_1_rd_en;
-assign trace_tx__tx_puzzle_fifo_r_1_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_1_rd_data;
-assign trace_tx__tx_puzzle_fifo_r_1_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_1_rd_data_count;
-assign trace_tx__tx_puzzle_fifo_r_2_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_2_empty;
-assign trace_tx__tx_puzzle_fifo_r_2_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_2_rd_en;
-assign trace_tx__tx_puzzle_fifo_r_2_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_2_rd_data;
-assign trace_tx__tx_puzzle_fifo_r_2_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_2_rd_data_count;
-assign trace_tx__tx_puzzle_fifo_r_3_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_3_empty;
-assign trace_tx__tx_puzzle_fifo_r_3_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_3_rd_en;
-assign trace_tx__tx_puzzle_fifo_r_3_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_3_rd_data;
-assign trace_tx__tx_puzzle_fifo_r_3_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_3_rd_data_count;
-
-assign trace_tx__tx_puzzle_fifo_w_0_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_0_full;
-assign trace_tx__tx_puzzle_fifo_w_0_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_0_wr_en;
-assign trace_tx__tx_puzzle_fifo_w_0_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_0_wr_data;
-assign trace_tx__tx_puzzle_fifo_w_0_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_0_wr_data_count;
-assign trace_tx__tx_puzzle_fifo_w_1_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_1_full;
-assign trace_tx__tx_puzzle_fifo_w_1_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_1_wr_data;
-assign trace_tx__tx_puzzle_fifo_w_1_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_1_wr_en;
-assign trace_tx__tx_puzzle_fifo_w_1_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_1_wr_data_count;
-assign trace_tx__tx_puzzle_fifo_w_2_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_2_full;
-assign trace_tx__tx_puzzle_fifo_w_2_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_2_wr_en;
-assign trace_tx__tx_puzzle_fifo_w_2_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_2_wr_data;
-assign trace_tx__tx_puzzle_fifo_w_2_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_2_wr_data_count;
-assign trace_tx__tx_puzzle_fifo_w_3_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_3_full;
-assign trace_tx__tx_puzzle_fifo_w_3_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_3_wr_en;
-assign trace_tx__tx_puzzle_fifo_w_3_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_3_wr_data;
-assign trace_tx__tx_puzzle_fifo_w_3_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_3_wr_data_count;
+assign trace_tx__tx_puzzle_fifo_r_0_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_empty[0];
+assign trace_tx__tx_puzzle_fifo_r_0_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_en[0];
+assign trace_tx__tx_puzzle_fifo_r_0_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data[0];
+assign trace_tx__tx_puzzle_fifo_r_0_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[0];
+assign trace_tx__tx_puzzle_fifo_r_1_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_empty[1];
+assign trace_tx__tx_puzzle_fifo_r_1_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_en[1];
+assign trace_tx__tx_puzzle_fifo_r_1_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data[1];
+assign trace_tx__tx_puzzle_fifo_r_1_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[1];
+assign trace_tx__tx_puzzle_fifo_r_2_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_empty[2];
+assign trace_tx__tx_puzzle_fifo_r_2_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_en[2];
+assign trace_tx__tx_puzzle_fifo_r_2_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data[2];
+assign trace_tx__tx_puzzle_fifo_r_2_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[2];
+assign trace_tx__tx_puzzle_fifo_r_3_empty =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_empty[3];
+assign trace_tx__tx_puzzle_fifo_r_3_rd_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_en[3];
+assign trace_tx__tx_puzzle_fifo_r_3_rd_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data[3];
+assign trace_tx__tx_puzzle_fifo_r_3_rd_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_r_rd_data_count[3];
+
+assign trace_tx__tx_puzzle_fifo_w_0_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_full[0];
+assign trace_tx__tx_puzzle_fifo_w_0_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_en[0];
+assign trace_tx__tx_puzzle_fifo_w_0_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data[0];
+assign trace_tx__tx_puzzle_fifo_w_0_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[0];
+assign trace_tx__tx_puzzle_fifo_w_1_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_full[1];
+assign trace_tx__tx_puzzle_fifo_w_1_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data[1];
+assign trace_tx__tx_puzzle_fifo_w_1_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_en[1];
+assign trace_tx__tx_puzzle_fifo_w_1_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[1];
+assign trace_tx__tx_puzzle_fifo_w_2_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_full[2];
+assign trace_tx__tx_puzzle_fifo_w_2_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_en[2];
+assign trace_tx__tx_puzzle_fifo_w_2_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data[2];
+assign trace_tx__tx_puzzle_fifo_w_2_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[2];
+assign trace_tx__tx_puzzle_fifo_w_3_full =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_full[3];
+assign trace_tx__tx_puzzle_fifo_w_3_wr_en =				trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_en[3];
+assign trace_tx__tx_puzzle_fifo_w_3_wr_data =			trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data[3];
+assign trace_tx__tx_puzzle_fifo_w_3_wr_data_count =		trace_tx__tx_puzzle[TRACE_TX__TX_PUZZLE_IDX].puzzle_fifo_w_wr_data_count[3];
 `endif
 
 `ifdef ENABLE_TRACE_TX__CSUM
@@ -2109,7 +2235,7 @@ prism_sp_rx_top #(
 	.DBRAM_SIZE(DBRAM_SIZE),
 	.ACPBRAM_SIZE(ACPBRAM_SIZE),
 	.RX_DATA_FIFO_SIZE(RX_DATA_FIFO_SIZE),
-	.RX_DATA_FIFO_WIDTH(C_M_AXI_DMA_DATA_WIDTH),
+	.RX_DATA_FIFO_WIDTH(RX_DATA_FIFO_WIDTH),
 	.NRXCORES(NRXCORES)
 ) prism_sp_rx_top_0 (
 	.clock(clock),
@@ -2159,8 +2285,17 @@ prism_sp_rx_top #(
 	.m_axi_dma_aw,
 	.m_axi_dma_w,
 	.m_axi_dma_b,
+	.m_axi_spill_aw,
+	.m_axi_spill_w,
+	.m_axi_spill_b,
+	.m_axi_spill_ar,
+	.m_axi_spill_r,
 
 	.gem_rx,
+	.tgen_now,
+	.pause_xoff,
+	.pause_control,
+	.pause_sa,
 
 	.trace_proc(trace_rx__proc),
 	.trace_sp_unit(trace_rx__sp_unit),
@@ -2174,7 +2309,7 @@ prism_sp_tx_top #(
 	.DBRAM_SIZE(DBRAM_SIZE),
 	.ACPBRAM_SIZE(ACPBRAM_SIZE),
 	.TX_DATA_FIFO_SIZE(TX_DATA_FIFO_SIZE),
-	.TX_DATA_FIFO_WIDTH(C_M_AXI_DMA_DATA_WIDTH),
+	.TX_DATA_FIFO_WIDTH(TX_DATA_FIFO_WIDTH),
 	.NTXCORES(NTXCORES)
 ) prism_sp_tx_top_0 (
 	.clock(clock),
@@ -2225,6 +2360,11 @@ prism_sp_tx_top #(
 	.m_axi_dma_r,
 
 	.gem_tx,
+	.tgen_clock(gem_rx_clock),
+	.tgen_now,
+	.pause_xoff,
+	.pause_control,
+	.pause_sa,
 
 	.trace_proc(trace_tx__proc),
 	.trace_sp_unit(trace_tx__sp_unit),
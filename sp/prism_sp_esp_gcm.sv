@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Inline AES-GCM for IPsec ESP (RFC 4106) on a byte stream.
+ *
+ * The module sees two views of the frames:
+ * - the h stream is the frame as it is on the wire (i.e., with the
+ *   ciphertext). It is parsed, authenticated and used to look up the SA.
+ * - the c stream is the frame that is transformed: c_out is c_data with
+ *   the payload encrypted (ENCRYPT) or decrypted (!ENCRYPT).
+ * For TX, both are the same stream, where h_data is c_out. For RX, the
+ *   c stream is the h stream delayed by ESP_RX_DELAY clock cycles (see
+ *   prism_sp_rx_esp), which leaves enough time to compute the first
+ *   key stream block after the IV has been received.
+ *
+ * The SA table is written through sa_key, sa_salt, sa_spi and
+ * sa_control (see REGOFF_ESP_SA_CONTROL). Every toggle of sa_control[31]
+ * commits the other inputs to SA sa_control[ESP_SA_WIDTH-1:0]. The SA
+ * becomes valid when its hash key has been computed. A commit also resets
+ * the IV counter of the SA; an SA must only be committed with a new key.
+ *
+ * TX frames select their SA with tx_sa ([ESP_SA_WIDTH] enable). The IV
+ * is inserted by the hardware from the counter of the SA. RX frames are
+ * matched by their SPI. Frames that are not ESP in IPv4 (see
+ * USE_ESP_GCM) pass unmodified.
+ *
+ * One AES core computes the hash keys, the encrypted pre-counter blocks
+ * and the key stream (one block per 16 bytes). One GHASH multiplier
+ * processes a 16-byte block per clock cycle.
+ */
+module prism_sp_esp_gcm #(
+	parameter int ENCRYPT
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [127:0] sa_key,
+	input wire logic [31:0] sa_salt,
+	input wire logic [31:0] sa_spi,
+	input wire logic [31:0] sa_control,
+
+	// TX: SA of the current frame, valid at h_sof
+	input wire logic [ESP_SA_WIDTH:0] tx_sa,
+
+	input wire logic h_valid,
+	input wire logic h_sof,
+	input wire logic [7:0] h_data,
+
+	input wire logic c_valid,
+	input wire logic c_sof,
+	input wire logic [7:0] c_data,
+	output var logic [7:0] c_out,
+
+	// RX: the c stream frame has been decrypted / its ICV did not match
+	output var logic esp,
+	output var logic auth_err
+);
+
+localparam int OFF_WIDTH = 14;
+
+typedef enum logic [1:0] {
+	JOB_H,
+	JOB_EJ0,
+	JOB_KS
+} job_t;
+
+typedef enum logic [1:0] {
+	MUL_NONE,
+	MUL_BLOCK,
+	MUL_LH,
+	MUL_H2
+} mul_t;
+
+function automatic logic [127:0] gf_mul(input logic [127:0] x, input logic [127:0] y);
+	logic [127:0] z;
+	logic [127:0] v;
+
+	z = '0;
+	v = y;
+	for (int i = 0; i < 128; i++) begin
+		if (x[127-i]) begin
+			z = z ^ v;
+		end
+		v = v[0] ? (v >> 1) ^ { 8'he1, 120'h0 } : v >> 1;
+	end
+	return z;
+endfunction
+
+/*
+ * SA table
+ */
+var logic [127:0] tab_key [ESP_NSAS];
+var logic [31:0] tab_salt [ESP_NSAS];
+var logic [31:0] tab_spi [ESP_NSAS];
+var logic [63:0] tab_iv [ESP_NSAS];
+var logic [127:0] tab_h [ESP_NSAS];
+var logic [127:0] tab_h2 [ESP_NSAS];
+var logic [ESP_NSAS-1:0] tab_valid;
+
+var logic [2:0] commit_sync;
+// The SA whose hash keys are computed
+var logic [ESP_SA_WIDTH-1:0] hk_idx;
+var logic hk_valid;
+var logic h_pending;
+var logic h2_pending;
+
+/*
+ * State of the current frame of the h stream
+ */
+var logic [OFF_WIDTH-1:0] h_cnt;
+wire logic [OFF_WIDTH-1:0] h_off = h_sof ? '0 : h_cnt;
+var logic epoch;
+var logic [15:0] f_ethertype;
+var logic [7:0] f_vihl;
+var logic [15:0] f_ip_len;
+var logic [7:0] f_proto;
+var logic [31:0] f_spi;
+var logic [63:0] f_iv;
+var logic [ESP_SA_WIDTH-1:0] f_idx;
+var logic [ESP_SA_WIDTH:0] f_tx_sa;
+var logic f_len_ok;
+var logic f_decided;
+var logic f_act;
+var logic f_iv_known;
+var logic [OFF_WIDTH-1:0] f_enc_end;
+var logic [OFF_WIDTH-1:0] f_clen;
+var logic [OFF_WIDTH-1:0] f_nks;
+var logic f_err;
+var logic f_chk_pending;
+
+var logic [127:0] y;
+var logic [127:0] blk;
+var logic [127:0] lh;
+var logic [127:0] tag_hash;
+var logic [127:0] rcvd;
+
+var logic [127:0] ej0;
+var logic ej0_issued;
+var logic ej0_done;
+var logic [OFF_WIDTH-1:0] ks_issued;
+var logic [127:0] ks [2];
+var logic [1:0] ks_count;
+
+// Results of the previous frame for the c stream (RX)
+var logic snap_act;
+var logic snap_err;
+var logic [OFF_WIDTH-1:0] snap_enc_end;
+
+/*
+ * Parse the h stream.
+ */
+wire logic [15:0] h_ip_len = { f_ip_len[15:8], h_data };
+wire logic [31:0] h_spi = { f_spi[31:8], h_data };
+wire logic h_hdr_ok = f_ethertype == 16'h0800 && f_vihl == 8'h45 && f_proto == 8'd50 &&
+	f_ip_len >= 16'(ESP_MIN_IP_LEN) && f_ip_len[15:14] == 2'b00;
+
+var logic h_match;
+var logic [ESP_SA_WIDTH-1:0] h_match_idx;
+always_comb begin
+	h_match = 1'b0;
+	h_match_idx = '0;
+
+	if (ENCRYPT) begin
+		h_match = f_tx_sa[ESP_SA_WIDTH] && tab_valid[f_idx];
+		h_match_idx = f_idx;
+	end
+	else begin
+		for (int s = 0; s < ESP_NSAS; s++) begin
+			if (tab_valid[s] && tab_spi[s] == h_spi) begin
+				h_match = 1'b1;
+				h_match_idx = ESP_SA_WIDTH'(s);
+			end
+		end
+	end
+end
+
+wire logic h_in_aad = h_off >= OFF_WIDTH'(ESP_SPI_OFF) && h_off < OFF_WIDTH'(ESP_IV_OFF);
+wire logic h_in_c = f_len_ok && h_off >= OFF_WIDTH'(ESP_DATA_OFF) && h_off < f_enc_end;
+wire logic h_in_icv = f_len_ok && h_off >= f_enc_end && h_off < f_enc_end + OFF_WIDTH'(ESP_ICV_SIZE);
+wire logic [3:0] h_pos = h_in_aad ? 4'(h_off - OFF_WIDTH'(ESP_SPI_OFF)) : 4'(h_off - OFF_WIDTH'(ESP_DATA_OFF));
+wire logic h_c_last = h_off == f_enc_end - 1;
+wire logic h_step = h_valid && (
+	(h_in_aad && h_off == OFF_WIDTH'(ESP_IV_OFF - 1)) ||
+	(h_in_c && (h_pos == 4'd15 || h_c_last)));
+
+var logic [127:0] blk_next;
+always_comb begin
+	blk_next = blk;
+	if (h_in_aad || h_in_c) begin
+		blk_next[127-8*h_pos -: 8] = h_data;
+	end
+end
+
+/*
+ * GHASH multiplier
+ */
+var mul_t mul_sel;
+var logic [127:0] mul_a;
+var logic [127:0] mul_b;
+wire logic [127:0] mul_r = gf_mul(mul_a, mul_b);
+
+always_comb begin
+	mul_sel = MUL_NONE;
+	mul_a = tab_h[hk_idx];
+	mul_b = tab_h[hk_idx];
+
+	if (h_step) begin
+		mul_sel = MUL_BLOCK;
+		mul_a = y ^ blk_next;
+		// The last block also multiplies in the final H.
+		mul_b = h_in_c && h_c_last ? tab_h2[f_idx] : tab_h[f_idx];
+	end
+	else if (h_valid && h_off == OFF_WIDTH'(ESP_SPI_OFF + 4)) begin
+		mul_sel = MUL_LH;
+		mul_a = { 64'd64, 64'(f_clen) << 3 };
+		mul_b = tab_h[f_idx];
+	end
+	else if (h2_pending) begin
+		mul_sel = MUL_H2;
+	end
+end
+
+/*
+ * AES jobs
+ */
+var job_t job;
+var logic job_epoch;
+wire logic aes_busy;
+wire logic aes_done;
+wire logic [127:0] aes_result;
+var logic aes_start;
+var logic [127:0] aes_key;
+var logic [127:0] aes_block;
+var job_t aes_job;
+
+wire logic ks_inflight = (aes_busy || aes_done) && job == JOB_KS && job_epoch == epoch;
+wire logic f_wants_ks = ej0_issued && f_len_ok && (!f_decided || f_act) && ks_issued < f_nks;
+// Hash keys are only computed while no frame needs the AES core.
+wire logic f_busy = ((ENCRYPT ? f_iv_known : !f_decided || f_act) && !ej0_issued) || f_wants_ks;
+
+always_comb begin
+	aes_start = 1'b0;
+	aes_job = JOB_H;
+	aes_key = tab_key[f_idx];
+	aes_block = { tab_salt[f_idx], f_iv, 32'd1 };
+
+	// Jobs are not started while the frame state is reset.
+	if (!aes_busy && !(h_valid && h_sof)) begin
+		if (f_iv_known && !ej0_issued) begin
+			aes_start = 1'b1;
+			aes_job = JOB_EJ0;
+		end
+		else if (f_wants_ks && 3'(ks_count) + 3'(ks_inflight) < 3'd2) begin
+			aes_start = 1'b1;
+			aes_job = JOB_KS;
+			aes_block[31:0] = 32'(ks_issued) + 32'd2;
+		end
+		else if (h_pending && !f_busy) begin
+			aes_start = 1'b1;
+			aes_job = JOB_H;
+			aes_key = tab_key[hk_idx];
+			aes_block = '0;
+		end
+	end
+end
+
+prism_sp_aes aes_inst (
+	.clock,
+	.resetn,
+	.start(aes_start),
+	.key(aes_key),
+	.block(aes_block),
+	.busy(aes_busy),
+	.done(aes_done),
+	.result(aes_result)
+);
+
+/*
+ * The c stream
+ */
+var logic [OFF_WIDTH-1:0] c_cnt;
+wire logic [OFF_WIDTH-1:0] c_off = c_sof ? '0 : c_cnt;
+var logic c_epoch;
+// The h stream may already be in the next frame.
+wire logic c_same = c_epoch == epoch;
+wire logic c_act = c_same ? f_act : snap_act;
+wire logic [OFF_WIDTH-1:0] c_enc_end = c_same ? f_enc_end : snap_enc_end;
+wire logic c_in_c = c_off >= OFF_WIDTH'(ESP_DATA_OFF) && c_off < c_enc_end;
+wire logic [3:0] c_pos = 4'(c_off - OFF_WIDTH'(ESP_DATA_OFF));
+wire logic c_pop = c_valid && c_act && c_in_c && (c_pos == 4'd15 || c_off == c_enc_end - 1);
+wire logic [127:0] tag = tag_hash ^ ej0;
+
+always_comb begin
+	c_out = c_data;
+
+	if (c_act) begin
+		if (ENCRYPT && c_off >= OFF_WIDTH'(ESP_IV_OFF) && c_off < OFF_WIDTH'(ESP_DATA_OFF)) begin
+			c_out = f_iv[63-8*(c_off-OFF_WIDTH'(ESP_IV_OFF)) -: 8];
+		end
+		if (c_in_c) begin
+			c_out = c_data ^ ks[0][127-8*c_pos -: 8];
+		end
+		if (ENCRYPT && c_off >= c_enc_end && c_off < c_enc_end + OFF_WIDTH'(ESP_ICV_SIZE)) begin
+			c_out = tag[127-8*(c_off-c_enc_end) -: 8];
+		end
+	end
+end
+
+assign esp = !ENCRYPT && c_act;
+assign auth_err = !ENCRYPT && c_act && (c_same ? f_err : snap_err);
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		c_cnt <= '0;
+		c_epoch <= 1'b0;
+	end
+	else if (c_valid) begin
+		c_cnt <= c_off + 1;
+		if (c_sof) begin
+			c_epoch <= ~c_epoch;
+		end
+	end
+end
+
+always_ff @(posedge clock) begin
+	commit_sync <= { commit_sync[1:0], sa_control[31] };
+
+	if (!resetn) begin
+		tab_valid <= '0;
+		h_pending <= 1'b0;
+		h2_pending <= 1'b0;
+		h_cnt <= '0;
+		epoch <= 1'b0;
+		f_len_ok <= 1'b0;
+		f_decided <= 1'b1;
+		f_act <= 1'b0;
+		f_tx_sa <= '0;
+		f_iv_known <= 1'b0;
+		f_chk_pending <= 1'b0;
+		ej0_issued <= 1'b0;
+		ej0_done <= 1'b0;
+		ks_issued <= '0;
+		ks_count <= '0;
+		snap_act <= 1'b0;
+		job <= JOB_H;
+		job_epoch <= 1'b0;
+	end
+	else begin
+		/*
+		 * h stream
+		 */
+		if (h_valid) begin
+			h_cnt <= h_off + 1;
+
+			if (h_sof) begin
+				snap_act <= f_act;
+				snap_err <= f_err;
+				snap_enc_end <= f_enc_end;
+
+				epoch <= ~epoch;
+				f_len_ok <= 1'b0;
+				f_decided <= 1'b0;
+				f_act <= 1'b0;
+				f_err <= 1'b0;
+				f_chk_pending <= 1'b0;
+				f_iv_known <= 1'b0;
+				ej0_issued <= 1'b0;
+				ej0_done <= 1'b0;
+				ks_issued <= '0;
+				ks_count <= '0;
+				y <= '0;
+				blk <= '0;
+				f_tx_sa <= tx_sa;
+				if (ENCRYPT) begin
+					// The IV is known from the start.
+					f_idx <= tx_sa[ESP_SA_WIDTH-1:0];
+					f_iv <= tab_iv[tx_sa[ESP_SA_WIDTH-1:0]];
+					f_iv_known <= tx_sa[ESP_SA_WIDTH];
+				end
+			end
+
+			case (h_off)
+			12: f_ethertype[15:8] <= h_data;
+			13: f_ethertype[7:0] <= h_data;
+			14: f_vihl <= h_data;
+			16: f_ip_len[15:8] <= h_data;
+			17: begin
+				f_ip_len[7:0] <= h_data;
+				f_enc_end <= OFF_WIDTH'(h_ip_len - 16'd2);
+				f_clen <= OFF_WIDTH'(h_ip_len - 16'(ESP_DATA_OFF + 2));
+				f_nks <= OFF_WIDTH'((h_ip_len - 16'(ESP_DATA_OFF + 2) + 16'd15) >> 4);
+				f_len_ok <= 1'b1;
+			end
+			23: f_proto <= h_data;
+			34, 35, 36: f_spi[8*(37-h_off) +: 8] <= h_data;
+			37: begin
+				f_spi[7:0] <= h_data;
+				f_decided <= 1'b1;
+				if (h_hdr_ok && h_match) begin
+					f_act <= 1'b1;
+					f_idx <= h_match_idx;
+					// Cleared when the ICV has been checked
+					f_err <= 1'b1;
+					if (ENCRYPT) begin
+						tab_iv[f_idx] <= tab_iv[f_idx] + 1;
+					end
+				end
+			end
+			endcase
+
+			if (!ENCRYPT && f_act && h_off >= OFF_WIDTH'(ESP_IV_OFF) && h_off < OFF_WIDTH'(ESP_DATA_OFF)) begin
+				f_iv[63-8*(h_off-OFF_WIDTH'(ESP_IV_OFF)) -: 8] <= h_data;
+				if (h_off == OFF_WIDTH'(ESP_DATA_OFF - 1)) begin
+					f_iv_known <= 1'b1;
+				end
+			end
+
+			if (h_in_aad || h_in_c) begin
+				blk <= h_step ? '0 : blk_next;
+			end
+			if (h_in_icv) begin
+				rcvd[127-8*(h_off-f_enc_end) -: 8] <= h_data;
+				if (h_off == f_enc_end + OFF_WIDTH'(ESP_ICV_SIZE - 1)) begin
+					f_chk_pending <= f_act;
+				end
+			end
+		end
+
+		case (mul_sel)
+		MUL_BLOCK: begin
+			y <= mul_r;
+			if (h_in_c && h_c_last) begin
+				tag_hash <= mul_r ^ lh;
+			end
+		end
+		MUL_LH: lh <= mul_r;
+		MUL_H2: begin
+			tab_h2[hk_idx] <= mul_r;
+			tab_valid[hk_idx] <= hk_valid;
+			h2_pending <= 1'b0;
+		end
+		default: begin
+		end
+		endcase
+
+		if (f_chk_pending && ej0_done) begin
+			f_err <= rcvd != tag;
+			f_chk_pending <= 1'b0;
+		end
+
+		/*
+		 * AES jobs
+		 */
+		if (aes_start) begin
+			job <= aes_job;
+			job_epoch <= epoch;
+			case (aes_job)
+			JOB_EJ0: ej0_issued <= 1'b1;
+			JOB_KS: ks_issued <= ks_issued + 1;
+			JOB_H: h_pending <= 1'b0;
+			endcase
+		end
+
+		if (c_pop) begin
+			ks[0] <= ks[1];
+		end
+		if (aes_done) begin
+			case (job)
+			JOB_H: begin
+				tab_h[hk_idx] <= aes_result;
+				h2_pending <= 1'b1;
+			end
+			JOB_EJ0: begin
+				if (job_epoch == epoch && !(h_valid && h_sof)) begin
+					ej0 <= aes_result;
+					ej0_done <= 1'b1;
+				end
+			end
+			JOB_KS: begin
+				if (job_epoch == epoch && !(h_valid && h_sof)) begin
+					if (ks_count == 2'd0 || (ks_count == 2'd1 && c_pop)) begin
+						ks[0] <= aes_result;
+					end
+					else begin
+						ks[1] <= aes_result;
+					end
+				end
+			end
+			endcase
+		end
+		if (!(h_valid && h_sof)) begin
+			ks_count <= ks_count
+				+ 2'(aes_done && job == JOB_KS && job_epoch == epoch)
+				- 2'(c_pop && ks_count != 2'd0);
+		end
+
+		/*
+		 * SA commit
+		 */
+		if (commit_sync[2] != commit_sync[1]) begin
+			for (int s = 0; s < ESP_NSAS; s++) begin
+				if (sa_control[ESP_SA_WIDTH-1:0] == s) begin
+					tab_key[s] <= sa_key;
+					tab_salt[s] <= sa_salt;
+					tab_spi[s] <= sa_spi;
+					tab_iv[s] <= 64'd1;
+					tab_valid[s] <= 1'b0;
+				end
+			end
+			hk_idx <= sa_control[ESP_SA_WIDTH-1:0];
+			hk_valid <= sa_control[8];
+			h_pending <= 1'b1;
+			h2_pending <= 1'b0;
+		end
+	end
+end
+
+endmodule
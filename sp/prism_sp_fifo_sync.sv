@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * A single FWFT FIFO configured like the puzzle FIFOs.
+ */
+module prism_sp_fifo_sync
+#(
+	parameter int FIFO_WRITE_DEPTH
+)
+(
+	input wire logic clock,
+	input wire logic resetn,
+
+	fifo_read_interface.slave fifo_r,
+	fifo_write_interface.slave fifo_w
+);
+
+xpm_fifo_sync #(
+	.DOUT_RESET_VALUE("0"),
+	.ECC_MODE("no_ecc"),
+	.FIFO_MEMORY_TYPE("auto"),
+	.FIFO_READ_LATENCY(0),
+	.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH),
+	.FULL_RESET_VALUE(0),
+	.PROG_EMPTY_THRESH(10),
+	.PROG_FULL_THRESH(10),
+	.RD_DATA_COUNT_WIDTH(fifo_r.DATA_COUNT_WIDTH),
+	.READ_DATA_WIDTH(fifo_r.DATA_WIDTH),
+	.READ_MODE("fwft"),
+	.SIM_ASSERT_CHK(0),
+	.USE_ADV_FEATURES("0707"),
+	.WAKEUP_TIME(0),
+	.WR_DATA_COUNT_WIDTH(fifo_w.DATA_COUNT_WIDTH),
+	.WRITE_DATA_WIDTH(fifo_w.DATA_WIDTH)
+) fifo (
+	.rst(~resetn),
+
+	.wr_clk(clock),
+	.wr_en(fifo_w.wr_en),
+	.din(fifo_w.wr_data),
+	.full(fifo_w.full),
+	.almost_full(fifo_w.almost_full),
+	.wr_data_count(fifo_w.wr_data_count),
+
+	.rd_en(fifo_r.rd_en),
+	.dout(fifo_r.rd_data),
+	.empty(fifo_r.empty),
+	.almost_empty(fifo_r.almost_empty),
+	.rd_data_count(fifo_r.rd_data_count)
+);
+
+endmodule
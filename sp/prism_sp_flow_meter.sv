@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Counts the received frames per flow (see USE_FLOW_METER).
+ *
+ * The meter watches the bytes of a GEM RX interface. The 5-tuple, the
+ * TCP flags and the IPv4 total length of a frame are taken while it is
+ * received. After its last byte, the entry selected by the CRC32C over
+ * the 5-tuple is updated. If the entry belongs to another flow, that flow
+ * is exported and the entry is taken over. In all other clock cycles, a
+ * scanner walks the table and exports the flows that have expired:
+ *   timeout[15:0]	idle timeout in ticks (0: none)
+ *   timeout[31:16]	active timeout in ticks (0: none)
+ * While enable is cleared, no frames are counted and all flows are
+ * exported. The table is cleared after reset.
+ *
+ * Records are written to record_fifo_w. If it is full, the record is
+ * lost and counted in drops.
+ * An update takes a few clock cycles, which is much less than the
+ * shortest frame plus the gap between two frames.
+ *
+ * enable and timeout are written in another clock domain.
+ */
+module prism_sp_flow_meter (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [31:0] timeout,
+
+	input wire logic valid,
+	input wire logic [7:0] data,
+	input wire logic sop,
+	input wire logic eop,
+	input wire logic err,
+
+	fifo_write_interface.master record_fifo_w,
+	output var logic [31:0] drops
+);
+
+localparam int INDEX_WIDTH = $clog2(FLOW_NENTRIES);
+localparam int OFF_WIDTH = 6;
+
+typedef struct packed {
+	logic [31:0] saddr;
+	logic [31:0] daddr;
+	logic [15:0] sport;
+	logic [15:0] dport;
+	logic [7:0] proto;
+} flow_key_t;
+
+typedef struct packed {
+	logic valid;
+	flow_key_t key;
+	logic [7:0] tcp_flags;
+	logic [31:0] packets;
+	logic [31:0] octets;
+	logic [31:0] first;
+	logic [31:0] last;
+} flow_entry_t;
+
+typedef enum logic [2:0] {
+	STATE_CLEAR,
+	STATE_IDLE,
+	STATE_FRAME_READ,
+	STATE_FRAME,
+	STATE_SCAN_READ,
+	STATE_SCAN
+} state_t;
+
+localparam logic [7:0] REASON_IDLE = 8'd0;
+localparam logic [7:0] REASON_ACTIVE = 8'd1;
+localparam logic [7:0] REASON_EVICTED = 8'd2;
+localparam logic [7:0] REASON_TCP_END = 8'd3;
+localparam logic [7:0] REASON_DISABLED = 8'd4;
+
+assign record_fifo_w.clock = clock;
+assign record_fifo_w.reset = ~resetn;
+
+var logic [1:0] enable_sync;
+wire logic enabled = enable_sync[1];
+
+/*
+ * Ticks
+ */
+var logic [FLOW_TICK_SHIFT-1:0] prescaler;
+var logic [31:0] now;
+
+always_ff @(posedge clock) begin
+	enable_sync <= { enable_sync[0], enable };
+
+	if (!resetn) begin
+		prescaler <= '0;
+		now <= '0;
+	end
+	else begin
+		prescaler <= prescaler + 1;
+		if (prescaler == '1) begin
+			now <= now + 1;
+		end
+	end
+end
+
+/*
+ * Parser
+ */
+var logic [OFF_WIDTH-1:0] cnt;
+wire logic [OFF_WIDTH-1:0] off = sop ? '0 : cnt;
+
+var logic [15:0] p_ethertype;
+var logic [7:0] p_vihl;
+var logic [15:0] p_len;
+var flow_key_t p_key;
+var logic [7:0] p_tcp_flags;
+var logic [31:0] p_hash;
+
+wire logic p_tcp = p_key.proto == 8'd6;
+wire logic p_ports = p_tcp || p_key.proto == 8'd17;
+// The ports of other protocols are taken as zero.
+wire logic [7:0] p_data = off >= 34 && !p_ports ? 8'h00 : data;
+wire logic p_ipv4 = p_ethertype == 16'h0800 && p_vihl == 8'h45;
+
+// The frame that is to be counted
+var logic f_pending;
+var flow_key_t f_key;
+var logic [15:0] f_len;
+var logic [7:0] f_tcp_flags;
+var logic [INDEX_WIDTH-1:0] f_idx;
+
+/*
+ * Table
+ */
+var flow_entry_t table_mem [FLOW_NENTRIES];
+var logic [INDEX_WIDTH-1:0] rd_addr;
+var flow_entry_t rd_entry;
+var logic wr_en;
+var logic [INDEX_WIDTH-1:0] wr_addr;
+var flow_entry_t wr_entry;
+
+always_ff @(posedge clock) begin
+	rd_entry <= table_mem[rd_addr];
+	if (wr_en) begin
+		table_mem[wr_addr] <= wr_entry;
+	end
+end
+
+function automatic flow_record_t make_record(input flow_entry_t e, input logic [7:0] reason);
+	flow_record_t r;
+
+	r = '0;
+	r.saddr = e.key.saddr;
+	r.daddr = e.key.daddr;
+	r.sport = e.key.sport;
+	r.dport = e.key.dport;
+	r.proto = e.key.proto;
+	r.tcp_flags = e.tcp_flags;
+	r.reason = reason;
+	r.packets = e.packets;
+	r.octets = e.octets;
+	r.first = e.first;
+	r.last = e.last;
+	return r;
+endfunction
+
+var state_t state;
+var logic [INDEX_WIDTH-1:0] scan_idx;
+
+wire logic idle_expired = timeout[15:0] != '0 && now - rd_entry.last >= 32'(timeout[15:0]);
+wire logic active_expired = timeout[31:16] != '0 && now - rd_entry.first >= 32'(timeout[31:16]);
+
+// The entry of the frame after the update
+var flow_entry_t upd_entry;
+wire logic f_match = rd_entry.valid && rd_entry.key == f_key;
+wire logic f_tcp_end = f_key.proto == 8'd6 && (upd_entry.tcp_flags & 8'h05) != '0;
+
+always_comb begin
+	upd_entry = rd_entry;
+	if (f_match) begin
+		upd_entry.packets = rd_entry.packets + 1;
+		upd_entry.octets = rd_entry.octets + 32'(f_len);
+		upd_entry.tcp_flags = rd_entry.tcp_flags | f_tcp_flags;
+		upd_entry.last = now;
+	end
+	else begin
+		upd_entry.valid = 1'b1;
+		upd_entry.key = f_key;
+		upd_entry.packets = 1;
+		upd_entry.octets = 32'(f_len);
+		upd_entry.tcp_flags = f_tcp_flags;
+		upd_entry.first = now;
+		upd_entry.last = now;
+	end
+end
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	wr_en <= 1'b0;
+	record_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		cnt <= '0;
+		f_pending <= 1'b0;
+		wr_addr <= '0;
+		scan_idx <= '0;
+		drops <= '0;
+		state <= STATE_CLEAR;
+	end
+	else begin
+		case (state)
+		STATE_CLEAR: begin
+			wr_en <= 1'b1;
+			wr_addr <= scan_idx;
+			wr_entry <= '0;
+			scan_idx <= scan_idx + 1;
+			if (scan_idx == INDEX_WIDTH'(FLOW_NENTRIES-1)) begin
+				state <= STATE_IDLE;
+			end
+		end
+		STATE_IDLE: begin
+			if (f_pending) begin
+				f_pending <= 1'b0;
+				rd_addr <= f_idx;
+				state <= STATE_FRAME_READ;
+			end
+			else begin
+				rd_addr <= scan_idx;
+				state <= STATE_SCAN_READ;
+			end
+		end
+		STATE_FRAME_READ: begin
+			state <= STATE_FRAME;
+		end
+		STATE_FRAME: begin
+			wr_en <= 1'b1;
+			wr_addr <= rd_addr;
+			wr_entry <= upd_entry;
+			if (rd_entry.valid && !f_match) begin
+				// Another flow has to make room.
+				if (!record_fifo_w.full) begin
+					record_fifo_w.wr_en <= 1'b1;
+					record_fifo_w.wr_data <= make_record(rd_entry, REASON_EVICTED);
+				end
+				else begin
+					drops <= drops + 1;
+				end
+			end
+			else if (f_tcp_end) begin
+				wr_entry.valid <= 1'b0;
+				if (!record_fifo_w.full) begin
+					record_fifo_w.wr_en <= 1'b1;
+					record_fifo_w.wr_data <= make_record(upd_entry, REASON_TCP_END);
+				end
+				else begin
+					drops <= drops + 1;
+				end
+			end
+			state <= STATE_IDLE;
+		end
+		STATE_SCAN_READ: begin
+			state <= STATE_SCAN;
+		end
+		STATE_SCAN: begin
+			if (rd_entry.valid && (!enabled || idle_expired || active_expired)) begin
+				wr_en <= 1'b1;
+				wr_addr <= rd_addr;
+				wr_entry <= '0;
+				if (!record_fifo_w.full) begin
+					record_fifo_w.wr_en <= 1'b1;
+					record_fifo_w.wr_data <= make_record(rd_entry,
+						!enabled ? REASON_DISABLED : idle_expired ? REASON_IDLE : REASON_ACTIVE);
+				end
+				else begin
+					drops <= drops + 1;
+				end
+			end
+			scan_idx <= scan_idx + 1;
+			state <= STATE_IDLE;
+		end
+		endcase
+
+		if (valid) begin
+			if (off != '1) begin
+				cnt <= off + 1;
+			end
+			if (sop) begin
+				p_hash <= '1;
+			end
+
+			case (off)
+			12: p_ethertype[15:8] <= data;
+			13: p_ethertype[7:0] <= data;
+			14: p_vihl <= data;
+			16: p_len[15:8] <= data;
+			17: p_len[7:0] <= data;
+			23: p_key.proto <= data;
+			26, 27, 28, 29: p_key.saddr <= { p_key.saddr[23:0], data };
+			30, 31, 32, 33: p_key.daddr <= { p_key.daddr[23:0], data };
+			34, 35: p_key.sport <= { p_key.sport[7:0], p_data };
+			36, 37: p_key.dport <= { p_key.dport[7:0], p_data };
+			47: p_tcp_flags <= data;
+			endcase
+
+			if (off == 23 || (off >= 26 && off < 38)) begin
+				p_hash <= crc32c_byte(p_hash, p_data);
+			end
+
+			// The 5-tuple is complete after byte 37.
+			if (eop && !err && enabled && state != STATE_CLEAR && p_ipv4 && off >= 38) begin
+				f_pending <= 1'b1;
+				f_key <= p_key;
+				f_len <= p_len;
+				f_tcp_flags <= p_tcp ? p_tcp_flags : '0;
+				f_idx <= p_hash[INDEX_WIDTH-1:0];
+			end
+		end
+	end
+end
+
+endmodule
@@ -24,6 +24,24 @@ module prism_sp_gem_rx_single#(
 	fifo_write_interface.master rx_meta_fifo_w [NRXCORES],
 	fifo_write_interface.master rx_data_fifo_w [NRXCORES],
 
+	// CRC32C data digest range (see REGOFF_RX_DIGEST)
+	input wire logic [31:0] digest_range,
+	// ESP status of the current frame, valid at rx_w_eop
+	// ([0] decrypted, [1] ICV mismatch, see prism_sp_rx_esp)
+	input wire logic [1:0] esp_status,
+	// Tunnel status of the current frame, valid at rx_w_eop
+	// (see prism_sp_rx_tunnel)
+	input rx_tunnel_status_t tunnel_status,
+
+	// Admission control (see REGOFF_ADMIT_CONTROL)
+	input wire logic [31:0] admit_control,
+	input wire logic [31:0] admit_thresh,
+	input wire logic [31:0] pause_control,
+	// Number of frames dropped early
+	output var logic [31:0] admit_drops,
+	// Priorities to be paused
+	output var logic [7:0] pause_xoff,
+
 	gem_rx_interface.slave gem_rx
 );
 
@@ -78,11 +96,185 @@ always_comb begin
 	end
 end
 
+/*
+ * Capture the EtherType and the first two bytes of the L3 header
+ * to extract the IP precedence of untagged frames.
+ */
+var logic [15:0] rx_ethertype;
+var logic [15:0] rx_l3_hdr;
+var logic [2:0] rx_ip_prio;
+
+always_ff @(posedge gem_rx.rx_clock) begin
+	if (gem_rx.rx_w_sop) begin
+		rx_ethertype <= '0;
+	end
+	if (gem_rx.rx_w_wr) begin
+		// rx_packet_byte_count_comb already accounts for the current byte.
+		case (rx_packet_byte_count_comb)
+		13: rx_ethertype[15:8] <= gem_rx.rx_w_data[7:0];
+		14: rx_ethertype[7:0] <= gem_rx.rx_w_data[7:0];
+		15: rx_l3_hdr[15:8] <= gem_rx.rx_w_data[7:0];
+		16: rx_l3_hdr[7:0] <= gem_rx.rx_w_data[7:0];
+		endcase
+	end
+end
+
+always_comb begin
+	case (rx_ethertype)
+	// IPv4: the TOS byte follows the version/IHL byte.
+	16'h0800: rx_ip_prio = rx_l3_hdr[7:5];
+	// IPv6: the traffic class follows the 4 bit version field.
+	16'h86dd: rx_ip_prio = rx_l3_hdr[11:9];
+	default: rx_ip_prio = '0;
+	endcase
+end
+
+/*
+ * Check the CRC32C data digest.
+ * The CRC is computed over the bytes [digest_start, digest_end) and
+ * compared with the 4 bytes at digest_end (least significant byte
+ * first). Frames that are too short to hold the digest are not checked.
+ */
+wire logic [13:0] digest_start = digest_range[13:0];
+wire logic [13:0] digest_end = digest_range[29:16];
+wire logic [13:0] rx_byte_off = 14'(rx_packet_byte_count_comb) - 14'd1;
+var logic [31:0] rx_digest_crc_ff;
+var logic [31:0] rx_digest_crc_comb;
+var logic [31:0] rx_digest_ff;
+var logic [31:0] rx_digest_comb;
+
+always_comb begin
+	rx_digest_crc_comb = gem_rx.rx_w_sop ? '1 : rx_digest_crc_ff;
+	rx_digest_comb = rx_digest_ff;
+
+	if (gem_rx.rx_w_wr) begin
+		if (rx_byte_off >= digest_start && rx_byte_off < digest_end) begin
+			rx_digest_crc_comb = crc32c_byte(rx_digest_crc_comb, gem_rx.rx_w_data[7:0]);
+		end
+		for (int k = 0; k < 4; k++) begin
+			if (rx_byte_off == digest_end + 14'(k)) begin
+				rx_digest_comb[k*8 +: 8] = gem_rx.rx_w_data[7:0];
+			end
+		end
+	end
+end
+
+always_ff @(posedge gem_rx.rx_clock) begin
+	rx_digest_crc_ff <= rx_digest_crc_comb;
+	rx_digest_ff <= rx_digest_comb;
+end
+
+wire logic rx_digest_err_comb = digest_end != '0 &&
+	14'(rx_packet_byte_count_comb) >= digest_end + 14'd4 &&
+	~rx_digest_crc_comb != rx_digest_comb;
+
+/*
+ * Admission control
+ * The fill level of the RX buffers is the fill level of the RX data FIFO
+ * or of the RX meta FIFO, whichever is higher, in 1/256.
+ * A frame is classified when its 16th byte is received, i.e., before its
+ * first word is written to the RX data FIFO. Its priority is the PCP of
+ * VLAN-tagged frames, the IP precedence of untagged IPv4/IPv6 frames if
+ * enabled or a default priority. Each priority is mapped to one of four
+ * drop levels. If the fill level has reached the threshold of its drop
+ * level, the frame is dropped.
+ * A priority is paused (see prism_sp_tx_pause) from the threshold of its
+ * drop level minus a headroom on, and resumed below the threshold minus
+ * twice the headroom.
+ */
+localparam int DATA_FIFO_DEPTH = RX_DATA_FIFO_SIZE / (rx_data_fifo_w[0].DATA_WIDTH/8);
+localparam int META_FIFO_DEPTH = 2**(rx_meta_fifo_w[0].DATA_COUNT_WIDTH-1);
+
+// Narrower words would be written before the frame is classified.
+if (rx_data_fifo_w[0].DATA_WIDTH < 128) begin
+	$error("The RX data FIFO width (%d) must be at least 128 bits for admission control.",
+		rx_data_fifo_w[0].DATA_WIDTH);
+end
+
+function automatic logic [7:0] fill_level(input logic [31:0] count, input int depth);
+	logic [39:0] level;
+
+	level = { count, 8'h00 } / depth;
+	return level > 255 ? 8'hff : level[7:0];
+endfunction
+
+wire logic admit_enable = admit_control[0];
+wire logic admit_dscp = admit_control[ADMIT_CONTROL_DSCP_BITN];
+wire logic [2:0] admit_prio = admit_control[ADMIT_CONTROL_PRIO_BITN +: 3];
+wire logic [15:0] admit_levels = admit_control[ADMIT_CONTROL_LEVEL_BITN +: 16];
+wire logic pause_enable = pause_control[0];
+wire logic [7:0] pause_headroom = pause_control[PAUSE_CONTROL_HEADROOM_BITN +: 8];
+
+wire logic [7:0] rx_data_fill = fill_level(32'(rx_data_fifo_w[0].wr_data_count), DATA_FIFO_DEPTH);
+wire logic [7:0] rx_meta_fill = fill_level(32'(rx_meta_fifo_w[0].wr_data_count), META_FIFO_DEPTH);
+var logic [7:0] rx_fill;
+
+always_ff @(posedge gem_rx.rx_clock) begin
+	rx_fill <= rx_data_fill > rx_meta_fill ? rx_data_fill : rx_meta_fill;
+end
+
+// Threshold of the drop level of each priority. 0 stands for 256,
+// i.e., the threshold is never reached.
+var logic [9:0] prio_thresh [8];
+always_comb begin
+	for (int p = 0; p < 8; p++) begin
+		prio_thresh[p] = admit_thresh[8*admit_levels[2*p +: 2] +: 8] == '0 ? 10'd256 :
+			10'(admit_thresh[8*admit_levels[2*p +: 2] +: 8]);
+	end
+end
+
+always_ff @(posedge gem_rx.rx_clock) begin
+	if (!gem_rx.rx_resetn || !pause_enable) begin
+		pause_xoff <= '0;
+	end
+	else begin
+		for (int p = 0; p < 8; p++) begin
+			if (10'(rx_fill) + 10'(pause_headroom) >= prio_thresh[p]) begin
+				pause_xoff[p] <= 1'b1;
+			end
+			else if (10'(rx_fill) + 10'(pause_headroom) + 10'(pause_headroom) < prio_thresh[p]) begin
+				pause_xoff[p] <= 1'b0;
+			end
+		end
+	end
+end
+
+var logic [2:0] rx_prio_comb;
+always_comb begin
+	rx_prio_comb = admit_prio;
+	// The 16th byte is on the bus.
+	case (rx_ethertype)
+	16'h8100: rx_prio_comb = rx_l3_hdr[15:13];
+	16'h0800: if (admit_dscp) rx_prio_comb = gem_rx.rx_w_data[7:5];
+	16'h86dd: if (admit_dscp) rx_prio_comb = rx_l3_hdr[11:9];
+	default: begin end
+	endcase
+end
+
+wire logic rx_classify = gem_rx.rx_w_wr && rx_packet_byte_count_comb == 16;
+wire logic rx_early_drop_comb = admit_enable && 10'(rx_fill) >= prio_thresh[rx_prio_comb];
+var logic rx_admit_ff;
+wire logic rx_admit_comb =
+	rx_classify ? !rx_early_drop_comb :
+	gem_rx.rx_w_sop ? 1'b1 : rx_admit_ff;
+
+always_ff @(posedge gem_rx.rx_clock) begin
+	rx_admit_ff <= rx_admit_comb;
+
+	if (!gem_rx.rx_resetn) begin
+		admit_drops <= '0;
+	end
+	else if (rx_classify && rx_early_drop_comb) begin
+		admit_drops <= admit_drops + 1;
+	end
+end
+
 var logic [31:0] gem_rx_w_status_encoded;
 
 gem_rx_w_status_encoder gem_rx_w_status_encoder_inst(
 	.rx_w_status(gem_rx.rx_w_status),
 	.frame_length(rx_packet_byte_count_comb),
+	.ip_prio(rx_ip_prio),
 	.out(gem_rx_w_status_encoded)
 );
 
@@ -165,8 +357,14 @@ always_ff @(posedge gem_rx.rx_clock) begin
 			};
 		end
 		if (gem_rx.rx_w_eop) begin
-			rx_meta_fifo_w[0].wr_en <= rx_data_fifo_has_space_ff;
+			rx_meta_fifo_w[0].wr_en <= rx_data_fifo_has_space_ff & rx_admit_comb;
 			o_meta_desc <= gem_rx_w_status_encoded;
+			o_meta_desc.digest_err <= rx_digest_err_comb;
+			o_meta_desc.esp <= esp_status[0];
+			o_meta_desc.esp_auth_err <= esp_status[1];
+			o_meta_desc.tunnel <= tunnel_status.tunnel;
+			o_meta_desc.inner_chksum_enc <= tunnel_status.inner_chksum_enc;
+			o_meta_desc.inner_hash <= tunnel_status.inner_hash;
 
 			rx_cur_buf_idx[0] <= 1'b1;
 			rx_cur_buf_idx[(rx_data_fifo_w[0].DATA_WIDTH/8)-1:1] <= '0;
@@ -174,7 +372,7 @@ always_ff @(posedge gem_rx.rx_clock) begin
 		// If we have a full rx_buf_cur or this is the last write, store what we have
 		// in the RX data FIFO.
 		if (gem_rx.rx_w_eop || (gem_rx.rx_w_wr & rx_cur_buf_idx[(rx_data_fifo_w[0].DATA_WIDTH/8)-1])) begin
-			rx_data_fifo_w[0].wr_en <= rx_data_fifo_has_space_ff;
+			rx_data_fifo_w[0].wr_en <= rx_data_fifo_has_space_ff & rx_admit_comb;
 			gem_rx.rx_w_overflow <= ~rx_data_fifo_has_space_ff & gem_rx.rx_w_eop;
 		end
 	end
@@ -21,8 +21,23 @@ module prism_sp_gem_tx_single#(
 (
 	fifo_read_interface.master tx_meta_fifo_r [NTXCORES],
 	fifo_read_interface.master tx_csum_fifo_r [NTXCORES],
+	fifo_read_interface.master tx_digest_fifo_r [NTXCORES],
 	fifo_read_interface.master tx_data_fifo_r [NTXCORES],
 
+	// Number of frames aborted due to a TX data FIFO underflow
+	output var logic [31:0] tx_underflows [NTXCORES],
+
+	// ESP SA table (see prism_sp_esp_gcm)
+	input wire logic [127:0] esp_sa_key,
+	input wire logic [31:0] esp_sa_salt,
+	input wire logic [31:0] esp_sa_spi,
+	input wire logic [31:0] esp_sa_control,
+
+	// Tunnel templates (see REGOFF_TUNNEL_CONTROL)
+	input wire logic [31:0] tunnel_control,
+	input wire logic [31:0] tunnel_tmpl,
+	input wire logic [31:0] tunnel_tmpl_addr,
+
 	gem_tx_interface.master gem_tx
 );
 
@@ -32,10 +47,10 @@ module prism_sp_gem_tx_single#(
  * --------  --------  --------  --------
  */
 assign gem_tx.tx_r_flushed = '0;
-assign gem_tx.tx_r_err = 1'b0;
-assign gem_tx.tx_r_underflow = 1'b0;
 
 localparam int TX_PACKET_BYTE_COUNT_WIDTH = 13;
+localparam int TX_DATA_NBYTES = tx_data_fifo_r[0].DATA_WIDTH / 8;
+localparam int TX_DATA_NBYTES_WIDTH = $clog2(TX_DATA_NBYTES);
 var logic [TX_PACKET_BYTE_COUNT_WIDTH-1:0] tx_packet_byte_count_decr;
 var logic [TX_PACKET_BYTE_COUNT_WIDTH-1:0] tx_packet_byte_count_incr;
 wire tx_meta_desc_t i_meta_desc;
@@ -44,46 +59,241 @@ assign i_meta_desc = tx_meta_fifo_r[0].rd_data;
 wire logic tx_last_byte_comb =
 	~|tx_packet_byte_count_decr[$bits(tx_packet_byte_count_decr)-1:1] & tx_packet_byte_count_decr[0];
 
+/*
+ * Number of TX data FIFO words that a frame occupies and the number of
+ * words that have to be buffered before a cut-through frame may start.
+ */
+localparam int TX_NWORDS_WIDTH = TX_META_DESC_SIZE_WIDTH - TX_DATA_NBYTES_WIDTH + 1;
+wire logic [TX_NWORDS_WIDTH-1:0] i_meta_desc_nwords = TX_NWORDS_WIDTH'(
+	((TX_META_DESC_SIZE_WIDTH+1)'(i_meta_desc.size) + (TX_DATA_NBYTES - 1)) >> TX_DATA_NBYTES_WIDTH);
+wire logic [TX_NWORDS_WIDTH-1:0] i_meta_desc_ct_nwords = TX_NWORDS_WIDTH'(
+	((TX_META_DESC_SIZE_WIDTH+1)'(i_meta_desc.ct_size) + (TX_DATA_NBYTES - 1)) >> TX_DATA_NBYTES_WIDTH);
+
+/*
+ * A frame may start if its meta descriptor, its checksum information
+ * and its data digest are available.
+ * For cut-through frames, we additionally wait until enough data
+ * is buffered.
+ * Note that the checksum information for a frame that needs checksum
+ * insertion and the digest of a frame with a data digest are only
+ * available after the whole frame has been written to the TX data FIFO.
+ * These frames are effectively handled in store-and-forward mode.
+ * Frames without either get their entries at their start.
+ */
+wire logic tx_frame_ready_comb =
+	!tx_meta_fifo_r[0].empty && !tx_csum_fifo_r[0].empty && !tx_digest_fifo_r[0].empty &&
+	(i_meta_desc.ct_size == '0 ||
+	 tx_data_fifo_r[0].rd_data_count >= ($bits(tx_data_fifo_r[0].rd_data_count))'(i_meta_desc_ct_nwords));
+
 assign tx_meta_fifo_r[0].clock = gem_tx.tx_clock;
 assign tx_meta_fifo_r[0].reset = ~gem_tx.tx_resetn;
 assign tx_csum_fifo_r[0].clock = gem_tx.tx_clock;
 assign tx_csum_fifo_r[0].reset = ~gem_tx.tx_resetn;
+assign tx_digest_fifo_r[0].clock = gem_tx.tx_clock;
+assign tx_digest_fifo_r[0].reset = ~gem_tx.tx_resetn;
 assign tx_data_fifo_r[0].clock = gem_tx.tx_clock;
 assign tx_data_fifo_r[0].reset = ~gem_tx.tx_resetn;
 
-// Only two states: idle (0) and not idle (1).
-var logic tx_state = 1'b0;
+typedef enum logic [1:0] {
+	TX_STATE_IDLE,
+	TX_STATE_BUSY,
+	// Discard the rest of a frame after an underflow.
+	TX_STATE_DRAIN
+} tx_state_t;
+var tx_state_t tx_state = TX_STATE_IDLE;
 var logic [tx_data_fifo_r[0].DATA_WIDTH-1:0] tx_cur_buf;
 var logic [(tx_data_fifo_r[0].DATA_WIDTH/8)-1:0] tx_cur_buf_valid;
 
+// Set if the current frame is sent in cut-through mode.
+var logic tx_cut_through;
+// Number of words of the current frame still in the TX data FIFO.
+var logic [TX_NWORDS_WIDTH-1:0] tx_nwords_left;
+
+wire logic tx_underflow_comb = tx_cut_through && tx_data_fifo_r[0].empty;
+
 var logic [1:0] checksum_ip_type;
 var logic [15:0] checksum_ip;
 var logic [1:0] checksum_l4_type;
 var logic [15:0] checksum_l4;
 
+/*
+ * CRC32C data digest (see prism_sp_tx_digest)
+ * The digest replaces the 4 zero bytes at digest_off. If the digest
+ * lies within the L4 payload, the L4 checksum that was computed over
+ * the zero bytes is updated accordingly.
+ */
+var logic [31:0] digest;
+var logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_off;
+wire logic [31:0] i_digest = tx_digest_fifo_r[0].rd_data[TX_COOKIE_SIZE_WIDTH +: 32];
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] i_digest_off = tx_digest_fifo_r[0].rd_data[0 +: TX_COOKIE_SIZE_WIDTH];
+
+function automatic logic [15:0] digest_checksum(
+	input logic [15:0] csum,
+	input logic [31:0] d,
+	input logic [TX_COOKIE_SIZE_WIDTH-1:0] off
+);
+	logic [19:0] s;
+
+	s = 20'(~csum);
+	for (int k = 0; k < 4; k++) begin
+		// Bytes at even offsets are the upper halves of 16-bit words.
+		if (off[0] ^ k[0]) begin
+			s = s + 20'(d[k*8 +: 8]);
+		end
+		else begin
+			s = s + 20'({ d[k*8 +: 8], 8'h00 });
+		end
+	end
+	s = 20'(s[15:0]) + 20'(s[19:16]);
+	s = 20'(s[15:0]) + 20'(s[16]);
+	return ~s[15:0];
+endfunction
+
+// ESP SA of the current frame (see prism_sp_esp_gcm)
+var logic [TX_COOKIE_ESP_SA_WIDTH-1:0] esp_sa;
+
+function automatic logic [15:0] csum_fold(input logic [19:0] s);
+	s = 20'(s[15:0]) + 20'(s[19:16]);
+	s = 20'(s[15:0]) + 20'(s[16]);
+	return s[15:0];
+endfunction
+
+/*
+ * Tunnel encapsulation (see USE_TUNNEL)
+ * The template of the queue of a frame is sent before the frame. The
+ * TX buffer is held meanwhile. The IPv4 total length, the IPv4 header
+ * checksum, the UDP length and the UDP checksum of the template are
+ * patched when the frame starts. The UDP checksum needs the sum over
+ * the inner frame from the checksum FIFO; it is left zero if that is
+ * unknown or if a data digest changes the frame.
+ */
+localparam int TUNNEL_TMPL_WORD_WIDTH = $clog2(TUNNEL_TMPL_SIZE / 4);
+var logic [31:0] tunnel_tmpl_mem [TUNNEL_TMPL_NWORDS];
+// Size of the template of every queue, stored with each template word
+var logic [6:0] tunnel_tmpl_size [TUNNEL_NTMPLS];
+var logic [2:0] tunnel_tmpl_sync;
+
+always_ff @(posedge gem_tx.tx_clock) begin
+	tunnel_tmpl_sync <= { tunnel_tmpl_sync[1:0], tunnel_tmpl_addr[31] };
+	if (tunnel_tmpl_sync[2] != tunnel_tmpl_sync[1]) begin
+		tunnel_tmpl_mem[tunnel_tmpl_addr[$clog2(TUNNEL_TMPL_NWORDS)-1:0]] <= tunnel_tmpl;
+		tunnel_tmpl_size[tunnel_tmpl_addr[TUNNEL_TMPL_WORD_WIDTH +: TX_COOKIE_QUEUE_WIDTH]] <= tunnel_tmpl_addr[8 +: 7];
+	end
+end
+
+var logic tunnel;
+var logic [TX_COOKIE_QUEUE_WIDTH-1:0] tunnel_queue;
+var logic [6:0] tunnel_tmpl_len;
+var logic [15:0] tunnel_ip_len;
+var logic [15:0] tunnel_ip_csum;
+var logic [15:0] tunnel_udp_len;
+var logic [15:0] tunnel_udp_csum;
+
+wire logic i_tunnel = USE_TUNNEL && tunnel_control[i_meta_desc.queue];
+wire logic [6:0] i_tunnel_tmpl_len = tunnel_tmpl_size[i_meta_desc.queue];
+wire logic [15:0] i_tunnel_tmpl_ip_csum =
+	tunnel_tmpl_mem[{ i_meta_desc.queue, TUNNEL_TMPL_WORD_WIDTH'(6) }][31:16];
+wire logic [15:0] i_tunnel_tmpl_udp_csum =
+	tunnel_tmpl_mem[{ i_meta_desc.queue, TUNNEL_TMPL_WORD_WIDTH'(10) }][31:16];
+wire logic [15:0] i_tunnel_ip_len = 16'(i_tunnel_tmpl_len) - 16'd14 + 16'(i_meta_desc.size);
+wire logic [15:0] i_tunnel_udp_len = i_tunnel_ip_len - 16'd20;
+wire logic [15:0] i_frame_sum = tx_csum_fifo_r[0].rd_data[2+16+2+16 +: 16];
+// The UDP length is part of the pseudo header and of the UDP header.
+wire logic [15:0] i_tunnel_udp_csum = ~csum_fold(20'(i_tunnel_tmpl_udp_csum) +
+	20'(i_tunnel_udp_len) + 20'(i_tunnel_udp_len) + 20'(i_frame_sum));
+
+wire logic [TX_PACKET_BYTE_COUNT_WIDTH-1:0] tunnel_tmpl_len_ext =
+	tunnel ? TX_PACKET_BYTE_COUNT_WIDTH'(tunnel_tmpl_len) : '0;
+// Set while the template is sent.
+wire logic tx_in_tmpl = tx_packet_byte_count_incr < tunnel_tmpl_len_ext;
+// Offset of the current byte in the frame from the TX data FIFO
+wire logic [TX_PACKET_BYTE_COUNT_WIDTH-1:0] tx_data_byte_count_incr =
+	tx_packet_byte_count_incr - tunnel_tmpl_len_ext;
+wire logic [31:0] tunnel_tmpl_word =
+	tunnel_tmpl_mem[{ tunnel_queue, tx_packet_byte_count_incr[2 +: TUNNEL_TMPL_WORD_WIDTH] }];
+
 `define USE_CHECKSUM
 `ifdef USE_CHECKSUM
 var logic [$bits(gem_tx.tx_r_data)-1:0] gem_tx_tx_r_data;
 always_comb begin
 	gem_tx_tx_r_data = tx_cur_buf[7:0];
 	if (checksum_ip_type == 2'b01) begin
-		case (tx_packet_byte_count_incr)
+		case (tx_data_byte_count_incr)
 		24: gem_tx_tx_r_data = checksum_ip[15:8];
 		25: gem_tx_tx_r_data = checksum_ip[7:0];
 		endcase
 	end
 	if (checksum_l4_type == 2'b10) begin
-		case (tx_packet_byte_count_incr)
+		case (tx_data_byte_count_incr)
 		40: gem_tx_tx_r_data = checksum_l4[15:8];
 		41: gem_tx_tx_r_data = checksum_l4[7:0];
 		endcase
 	end
 	if (checksum_l4_type == 2'b01) begin
-		case (tx_packet_byte_count_incr)
+		case (tx_data_byte_count_incr)
 		50: gem_tx_tx_r_data = checksum_l4[15:8];
 		51: gem_tx_tx_r_data = checksum_l4[7:0];
 		endcase
 	end
+	if (digest_off != '0) begin
+		for (int k = 0; k < 4; k++) begin
+			if (TX_COOKIE_SIZE_WIDTH'(tx_data_byte_count_incr) == digest_off + TX_COOKIE_SIZE_WIDTH'(k)) begin
+				gem_tx_tx_r_data = digest[k*8 +: 8];
+			end
+		end
+	end
+	if (tx_in_tmpl) begin
+		// The first byte of a template word is in [31:24].
+		gem_tx_tx_r_data = tunnel_tmpl_word[{ ~tx_packet_byte_count_incr[1:0], 3'b000 } +: 8];
+		case (tx_packet_byte_count_incr)
+		16: gem_tx_tx_r_data = tunnel_ip_len[15:8];
+		17: gem_tx_tx_r_data = tunnel_ip_len[7:0];
+		24: gem_tx_tx_r_data = tunnel_ip_csum[15:8];
+		25: gem_tx_tx_r_data = tunnel_ip_csum[7:0];
+		38: gem_tx_tx_r_data = tunnel_udp_len[15:8];
+		39: gem_tx_tx_r_data = tunnel_udp_len[7:0];
+		40: gem_tx_tx_r_data = tunnel_udp_csum[15:8];
+		41: gem_tx_tx_r_data = tunnel_udp_csum[7:0];
+		endcase
+	end
+end
+
+/*
+ * ESP encryption of the outgoing bytes
+ */
+var logic [$bits(gem_tx.tx_r_data)-1:0] gem_tx_esp_data;
+if (USE_ESP_GCM) begin
+	wire logic tx_esp_valid = tx_state == TX_STATE_BUSY && gem_tx.tx_r_rd;
+	wire logic tx_esp_sof = tx_packet_byte_count_incr == '0;
+
+	prism_sp_esp_gcm #(
+		.ENCRYPT(1)
+	) prism_sp_esp_gcm_0 (
+		.clock(gem_tx.tx_clock),
+		.resetn(gem_tx.tx_resetn),
+
+		.sa_key(esp_sa_key),
+		.sa_salt(esp_sa_salt),
+		.sa_spi(esp_sa_spi),
+		.sa_control(esp_sa_control),
+
+		.tx_sa(esp_sa),
+
+		.h_valid(tx_esp_valid),
+		.h_sof(tx_esp_sof),
+		.h_data(gem_tx_esp_data),
+
+		.c_valid(tx_esp_valid),
+		.c_sof(tx_esp_sof),
+		.c_data(gem_tx_tx_r_data),
+		.c_out(gem_tx_esp_data),
+
+		.esp(),
+		.auth_err()
+	);
+end
+else begin
+	assign gem_tx_esp_data = gem_tx_tx_r_data;
 end
 `endif
 
@@ -92,20 +302,36 @@ always_ff @(posedge gem_tx.tx_clock) begin
 	gem_tx.tx_r_valid <= 1'b0;
 	tx_meta_fifo_r[0].rd_en <= 1'b0;
 	tx_csum_fifo_r[0].rd_en <= 1'b0;
+	tx_digest_fifo_r[0].rd_en <= 1'b0;
 	tx_data_fifo_r[0].rd_en <= 1'b0;
 
+	gem_tx.tx_r_err <= 1'b0;
+	gem_tx.tx_r_underflow <= 1'b0;
+
 	if (!gem_tx.tx_resetn) begin
 		gem_tx.tx_r_data_rdy <= 1'b0;
+		tx_state <= TX_STATE_IDLE;
+		tx_cut_through <= 1'b0;
+		tx_underflows[0] <= '0;
 	end
 	else begin
-		if (tx_state && gem_tx.tx_r_rd) begin
+		if (tx_state == TX_STATE_DRAIN) begin
+			if (tx_nwords_left == '0) begin
+				tx_state <= TX_STATE_IDLE;
+			end
+			else if (!tx_data_fifo_r[0].empty) begin
+				tx_data_fifo_r[0].rd_en <= 1'b1;
+				tx_nwords_left <= tx_nwords_left - 1;
+			end
+		end
+		if (tx_state == TX_STATE_BUSY && gem_tx.tx_r_rd) begin
 			// The FIFO interface requests a word of information.
 			gem_tx.tx_r_data_rdy <= 1'b0;
 			gem_tx.tx_r_valid <= 1'b1;
 			// Put the lower 8 bits from the TX buffer on the bus.
 `ifdef USE_CHECKSUM
 			// Hardcode checksum replacement here.
-			gem_tx.tx_r_data <= gem_tx_tx_r_data;
+			gem_tx.tx_r_data <= gem_tx_esp_data;
 `else
 			gem_tx.tx_r_data <= tx_cur_buf[7:0];
 `endif
@@ -117,38 +343,86 @@ always_ff @(posedge gem_tx.tx_clock) begin
 			gem_tx.tx_r_sop <= gem_tx.tx_r_data_rdy;
 			gem_tx.tx_r_eop <= tx_last_byte_comb;
 
-			// If the TX buffer will be completely invalid after this
-			// cycle, reload the buffer from the FWFT FIFO, pop the
-			// element from the FIFO and update the "valid" register.
-			if (tx_cur_buf_valid[0] && !tx_last_byte_comb) begin
-				tx_data_fifo_r[0].rd_en <= 1'b1;
-				tx_cur_buf <= tx_data_fifo_r[0].rd_data;
+			// The TX buffer is held while the tunnel template is sent.
+			if (!tx_in_tmpl) begin
+				// If the TX buffer will be completely invalid after this
+				// cycle, reload the buffer from the FWFT FIFO, pop the
+				// element from the FIFO and update the "valid" register.
+				if (tx_cur_buf_valid[0] && !tx_last_byte_comb) begin
+					if (tx_underflow_comb) begin
+						/*
+						 * We are in cut-through mode and the data for the
+						 * next byte has not arrived yet.
+						 * Abort the frame and discard its remaining data.
+						 */
+						gem_tx.tx_r_err <= 1'b1;
+						gem_tx.tx_r_underflow <= 1'b1;
+						gem_tx.tx_r_eop <= 1'b1;
+						tx_underflows[0] <= tx_underflows[0] + 1;
+						tx_state <= TX_STATE_DRAIN;
+					end
+					else begin
+						tx_data_fifo_r[0].rd_en <= 1'b1;
+						tx_cur_buf <= tx_data_fifo_r[0].rd_data;
+						tx_nwords_left <= tx_nwords_left - 1;
+					end
+				end
+				else begin
+					// Shift the TX buffer right by 8 bits.
+					tx_cur_buf <= { 8'h00, tx_cur_buf[tx_data_fifo_r[0].DATA_WIDTH-1:8] };
+				end
+				// Rotate the TX buffer valid bits right by 1 bit.
+				tx_cur_buf_valid <= { tx_cur_buf_valid[0], tx_cur_buf_valid[(tx_data_fifo_r[0].DATA_WIDTH/8)-1:1] };
 			end
-			else begin
-				// Shift the TX buffer right by 8 bits.
-				tx_cur_buf <= { 8'h00, tx_cur_buf[tx_data_fifo_r[0].DATA_WIDTH-1:8] };
+			if (tx_last_byte_comb) begin
+				tx_state <= TX_STATE_IDLE;
 			end
-			// Rotate the TX buffer valid bits right by 1 bit.
-			tx_cur_buf_valid <= { tx_cur_buf_valid[0], tx_cur_buf_valid[(tx_data_fifo_r[0].DATA_WIDTH/8)-1:1] };
-			tx_state <= ~tx_last_byte_comb;
 			tx_packet_byte_count_decr <= tx_packet_byte_count_decr - 1;
 			tx_packet_byte_count_incr <= tx_packet_byte_count_incr + 1;
 		end
 		/*
 		 * If there is a packet available.
 		 */
-		if ((~tx_state || (gem_tx.tx_r_rd && tx_last_byte_comb)) && !tx_meta_fifo_r[0].empty && !tx_csum_fifo_r[0].empty) begin
+		if ((tx_state == TX_STATE_IDLE || (tx_state == TX_STATE_BUSY && gem_tx.tx_r_rd && tx_last_byte_comb)) && tx_frame_ready_comb) begin
 			gem_tx.tx_r_data_rdy <= 1'b1;
-			tx_state <= 1'b1;
+			tx_state <= TX_STATE_BUSY;
+			tx_cut_through <= i_meta_desc.ct_size != '0;
+			tx_nwords_left <= i_meta_desc_nwords - 1;
 
 			tx_csum_fifo_r[0].rd_en <= 1'b1;
 			checksum_ip_type <= tx_csum_fifo_r[0].rd_data[0+:2];
 			checksum_ip <= tx_csum_fifo_r[0].rd_data[2+:16];
 			checksum_l4_type <= tx_csum_fifo_r[0].rd_data[2+16+:2];
-			checksum_l4 <= tx_csum_fifo_r[0].rd_data[2+16+2+:16];
+			if (tx_csum_fifo_r[0].rd_data[2+16+:2] != 2'b00 && i_digest_off != '0) begin
+				checksum_l4 <= digest_checksum(tx_csum_fifo_r[0].rd_data[2+16+2+:16], i_digest, i_digest_off);
+			end
+			else begin
+				checksum_l4 <= tx_csum_fifo_r[0].rd_data[2+16+2+:16];
+			end
+
+			tx_digest_fifo_r[0].rd_en <= 1'b1;
+			digest <= i_digest;
+			digest_off <= i_digest_off;
+			// Tunneled frames are not encrypted.
+			esp_sa <= i_tunnel ? '0 : i_meta_desc.esp_sa;
+
+			tunnel <= i_tunnel;
+			tunnel_queue <= i_meta_desc.queue;
+			tunnel_tmpl_len <= i_tunnel_tmpl_len;
+			tunnel_ip_len <= i_tunnel_ip_len;
+			tunnel_ip_csum <= ~csum_fold(20'(~i_tunnel_tmpl_ip_csum) + 20'(i_tunnel_ip_len));
+			tunnel_udp_len <= i_tunnel_udp_len;
+			if (i_tunnel_tmpl_udp_csum == '0 || i_frame_sum == '0 || i_digest_off != '0) begin
+				tunnel_udp_csum <= '0;
+			end
+			else begin
+				// A computed checksum of zero is sent as all ones.
+				tunnel_udp_csum <= i_tunnel_udp_csum == '0 ? '1 : i_tunnel_udp_csum;
+			end
 
 			tx_meta_fifo_r[0].rd_en <= 1'b1;
-			tx_packet_byte_count_decr <= i_meta_desc.size[TX_PACKET_BYTE_COUNT_WIDTH-1:0];
+			tx_packet_byte_count_decr <= i_meta_desc.size[TX_PACKET_BYTE_COUNT_WIDTH-1:0] +
+				(i_tunnel ? TX_PACKET_BYTE_COUNT_WIDTH'(i_tunnel_tmpl_len) : '0);
 			tx_packet_byte_count_incr <= '0;
 			gem_tx.tx_r_control <= i_meta_desc.nocrc;
 
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Free-running counters of the SP unit events (see SP_PERF_EVENT_*).
+ * Counter n is incremented in every clock cycle in which event n is set.
+ */
+module prism_sp_perf_counters #(
+	parameter int NEVENTS,
+	parameter int WIDTH
+) (
+	input wire logic clk,
+	input wire logic rst,
+
+	input wire logic [NEVENTS-1:0] events,
+	output var logic [WIDTH-1:0] counters [NEVENTS]
+);
+
+always_ff @(posedge clk) begin
+	if (rst) begin
+		for (int i = 0; i < NEVENTS; i++) begin
+			counters[i] <= '0;
+		end
+	end
+	else begin
+		for (int i = 0; i < NEVENTS; i++) begin
+			if (events[i]) begin
+				counters[i] <= counters[i] + 1;
+			end
+		end
+	end
+end
+
+endmodule
@@ -20,7 +20,9 @@ module prism_sp_processor
 	parameter int ACPBRAM_SIZE,
 	parameter int USE_SP_UNIT_RX,
 	parameter int USE_SP_UNIT_TX,
-	parameter int NPUZZLEFIFOS
+	parameter int NPUZZLEFIFOS,
+	// mhartid
+	parameter int HART_ID = 0
 )
 (
 	input wire logic clock,
@@ -34,14 +36,8 @@ module prism_sp_processor
 	local_memory_interface.slave data_bram_mmr,
 
 	// Interfaces used by the puzzle unit
-	fifo_read_interface.master puzzle_sw_fifo_r_0,
-	fifo_write_interface.master puzzle_sw_fifo_w_0,
-	fifo_read_interface.master puzzle_sw_fifo_r_1,
-	fifo_write_interface.master puzzle_sw_fifo_w_1,
-	fifo_read_interface.master puzzle_sw_fifo_r_2,
-	fifo_write_interface.master puzzle_sw_fifo_w_2,
-	fifo_read_interface.master puzzle_sw_fifo_r_3,
-	fifo_write_interface.master puzzle_sw_fifo_w_3,
+	fifo_read_interface.master puzzle_sw_fifo_r [NPUZZLEFIFOS],
+	fifo_write_interface.master puzzle_sw_fifo_w [NPUZZLEFIFOS],
 
 	// Interfaces used by the RX unit
 	memory_write_interface.master rx_data_mem_w,
@@ -57,6 +53,9 @@ module prism_sp_processor
 	mmr_trigger_interface.master mmr_t,
 	mmr_intr_interface.master mmr_i,
 
+	// Interface used by the HDR unit
+	header_window_interface.master hdr_w,
+
 	// Interfaces used by the ACP unit
 	axi_write_address_channel.master m_axi_acp_aw,
 	axi_write_channel.master m_axi_acp_w,
@@ -67,7 +66,9 @@ module prism_sp_processor
 	output trace_outputs_t trace_proc,
 	output trace_sp_unit_t trace_sp_unit,
 	output trace_sp_unit_rx_t trace_sp_unit_rx,
-	output trace_sp_unit_tx_t trace_sp_unit_tx
+	output trace_sp_unit_tx_t trace_sp_unit_tx,
+
+	output wire logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS]
 );
 	localparam int IBRAM_DATA_WIDTH = 32;
 	localparam int IBRAM_ADDR_WIDTH = $clog2(IBRAM_SIZE / (IBRAM_DATA_WIDTH/8));
@@ -99,7 +100,8 @@ module prism_sp_processor
 	taiga #(
 		.USE_SP_UNIT_TX(USE_SP_UNIT_TX),
 		.USE_SP_UNIT_RX(USE_SP_UNIT_RX),
-		.NPUZZLEFIFOS(NPUZZLEFIFOS)
+		.NPUZZLEFIFOS(NPUZZLEFIFOS),
+		.HART_ID(HART_ID)
 	) cpu(
 		.clk(clock),
 		.rst(cpu_reset),
@@ -121,14 +123,8 @@ module prism_sp_processor
 	 * ---- Begin SP unit signals
 	 */
 		// Puzzle
-		.puzzle_sw_fifo_r_0,
-		.puzzle_sw_fifo_w_0,
-		.puzzle_sw_fifo_r_1,
-		.puzzle_sw_fifo_w_1,
-		.puzzle_sw_fifo_r_2,
-		.puzzle_sw_fifo_w_2,
-		.puzzle_sw_fifo_r_3,
-		.puzzle_sw_fifo_w_3,
+		.puzzle_sw_fifo_r,
+		.puzzle_sw_fifo_w,
 
 		// Interfaces used by the RX unit
 		.rx_data_mem_w,
@@ -145,6 +141,9 @@ module prism_sp_processor
 		.mmr_t,
 		.mmr_i,
 
+		// HDR
+		.hdr_w,
+
 		// ACP
 		.m_axi_acp_aw,
 		.m_axi_acp_w,
@@ -153,7 +152,8 @@ module prism_sp_processor
 		.m_axi_acp_r,
 
 		// Trace
-		.trace_sp_unit
+		.trace_sp_unit,
+		.sp_perf_counters
 	/*
 	 * ---- End SP unit signals
 	 */
@@ -268,7 +268,7 @@ module prism_sp_processor
 		.MEMORY_INIT_PARAM("0"),
 		.MEMORY_OPTIMIZATION("true"),
 		.MEMORY_PRIMITIVE("auto"),
-		.MEMORY_SIZE(2*64*8),
+		.MEMORY_SIZE(ACPBRAM_SIZE),
 		.MESSAGE_CONTROL(0),
 		.READ_DATA_WIDTH_A(ACPBRAM_A_DATA_WIDTH),
 		.READ_DATA_WIDTH_B(ACPBRAM_B_DATA_WIDTH),
@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * NWORKERS processors that share one puzzle stage.
+ *
+ * The stage consists of the puzzle FIFO WORKER_FIFO_R, which is read by
+ * the processors, and the puzzle FIFO WORKER_FIFO_W, which is written by
+ * them. Its cookies are distributed by prism_sp_puzzle_worker_dispatch.
+ *
+ * All processors run the same firmware: writes to instruction_bram_mmr
+ * and data_bram_mmr go to the BRAMs of all processors, reads return the
+ * contents of the BRAMs of processor 0. Processor w reads w from mhartid.
+ * The IO bus is shared by all processors (see prism_sp_axi_io_arbiter),
+ * so all of them may access the UART and other peripherals.
+ * Processor 0 is connected to all other interfaces. The other processors
+ * only see the stage FIFOs, the read-only MMRs and the contents (but not
+ * the stores) of the read-write MMRs. Their firmware must not use the
+ * RX, TX, header window and ACP unit instructions, which would never
+ * complete, must neither initialize shared peripherals nor rely on MMR
+ * stores or triggers, and gets no interrupts. Work that needs these
+ * units therefore does not scale with NWORKERS: only processor 0 can
+ * do it.
+ *
+ * With NWORKERS=1, this is a single prism_sp_processor.
+ */
+module prism_sp_processor_pool
+#(
+	parameter int IBRAM_SIZE,
+	parameter int DBRAM_SIZE,
+	parameter int ACPBRAM_SIZE,
+	parameter int USE_SP_UNIT_RX,
+	parameter int USE_SP_UNIT_TX,
+	parameter int NPUZZLEFIFOS,
+	parameter int NWORKERS = 1,
+	parameter int WORKER_FIFO_R = 0,
+	parameter int WORKER_FIFO_W = 0,
+	parameter int DISPATCH_HASH_WORD = -1,
+	parameter int DISPATCH_EOF_BITN = -1
+)
+(
+	input wire logic clock,
+	input wire logic resetn,
+	input wire logic cpu_reset,
+
+	input wire logic [3:0] io_axi_axcache,
+	axi_interface.master m_axi_io,
+
+	local_memory_interface.slave instruction_bram_mmr,
+	local_memory_interface.slave data_bram_mmr,
+
+	// Interfaces used by the puzzle unit
+	fifo_read_interface.master puzzle_sw_fifo_r [NPUZZLEFIFOS],
+	fifo_write_interface.master puzzle_sw_fifo_w [NPUZZLEFIFOS],
+
+	// Interfaces used by the RX unit
+	memory_write_interface.master rx_data_mem_w,
+	fifo_read_interface.master rx_meta_fifo_r,
+	// Interfaces used by the TX unit
+	fifo_write_interface.inputs tx_data_fifo_w,
+	memory_read_interface.master tx_data_mem_r,
+	fifo_write_interface.master tx_meta_fifo_w,
+
+	// Interfaces used by the common unit
+	mmr_readwrite_interface.master mmr_rw,
+	mmr_read_interface.master mmr_r,
+	mmr_trigger_interface.master mmr_t,
+	mmr_intr_interface.master mmr_i,
+
+	// Interface used by the HDR unit
+	header_window_interface.master hdr_w,
+
+	// Interfaces used by the ACP unit
+	axi_write_address_channel.master m_axi_acp_aw,
+	axi_write_channel.master m_axi_acp_w,
+	axi_write_response_channel.master m_axi_acp_b,
+	axi_read_address_channel.master m_axi_acp_ar,
+	axi_read_channel.master m_axi_acp_r,
+
+	output trace_outputs_t trace_proc,
+	output trace_sp_unit_t trace_sp_unit,
+	output trace_sp_unit_rx_t trace_sp_unit_rx,
+	output trace_sp_unit_tx_t trace_sp_unit_tx,
+
+	// The event counters of processor 0
+	output wire logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS]
+);
+
+if (NWORKERS > 1 &&
+	!(puzzle_sw_fifo_r_enabled(USE_SP_UNIT_RX, WORKER_FIFO_R) &&
+	puzzle_sw_fifo_w_enabled(USE_SP_UNIT_RX, WORKER_FIFO_W)))
+begin
+	$fatal("WORKER_FIFO_R=%d and WORKER_FIFO_W=%d must be software FIFOs.\n",
+		WORKER_FIFO_R, WORKER_FIFO_W);
+end
+
+localparam int FIFO_DATA_WIDTH = puzzle_sw_fifo_r[0].DATA_WIDTH;
+localparam int FIFO_DATA_COUNT_WIDTH = puzzle_sw_fifo_r[0].DATA_COUNT_WIDTH;
+
+/*
+ * The worker side of the stage FIFOs
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+) stage_fifo_r [NWORKERS] ();
+fifo_write_interface #(
+	.DATA_WIDTH(FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+) stage_fifo_w [NWORKERS] ();
+
+if (NWORKERS > 1) begin
+	prism_sp_puzzle_worker_dispatch #(
+		.NWORKERS(NWORKERS),
+		.HASH_WORD(DISPATCH_HASH_WORD),
+		.EOF_BITN(DISPATCH_EOF_BITN)
+	) prism_sp_puzzle_worker_dispatch_0 (
+		.clock,
+		.resetn,
+
+		.m_fifo_r(puzzle_sw_fifo_r[WORKER_FIFO_R]),
+		.m_fifo_w(puzzle_sw_fifo_w[WORKER_FIFO_W]),
+
+		.s_fifo_r(stage_fifo_r),
+		.s_fifo_w(stage_fifo_w)
+	);
+end
+
+/*
+ * The IO bus
+ */
+axi_interface #(
+	.C_M_AXI_ADDR_WIDTH(m_axi_io.C_M_AXI_ADDR_WIDTH),
+	.C_M_AXI_DATA_WIDTH(m_axi_io.C_M_AXI_DATA_WIDTH)
+) worker_m_axi_io [NWORKERS] ();
+
+if (NWORKERS > 1) begin
+	prism_sp_axi_io_arbiter #(
+		.NPORTS(NWORKERS)
+	) prism_sp_axi_io_arbiter_0 (
+		.clock,
+		.resetn,
+
+		.s_axi_io(worker_m_axi_io),
+		.m_axi_io
+	);
+end
+else begin
+	axi_interface_connect axi_interface_connect_0(.m(m_axi_io), .s(worker_m_axi_io[0]));
+end
+
+/*
+ * Processor 0
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+) worker_0_fifo_r [NPUZZLEFIFOS] ();
+fifo_write_interface #(
+	.DATA_WIDTH(FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+) worker_0_fifo_w [NPUZZLEFIFOS] ();
+
+for (genvar i = 0; i < NPUZZLEFIFOS; i++) begin
+	if (NWORKERS > 1 && i == WORKER_FIFO_R) begin
+		fifo_read_interface_connect fifo_read_interface_connect_0(.m(stage_fifo_r[0]), .s(worker_0_fifo_r[i]));
+	end
+	else begin
+		fifo_read_interface_connect fifo_read_interface_connect_0(.m(puzzle_sw_fifo_r[i]), .s(worker_0_fifo_r[i]));
+	end
+
+	if (NWORKERS > 1 && i == WORKER_FIFO_W) begin
+		fifo_write_interface_connect fifo_write_interface_connect_0(.m(stage_fifo_w[0]), .s(worker_0_fifo_w[i]));
+	end
+	else begin
+		fifo_write_interface_connect fifo_write_interface_connect_0(.m(puzzle_sw_fifo_w[i]), .s(worker_0_fifo_w[i]));
+	end
+end
+
+prism_sp_processor #(
+	.IBRAM_SIZE(IBRAM_SIZE),
+	.DBRAM_SIZE(DBRAM_SIZE),
+	.ACPBRAM_SIZE(ACPBRAM_SIZE),
+	.USE_SP_UNIT_RX(USE_SP_UNIT_RX),
+	.USE_SP_UNIT_TX(USE_SP_UNIT_TX),
+	.NPUZZLEFIFOS(NPUZZLEFIFOS),
+	.HART_ID(0)
+) prism_sp_processor_0(
+	.clock,
+	.resetn,
+	.cpu_reset,
+
+	.io_axi_axcache,
+	.m_axi_io(worker_m_axi_io[0]),
+	.instruction_bram_mmr,
+	.data_bram_mmr,
+
+	.puzzle_sw_fifo_r(worker_0_fifo_r),
+	.puzzle_sw_fifo_w(worker_0_fifo_w),
+
+	// Interfaces used by the RX unit
+	.rx_data_mem_w,
+	.rx_meta_fifo_r,
+	// Interfaces used by the TX unit
+	.tx_data_fifo_w,
+	.tx_data_mem_r,
+	.tx_meta_fifo_w,
+
+	// Interfaces used by the common unit
+	.mmr_rw,
+	.mmr_r,
+	.mmr_t,
+	.mmr_i,
+
+	// Interface used by the HDR unit
+	.hdr_w,
+
+	// Interfaces used by the ACP unit
+	.m_axi_acp_aw,
+	.m_axi_acp_w,
+	.m_axi_acp_b,
+	.m_axi_acp_ar,
+	.m_axi_acp_r,
+
+	.trace_proc,
+	.trace_sp_unit,
+	.trace_sp_unit_rx,
+	.trace_sp_unit_tx,
+	.sp_perf_counters
+);
+
+/*
+ * Processors 1 to NWORKERS-1
+ */
+for (genvar w = 1; w < NWORKERS; w++) begin : worker
+	fifo_read_interface #(
+		.DATA_WIDTH(FIFO_DATA_WIDTH),
+		.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+	) fifo_r [NPUZZLEFIFOS] ();
+	fifo_write_interface #(
+		.DATA_WIDTH(FIFO_DATA_WIDTH),
+		.DATA_COUNT_WIDTH(FIFO_DATA_COUNT_WIDTH)
+	) fifo_w [NPUZZLEFIFOS] ();
+
+	for (genvar i = 0; i < NPUZZLEFIFOS; i++) begin
+		if (i == WORKER_FIFO_R) begin
+			fifo_read_interface_connect fifo_read_interface_connect_0(.m(stage_fifo_r[w]), .s(fifo_r[i]));
+		end
+		else begin
+			// All other FIFOs belong to processor 0.
+			assign fifo_r[i].rd_data = '0;
+			assign fifo_r[i].empty = 1'b1;
+			assign fifo_r[i].almost_empty = 1'b1;
+			assign fifo_r[i].rd_data_count = '0;
+		end
+
+		if (i == WORKER_FIFO_W) begin
+			fifo_write_interface_connect fifo_write_interface_connect_0(.m(stage_fifo_w[w]), .s(fifo_w[i]));
+		end
+		else begin
+			assign fifo_w[i].full = 1'b1;
+			assign fifo_w[i].almost_full = 1'b1;
+			assign fifo_w[i].wr_data_count = '0;
+		end
+	end
+
+	/*
+	 * The firmware is written to all processors.
+	 */
+	local_memory_interface instruction_bram_mmr_w();
+	local_memory_interface data_bram_mmr_w();
+	assign instruction_bram_mmr_w.addr = instruction_bram_mmr.addr;
+	assign instruction_bram_mmr_w.en = instruction_bram_mmr.en;
+	assign instruction_bram_mmr_w.be = instruction_bram_mmr.be;
+	assign instruction_bram_mmr_w.data_in = instruction_bram_mmr.data_in;
+	assign data_bram_mmr_w.addr = data_bram_mmr.addr;
+	assign data_bram_mmr_w.en = data_bram_mmr.en;
+	assign data_bram_mmr_w.be = data_bram_mmr.be;
+	assign data_bram_mmr_w.data_in = data_bram_mmr.data_in;
+
+	/*
+	 * The read-write MMRs may be read but not written.
+	 */
+	mmr_readwrite_interface #(.NREGS(mmr_rw.NREGS)) dummy_mmr_rw();
+	assign dummy_mmr_rw.data = mmr_rw.data;
+
+	mmr_trigger_interface #(.N(mmr_t.N), .WIDTH(mmr_t.WIDTH)) dummy_mmr_t();
+	mmr_intr_interface #(.N(mmr_i.N), .WIDTH(mmr_i.WIDTH)) dummy_mmr_i();
+
+	/*
+	 * Only the main processor owns the header window.
+	 */
+	header_window_interface dummy_hdr_w();
+	assign dummy_hdr_w.busy = 1'b0;
+	assign dummy_hdr_w.loading = 1'b0;
+	assign dummy_hdr_w.peek_data = '0;
+
+	memory_write_interface #(
+		.DATA_WIDTH(0),
+		.ADDR_WIDTH(0)
+	) dummy_rx_data_mem_w();
+	fifo_read_interface #(
+		.DATA_WIDTH(0),
+		.DATA_COUNT_WIDTH(0)
+	) dummy_rx_meta_fifo_r();
+	fifo_write_interface #(
+		.DATA_WIDTH(0),
+		.DATA_COUNT_WIDTH(0)
+	) dummy_tx_data_fifo_w();
+	memory_read_interface #(
+		.DATA_WIDTH(0),
+		.ADDR_WIDTH(0)
+	) dummy_tx_data_mem_r();
+	fifo_write_interface #(
+		.DATA_WIDTH(0),
+		.DATA_COUNT_WIDTH(0)
+	) dummy_tx_meta_fifo_w();
+
+	axi_write_address_channel #(
+		.AXI_AWID_WIDTH(m_axi_acp_aw.AXI_AWID_WIDTH),
+		.AXI_AWADDR_WIDTH(m_axi_acp_aw.AXI_AWADDR_WIDTH),
+		.AXI_AWUSER_WIDTH(m_axi_acp_aw.AXI_AWUSER_WIDTH)
+	) dummy_m_axi_acp_aw();
+	axi_write_channel #(
+		.AXI_WDATA_WIDTH(m_axi_acp_w.AXI_WDATA_WIDTH),
+		.AXI_WUSER_WIDTH(m_axi_acp_w.AXI_WUSER_WIDTH)
+	) dummy_m_axi_acp_w();
+	axi_write_response_channel #(
+		.AXI_BID_WIDTH(m_axi_acp_b.AXI_BID_WIDTH),
+		.AXI_BUSER_WIDTH(m_axi_acp_b.AXI_BUSER_WIDTH)
+	) dummy_m_axi_acp_b();
+	axi_read_address_channel #(
+		.AXI_ARID_WIDTH(m_axi_acp_ar.AXI_ARID_WIDTH),
+		.AXI_ARADDR_WIDTH(m_axi_acp_ar.AXI_ARADDR_WIDTH),
+		.AXI_ARUSER_WIDTH(m_axi_acp_ar.AXI_ARUSER_WIDTH)
+	) dummy_m_axi_acp_ar();
+	axi_read_channel #(
+		.AXI_RID_WIDTH(m_axi_acp_r.AXI_RID_WIDTH),
+		.AXI_RDATA_WIDTH(m_axi_acp_r.AXI_RDATA_WIDTH),
+		.AXI_RUSER_WIDTH(m_axi_acp_r.AXI_RUSER_WIDTH)
+	) dummy_m_axi_acp_r();
+
+	var trace_outputs_t dummy_trace_proc;
+	var trace_sp_unit_t dummy_trace_sp_unit;
+	var trace_sp_unit_rx_t dummy_trace_sp_unit_rx;
+	var trace_sp_unit_tx_t dummy_trace_sp_unit_tx;
+	wire logic [COUNTER_W-1:0] dummy_sp_perf_counters [SP_NPERF_EVENTS];
+
+	prism_sp_processor #(
+		.IBRAM_SIZE(IBRAM_SIZE),
+		.DBRAM_SIZE(DBRAM_SIZE),
+		.ACPBRAM_SIZE(ACPBRAM_SIZE),
+		.USE_SP_UNIT_RX(USE_SP_UNIT_RX),
+		.USE_SP_UNIT_TX(USE_SP_UNIT_TX),
+		.NPUZZLEFIFOS(NPUZZLEFIFOS),
+		.HART_ID(w)
+	) prism_sp_processor_0(
+		.clock,
+		.resetn,
+		.cpu_reset,
+
+		.io_axi_axcache,
+		.m_axi_io(worker_m_axi_io[w]),
+		.instruction_bram_mmr(instruction_bram_mmr_w),
+		.data_bram_mmr(data_bram_mmr_w),
+
+		.puzzle_sw_fifo_r(fifo_r),
+		.puzzle_sw_fifo_w(fifo_w),
+
+		// Interfaces used by the RX unit
+		.rx_data_mem_w(dummy_rx_data_mem_w),
+		.rx_meta_fifo_r(dummy_rx_meta_fifo_r),
+		// Interfaces used by the TX unit
+		.tx_data_fifo_w(dummy_tx_data_fifo_w),
+		.tx_data_mem_r(dummy_tx_data_mem_r),
+		.tx_meta_fifo_w(dummy_tx_meta_fifo_w),
+
+		// Interfaces used by the common unit
+		.mmr_rw(dummy_mmr_rw),
+		.mmr_r,
+		.mmr_t(dummy_mmr_t),
+		.mmr_i(dummy_mmr_i),
+
+		// Interface used by the HDR unit
+		.hdr_w(dummy_hdr_w),
+
+		// Interfaces used by the ACP unit
+		.m_axi_acp_aw(dummy_m_axi_acp_aw),
+		.m_axi_acp_w(dummy_m_axi_acp_w),
+		.m_axi_acp_b(dummy_m_axi_acp_b),
+		.m_axi_acp_ar(dummy_m_axi_acp_ar),
+		.m_axi_acp_r(dummy_m_axi_acp_r),
+
+		.trace_proc(dummy_trace_proc),
+		.trace_sp_unit(dummy_trace_sp_unit),
+		.trace_sp_unit_rx(dummy_trace_sp_unit_rx),
+		.trace_sp_unit_tx(dummy_trace_sp_unit_tx),
+		.sp_perf_counters(dummy_sp_perf_counters)
+	);
+end
+
+endmodule
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Hardware bypass around the software stage between two puzzle FIFOs.
+ *
+ * The cookie at the head of m_fifo_r is diverted to the software
+ * (s_fifo_r) if the bypass is disabled or if
+ *   (cookie word 'word' & mask) == match.
+ * All other cookies are moved from m_fifo_r to m_fifo_w directly, one
+ * per clock cycle.
+ *
+ * The order of the cookies is kept per key, which is the KEY_WIDTH bits
+ * at key_shift of cookie word 'key_word' (e.g., the TX ring of a cookie).
+ * A cookie is only bypassed while no diverted cookie with the same key
+ * is outstanding, i.e., the software has pushed one cookie to s_fifo_w
+ * for every cookie of that key it has popped from s_fifo_r. Cookies of
+ * other keys may overtake diverted ones. Without key_enable, all cookies
+ * have the same key and keep their order.
+ * The software therefore must push exactly one cookie per popped cookie
+ * and must not change the key bits.
+ */
+module prism_sp_puzzle_fifo_bypass
+(
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] word,
+	input wire logic [31:0] mask,
+	input wire logic [31:0] match,
+	input wire logic key_enable,
+	input wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] key_word,
+	input wire logic [4:0] key_shift,
+
+	fifo_read_interface.master m_fifo_r,
+	fifo_write_interface.master m_fifo_w,
+	fifo_read_interface.slave s_fifo_r,
+	fifo_write_interface.slave s_fifo_w
+);
+
+localparam int NWORDS = (m_fifo_r.DATA_WIDTH + 31) / 32;
+localparam int OUTSTANDING_WIDTH = m_fifo_r.DATA_COUNT_WIDTH + 1;
+localparam int KEY_WIDTH = PUZZLE_BYPASS_KEY_WIDTH;
+localparam int NKEYS = 2**KEY_WIDTH;
+
+function automatic logic [31:0] cookie_word(
+	input logic [32*NWORDS-1:0] cookie,
+	input logic [BYPASS_CONTROL_WORD_WIDTH-1:0] n
+);
+	logic [31:0] w;
+
+	w = '0;
+	for (int i = 0; i < NWORDS; i++) begin
+		if (n == i) begin
+			w = cookie[32*i +: 32];
+		end
+	end
+	return w;
+endfunction
+
+function automatic logic [KEY_WIDTH-1:0] cookie_key(
+	input logic [32*NWORDS-1:0] cookie,
+	input logic enable,
+	input logic [BYPASS_CONTROL_WORD_WIDTH-1:0] n,
+	input logic [4:0] shift
+);
+	return enable ? KEY_WIDTH'(cookie_word(cookie, n) >> shift) : '0;
+endfunction
+
+wire logic [32*NWORDS-1:0] head = (32*NWORDS)'(m_fifo_r.rd_data);
+wire logic [32*NWORDS-1:0] pushed = (32*NWORDS)'(s_fifo_w.wr_data);
+wire logic [31:0] head_word = cookie_word(head, word);
+wire logic [KEY_WIDTH-1:0] head_key = cookie_key(head, key_enable, key_word, key_shift);
+wire logic [KEY_WIDTH-1:0] pushed_key = cookie_key(pushed, key_enable, key_word, key_shift);
+
+wire logic divert = !enable || (head_word & mask) == match;
+
+// The number of cookies of each key the software has popped but not yet
+// pushed.
+var logic [OUTSTANDING_WIDTH-1:0] outstanding [NKEYS];
+
+/*
+ * The input FIFO is first-word fall-through, so the head cookie is
+ * popped and written in the same clock cycle. A software push always
+ * wins. A bypassed cookie waits in that case.
+ */
+wire logic bypass_pop = !m_fifo_r.empty && !divert && outstanding[head_key] == 0 &&
+	!s_fifo_w.wr_en && !m_fifo_w.full;
+
+assign m_fifo_r.clock = s_fifo_r.clock;
+assign m_fifo_r.reset = s_fifo_r.reset;
+assign m_fifo_r.rd_en = s_fifo_r.rd_en | bypass_pop;
+assign s_fifo_r.rd_data = m_fifo_r.rd_data;
+assign s_fifo_r.empty = m_fifo_r.empty || !divert;
+assign s_fifo_r.almost_empty = m_fifo_r.almost_empty || !divert;
+assign s_fifo_r.rd_data_count = s_fifo_r.empty ? '0 : m_fifo_r.rd_data_count;
+
+assign m_fifo_w.clock = s_fifo_w.clock;
+assign m_fifo_w.reset = s_fifo_w.reset;
+assign m_fifo_w.wr_en = s_fifo_w.wr_en | bypass_pop;
+assign m_fifo_w.wr_data = s_fifo_w.wr_en ? s_fifo_w.wr_data : m_fifo_w.DATA_WIDTH'(m_fifo_r.rd_data);
+assign s_fifo_w.full = m_fifo_w.full;
+assign s_fifo_w.almost_full = m_fifo_w.almost_full;
+assign s_fifo_w.wr_data_count = m_fifo_w.wr_data_count;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		outstanding <= '{default: '0};
+	end
+	else begin
+		for (int k = 0; k < NKEYS; k++) begin
+			if (s_fifo_r.rd_en && head_key == k &&
+				!(s_fifo_w.wr_en && pushed_key == k))
+			begin
+				outstanding[k] <= outstanding[k] + 1;
+			end
+			else if (!(s_fifo_r.rd_en && head_key == k) &&
+				s_fifo_w.wr_en && pushed_key == k && outstanding[k] != 0)
+			begin
+				outstanding[k] <= outstanding[k] - 1;
+			end
+		end
+	end
+end
+
+endmodule
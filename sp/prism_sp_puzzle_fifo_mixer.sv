@@ -23,88 +23,68 @@ module prism_sp_puzzle_fifo_mixer
 	input wire logic clock,
 	input wire logic resetn,
 
-	fifo_read_interface.slave puzzle_hw_fifo_r_0,
-	fifo_write_interface.slave puzzle_hw_fifo_w_0,
-	fifo_read_interface.slave puzzle_hw_fifo_r_1,
-	fifo_write_interface.slave puzzle_hw_fifo_w_1,
-	fifo_read_interface.slave puzzle_hw_fifo_r_2,
-	fifo_write_interface.slave puzzle_hw_fifo_w_2,
-	fifo_read_interface.slave puzzle_hw_fifo_r_3,
-	fifo_write_interface.slave puzzle_hw_fifo_w_3,
+	input wire logic bypass_enable,
+	input wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_word,
+	input wire logic [31:0] bypass_mask,
+	input wire logic [31:0] bypass_match,
+	input wire logic bypass_key_enable,
+	input wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_key_word,
+	input wire logic [4:0] bypass_key_shift,
 
-	fifo_read_interface.slave puzzle_sw_fifo_r_0,
-	fifo_write_interface.slave puzzle_sw_fifo_w_0,
-	fifo_read_interface.slave puzzle_sw_fifo_r_1,
-	fifo_write_interface.slave puzzle_sw_fifo_w_1,
-	fifo_read_interface.slave puzzle_sw_fifo_r_2,
-	fifo_write_interface.slave puzzle_sw_fifo_w_2,
-	fifo_read_interface.slave puzzle_sw_fifo_r_3,
-	fifo_write_interface.slave puzzle_sw_fifo_w_3,
+	fifo_read_interface.slave puzzle_hw_fifo_r [NFIFOS],
+	fifo_write_interface.slave puzzle_hw_fifo_w [NFIFOS],
 
-	fifo_read_interface.master puzzle_fifo_r_0,
-	fifo_write_interface.master puzzle_fifo_w_0,
-	fifo_read_interface.master puzzle_fifo_r_1,
-	fifo_write_interface.master puzzle_fifo_w_1,
-	fifo_read_interface.master puzzle_fifo_r_2,
-	fifo_write_interface.master puzzle_fifo_w_2,
-	fifo_read_interface.master puzzle_fifo_r_3,
-	fifo_write_interface.master puzzle_fifo_w_3
-);
+	fifo_read_interface.slave puzzle_sw_fifo_r [NFIFOS],
+	fifo_write_interface.slave puzzle_sw_fifo_w [NFIFOS],
 
-if (ENABLE_PUZZLE_FIFO_R[0] == 0) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_0), .s(puzzle_hw_fifo_r_0));
-end
-else if (ENABLE_PUZZLE_FIFO_R[0] == 1) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_0), .s(puzzle_sw_fifo_r_0));
-end
-
-if (ENABLE_PUZZLE_FIFO_W[0] == 0) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_0), .s(puzzle_hw_fifo_w_0));
-end
-else if (ENABLE_PUZZLE_FIFO_W[0] == 1) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_0), .s(puzzle_sw_fifo_w_0));
-end
+	fifo_read_interface.master puzzle_fifo_r [NFIFOS],
+	fifo_write_interface.master puzzle_fifo_w [NFIFOS]
+);
 
-if (ENABLE_PUZZLE_FIFO_R[1] == 0) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_1), .s(puzzle_hw_fifo_r_1));
-end
-else if (ENABLE_PUZZLE_FIFO_R[1] == 1) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_1), .s(puzzle_sw_fifo_r_1));
-end
+/*
+ * FIFO n and FIFO n+1 are bridged by a hardware bypass if the software
+ * reads the one and writes the other.
+ */
+function automatic int bypass(int n);
+	return USE_PUZZLE_BYPASS && n >= 0 && n < NFIFOS - 1 &&
+		ENABLE_PUZZLE_FIFO_R[n] == 1 && ENABLE_PUZZLE_FIFO_W[n+1] == 1;
+endfunction
 
-if (ENABLE_PUZZLE_FIFO_W[1] == 0) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_1), .s(puzzle_hw_fifo_w_1));
-end
-else if (ENABLE_PUZZLE_FIFO_W[1] == 1) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_1), .s(puzzle_sw_fifo_w_1));
-end
+for (genvar n = 0; n < NFIFOS; n++) begin : puzzle_fifo
+	if (ENABLE_PUZZLE_FIFO_R[n] == 0) begin
+		fifo_read_interface_connect fifo_read_interface_connect_0(.m(puzzle_fifo_r[n]), .s(puzzle_hw_fifo_r[n]));
+	end
+	else if (ENABLE_PUZZLE_FIFO_R[n] == 1 && !bypass(n)) begin
+		fifo_read_interface_connect fifo_read_interface_connect_0(.m(puzzle_fifo_r[n]), .s(puzzle_sw_fifo_r[n]));
+	end
 
-if (ENABLE_PUZZLE_FIFO_R[2] == 0) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_2), .s(puzzle_hw_fifo_r_2));
-end
-else if (ENABLE_PUZZLE_FIFO_R[2] == 1) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_2), .s(puzzle_sw_fifo_r_2));
-end
+	if (ENABLE_PUZZLE_FIFO_W[n] == 0) begin
+		fifo_write_interface_connect fifo_write_interface_connect_0(.m(puzzle_fifo_w[n]), .s(puzzle_hw_fifo_w[n]));
+	end
+	else if (ENABLE_PUZZLE_FIFO_W[n] == 1 && !bypass(n-1)) begin
+		fifo_write_interface_connect fifo_write_interface_connect_0(.m(puzzle_fifo_w[n]), .s(puzzle_sw_fifo_w[n]));
+	end
 
-if (ENABLE_PUZZLE_FIFO_W[2] == 0) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_2), .s(puzzle_hw_fifo_w_2));
-end
-else if (ENABLE_PUZZLE_FIFO_W[2] == 1) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_2), .s(puzzle_sw_fifo_w_2));
-end
+	if (bypass(n)) begin
+		prism_sp_puzzle_fifo_bypass
+		prism_sp_puzzle_fifo_bypass_0 (
+			.clock,
+			.resetn,
 
-if (ENABLE_PUZZLE_FIFO_R[3] == 0) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_3), .s(puzzle_hw_fifo_r_3));
-end
-else if (ENABLE_PUZZLE_FIFO_R[3] == 1) begin
-	fifo_read_interface_connect(.m(puzzle_fifo_r_3), .s(puzzle_sw_fifo_r_3));
-end
+			.enable(bypass_enable),
+			.word(bypass_word),
+			.mask(bypass_mask),
+			.match(bypass_match),
+			.key_enable(bypass_key_enable),
+			.key_word(bypass_key_word),
+			.key_shift(bypass_key_shift),
 
-if (ENABLE_PUZZLE_FIFO_W[3] == 0) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_3), .s(puzzle_hw_fifo_w_3));
-end
-else if (ENABLE_PUZZLE_FIFO_W[3] == 1) begin
-	fifo_write_interface_connect(.m(puzzle_fifo_w_3), .s(puzzle_sw_fifo_w_3));
+			.m_fifo_r(puzzle_fifo_r[n]),
+			.m_fifo_w(puzzle_fifo_w[n+1]),
+			.s_fifo_r(puzzle_sw_fifo_r[n]),
+			.s_fifo_w(puzzle_sw_fifo_w[n+1])
+		);
+	end
 end
 
 endmodule
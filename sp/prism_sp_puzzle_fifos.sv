@@ -13,159 +13,72 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+/*
+ * The puzzle FIFOs of one core.
+ *
+ * All interfaces share the width of the widest FIFO. FIFO i only stores
+ * the lower FIFO_W_DATA_WIDTH[i] bits and returns FIFO_R_DATA_WIDTH[i]
+ * bits; the upper bits of rd_data and the data counts read as zero.
+ */
 module prism_sp_puzzle_fifos
 #(
 	parameter int NFIFOS,
-	parameter int FIFO_WRITE_DEPTH [NFIFOS]
+	parameter int FIFO_WRITE_DEPTH [NFIFOS],
+	parameter int FIFO_R_DATA_WIDTH [NFIFOS],
+	parameter int FIFO_W_DATA_WIDTH [NFIFOS],
+	parameter int FIFO_R_DATA_COUNT_WIDTH [NFIFOS],
+	parameter int FIFO_W_DATA_COUNT_WIDTH [NFIFOS]
 )
 (
 	input wire logic clock,
 	input wire logic resetn,
 
-	fifo_read_interface.slave fifo_r_0,
-	fifo_write_interface.slave fifo_w_0,
-	fifo_read_interface.slave fifo_r_1,
-	fifo_write_interface.slave fifo_w_1,
-	fifo_read_interface.slave fifo_r_2,
-	fifo_write_interface.slave fifo_w_2,
-	fifo_read_interface.slave fifo_r_3,
-	fifo_write_interface.slave fifo_w_3
-);
-
-xpm_fifo_sync #(
-	.DOUT_RESET_VALUE("0"),
-	.ECC_MODE("no_ecc"),
-	.FIFO_MEMORY_TYPE("auto"),
-	.FIFO_READ_LATENCY(0),
-	.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH[0]),
-	.FULL_RESET_VALUE(0),
-	.PROG_EMPTY_THRESH(10),
-	.PROG_FULL_THRESH(10),
-	.RD_DATA_COUNT_WIDTH(fifo_r_0.DATA_COUNT_WIDTH),
-	.READ_DATA_WIDTH(fifo_r_0.DATA_WIDTH),
-	.READ_MODE("fwft"),
-	.SIM_ASSERT_CHK(0),
-	.USE_ADV_FEATURES("0707"),
-	.WAKEUP_TIME(0),
-	.WR_DATA_COUNT_WIDTH(fifo_w_0.DATA_COUNT_WIDTH),
-	.WRITE_DATA_WIDTH(fifo_w_0.DATA_WIDTH)
-) fifo_0 (
-	.rst(~resetn),
-
-	.wr_clk(clock),
-	.wr_en(fifo_w_0.wr_en),
-	.din(fifo_w_0.wr_data),
-	.full(fifo_w_0.full),
-	.almost_full(fifo_w_0.almost_full),
-	.wr_data_count(fifo_w_0.wr_data_count),
-
-	.rd_en(fifo_r_0.rd_en),
-	.dout(fifo_r_0.rd_data),
-	.empty(fifo_r_0.empty),
-	.almost_empty(fifo_r_0.almost_empty),
-	.rd_data_count(fifo_r_0.rd_data_count)
+	fifo_read_interface.slave fifo_r [NFIFOS],
+	fifo_write_interface.slave fifo_w [NFIFOS]
 );
 
-xpm_fifo_sync #(
-	.DOUT_RESET_VALUE("0"),
-	.ECC_MODE("no_ecc"),
-	.FIFO_MEMORY_TYPE("auto"),
-	.FIFO_READ_LATENCY(0),
-	.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH[1]),
-	.FULL_RESET_VALUE(0),
-	.PROG_EMPTY_THRESH(10),
-	.PROG_FULL_THRESH(10),
-	.RD_DATA_COUNT_WIDTH(fifo_r_1.DATA_COUNT_WIDTH),
-	.READ_DATA_WIDTH(fifo_r_1.DATA_WIDTH),
-	.READ_MODE("fwft"),
-	.SIM_ASSERT_CHK(0),
-	.USE_ADV_FEATURES("0707"),
-	.WAKEUP_TIME(0),
-	.WR_DATA_COUNT_WIDTH(fifo_w_1.DATA_COUNT_WIDTH),
-	.WRITE_DATA_WIDTH(fifo_w_1.DATA_WIDTH)
-) fifo_1 (
-	.rst(~resetn),
+for (genvar i = 0; i < NFIFOS; i++) begin : puzzle_fifo
+	wire logic [FIFO_R_DATA_WIDTH[i]-1:0] rd_data;
+	wire logic [FIFO_R_DATA_COUNT_WIDTH[i]-1:0] rd_data_count;
+	wire logic [FIFO_W_DATA_COUNT_WIDTH[i]-1:0] wr_data_count;
 
-	.wr_clk(clock),
-	.wr_en(fifo_w_1.wr_en),
-	.din(fifo_w_1.wr_data),
-	.full(fifo_w_1.full),
-	.almost_full(fifo_w_1.almost_full),
-	.wr_data_count(fifo_w_1.wr_data_count),
+	assign fifo_r[i].rd_data = rd_data;
+	assign fifo_r[i].rd_data_count = rd_data_count;
+	assign fifo_w[i].wr_data_count = wr_data_count;
 
-	.rd_en(fifo_r_1.rd_en),
-	.dout(fifo_r_1.rd_data),
-	.empty(fifo_r_1.empty),
-	.almost_empty(fifo_r_1.almost_empty),
-	.rd_data_count(fifo_r_1.rd_data_count)
-);
-
-xpm_fifo_sync #(
-	.DOUT_RESET_VALUE("0"),
-	.ECC_MODE("no_ecc"),
-	.FIFO_MEMORY_TYPE("auto"),
-	.FIFO_READ_LATENCY(0),
-	.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH[2]),
-	.FULL_RESET_VALUE(0),
-	.PROG_EMPTY_THRESH(10),
-	.PROG_FULL_THRESH(10),
-	.RD_DATA_COUNT_WIDTH(fifo_r_2.DATA_COUNT_WIDTH),
-	.READ_DATA_WIDTH(fifo_r_2.DATA_WIDTH),
-	.READ_MODE("fwft"),
-	.SIM_ASSERT_CHK(0),
-	.USE_ADV_FEATURES("0707"),
-	.WAKEUP_TIME(0),
-	.WR_DATA_COUNT_WIDTH(fifo_w_2.DATA_COUNT_WIDTH),
-	.WRITE_DATA_WIDTH(fifo_w_2.DATA_WIDTH)
-) fifo_2 (
-	.rst(~resetn),
+	xpm_fifo_sync #(
+		.DOUT_RESET_VALUE("0"),
+		.ECC_MODE("no_ecc"),
+		.FIFO_MEMORY_TYPE("auto"),
+		.FIFO_READ_LATENCY(0),
+		.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH[i]),
+		.FULL_RESET_VALUE(0),
+		.PROG_EMPTY_THRESH(10),
+		.PROG_FULL_THRESH(10),
+		.RD_DATA_COUNT_WIDTH(FIFO_R_DATA_COUNT_WIDTH[i]),
+		.READ_DATA_WIDTH(FIFO_R_DATA_WIDTH[i]),
+		.READ_MODE("fwft"),
+		.SIM_ASSERT_CHK(0),
+		.USE_ADV_FEATURES("0707"),
+		.WAKEUP_TIME(0),
+		.WR_DATA_COUNT_WIDTH(FIFO_W_DATA_COUNT_WIDTH[i]),
+		.WRITE_DATA_WIDTH(FIFO_W_DATA_WIDTH[i])
+	) fifo (
+		.rst(~resetn),
 
-	.wr_clk(clock),
-	.wr_en(fifo_w_2.wr_en),
-	.din(fifo_w_2.wr_data),
-	.full(fifo_w_2.full),
-	.almost_full(fifo_w_2.almost_full),
-	.wr_data_count(fifo_w_2.wr_data_count),
-
-	.rd_en(fifo_r_2.rd_en),
-	.dout(fifo_r_2.rd_data),
-	.empty(fifo_r_2.empty),
-	.almost_empty(fifo_r_2.almost_empty),
-	.rd_data_count(fifo_r_2.rd_data_count)
-);
+		.wr_clk(clock),
+		.wr_en(fifo_w[i].wr_en),
+		.din(fifo_w[i].wr_data[FIFO_W_DATA_WIDTH[i]-1:0]),
+		.full(fifo_w[i].full),
+		.almost_full(fifo_w[i].almost_full),
+		.wr_data_count(wr_data_count),
 
-xpm_fifo_sync #(
-	.DOUT_RESET_VALUE("0"),
-	.ECC_MODE("no_ecc"),
-	.FIFO_MEMORY_TYPE("auto"),
-	.FIFO_READ_LATENCY(0),
-	.FIFO_WRITE_DEPTH(FIFO_WRITE_DEPTH[3]),
-	.FULL_RESET_VALUE(0),
-	.PROG_EMPTY_THRESH(10),
-	.PROG_FULL_THRESH(10),
-	.RD_DATA_COUNT_WIDTH(fifo_r_3.DATA_COUNT_WIDTH),
-	.READ_DATA_WIDTH(fifo_r_3.DATA_WIDTH),
-	.READ_MODE("fwft"),
-	.SIM_ASSERT_CHK(0),
-	.USE_ADV_FEATURES("0707"),
-	.WAKEUP_TIME(0),
-	.WR_DATA_COUNT_WIDTH(fifo_w_3.DATA_COUNT_WIDTH),
-	.WRITE_DATA_WIDTH(fifo_w_3.DATA_WIDTH)
-) fifo_3 (
-	.rst(~resetn),
-
-	.wr_clk(clock),
-	.wr_en(fifo_w_3.wr_en),
-	.din(fifo_w_3.wr_data),
-	.full(fifo_w_3.full),
-	.almost_full(fifo_w_3.almost_full),
-	.wr_data_count(fifo_w_3.wr_data_count),
-
-	.rd_en(fifo_r_3.rd_en),
-	.dout(fifo_r_3.rd_data),
-	.empty(fifo_r_3.empty),
-	.almost_empty(fifo_r_3.almost_empty),
-	.rd_data_count(fifo_r_3.rd_data_count)
-);
+		.rd_en(fifo_r[i].rd_en),
+		.dout(rd_data),
+		.empty(fifo_r[i].empty),
+		.almost_empty(fifo_r[i].almost_empty),
+		.rd_data_count(rd_data_count)
+	);
+end
 
 endmodule
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Writes the slots of the capture unit (see prism_sp_capture) to the
+ * capture ring at base with 2**size slots.
+ *
+ * Every slot is written with one INCR burst of CAPTURE_SLOT_SIZE bytes,
+ * i.e., base must be aligned to CAPTURE_SLOT_SIZE. A slot is only
+ * written while the ring is not full, i.e., while head - tail is less
+ * than 2**size. Otherwise, the slots queue up in the FIFO and the
+ * capture unit drops frames. head is advanced after the response of the
+ * burst.
+ * While enable is cleared, head is reset to 0.
+ */
+module prism_sp_puzzle_hw_capture_write (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0] size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] base,
+	input wire logic [31:0] tail,
+	output var logic [31:0] head,
+
+	fifo_read_interface.master slot_fifo_r,
+
+	input wire axi_attr_t				axi_attr,
+	axi_write_address_channel.master	axi_aw,
+	axi_write_channel.master			axi_w,
+	axi_write_response_channel.master	axi_b
+);
+
+localparam int DATA_WIDTH = $bits(axi_w.wdata);
+
+if (DATA_WIDTH != CAPTURE_WORD_WIDTH) begin
+	$error("The data width of the AXI port (%d) must be %d\n",
+		DATA_WIDTH, CAPTURE_WORD_WIDTH);
+end
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_BURST,
+	STATE_RESPONSE
+} state_t;
+
+var state_t state;
+var logic [8:0] beats_left;
+
+wire logic [31:0] used = head - tail;
+wire logic ring_full = used >= (32'd1 << size);
+wire logic [31:0] slot = head & ((32'd1 << size) - 1);
+wire logic slot_ready = 32'(slot_fifo_r.rd_data_count) >= CAPTURE_SLOT_WORDS;
+
+assign axi_w.wdata = slot_fifo_r.rd_data;
+assign axi_w.wstrb = '1;
+assign axi_w.wuser = 0;
+assign slot_fifo_r.rd_en = state == STATE_BURST && axi_w.wvalid && axi_w.wready;
+
+assign axi_aw.awid = '0;
+assign axi_aw.awsize = $clog2((DATA_WIDTH/8)-1);
+assign axi_aw.awburst = 2'b01;
+assign axi_aw.awcache = axi_attr.cache;
+assign axi_aw.awprot = axi_attr.prot;
+assign axi_aw.awqos = 4'h0;
+assign axi_aw.awlock = 0;
+assign axi_aw.awuser = axi_attr.user;
+
+assign axi_b.bready = 1'b1;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		axi_aw.awvalid <= 1'b0;
+		axi_w.wvalid <= 1'b0;
+		axi_w.wlast <= 1'b0;
+		head <= '0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			if (!enable) begin
+				head <= '0;
+			end
+			else if (slot_ready && !ring_full) begin
+				axi_aw.awvalid <= 1'b1;
+				axi_aw.awaddr <= base + SYSTEM_ADDR_WIDTH'(slot) * CAPTURE_SLOT_SIZE;
+				axi_aw.awlen <= 8'(CAPTURE_SLOT_WORDS - 1);
+
+				axi_w.wvalid <= 1'b1;
+				axi_w.wlast <= CAPTURE_SLOT_WORDS == 1;
+				beats_left <= 9'(CAPTURE_SLOT_WORDS);
+				state <= STATE_BURST;
+			end
+		end
+		STATE_BURST: begin
+			if (axi_aw.awvalid & axi_aw.awready) begin
+				axi_aw.awvalid <= 1'b0;
+			end
+			if (axi_w.wvalid & axi_w.wready) begin
+				if (axi_w.wlast) begin
+					axi_w.wvalid <= 1'b0;
+					axi_w.wlast <= 1'b0;
+				end
+				else begin
+					beats_left <= beats_left - 1;
+					axi_w.wlast <= beats_left == 9'd2;
+				end
+			end
+			if (((axi_aw.awvalid & axi_aw.awready) || !axi_aw.awvalid) &&
+				((axi_w.wvalid & axi_w.wready & axi_w.wlast) || !axi_w.wvalid))
+			begin
+				state <= STATE_RESPONSE;
+			end
+		end
+		STATE_RESPONSE: begin
+			// This also lets the data count of the FIFO catch up with
+			// the reads.
+			if (axi_b.bvalid) begin
+				head <= head + 1;
+				state <= STATE_IDLE;
+			end
+		end
+		endcase
+	end
+end
+
+endmodule
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Writes the records of the flow meter (see prism_sp_flow_meter) to the
+ * export ring at base with 2**size records.
+ *
+ * Records are written in INCR bursts of up to FLOW_BATCH records. A burst
+ * does not cross a multiple of FLOW_BATCH records, i.e., base must be
+ * aligned to FLOW_BATCH records. A burst is started as soon as it can
+ * be filled up to that multiple or FLOW_BATCH_TIMEOUT clock cycles after
+ * the FIFO has become non-empty.
+ * The phase bit of a record is 1 during the first pass through the ring
+ * and flips on every wrap. Like the completion queue, the ring is never
+ * full; the host has to keep up.
+ */
+module prism_sp_puzzle_hw_flow_export (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [FLOW_CONTROL_SIZE_WIDTH-1:0] size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] base,
+
+	fifo_read_interface.master record_fifo_r,
+
+	input wire axi_attr_t				axi_attr,
+	axi_write_address_channel.master	axi_aw,
+	axi_write_channel.master			axi_w,
+	axi_write_response_channel.master	axi_b
+);
+
+localparam int DATA_WIDTH = $bits(axi_w.wdata);
+localparam int BEATS = FLOW_RECORD_WIDTH / DATA_WIDTH;
+localparam int BEAT_WIDTH = BEATS > 1 ? $clog2(BEATS) : 1;
+localparam int BATCH_WIDTH = $clog2(FLOW_BATCH);
+localparam int WAIT_WIDTH = $clog2(FLOW_BATCH_TIMEOUT) + 1;
+
+if (BEATS < 1 || FLOW_RECORD_WIDTH % DATA_WIDTH != 0) begin
+	$error("The data width of the AXI port (%d) must divide %d\n",
+		DATA_WIDTH, FLOW_RECORD_WIDTH);
+end
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_BURST,
+	STATE_SETTLE
+} state_t;
+
+var state_t state;
+var logic [FLOW_INDEX_WIDTH-1:0] tail;
+var logic phase;
+// Phase of the records of the current burst
+var logic burst_phase;
+var logic [BEAT_WIDTH-1:0] beat;
+var logic [8:0] beats_left;
+var logic [WAIT_WIDTH-1:0] wait_cnt;
+
+wire logic [FLOW_FIFO_DATA_COUNT_WIDTH-1:0] avail = record_fifo_r.rd_data_count;
+// Records up to the next multiple of FLOW_BATCH
+wire logic [BATCH_WIDTH:0] room =
+	(BATCH_WIDTH+1)'(FLOW_BATCH) - (BATCH_WIDTH+1)'(tail[BATCH_WIDTH-1:0]);
+wire logic [BATCH_WIDTH:0] nrecords =
+	32'(avail) >= 32'(room) ? room : (BATCH_WIDTH+1)'(avail);
+wire logic [FLOW_INDEX_WIDTH-1:0] next_tail = tail + FLOW_INDEX_WIDTH'(nrecords);
+wire logic tail_wraps = next_tail == FLOW_INDEX_WIDTH'(1 << size);
+
+var flow_record_t record;
+always_comb begin
+	record = record_fifo_r.rd_data;
+	record.phase = burst_phase;
+end
+
+wire logic beat_last = BEATS == 1 || beat == BEAT_WIDTH'(BEATS-1);
+
+assign axi_w.wdata = record[beat*DATA_WIDTH +: DATA_WIDTH];
+assign axi_w.wstrb = '1;
+assign axi_w.wuser = 0;
+// A record is popped with its last beat.
+assign record_fifo_r.rd_en = state == STATE_BURST && axi_w.wvalid && axi_w.wready && beat_last;
+
+assign axi_aw.awid = '0;
+assign axi_aw.awsize = $clog2((DATA_WIDTH/8)-1);
+assign axi_aw.awburst = 2'b01;
+assign axi_aw.awcache = axi_attr.cache;
+assign axi_aw.awprot = axi_attr.prot;
+assign axi_aw.awqos = 4'h0;
+assign axi_aw.awlock = 0;
+assign axi_aw.awuser = axi_attr.user;
+
+// Responses are not checked.
+assign axi_b.bready = 1'b1;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		axi_aw.awvalid <= 1'b0;
+		axi_w.wvalid <= 1'b0;
+		axi_w.wlast <= 1'b0;
+		tail <= '0;
+		phase <= 1'b1;
+		wait_cnt <= '0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			if (!enable) begin
+				tail <= '0;
+				phase <= 1'b1;
+			end
+
+			if (record_fifo_r.empty) begin
+				wait_cnt <= '0;
+			end
+			else if (wait_cnt != WAIT_WIDTH'(FLOW_BATCH_TIMEOUT)) begin
+				wait_cnt <= wait_cnt + 1;
+			end
+
+			if (enable && avail != '0 &&
+				(32'(avail) >= 32'(room) || wait_cnt == WAIT_WIDTH'(FLOW_BATCH_TIMEOUT)))
+			begin
+				axi_aw.awvalid <= 1'b1;
+				axi_aw.awaddr <= base + SYSTEM_ADDR_WIDTH'(tail) * (FLOW_RECORD_WIDTH/8);
+				axi_aw.awlen <= 8'(nrecords * BEATS - 1);
+
+				axi_w.wvalid <= 1'b1;
+				axi_w.wlast <= nrecords * BEATS == 1;
+				beat <= '0;
+				beats_left <= 9'(nrecords * BEATS);
+				burst_phase <= phase;
+
+				if (tail_wraps) begin
+					tail <= '0;
+					phase <= ~phase;
+				end
+				else begin
+					tail <= next_tail;
+				end
+				wait_cnt <= '0;
+				state <= STATE_BURST;
+			end
+		end
+		STATE_BURST: begin
+			if (axi_aw.awvalid & axi_aw.awready) begin
+				axi_aw.awvalid <= 1'b0;
+			end
+			if (axi_w.wvalid & axi_w.wready) begin
+				if (axi_w.wlast) begin
+					axi_w.wvalid <= 1'b0;
+					axi_w.wlast <= 1'b0;
+				end
+				else begin
+					beat <= beat_last ? '0 : beat + 1;
+					beats_left <= beats_left - 1;
+					axi_w.wlast <= beats_left == 9'd2;
+				end
+			end
+			if (((axi_aw.awvalid & axi_aw.awready) || !axi_aw.awvalid) &&
+				((axi_w.wvalid & axi_w.wready & axi_w.wlast) || !axi_w.wvalid))
+			begin
+				state <= STATE_SETTLE;
+			end
+		end
+		STATE_SETTLE: begin
+			// Let the data count of the FIFO catch up with the reads.
+			state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+endmodule
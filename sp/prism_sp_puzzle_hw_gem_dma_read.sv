@@ -17,11 +17,20 @@ module prism_sp_puzzle_hw_gem_dma_read (
 	input wire logic clock,
 	input wire logic resetn,
 
+	// Cut-through threshold in bytes (0 disables cut-through)
+	input wire logic [TX_META_DESC_SIZE_WIDTH-1:0] ct_size,
+
+	// Digest range of the frame that is read (see prism_sp_tx_digest)
+	output var logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_start,
+	output var logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_end,
+
 	fifo_read_interface.master i_cookie_fifo_r,
 	fifo_write_interface.master meta_desc_fifo_w,
 	fifo_write_interface.master o_cookie_fifo_w,
 
-	memory_read_interface.master tx_data_mem_r
+	memory_read_interface.master tx_data_mem_r,
+	// Set while no cookie is processed
+	output wire logic idle
 );
 
 typedef enum logic [1:0] {
@@ -33,6 +42,8 @@ typedef enum logic [1:0] {
 
 var state_t state;
 
+assign idle = state == STATE_IDLE;
+
 /*
  * Cookie stored in
  * i_cookie_fifo_r.rd_data
@@ -53,6 +64,9 @@ var logic [GEM_RX_W_STATUS_FRAME_LENGTH_WIDTH-1:0] packet_length;
 var logic start_of_frame;
 var logic end_of_frame;
 var logic no_crc;
+var logic [TX_COOKIE_ESP_SA_WIDTH-1:0] esp_sa;
+var logic [TX_COOKIE_QUEUE_WIDTH-1:0] queue;
+var logic cut_through;
 
 always_ff @(posedge clock) begin
 	i_cookie_fifo_r.rd_en <= 1'b0;
@@ -65,6 +79,9 @@ always_ff @(posedge clock) begin
 		packet_length <= '0;
 		start_of_frame <= 1'b1;
 		end_of_frame <= 1'b0;
+		cut_through <= 1'b0;
+		digest_start <= '0;
+		digest_end <= '0;
 	end
 	else begin
 		case (state)
@@ -76,7 +93,28 @@ always_ff @(posedge clock) begin
 
 				if (start_of_frame) begin
 					no_crc <= i_tx_cookie.nocrc;
+					esp_sa <= i_tx_cookie.esp_sa;
+					queue <= i_tx_cookie.queue;
+					digest_start <= i_tx_cookie.digest_start;
+					digest_end <= i_tx_cookie.digest_end;
 					start_of_frame <= 1'b0;
+
+					/*
+					 * Cut-through is only possible if we know the
+					 * size of the frame up front, i.e., the frame
+					 * consists of a single fragment.
+					 * Write the meta descriptor right away in this
+					 * case and not after the DMA has finished.
+					 */
+					if (ct_size != '0 && i_tx_cookie.eof && i_tx_cookie.size > ct_size) begin
+						meta_desc_fifo_w.wr_en <= 1'b1;
+						o_meta_desc.ct_size <= ct_size;
+						o_meta_desc.size <= i_tx_cookie.size;
+						o_meta_desc.nocrc <= i_tx_cookie.nocrc;
+						o_meta_desc.esp_sa <= i_tx_cookie.esp_sa;
+						o_meta_desc.queue <= i_tx_cookie.queue;
+						cut_through <= 1'b1;
+					end
 				end
 				end_of_frame <= i_tx_cookie.eof;
 
@@ -98,18 +136,24 @@ always_ff @(posedge clock) begin
 		STATE_BUSY: begin
 			if (!tx_data_mem_r.busy) begin
 				if (end_of_frame) begin
-					meta_desc_fifo_w.wr_en <= 1'b1;
-					/*
-					 * Start of conversion:
-					 * i_tx_cookie(s) -> o_meta_desc
-					 */
-					o_meta_desc.size <= packet_length;
-					o_meta_desc.nocrc <= no_crc;
-					/*
-					 * End of conversion
-					 */
+					if (!cut_through) begin
+						meta_desc_fifo_w.wr_en <= 1'b1;
+						/*
+						 * Start of conversion:
+						 * i_tx_cookie(s) -> o_meta_desc
+						 */
+						o_meta_desc.ct_size <= '0;
+						o_meta_desc.size <= packet_length;
+						o_meta_desc.nocrc <= no_crc;
+						o_meta_desc.esp_sa <= esp_sa;
+						o_meta_desc.queue <= queue;
+						/*
+						 * End of conversion
+						 */
+					end
 
 					start_of_frame <= 1'b1;
+					cut_through <= 1'b0;
 					packet_length <= '0;
 				end
 
@@ -13,20 +13,52 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-module prism_sp_puzzle_hw_gem_dma_write (
+/*
+ * Frames are mapped to one of NQUEUES cookie FIFOs (one per RX ring)
+ * by their priority. prio_map holds the ring of priority p in
+ * bits [4*p +: 4]. Frames mapped to a disabled ring go to ring 0.
+ * A frame waits at most RING_WAIT cycles for a cookie of its ring. Then
+ * it goes to ring 0 as soon as that has a buffer, so that a ring that
+ * the host does not refill does not block the frames of the others.
+ *
+ * If stride_enable is set, the buffer of a descriptor receives several
+ * frames. Every frame starts at an offset that is a multiple of
+ * 2**stride_shift bytes. The buffer (of 2**buf_shift bytes) is kept
+ * open until fewer than buf_reserve bytes would remain after a frame.
+ * The cookie of that frame has buf_last set. Every frame has a cookie of
+ * its own whose addr and data_addr are the address of the frame.
+ * An open buffer is also returned if no frame has arrived for BUF_TIMEOUT
+ * cycles or if stride_enable is cleared. This is done with a cookie of
+ * size 0 with buf_last set, whose addr is the end of the used part of
+ * the buffer.
+ */
+module prism_sp_puzzle_hw_gem_dma_write #(
+	parameter int NQUEUES = 1
+) (
 	input wire logic clock,
 	input wire logic resetn,
 
-	fifo_read_interface.master i_cookie_fifo_r,
+	input wire logic [NQUEUES-1:0] queue_enable,
+	input wire logic [31:0] prio_map,
+
+	input wire logic stride_enable,
+	input wire logic [4:0] stride_shift,
+	input wire logic [4:0] buf_shift,
+	input wire logic [15:0] buf_reserve,
+
+	fifo_read_interface.master i_cookie_fifo_r [NQUEUES],
 	fifo_read_interface.master meta_desc_fifo_r,
 	fifo_write_interface.master o_cookie_fifo_w,
 
 	memory_write_interface.master rx_data_mem_w
 );
 
+localparam int QUEUE_WIDTH = NQUEUES > 1 ? $clog2(NQUEUES) : 1;
+localparam int RING_WAIT = 1024;
+localparam int BUF_TIMEOUT = 2**16;
+
 typedef enum logic [2:0] {
 	STATE_IDLE,
-	STATE_HAVE_DMA_DESC,
 	STATE_HAVE_META_DESC,
 	STATE_PREBUSY,
 	STATE_BUSY,
@@ -36,11 +68,33 @@ var state_t state;
 
 /*
  * Cookie stored in
- * i_cookie_fifo_r.rd_data
+ * i_cookie_fifo_r[queue].rd_data
  */
-wire dma_rx_cookie_t i_rx_cookie = i_cookie_fifo_r.rd_data;
+var logic [QUEUE_WIDTH-1:0] queue;
+var logic cookie_rd_en;
+wire dma_rx_cookie_t i_rx_cookies [NQUEUES];
+wire logic [NQUEUES-1:0] cookie_available;
+for (genvar q = 0; q < NQUEUES; q++) begin
+	assign i_rx_cookies[q] = i_cookie_fifo_r[q].rd_data;
+	assign cookie_available[q] = !i_cookie_fifo_r[q].empty;
+	assign i_cookie_fifo_r[q].rd_en = cookie_rd_en && queue == q;
+end
 wire rx_meta_desc_t i_meta_desc = meta_desc_fifo_r.rd_data;
 
+/*
+ * The ring of the frame at the head of the meta FIFO
+ */
+wire logic [3:0] meta_ring = prio_map[4*i_meta_desc.prio +: 4];
+var logic [QUEUE_WIDTH-1:0] meta_queue;
+always_comb begin
+	meta_queue = '0;
+	for (int q = 1; q < NQUEUES; q++) begin
+		if (meta_ring == q && queue_enable[q]) begin
+			meta_queue = QUEUE_WIDTH'(q);
+		end
+	end
+end
+
 /*
  * Cookie stored in
  * o_cookie_fifo_w.wr_data
@@ -48,83 +102,173 @@ wire rx_meta_desc_t i_meta_desc = meta_desc_fifo_r.rd_data;
 var rx_cookie_t o_rx_cookie;
 assign o_cookie_fifo_w.wr_data = o_rx_cookie;
 
+/*
+ * The open buffer of every queue in striding mode
+ */
+var logic [NQUEUES-1:0] buf_open;
+var logic [SYSTEM_ADDR_WIDTH-1:0] buf_addr [NQUEUES];
+var logic [31:0] buf_offset [NQUEUES];
+
+// Cycles without a frame, and the open buffer to return first
+var logic [$clog2(BUF_TIMEOUT)-1:0] buf_idle;
+var logic [QUEUE_WIDTH-1:0] close_queue;
+always_comb begin
+	close_queue = '0;
+	for (int q = NQUEUES - 1; q >= 0; q--) begin
+		if (buf_open[q]) begin
+			close_queue = QUEUE_WIDTH'(q);
+		end
+	end
+end
+wire logic close_buf = |buf_open && (!stride_enable || buf_idle == '1);
+
+// Cycles that the frame in STATE_HAVE_META_DESC has waited for a cookie
+var logic [$clog2(RING_WAIT)-1:0] ring_wait;
+
+task place_frame(
+	input var logic [QUEUE_WIDTH-1:0] q,
+	input var logic [SYSTEM_ADDR_WIDTH-1:0] base,
+	input var logic [31:0] offset,
+	input var logic [31:0] size
+);
+	logic [SYSTEM_ADDR_WIDTH-1:0] frame_addr;
+	logic [32:0] next;
+	logic last;
+
+	frame_addr = base + SYSTEM_ADDR_WIDTH'(offset);
+	// Round up to the next stride
+	next = ((33'(offset) + 33'(size) + (33'(1) << stride_shift) - 33'(1)) >> stride_shift) << stride_shift;
+	last = next + 33'(buf_reserve) > (33'(1) << buf_shift);
+
+	o_rx_cookie.addr <= frame_addr;
+	o_rx_cookie.data_addr <= frame_addr;
+	o_rx_cookie.buf_last <= last;
+	rx_data_mem_w.addr <= frame_addr;
+	rx_data_mem_w.start <= 1'b1;
+
+	buf_open[q] <= !last;
+	buf_addr[q] <= base;
+	buf_offset[q] <= next[31:0];
+endtask
+
+task take_cookie(
+	input var logic [QUEUE_WIDTH-1:0] q,
+	input var logic [31:0] size
+);
+	// The ctrl fields are set from the meta descriptor.
+	cookie_rd_en <= 1'b1;
+	if (stride_enable) begin
+		place_frame(q, i_rx_cookies[q].data_addr, '0, size);
+	end
+	else begin
+		/*
+		 * Start of conversion:
+		 * i_rx_cookie -> o_rx_cookie
+		 */
+		o_rx_cookie.addr <= i_rx_cookies[q].addr;
+		o_rx_cookie.data_addr <= i_rx_cookies[q].data_addr;
+		o_rx_cookie.buf_last <= 1'b0;
+		/*
+		 * End of conversion
+		 */
+		rx_data_mem_w.addr <= i_rx_cookies[q].data_addr;
+		rx_data_mem_w.start <= 1'b1;
+	end
+endtask
+
 always_ff @(posedge clock) begin
-	i_cookie_fifo_r.rd_en <= 1'b0;
+	cookie_rd_en <= 1'b0;
 	o_cookie_fifo_w.wr_en <= 1'b0;
 	meta_desc_fifo_r.rd_en <= 1'b0;
 	rx_data_mem_w.start <= 1'b0;
 
 	if (!resetn) begin
+		queue <= '0;
+		buf_open <= '0;
+		buf_idle <= '0;
 		state <= STATE_IDLE;
 	end
 	else begin
-		if ((state == STATE_IDLE || state == STATE_HAVE_META_DESC) &&
-			!i_cookie_fifo_r.empty)
-		begin
-			/*
-			 * Start of conversion:
-			 * i_rx_cookie -> o_rx_cookie
-			 */
-			o_rx_cookie.addr <= i_rx_cookie.addr;
-			o_rx_cookie.data_addr <= i_rx_cookie.data_addr;
-			/*
-			 * End of conversion
-			 */
-			// The ctrl fields will be set below.
-			i_cookie_fifo_r.rd_en <= 1'b1;
-			rx_data_mem_w.addr <= i_rx_cookie.data_addr;
-		end
-
-		if ((state == STATE_IDLE || state == STATE_HAVE_DMA_DESC) &&
-			!meta_desc_fifo_r.empty)
-		begin
-			/*
-			 * Start of conversion:
-			 * i_meta_desc -> o_rx_cookie
-			 */
-			o_rx_cookie.w_broadcast_frame <= i_meta_desc.w_broadcast_frame;
-			o_rx_cookie.w_mult_hash_match <= i_meta_desc.w_mult_hash_match;
-			o_rx_cookie.w_uni_hash_match <= i_meta_desc.w_uni_hash_match;
-			o_rx_cookie.w_ext_match <= i_meta_desc.w_ext_match;
-			o_rx_cookie.w_add_match <= i_meta_desc.w_add_match;
-			o_rx_cookie.add_match <= i_meta_desc.add_match;
-			o_rx_cookie.chksum_enc <= i_meta_desc.chksum_enc;
-			o_rx_cookie.rx_w_vlan_tagged <= i_meta_desc.rx_w_vlan_tagged;
-			o_rx_cookie.rx_w_prty_tagged <= i_meta_desc.rx_w_prty_tagged;
-			o_rx_cookie.cfi <= i_meta_desc.cfi;
-			o_rx_cookie.eof <= i_meta_desc.eof;
-			o_rx_cookie.sof <= i_meta_desc.sof;
-			o_rx_cookie.fcs <= i_meta_desc.fcs;
-			o_rx_cookie.size <= i_meta_desc.size;
-			/*
-			 * End of conversion
-			 */
-			meta_desc_fifo_r.rd_en <= 1'b1;
-			rx_data_mem_w.len <= i_meta_desc.size;
+		if (state == STATE_IDLE && meta_desc_fifo_r.empty && buf_idle != '1) begin
+			buf_idle <= buf_idle + 1;
 		end
 
 		case (state)
 		STATE_IDLE: begin
-			if (!i_cookie_fifo_r.empty && !meta_desc_fifo_r.empty) begin
-				rx_data_mem_w.start <= 1'b1;
-				state <= STATE_PREBUSY;
-			end
-			else if (!i_cookie_fifo_r.empty) begin
-				state <= STATE_HAVE_DMA_DESC;
+			if (close_buf) begin
+				// Return the open buffer without a frame.
+				o_rx_cookie <= '0;
+				o_rx_cookie.addr <= buf_addr[close_queue] + SYSTEM_ADDR_WIDTH'(buf_offset[close_queue]);
+				o_rx_cookie.data_addr <= buf_addr[close_queue] + SYSTEM_ADDR_WIDTH'(buf_offset[close_queue]);
+				o_rx_cookie.buf_last <= 1'b1;
+				buf_open[close_queue] <= 1'b0;
+				buf_idle <= '0;
+				state <= STATE_WAIT_FOR_O_COOKIE_FIFO_W_NOT_FULL;
 			end
 			else if (!meta_desc_fifo_r.empty) begin
-				state <= STATE_HAVE_META_DESC;
+				buf_idle <= '0;
+				/*
+				 * Start of conversion:
+				 * i_meta_desc -> o_rx_cookie
+				 */
+				o_rx_cookie.w_broadcast_frame <= i_meta_desc.w_broadcast_frame;
+				o_rx_cookie.w_mult_hash_match <= i_meta_desc.w_mult_hash_match;
+				o_rx_cookie.w_uni_hash_match <= i_meta_desc.w_uni_hash_match;
+				o_rx_cookie.w_ext_match <= i_meta_desc.w_ext_match;
+				o_rx_cookie.w_add_match <= i_meta_desc.w_add_match;
+				o_rx_cookie.add_match <= i_meta_desc.add_match;
+				o_rx_cookie.chksum_enc <= i_meta_desc.chksum_enc;
+				o_rx_cookie.digest_err <= i_meta_desc.digest_err;
+				o_rx_cookie.esp <= i_meta_desc.esp;
+				o_rx_cookie.esp_auth_err <= i_meta_desc.esp_auth_err;
+				o_rx_cookie.tunnel <= i_meta_desc.tunnel;
+				o_rx_cookie.inner_chksum_enc <= i_meta_desc.inner_chksum_enc;
+				o_rx_cookie.inner_hash <= i_meta_desc.inner_hash;
+				o_rx_cookie.rx_w_vlan_tagged <= i_meta_desc.rx_w_vlan_tagged;
+				o_rx_cookie.rx_w_prty_tagged <= i_meta_desc.rx_w_prty_tagged;
+				o_rx_cookie.prio <= i_meta_desc.prio;
+				o_rx_cookie.cfi <= i_meta_desc.cfi;
+				o_rx_cookie.eof <= i_meta_desc.eof;
+				o_rx_cookie.sof <= i_meta_desc.sof;
+				o_rx_cookie.fcs <= i_meta_desc.fcs;
+				o_rx_cookie.size <= i_meta_desc.size;
+				/*
+				 * End of conversion
+				 */
+				meta_desc_fifo_r.rd_en <= 1'b1;
+				rx_data_mem_w.len <= i_meta_desc.size;
+				queue <= meta_queue;
+
+				if (stride_enable && buf_open[meta_queue]) begin
+					place_frame(meta_queue, buf_addr[meta_queue], buf_offset[meta_queue], 32'(i_meta_desc.size));
+					state <= STATE_PREBUSY;
+				end
+				else if (cookie_available[meta_queue]) begin
+					take_cookie(meta_queue, 32'(i_meta_desc.size));
+					state <= STATE_PREBUSY;
+				end
+				else begin
+					ring_wait <= '0;
+					state <= STATE_HAVE_META_DESC;
+				end
 			end
 		end
-		STATE_HAVE_DMA_DESC: begin
-			if (!meta_desc_fifo_r.empty) begin
-				rx_data_mem_w.start <= 1'b1;
+		STATE_HAVE_META_DESC: begin
+			if (cookie_available[queue]) begin
+				take_cookie(queue, 32'(rx_data_mem_w.len));
 				state <= STATE_PREBUSY;
 			end
-		end
-		STATE_HAVE_META_DESC: begin
-			if (!i_cookie_fifo_r.empty) begin
-				rx_data_mem_w.start <= 1'b1;
+			else if (ring_wait != '1) begin
+				ring_wait <= ring_wait + 1;
+			end
+			else if (stride_enable && buf_open[0]) begin
+				queue <= '0;
+				place_frame('0, buf_addr[0], buf_offset[0], 32'(rx_data_mem_w.len));
+				state <= STATE_PREBUSY;
+			end
+			else if (cookie_available[0]) begin
+				queue <= '0;
+				take_cookie('0, 32'(rx_data_mem_w.len));
 				state <= STATE_PREBUSY;
 			end
 		end
@@ -13,22 +13,50 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+/*
+ * Walks NQUEUES descriptor rings. Every ring has its own base, head
+ * pointer, output FIFO and doorbell (bit q of the trigger register).
+ * Rings that need a refill are served round-robin.
+ *
+ * Whether a descriptor belongs to the hardware and whether it is the
+ * last one of its ring is decided by the cookie converter (conv). Every
+ * ring has a phase bit that is passed to the converter. It flips every
+ * time the ring wraps if the converter sets phase_per_pass (virtio
+ * packed rings) or in SQ/CQ mode (cq_enable). In SQ/CQ mode, descriptors
+ * are not written back by the ring release, so a GEM descriptor belongs
+ * to the hardware if its VALID bit equals the phase, i.e., software
+ * writes VALID with the number of the current pass modulo 2.
+ *
+ * A ring that hit a descriptor not owned by the hardware waits for its
+ * doorbell. If poll_enable is set, it also re-reads the descriptor after
+ * 2**n clock cycles without a doorbell, i.e., software may post
+ * descriptors with plain memory writes. n starts at poll_min_shift and
+ * grows by one after every poll that returned nothing, up to
+ * poll_max_shift.
+ */
 module prism_sp_puzzle_hw_gem_ring_acquire#(
 	type DESC_TYPE,
 	type COOKIE_TYPE,
-	parameter int FIFO_DEPTH
+	parameter int FIFO_DEPTH,
+	parameter int NQUEUES = 1
 ) (
 	input wire logic clock,
 	input wire logic resetn,
 
-	input wire logic enable,
+	input wire logic [NQUEUES-1:0] enable,
+	input wire logic cq_enable,
+	input wire logic poll_enable,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_min_shift,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_max_shift,
+	input wire logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size,
 	mmr_trigger_interface.master mmr_t,
 
-	input wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base [NQUEUES],
 
-	fifo_write_interface.master o_cookie_fifo_w,
+	fifo_write_interface.master o_cookie_fifo_w [NQUEUES],
 	prism_sp_ring_acquire_cookie_convert_interface.master conv,
 
+	input wire axi_attr_t axi_attr,
 	axi_read_address_channel.master axi_ar,
 	axi_read_channel.master axi_r
 );
@@ -38,6 +66,10 @@ if ($bits(axi_r.rdata) != DESC_WIDTH) begin
 	$error("The data width of AXI port MA (%d) has to be equal to DESC_WIDTH (%d)\n",
 		$bits(axi_r.rdata), DESC_WIDTH);
 end
+if (mmr_t.WIDTH < NQUEUES) begin
+	$error("The trigger register (%d) needs one bit per queue (%d)\n",
+		mmr_t.WIDTH, NQUEUES);
+end
 
 assign axi_ar.arsize = $clog2(DESC_WIDTH/8);
 
@@ -46,45 +78,115 @@ assign axi_ar.arsize = $clog2(DESC_WIDTH/8);
  * FIFO_THRESH = FIFO_DEPTH / 2 .
  */
 localparam int FIFO_THRESH = FIFO_DEPTH / 2;
+localparam int QUEUE_WIDTH = NQUEUES > 1 ? $clog2(NQUEUES) : 1;
+
+/*
+ * The queue that is currently refilled.
+ */
+var logic [QUEUE_WIDTH-1:0] queue;
 
 /*
  * Set up the converter
  */
 assign conv.data_in = axi_r.rdata;
-assign conv.dma_desc_cur = dma_desc_cur;
-
-wire DESC_TYPE i_desc = axi_r.rdata;
+assign conv.dma_desc_cur = dma_desc_cur[queue];
+assign conv.dma_desc_base = dma_desc_base[queue];
+assign conv.ring_size = ring_size;
+assign conv.phase = sq_phase[queue];
 
-typedef enum logic [2:0] {
-	STATE_INIT,
+typedef enum logic [1:0] {
 	STATE_IDLE,
 	STATE_REFILL,
 	STATE_FIFO_SETTLE1,
-	STATE_FIFO_SETTLE2,
-	STATE_WAIT_FOR_TRIGGER
+	STATE_FIFO_SETTLE2
 } state_t;
 
-var logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_cur;
+typedef enum logic [1:0] {
+	RING_STATE_INIT,
+	RING_STATE_READY,
+	RING_STATE_WAIT_FOR_TRIGGER
+} ring_state_t;
+
+var logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_cur [NQUEUES];
 var state_t state;
+var ring_state_t ring_state [NQUEUES];
+// Value of the VALID bit of the descriptors owned by the hardware
+var logic [NQUEUES-1:0] sq_phase;
+// Polling timer and backoff of every ring
+var logic [31:0] poll_timer [NQUEUES];
+var logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_shift [NQUEUES];
+
+wire logic [NQUEUES-1:0] ring_needs_refill;
+for (genvar q = 0; q < NQUEUES; q++) begin
+	assign ring_needs_refill[q] = ring_state[q] == RING_STATE_READY &&
+		o_cookie_fifo_w[q].wr_data_count <= FIFO_THRESH;
+end
+
+/*
+ * Round-robin: the first ring after the current one wins.
+ */
+var logic [QUEUE_WIDTH-1:0] next_queue;
+var logic next_queue_valid;
+always_comb begin
+	next_queue = queue;
+	next_queue_valid = 1'b0;
+
+	for (int i = NQUEUES; i > 0; i--) begin
+		if (ring_needs_refill[(queue + i) % NQUEUES]) begin
+			next_queue = QUEUE_WIDTH'((queue + i) % NQUEUES);
+			next_queue_valid = 1'b1;
+		end
+	end
+end
 
 always_ff @(posedge clock) begin
-	mmr_t.tsr_invpulses[0][0] <= 1'b0;
+	for (int q = 0; q < NQUEUES; q++) begin
+		mmr_t.tsr_invpulses[0][q] <= 1'b0;
+	end
 
 	if (!resetn) begin
 		axi_ar.arvalid <= 1'b0;
-		state <= STATE_INIT;
+		queue <= '0;
+		state <= STATE_IDLE;
+		for (int q = 0; q < NQUEUES; q++) begin
+			ring_state[q] <= RING_STATE_INIT;
+		end
 	end
 	else begin
-		case (state)
-		STATE_INIT: begin
-			if (enable) begin
-				state <= STATE_IDLE;
+		for (int q = 0; q < NQUEUES; q++) begin
+			case (ring_state[q])
+			RING_STATE_INIT: begin
+				if (enable[q]) begin
+					poll_shift[q] <= poll_min_shift;
+					ring_state[q] <= RING_STATE_READY;
+				end
 			end
+			RING_STATE_WAIT_FOR_TRIGGER: begin
+				if (mmr_t.tsr[0][q]) begin
+					mmr_t.tsr_invpulses[0][q] <= 1'b1;
+					poll_shift[q] <= poll_min_shift;
+					ring_state[q] <= RING_STATE_READY;
+				end
+				else if (poll_enable) begin
+					if (poll_timer[q] == '0) begin
+						ring_state[q] <= RING_STATE_READY;
+					end
+					else begin
+						poll_timer[q] <= poll_timer[q] - 1;
+					end
+				end
+			end
+			default: begin
+			end
+			endcase
 		end
+
+		case (state)
 		STATE_IDLE: begin
-			if (o_cookie_fifo_w.wr_data_count <= FIFO_THRESH) begin
+			if (next_queue_valid) begin
+				queue <= next_queue;
 				axi_ar.arvalid <= 1'b1;
-				axi_ar.araddr <= dma_desc_cur;
+				axi_ar.araddr <= dma_desc_cur[next_queue];
 				// We have to be careful not to cross a 4 kiB boundary.
 				state <= STATE_REFILL;
 			end
@@ -101,17 +203,20 @@ always_ff @(posedge clock) begin
 		STATE_FIFO_SETTLE2: begin
 			// In this clock cycle, wr_data_count is not touched yet.
 			if (saw_invalid) begin
-				state <= STATE_WAIT_FOR_TRIGGER;
-			end
-			else begin
-				state <= STATE_IDLE;
-			end
-		end
-		STATE_WAIT_FOR_TRIGGER: begin
-			if (mmr_t.tsr[0][0]) begin
-				mmr_t.tsr_invpulses[0][0] <= 1'b1;
-				state <= STATE_IDLE;
+				ring_state[queue] <= RING_STATE_WAIT_FOR_TRIGGER;
+				// Back off if the ring was still empty.
+				if (!saw_owned) begin
+					poll_timer[queue] <= (32'(1) << poll_shift[queue]) - 1;
+					if (poll_shift[queue] < poll_max_shift) begin
+						poll_shift[queue] <= poll_shift[queue] + 1;
+					end
+				end
+				else begin
+					poll_timer[queue] <= (32'(1) << poll_min_shift) - 1;
+					poll_shift[queue] <= poll_min_shift;
+				end
 			end
+			state <= STATE_IDLE;
 		end
 		endcase
 	end
@@ -133,54 +238,76 @@ assign axi_ar.arsize = $clog2(DESC_WIDTH/8);
 // INCR burst type
 assign axi_ar.arburst = 2'b01;
 assign axi_ar.arlock = 1'b0;
-assign axi_ar.arcache = 4'b0011;
-assign axi_ar.arprot = 3'h0;
+assign axi_ar.arcache = axi_attr.cache;
+assign axi_ar.arprot = axi_attr.prot;
 assign axi_ar.arqos = 4'h0;
-assign axi_ar.aruser = '0;
-var logic [$clog2(FIFO_THRESH)-1:0] axi_ar_arlen;
-assign axi_ar.arlen = { {($bits(axi_ar.arlen) - $bits(axi_ar_arlen)){1'b0}}, axi_ar_arlen };
+assign axi_ar.aruser = axi_attr.user;
+var logic [$clog2(FIFO_THRESH)-1:0] axi_ar_arlen [NQUEUES];
+assign axi_ar.arlen = { {($bits(axi_ar.arlen) - $bits(axi_ar_arlen[0])){1'b0}}, axi_ar_arlen[queue] };
 
 var logic saw_invalid;
+// Set if the current refill returned at least one descriptor.
+var logic saw_owned;
+
+wire logic desc_owned = conv.owned;
+
+/*
+ * The cookie is written to the output FIFO of the current queue.
+ */
+var logic cookie_wr_en;
+var logic [$bits(conv.data_out)-1:0] cookie_wr_data;
+for (genvar q = 0; q < NQUEUES; q++) begin
+	assign o_cookie_fifo_w[q].wr_en = cookie_wr_en && queue == q;
+	assign o_cookie_fifo_w[q].wr_data = cookie_wr_data;
+end
 
 always_ff @(posedge clock) begin
-	o_cookie_fifo_w.wr_en <= 1'b0;
+	cookie_wr_en <= 1'b0;
 
 	if (!resetn) begin
 		saw_invalid <= 1'b0;
+		saw_owned <= 1'b0;
 	end
 	else begin
-
-		if (state == STATE_INIT) begin
-			if (enable) begin
-				dma_desc_cur <= dma_desc_base;
-				// Start with FIFO_THRESH number of beats.
-				axi_ar_arlen <= '1;
+		for (int q = 0; q < NQUEUES; q++) begin
+			if (ring_state[q] == RING_STATE_INIT) begin
+				if (enable[q]) begin
+					dma_desc_cur[q] <= dma_desc_base[q];
+					sq_phase[q] <= 1'b0;
+					// Start with FIFO_THRESH number of beats.
+					axi_ar_arlen[q] <= '1;
+				end
 			end
 		end
 
 		if (ar_hshake) begin
 			saw_invalid <= 1'b0;
+			saw_owned <= 1'b0;
 		end
 
 		if (!saw_invalid) begin
 			if (r_hshake) begin
-				o_cookie_fifo_w.wr_en <= ~i_desc.valid;
-				o_cookie_fifo_w.wr_data <= conv.data_out;
-				saw_invalid <= i_desc.valid;
+				cookie_wr_en <= desc_owned;
+				cookie_wr_data <= conv.data_out;
+				saw_invalid <= !desc_owned;
 
-				if (!i_desc.valid) begin
+				if (desc_owned) begin
+					saw_owned <= 1'b1;
 					// Check the WRAP bit
-					if (i_desc.wrap) begin
-						dma_desc_cur <= dma_desc_base;
+					if (conv.last) begin
+						dma_desc_cur[queue] <= dma_desc_base[queue];
+						if (cq_enable || conv.phase_per_pass) begin
+							sq_phase[queue] <= ~sq_phase[queue];
+						end
 						// Start with FIFO_THRESH beats again.
-						axi_ar_arlen <= '1;
+						axi_ar_arlen[queue] <= '1;
 						// Every word following this word will be invalid.
 						saw_invalid <= 1'b1;
 					end
 					else begin
-						dma_desc_cur <= dma_desc_cur + (DESC_WIDTH / 8);
+						dma_desc_cur[queue] <= dma_desc_cur[queue] + (DESC_WIDTH / 8);
 						// This wraps around automagically.
-						axi_ar_arlen <= axi_ar_arlen - 1;
+						axi_ar_arlen[queue] <= axi_ar_arlen[queue] - 1;
 					end
 				end
 			end
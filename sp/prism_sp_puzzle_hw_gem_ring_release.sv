@@ -13,6 +13,21 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+/*
+ * Completes the cookies of a ring.
+ *
+ * By default, the descriptor a cookie was acquired from is written back.
+ * A virtio packed virtqueue descriptor is marked as used in place; only
+ * its len and flags are written, which keeps the buffer id.
+ * In SQ/CQ mode (cq_enable), a cq_entry_t is appended to the completion
+ * queue at cq_base with 2**cq_size entries instead. Entries are collected
+ * until the end of a CQ_LINE_SIZE line is reached or no further cookie is
+ * available and are then written with a single burst. The completion
+ * queue must hold at least as many entries as there are descriptors in
+ * all rings.
+ *
+ * In both modes, one entry is written to fifo_w per AXI write.
+ */
 module prism_sp_puzzle_hw_gem_ring_release #(
 	type DESC_TYPE,
 	type COOKIE_TYPE
@@ -21,9 +36,14 @@ module prism_sp_puzzle_hw_gem_ring_release #(
 	input wire logic clock,
 	input wire logic resetn,
 
+	input wire logic cq_enable,
+	input wire logic [CQ_CONTROL_SIZE_WIDTH-1:0] cq_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] cq_base,
+
 	fifo_read_interface.master			i_cookie_fifo_r,
 	fifo_write_interface.master			fifo_w,
 
+	input wire axi_attr_t				axi_attr,
 	axi_write_address_channel.master	axi_aw,
 	axi_write_channel.master			axi_w,
 	axi_write_response_channel.master	axi_b
@@ -43,13 +63,72 @@ wire COOKIE_TYPE i_cookie = i_cookie_fifo_r.rd_data;
  * axi_w.wdata
  */
 var DESC_TYPE o_desc;
-assign axi_w.wdata = o_desc;
 
-typedef enum logic [1:0] {
+/*
+ * Completion queue
+ */
+localparam int CQ_ENTRY_WIDTH = $bits(cq_entry_t);
+localparam int CQ_ENTRIES_PER_BEAT = $bits(axi_w.wdata) / CQ_ENTRY_WIDTH;
+localparam int CQ_LINE_ENTRIES = CQ_LINE_SIZE / (CQ_ENTRY_WIDTH/8);
+localparam int CQ_LINE_BEATS = CQ_LINE_ENTRIES / CQ_ENTRIES_PER_BEAT;
+localparam int CQ_SLOT_WIDTH = $clog2(CQ_LINE_ENTRIES);
+localparam int CQ_BEAT_WIDTH = CQ_LINE_BEATS > 1 ? $clog2(CQ_LINE_BEATS) : 1;
+
+if (CQ_ENTRIES_PER_BEAT < 1 || CQ_LINE_BEATS < 1) begin
+	$error("The data width of the AXI port (%d) must be between %d and %d\n",
+		$bits(axi_w.wdata), CQ_ENTRY_WIDTH, CQ_LINE_SIZE*8);
+end
+
+var logic [CQ_INDEX_WIDTH-1:0] cq_tail;
+var logic cq_phase;
+// The line of the completion queue cq_tail is in
+var cq_entry_t cq_line [CQ_LINE_ENTRIES];
+var logic [CQ_LINE_ENTRIES-1:0] cq_line_valid;
+var logic [SYSTEM_ADDR_WIDTH-1:0] cq_line_addr;
+// Set while the line is written.
+var logic cq_active;
+var logic [CQ_BEAT_WIDTH-1:0] cq_beat;
+var logic [CQ_BEAT_WIDTH-1:0] cq_last_beat;
+var logic [7:0] cq_awlen;
+
+wire logic [CQ_SLOT_WIDTH-1:0] cq_slot = cq_tail[CQ_SLOT_WIDTH-1:0];
+wire logic cq_tail_wraps = cq_tail == CQ_INDEX_WIDTH'((1 << cq_size) - 1);
+
+var logic [$bits(axi_w.wdata)-1:0] cq_wdata;
+var logic [$bits(axi_w.wdata)/8-1:0] cq_wstrb;
+var logic [CQ_BEAT_WIDTH-1:0] cq_first_valid_beat;
+var logic [CQ_BEAT_WIDTH-1:0] cq_last_valid_beat;
+always_comb begin
+	for (int e = 0; e < CQ_ENTRIES_PER_BEAT; e++) begin
+		cq_wdata[e*CQ_ENTRY_WIDTH +: CQ_ENTRY_WIDTH] = cq_line[cq_beat*CQ_ENTRIES_PER_BEAT + e];
+		cq_wstrb[e*(CQ_ENTRY_WIDTH/8) +: CQ_ENTRY_WIDTH/8] =
+			{(CQ_ENTRY_WIDTH/8){cq_line_valid[cq_beat*CQ_ENTRIES_PER_BEAT + e]}};
+	end
+
+	cq_first_valid_beat = '0;
+	cq_last_valid_beat = '0;
+	for (int i = CQ_LINE_ENTRIES-1; i >= 0; i--) begin
+		if (cq_line_valid[i]) begin
+			cq_first_valid_beat = CQ_BEAT_WIDTH'(i / CQ_ENTRIES_PER_BEAT);
+		end
+	end
+	for (int i = 0; i < CQ_LINE_ENTRIES; i++) begin
+		if (cq_line_valid[i]) begin
+			cq_last_valid_beat = CQ_BEAT_WIDTH'(i / CQ_ENTRIES_PER_BEAT);
+		end
+	end
+end
+
+assign axi_w.wdata = cq_active ? cq_wdata : o_desc;
+
+typedef enum logic [2:0] {
 	W_STATE_INIT,
 	W_STATE_FETCH_AXI_ID,
 	W_STATE_FETCH_COOKIE,
-	W_STATE_START_AXI_TRANSACTION
+	W_STATE_START_AXI_TRANSACTION,
+	W_STATE_CQ_SETTLE,
+	W_STATE_CQ_START_AXI_TRANSACTION,
+	W_STATE_CQ_AXI_TRANSACTION
 } w_state_t;
 var w_state_t w_state;
 
@@ -61,16 +140,18 @@ typedef enum logic [1:0] {
 } b_state_t;
 var b_state_t b_state;
 
-assign axi_aw.awlen = 8'd0;
+assign axi_aw.awlen = cq_active ? cq_awlen : 8'd0;
 assign axi_aw.awsize = $clog2(($bits(axi_w.wdata)/8)-1);
 assign axi_aw.awburst = 2'b01;
-assign axi_aw.awcache = 4'b0011;
-assign axi_aw.awprot = 3'h0;
+assign axi_aw.awcache = axi_attr.cache;
+assign axi_aw.awprot = axi_attr.prot;
 assign axi_aw.awqos = 4'h0;
 assign axi_aw.awlock = 0;
-assign axi_aw.awuser = 1;
+assign axi_aw.awuser = axi_attr.user;
 
-assign axi_w.wstrb = {($bits(axi_w.wdata)/8){1'b1}};
+localparam logic [$bits(DESC_TYPE)/8-1:0] DESC_WSTRB =
+	type(DESC_TYPE) == type(virtq_packed_desc_t) ? {2'b11, 2'b00, 4'hf, 8'h00} : '1;
+assign axi_w.wstrb = cq_active ? cq_wstrb : DESC_WSTRB;
 assign axi_w.wuser = 0;
 
 always_ff @(posedge clock) begin
@@ -86,8 +167,17 @@ always_ff @(posedge clock) begin
 		axi_b.bready <= 1'b0;
 		axi_id_alloc_ready <= 1'b0;
 		axi_id_dealloc_valid <= 1'b0;
+		cq_tail <= '0;
+		cq_phase <= 1'b1;
+		cq_line_valid <= '0;
+		cq_active <= 1'b0;
 	end
 	else begin
+		if (!cq_enable) begin
+			cq_tail <= '0;
+			cq_phase <= 1'b1;
+		end
+
 		case (w_state)
 		W_STATE_INIT: begin
 			axi_id_alloc_ready <= 1'b1;
@@ -101,14 +191,76 @@ always_ff @(posedge clock) begin
 			end
 		end
 		W_STATE_FETCH_COOKIE: begin
-			if (!i_cookie_fifo_r.empty) begin
+			if (cq_enable) begin
+				if (!i_cookie_fifo_r.empty) begin
+					i_cookie_fifo_r.rd_en <= 1'b1;
+
+					if (cq_line_valid == '0) begin
+						cq_line_addr <= cq_base +
+							SYSTEM_ADDR_WIDTH'({cq_tail[CQ_INDEX_WIDTH-1:CQ_SLOT_WIDTH], {CQ_SLOT_WIDTH{1'b0}}}) *
+							(CQ_ENTRY_WIDTH/8);
+					end
+					cq_line_valid[cq_slot] <= 1'b1;
+					cq_line[cq_slot].phase <= cq_phase;
+					cq_line[cq_slot].size <= CQ_ENTRY_SIZE_WIDTH'(i_cookie.size);
+					cq_line[cq_slot].desc_addr <= i_cookie.addr;
+					cq_line[cq_slot].flags <= '0;
+					cq_line[cq_slot].flags[0] <= i_cookie.eof;
+					cq_line[cq_slot].buf_last <= 1'b0;
+					if (type(i_cookie) == type(rx_cookie_t)) begin
+						cq_line[cq_slot].buf_last <= i_cookie.buf_last;
+						cq_line[cq_slot].flags[1] <= i_cookie.sof;
+						cq_line[cq_slot].flags[2] <= i_cookie.fcs;
+						cq_line[cq_slot].flags[4:3] <= i_cookie.chksum_enc;
+						cq_line[cq_slot].flags[5] <= i_cookie.rx_w_vlan_tagged;
+						cq_line[cq_slot].flags[6] <= i_cookie.rx_w_prty_tagged;
+						cq_line[cq_slot].flags[7] <= i_cookie.digest_err | i_cookie.esp_auth_err;
+					end
+					else if (type(i_cookie) == type(tx_cookie_t)) begin
+						cq_line[cq_slot].flags[2] <= i_cookie.nocrc;
+					end
+
+					if (cq_tail_wraps) begin
+						cq_tail <= '0;
+						cq_phase <= ~cq_phase;
+					end
+					else begin
+						cq_tail <= cq_tail + 1;
+					end
+
+					// The line is full or the queue wraps.
+					if (cq_slot == CQ_SLOT_WIDTH'(CQ_LINE_ENTRIES-1) || cq_tail_wraps) begin
+						w_state <= W_STATE_CQ_START_AXI_TRANSACTION;
+					end
+					else begin
+						w_state <= W_STATE_CQ_SETTLE;
+					end
+				end
+				else if (cq_line_valid != '0) begin
+					// No further completions right now.
+					w_state <= W_STATE_CQ_START_AXI_TRANSACTION;
+				end
+			end
+			else if (!i_cookie_fifo_r.empty) begin
 				i_cookie_fifo_r.rd_en <= 1'b1;
 
 				axi_aw.awvalid <= 1'b1;
 				axi_aw.awaddr <= i_cookie.addr;
 
 				axi_w.wvalid <= 1'b1;
-				if (type(i_cookie) == type(rx_cookie_t)) begin
+				if (type(o_desc) == type(virtq_packed_desc_t)) begin
+					o_desc.flags <= '0;
+					o_desc.flags[VIRTQ_DESC_F_AVAIL_BITN] <= i_cookie.wrap;
+					o_desc.flags[VIRTQ_DESC_F_USED_BITN] <= i_cookie.wrap;
+					// The number of bytes written to the buffer
+					if (type(i_cookie) == type(rx_cookie_t)) begin
+						o_desc.len <= 32'(i_cookie.size);
+					end
+					else begin
+						o_desc.len <= '0;
+					end
+				end
+				else if (type(i_cookie) == type(rx_cookie_t)) begin
 					o_desc.valid <= 1'b1;
 					o_desc.wrap <= i_cookie.wrap;
 					// The 2 LSB of the ADDRL field are used for the
@@ -120,6 +272,9 @@ always_ff @(posedge clock) begin
 					o_desc.sof <= i_cookie.sof;
 					o_desc.eof <= i_cookie.eof;
 					o_desc.cfi <= i_cookie.cfi;
+					// For untagged frames, prio is the IP precedence.
+					o_desc.vlan_prio <= (i_cookie.rx_w_vlan_tagged | i_cookie.rx_w_prty_tagged) ?
+						i_cookie.prio : 3'b000;
 					o_desc.rx_w_prty_tagged <= i_cookie.rx_w_prty_tagged;
 					o_desc.rx_w_vlan_tagged <= i_cookie.rx_w_vlan_tagged;
 					o_desc.chksum_enc <= i_cookie.chksum_enc;
@@ -170,6 +325,48 @@ always_ff @(posedge clock) begin
 				w_state <= W_STATE_FETCH_AXI_ID;
 			end
 		end
+		W_STATE_CQ_SETTLE: begin
+			// In this clock cycle, the input FIFO pops the cookie.
+			w_state <= W_STATE_FETCH_COOKIE;
+		end
+		W_STATE_CQ_START_AXI_TRANSACTION: begin
+			cq_active <= 1'b1;
+			cq_beat <= cq_first_valid_beat;
+			cq_last_beat <= cq_last_valid_beat;
+			cq_awlen <= 8'(cq_last_valid_beat - cq_first_valid_beat);
+
+			axi_aw.awvalid <= 1'b1;
+			axi_aw.awaddr <= cq_line_addr +
+				SYSTEM_ADDR_WIDTH'(cq_first_valid_beat) * ($bits(axi_w.wdata)/8);
+
+			axi_w.wvalid <= 1'b1;
+			axi_w.wlast <= cq_first_valid_beat == cq_last_valid_beat;
+
+			w_state <= W_STATE_CQ_AXI_TRANSACTION;
+		end
+		W_STATE_CQ_AXI_TRANSACTION: begin
+			if (axi_aw.awvalid & axi_aw.awready) begin
+				axi_aw.awvalid <= 1'b0;
+			end
+			if (axi_w.wvalid & axi_w.wready) begin
+				if (axi_w.wlast) begin
+					axi_w.wvalid <= 1'b0;
+					axi_w.wlast <= 1'b0;
+				end
+				else begin
+					cq_beat <= cq_beat + 1;
+					axi_w.wlast <= cq_beat + 1 == cq_last_beat;
+				end
+			end
+			if (((axi_aw.awvalid & axi_aw.awready) || !axi_aw.awvalid) &&
+				((axi_w.wvalid & axi_w.wready & axi_w.wlast) || !axi_w.wvalid))
+			begin
+				cq_active <= 1'b0;
+				cq_line_valid <= '0;
+				axi_id_alloc_ready <= 1'b1;
+				w_state <= W_STATE_FETCH_AXI_ID;
+			end
+		end
 		endcase
 
 		case (b_state)
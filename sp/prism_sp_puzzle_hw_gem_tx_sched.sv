@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Merges the cookies of NQUEUES TX rings into a single FIFO.
+ *
+ * Rings are only switched at frame boundaries (eof).
+ * With strict priority, the non-empty ring with the highest index wins.
+ * With weighted round-robin, ring q may send weights[4*q +: 4] frames
+ * (a weight of zero counts as one) before the next non-empty ring is
+ * served.
+ */
+module prism_sp_puzzle_hw_gem_tx_sched #(
+	parameter int NQUEUES
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic wrr,
+	input wire logic [31:0] weights,
+
+	fifo_read_interface.master i_cookie_fifo_r [NQUEUES],
+	fifo_write_interface.master o_cookie_fifo_w
+);
+
+localparam int QUEUE_WIDTH = NQUEUES > 1 ? $clog2(NQUEUES) : 1;
+
+typedef enum logic {
+	STATE_IDLE,
+	STATE_FIFO_SETTLE
+} state_t;
+var state_t state;
+
+var logic [QUEUE_WIDTH-1:0] queue;
+var logic cookie_rd_en;
+wire tx_cookie_t i_tx_cookies [NQUEUES];
+wire logic [NQUEUES-1:0] cookie_available;
+for (genvar q = 0; q < NQUEUES; q++) begin
+	assign i_tx_cookies[q] = i_cookie_fifo_r[q].rd_data;
+	assign cookie_available[q] = !i_cookie_fifo_r[q].empty;
+	assign i_cookie_fifo_r[q].rd_en = cookie_rd_en && queue == q;
+end
+
+/*
+ * Cookie stored in
+ * o_cookie_fifo_w.wr_data
+ */
+var tx_cookie_t o_tx_cookie;
+assign o_cookie_fifo_w.wr_data = o_tx_cookie;
+
+// Set while the fragments of a frame are forwarded.
+var logic in_frame;
+// The number of frames the current ring may still send in this round.
+var logic [3:0] credit;
+
+var logic [QUEUE_WIDTH-1:0] sel_queue;
+var logic [3:0] sel_credit;
+var logic sel_valid;
+
+always_comb begin
+	sel_queue = queue;
+	sel_credit = credit;
+	sel_valid = 1'b0;
+
+	if (in_frame) begin
+		sel_valid = cookie_available[queue];
+	end
+	else if (wrr) begin
+		if (credit != 0 && cookie_available[queue]) begin
+			sel_valid = 1'b1;
+		end
+		else begin
+			// The first non-empty ring after the current one wins.
+			for (int i = NQUEUES; i > 0; i--) begin
+				if (cookie_available[(queue + i) % NQUEUES]) begin
+					sel_queue = QUEUE_WIDTH'((queue + i) % NQUEUES);
+					sel_credit = weights[4*((queue + i) % NQUEUES) +: 4];
+					if (sel_credit == 0) begin
+						sel_credit = 1;
+					end
+					sel_valid = 1'b1;
+				end
+			end
+		end
+	end
+	else begin
+		for (int q = 0; q < NQUEUES; q++) begin
+			if (cookie_available[q]) begin
+				sel_queue = QUEUE_WIDTH'(q);
+				sel_valid = 1'b1;
+			end
+		end
+	end
+end
+
+always_ff @(posedge clock) begin
+	cookie_rd_en <= 1'b0;
+	o_cookie_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		queue <= '0;
+		in_frame <= 1'b0;
+		credit <= '0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			// Keep the downstream FIFO short so that a higher priority
+			// ring does not have to wait for a backlog of bulk cookies.
+			if (sel_valid && !o_cookie_fifo_w.full &&
+				o_cookie_fifo_w.wr_data_count < TX_SCHED_BACKLOG)
+			begin
+				o_tx_cookie <= i_tx_cookies[sel_queue];
+				o_tx_cookie.queue <= TX_COOKIE_QUEUE_WIDTH'(sel_queue);
+				o_cookie_fifo_w.wr_en <= 1'b1;
+				cookie_rd_en <= 1'b1;
+				queue <= sel_queue;
+				in_frame <= !i_tx_cookies[sel_queue].eof;
+				credit <= sel_credit - i_tx_cookies[sel_queue].eof;
+				state <= STATE_FIFO_SETTLE;
+			end
+		end
+		STATE_FIFO_SETTLE: begin
+			// In this clock cycle, the input FIFO pops the cookie.
+			state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+endmodule
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Token bucket shaper in front of a cookie FIFO.
+ *
+ * The shaper does not buffer cookies. It hides the head of
+ * i_cookie_fifo_r (by reporting the FIFO as empty) until the frame may
+ * be sent. A frame may start if
+ * - the bucket of its ring holds tokens,
+ * - the port bucket, which is shared by all rings, holds tokens and
+ * - its launch time, if any, has been reached.
+ * Every fragment that is read debits its size from both buckets.
+ * The buckets may become negative, i.e., a frame is never split.
+ *
+ * rate is given in 1/256 bytes per clock cycle (16 bits used), burst in
+ * bytes (24 bits used). A rate of zero disables the bucket.
+ */
+module prism_sp_puzzle_hw_gem_tx_shaper #(
+	parameter int NQUEUES
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [31:0] queue_rate [NQUEUES],
+	input wire logic [31:0] queue_burst [NQUEUES],
+	input wire logic [31:0] port_rate,
+	input wire logic [31:0] port_burst,
+
+	// Free-running clock cycle counter for launch times
+	output var logic [TX_COOKIE_LAUNCH_TIME_WIDTH-1:0] now,
+
+	fifo_read_interface.master i_cookie_fifo_r,
+	fifo_read_interface.slave o_cookie_fifo_r
+);
+
+localparam int RATE_WIDTH = 16;
+localparam int BURST_WIDTH = 24;
+localparam int TOKEN_FRAC_WIDTH = 8;
+// One bit of headroom plus the sign bit
+localparam int TOKEN_WIDTH = BURST_WIDTH + TOKEN_FRAC_WIDTH + 2;
+
+wire tx_cookie_t i_tx_cookie = i_cookie_fifo_r.rd_data;
+wire logic pop = o_cookie_fifo_r.rd_en;
+
+var logic signed [TOKEN_WIDTH-1:0] queue_tokens [NQUEUES];
+var logic signed [TOKEN_WIDTH-1:0] port_tokens;
+
+// Set while the fragments of a frame are read.
+var logic in_frame;
+
+var logic hold;
+always_comb begin
+	hold = 1'b0;
+
+	if (!in_frame) begin
+		for (int q = 0; q < NQUEUES; q++) begin
+			if (i_tx_cookie.queue == q && queue_rate[q][RATE_WIDTH-1:0] != '0 && queue_tokens[q] <= 0) begin
+				hold = 1'b1;
+			end
+		end
+		if (port_rate[RATE_WIDTH-1:0] != '0 && port_tokens <= 0) begin
+			hold = 1'b1;
+		end
+		if (i_tx_cookie.launch_time != '0 && $signed(now - i_tx_cookie.launch_time) < 0) begin
+			hold = 1'b1;
+		end
+	end
+end
+
+assign i_cookie_fifo_r.clock = o_cookie_fifo_r.clock;
+assign i_cookie_fifo_r.reset = o_cookie_fifo_r.reset;
+assign i_cookie_fifo_r.rd_en = pop;
+assign o_cookie_fifo_r.rd_data = i_cookie_fifo_r.rd_data;
+assign o_cookie_fifo_r.empty = i_cookie_fifo_r.empty | hold;
+assign o_cookie_fifo_r.almost_empty = i_cookie_fifo_r.almost_empty | hold;
+assign o_cookie_fifo_r.rd_data_count = hold ? '0 : i_cookie_fifo_r.rd_data_count;
+
+function automatic logic signed [TOKEN_WIDTH-1:0] refill(
+	input var logic signed [TOKEN_WIDTH-1:0] tokens,
+	input var logic [31:0] rate,
+	input var logic [31:0] burst,
+	input var logic debit,
+	input var logic [TX_COOKIE_SIZE_WIDTH-1:0] size
+);
+	logic signed [TOKEN_WIDTH-1:0] limit;
+	logic signed [TOKEN_WIDTH-1:0] t;
+
+	limit = TOKEN_WIDTH'({burst[BURST_WIDTH-1:0], {TOKEN_FRAC_WIDTH{1'b0}}});
+	t = tokens + TOKEN_WIDTH'(rate[RATE_WIDTH-1:0]);
+	if (t > limit) begin
+		t = limit;
+	end
+	if (debit) begin
+		t = t - TOKEN_WIDTH'({size, {TOKEN_FRAC_WIDTH{1'b0}}});
+	end
+	// A disabled bucket starts full when it is enabled.
+	if (rate[RATE_WIDTH-1:0] == '0) begin
+		t = limit;
+	end
+	return t;
+endfunction
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		now <= '0;
+		in_frame <= 1'b0;
+		port_tokens <= '0;
+		for (int q = 0; q < NQUEUES; q++) begin
+			queue_tokens[q] <= '0;
+		end
+	end
+	else begin
+		now <= now + 1;
+
+		if (pop) begin
+			in_frame <= !i_tx_cookie.eof;
+		end
+
+		port_tokens <= refill(port_tokens, port_rate, port_burst, pop, i_tx_cookie.size);
+		for (int q = 0; q < NQUEUES; q++) begin
+			queue_tokens[q] <= refill(queue_tokens[q], queue_rate[q], queue_burst[q],
+				pop && i_tx_cookie.queue == q, i_tx_cookie.size);
+		end
+	end
+end
+
+endmodule
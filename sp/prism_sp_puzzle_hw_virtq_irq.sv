@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * The interrupt module of a virtio packed virtqueue.
+ *
+ * Every entry of fifo_r stands for a descriptor that the ring release
+ * has marked as used. For every entry, the driver event suppression
+ * structure at event_addr is read over axi_ar/axi_r. An interrupt is
+ * raised if
+ * - its flags are VIRTQ_EVENT_F_ENABLE or
+ * - its flags are VIRTQ_EVENT_F_DESC and its off_wrap equals the index
+ *   and the wrap counter of the used descriptor.
+ *
+ * The index of the next used descriptor is tracked here. It is reset
+ * while the ring is disabled.
+ */
+module prism_sp_puzzle_hw_virtq_irq (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] event_addr,
+
+	mmr_intr_interface.master mmr_i,
+
+	fifo_read_interface.master fifo_r,
+
+	input wire axi_attr_t axi_attr,
+	axi_read_address_channel.master axi_ar,
+	axi_read_channel.master axi_r
+);
+
+localparam int EVENT_WIDTH = $bits(virtq_event_t);
+if ($bits(axi_r.rdata) < EVENT_WIDTH) begin
+	$error("The data width of the AXI port (%d) has to be at least %d\n",
+		$bits(axi_r.rdata), EVENT_WIDTH);
+end
+localparam int LANE_WIDTH = $clog2($bits(axi_r.rdata)/8);
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_AR,
+	STATE_R
+} state_t;
+
+var state_t state;
+
+// The next descriptor to be marked as used
+var logic [VIRTQ_RING_SIZE_WIDTH-1:0] used_idx;
+var logic used_wrap;
+// The descriptor the event suppression structure is read for
+var logic [VIRTQ_RING_SIZE_WIDTH-1:0] cur_idx;
+var logic cur_wrap;
+
+wire virtq_event_t event_in = EVENT_WIDTH'(axi_r.rdata >> (8 * event_addr[LANE_WIDTH-1:0]));
+wire logic event_match =
+	event_in.flags == VIRTQ_EVENT_F_ENABLE ||
+	(event_in.flags == VIRTQ_EVENT_F_DESC && event_in.off_wrap == { cur_wrap, cur_idx[14:0] });
+
+assign axi_ar.arid = '0;
+assign axi_ar.arlen = 8'd0;
+assign axi_ar.arsize = $clog2(EVENT_WIDTH/8);
+assign axi_ar.arburst = 2'b01;
+assign axi_ar.arlock = 1'b0;
+assign axi_ar.arcache = axi_attr.cache;
+assign axi_ar.arprot = axi_attr.prot;
+assign axi_ar.arqos = 4'h0;
+assign axi_ar.aruser = axi_attr.user;
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	fifo_r.rd_en <= 1'b0;
+	mmr_i.isr_pulses[0] <= '0;
+
+	if (!resetn) begin
+		axi_ar.arvalid <= 1'b0;
+		axi_r.rready <= 1'b0;
+		used_idx <= '0;
+		// The wrap counters start at 1.
+		used_wrap <= 1'b1;
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			if (!enable) begin
+				used_idx <= '0;
+				used_wrap <= 1'b1;
+			end
+			else if (!fifo_r.empty) begin
+				fifo_r.rd_en <= 1'b1;
+
+				cur_idx <= used_idx;
+				cur_wrap <= used_wrap;
+				if (used_idx == ring_size - 1) begin
+					used_idx <= '0;
+					used_wrap <= ~used_wrap;
+				end
+				else begin
+					used_idx <= used_idx + 1;
+				end
+
+				axi_ar.araddr <= event_addr;
+				axi_ar.arvalid <= 1'b1;
+				state <= STATE_AR;
+			end
+		end
+		STATE_AR: begin
+			if (axi_ar.arready) begin
+				axi_ar.arvalid <= 1'b0;
+				axi_r.rready <= 1'b1;
+				state <= STATE_R;
+			end
+		end
+		STATE_R: begin
+			if (axi_r.rvalid) begin
+				axi_r.rready <= 1'b0;
+				mmr_i.isr_pulses[0] <= event_match;
+				state <= STATE_IDLE;
+			end
+		end
+		endcase
+	end
+end
+
+endmodule
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Spreads the cookies of one puzzle stage over NWORKERS processors and
+ * restores their original order on the output side.
+ *
+ * Cookies are read from m_fifo_r and written to the input FIFO
+ * (s_fifo_r) of a worker. Workers are only switched at frame boundaries,
+ * i.e., after a cookie with bit EOF_BITN set. If EOF_BITN is negative,
+ * every cookie is a frame of its own.
+ * If HASH_WORD is negative, frames are dealt round-robin. Otherwise,
+ * the worker is selected by a hash over the 32-bit word HASH_WORD of the
+ * first cookie of a frame.
+ *
+ * The index of the worker of every dispatched cookie is kept in an order
+ * FIFO. Cookies are taken from the output FIFOs (s_fifo_w) of the
+ * workers in that order and written to m_fifo_w. Hence, a worker must
+ * write exactly one cookie for every cookie it reads.
+ */
+module prism_sp_puzzle_worker_dispatch #(
+	parameter int NWORKERS,
+	parameter int HASH_WORD = -1,
+	parameter int EOF_BITN = -1
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	fifo_read_interface.master m_fifo_r,
+	fifo_write_interface.master m_fifo_w,
+
+	fifo_read_interface.slave s_fifo_r [NWORKERS],
+	fifo_write_interface.slave s_fifo_w [NWORKERS]
+);
+
+localparam int WORKER_WIDTH = NWORKERS > 1 ? $clog2(NWORKERS) : 1;
+// The per-worker FIFOs are as deep as the FIFOs of the stage.
+localparam int WORKER_FIFO_DEPTH = 2**(m_fifo_r.DATA_COUNT_WIDTH-1);
+// Every cookie that is in a worker FIFO or in a worker is in the order FIFO.
+localparam int ORDER_FIFO_DEPTH = 2**$clog2(NWORKERS * (2*WORKER_FIFO_DEPTH + 1));
+localparam int ORDER_FIFO_DATA_COUNT_WIDTH = $clog2(ORDER_FIFO_DEPTH) + 1;
+
+typedef enum logic {
+	STATE_IDLE,
+	STATE_FIFO_SETTLE
+} state_t;
+
+fifo_write_interface #(
+	.DATA_WIDTH(m_fifo_r.DATA_WIDTH),
+	.DATA_COUNT_WIDTH(m_fifo_r.DATA_COUNT_WIDTH)
+) in_fifo_w [NWORKERS] ();
+fifo_read_interface #(
+	.DATA_WIDTH(m_fifo_w.DATA_WIDTH),
+	.DATA_COUNT_WIDTH(m_fifo_w.DATA_COUNT_WIDTH)
+) out_fifo_r [NWORKERS] ();
+
+fifo_write_interface #(
+	.DATA_WIDTH(FIFO_MIN_WIDTH),
+	.DATA_COUNT_WIDTH(ORDER_FIFO_DATA_COUNT_WIDTH)
+) order_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(FIFO_MIN_WIDTH),
+	.DATA_COUNT_WIDTH(ORDER_FIFO_DATA_COUNT_WIDTH)
+) order_fifo_r();
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(ORDER_FIFO_DEPTH)
+) order_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(order_fifo_r),
+	.fifo_w(order_fifo_w)
+);
+
+/*
+ * Dispatch
+ */
+var state_t dispatch_state;
+var logic [WORKER_WIDTH-1:0] dispatch_worker;
+var logic [m_fifo_r.DATA_WIDTH-1:0] dispatch_cookie;
+var logic dispatch_wr_en;
+// Set while the cookies of a frame are dispatched.
+var logic in_frame;
+
+wire logic [m_fifo_r.DATA_WIDTH-1:0] head = m_fifo_r.rd_data;
+wire logic [NWORKERS-1:0] in_full;
+
+for (genvar w = 0; w < NWORKERS; w++) begin
+	assign in_fifo_w[w].wr_data = dispatch_cookie;
+	assign in_fifo_w[w].wr_en = dispatch_wr_en && dispatch_worker == w;
+	assign in_full[w] = in_fifo_w[w].full;
+
+	prism_sp_fifo_sync #(
+		.FIFO_WRITE_DEPTH(WORKER_FIFO_DEPTH)
+	) in_fifo (
+		.clock,
+		.resetn,
+		.fifo_r(s_fifo_r[w]),
+		.fifo_w(in_fifo_w[w])
+	);
+end
+
+assign order_fifo_w.wr_data = FIFO_MIN_WIDTH'(dispatch_worker);
+assign order_fifo_w.wr_en = dispatch_wr_en;
+
+function automatic logic [WORKER_WIDTH-1:0] hash(input logic [31:0] word);
+	logic [31:0] h;
+
+	h = word ^ (word >> 16);
+	h = h ^ (h >> 8);
+	h = h ^ (h >> 4);
+	return WORKER_WIDTH'(h[7:0] % NWORKERS);
+endfunction
+
+var logic [WORKER_WIDTH-1:0] sel_worker;
+always_comb begin
+	sel_worker = dispatch_worker;
+
+	if (!in_frame) begin
+		if (HASH_WORD >= 0) begin
+			sel_worker = hash(head[32*HASH_WORD +: 32]);
+		end
+		else begin
+			sel_worker = WORKER_WIDTH'((dispatch_worker + 1) % NWORKERS);
+		end
+	end
+end
+
+wire logic head_eof = EOF_BITN < 0 ? 1'b1 : head[EOF_BITN];
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	m_fifo_r.rd_en <= 1'b0;
+	dispatch_wr_en <= 1'b0;
+
+	if (!resetn) begin
+		// The first frame goes to worker 0.
+		dispatch_worker <= WORKER_WIDTH'(NWORKERS - 1);
+		in_frame <= 1'b0;
+		dispatch_state <= STATE_IDLE;
+	end
+	else begin
+		case (dispatch_state)
+		STATE_IDLE: begin
+			if (!m_fifo_r.empty && !in_full[sel_worker] && !order_fifo_w.full) begin
+				dispatch_cookie <= head;
+				dispatch_worker <= sel_worker;
+				dispatch_wr_en <= 1'b1;
+				m_fifo_r.rd_en <= 1'b1;
+				in_frame <= !head_eof;
+				dispatch_state <= STATE_FIFO_SETTLE;
+			end
+		end
+		STATE_FIFO_SETTLE: begin
+			// In this clock cycle, the stage FIFO pops the cookie.
+			dispatch_state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+/*
+ * Reorder
+ */
+var state_t merge_state;
+var logic [WORKER_WIDTH-1:0] merge_worker;
+var logic merge_rd_en;
+
+wire logic [WORKER_WIDTH-1:0] order_head = order_fifo_r.rd_data[WORKER_WIDTH-1:0];
+wire logic [NWORKERS-1:0] out_empty;
+wire logic [m_fifo_w.DATA_WIDTH-1:0] out_data [NWORKERS];
+
+for (genvar w = 0; w < NWORKERS; w++) begin
+	assign out_empty[w] = out_fifo_r[w].empty;
+	assign out_data[w] = out_fifo_r[w].rd_data;
+	assign out_fifo_r[w].rd_en = merge_rd_en && merge_worker == w;
+
+	prism_sp_fifo_sync #(
+		.FIFO_WRITE_DEPTH(WORKER_FIFO_DEPTH)
+	) out_fifo (
+		.clock,
+		.resetn,
+		.fifo_r(out_fifo_r[w]),
+		.fifo_w(s_fifo_w[w])
+	);
+end
+
+assign order_fifo_r.rd_en = merge_rd_en;
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	m_fifo_w.wr_en <= 1'b0;
+	merge_rd_en <= 1'b0;
+
+	if (!resetn) begin
+		merge_worker <= '0;
+		merge_state <= STATE_IDLE;
+	end
+	else begin
+		case (merge_state)
+		STATE_IDLE: begin
+			if (!order_fifo_r.empty && !out_empty[order_head] && !m_fifo_w.full) begin
+				m_fifo_w.wr_data <= out_data[order_head];
+				m_fifo_w.wr_en <= 1'b1;
+				merge_worker <= order_head;
+				merge_rd_en <= 1'b1;
+				merge_state <= STATE_FIFO_SETTLE;
+			end
+		end
+		STATE_FIFO_SETTLE: begin
+			// In this clock cycle, the order FIFO and the worker FIFO
+			// pop their heads.
+			merge_state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+endmodule
@@ -35,4 +35,9 @@ if (DMA_DESC_64BITADDR) begin
 end
 assign cookie.wrap = desc.wrap;
 
+// In SQ/CQ mode, phase flips every time the ring wraps.
+assign conv.owned = desc.valid == conv.phase;
+assign conv.last = desc.wrap;
+assign conv.phase_per_pass = 1'b0;
+
 endmodule
@@ -23,6 +23,13 @@ assign desc = conv.data_in;
 wire dma_tx_cookie_t cookie;
 assign conv.data_out = cookie;
 
+assign cookie.launch_time = desc.unused;
+// Set by the firmware
+assign cookie.digest_start = '0;
+assign cookie.digest_end = '0;
+assign cookie.esp_sa = '0;
+// Set by the TX scheduler if there is more than one ring.
+assign cookie.queue = '0;
 assign cookie.addr = conv.dma_desc_cur;
 assign cookie.size = desc.size;
 assign cookie.nocrc = desc.nocrc;
@@ -33,4 +40,9 @@ if (DMA_DESC_64BITADDR) begin
 	assign cookie.data_addr[39:32] = desc.addrh;
 end
 
+// In SQ/CQ mode, phase flips every time the ring wraps.
+assign conv.owned = desc.valid == conv.phase;
+assign conv.last = desc.wrap;
+assign conv.phase_per_pass = 1'b0;
+
 endmodule
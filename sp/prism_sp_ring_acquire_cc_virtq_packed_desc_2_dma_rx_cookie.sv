@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * The RX buffer of a virtio packed virtqueue descriptor.
+ * The id of the descriptor is not copied; the ring release leaves it
+ * untouched when the descriptor is marked as used.
+ */
+module prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_rx_cookie(
+	prism_sp_ring_acquire_cookie_convert_interface.slave conv
+);
+
+wire virtq_packed_desc_t desc;
+assign desc = conv.data_in;
+
+wire dma_rx_cookie_t cookie;
+assign conv.data_out = cookie;
+
+assign cookie.addr = conv.dma_desc_cur;
+assign cookie.data_addr = desc.addr[SYSTEM_ADDR_WIDTH-1:0];
+// The wrap counter of the device, which the ring release writes to the
+// AVAIL and USED flags.
+assign cookie.wrap = ~conv.phase;
+
+// The wrap counters start at 1, the phase starts at 0.
+assign conv.owned = desc.flags[VIRTQ_DESC_F_AVAIL_BITN] == ~conv.phase &&
+	desc.flags[VIRTQ_DESC_F_USED_BITN] == conv.phase;
+assign conv.last = conv.dma_desc_cur - conv.dma_desc_base ==
+	SYSTEM_ADDR_WIDTH'(conv.ring_size - 1) * ($bits(virtq_packed_desc_t)/8);
+assign conv.phase_per_pass = 1'b1;
+
+endmodule
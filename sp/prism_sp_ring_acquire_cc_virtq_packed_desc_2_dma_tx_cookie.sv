@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * The TX buffer of a virtio packed virtqueue descriptor.
+ * A frame ends with the first descriptor without the NEXT flag. The
+ * virtio-net header in front of the frame is not removed here.
+ */
+module prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_tx_cookie(
+	prism_sp_ring_acquire_cookie_convert_interface.slave conv
+);
+
+wire virtq_packed_desc_t desc;
+assign desc = conv.data_in;
+
+wire dma_tx_cookie_t cookie;
+assign conv.data_out = cookie;
+
+assign cookie.launch_time = '0;
+// Set by the firmware
+assign cookie.digest_start = '0;
+assign cookie.digest_end = '0;
+assign cookie.esp_sa = '0;
+// Set by the TX scheduler if there is more than one ring.
+assign cookie.queue = '0;
+assign cookie.addr = conv.dma_desc_cur;
+assign cookie.size = desc.len[TX_COOKIE_SIZE_WIDTH-1:0];
+assign cookie.nocrc = 1'b0;
+assign cookie.eof = !desc.flags[VIRTQ_DESC_F_NEXT_BITN];
+// The wrap counter of the device, which the ring release writes to the
+// AVAIL and USED flags.
+assign cookie.wrap = ~conv.phase;
+assign cookie.data_addr = desc.addr[SYSTEM_ADDR_WIDTH-1:0];
+
+// The wrap counters start at 1, the phase starts at 0.
+assign conv.owned = desc.flags[VIRTQ_DESC_F_AVAIL_BITN] == ~conv.phase &&
+	desc.flags[VIRTQ_DESC_F_USED_BITN] == conv.phase;
+assign conv.last = conv.dma_desc_cur - conv.dma_desc_base ==
+	SYSTEM_ADDR_WIDTH'(conv.ring_size - 1) * ($bits(virtq_packed_desc_t)/8);
+assign conv.phase_per_pass = 1'b1;
+
+endmodule
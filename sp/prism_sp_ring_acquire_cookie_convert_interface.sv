@@ -21,16 +21,38 @@ interface prism_sp_ring_acquire_cookie_convert_interface#(
 logic [DATA_IN_WIDTH-1:0] data_in;
 logic [DATA_OUT_WIDTH-1:0] data_out;
 logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_cur;
+logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base;
+logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size;
+// Flips every time the ring wraps if phase_per_pass is set.
+logic phase;
+
+// The descriptor in data_in belongs to the hardware.
+logic owned;
+// The descriptor in data_in is the last one of the ring.
+logic last;
+logic phase_per_pass;
 
 modport master(
 	output data_in,
 	input data_out,
-	output dma_desc_cur
+	output dma_desc_cur,
+	output dma_desc_base,
+	output ring_size,
+	output phase,
+	input owned,
+	input last,
+	input phase_per_pass
 );
 modport slave(
 	input data_in,
 	output data_out,
-	input dma_desc_cur
+	input dma_desc_cur,
+	input dma_desc_base,
+	input ring_size,
+	input phase,
+	output owned,
+	output last,
+	output phase_per_pass
 );
 
 endinterface
@@ -25,6 +25,8 @@ module prism_sp_rx_core #(
 
 	parameter int RX_DATA_FIFO_SIZE = 0,
 	parameter int RX_DATA_FIFO_WIDTH = 0,
+	// Admission control is only done for a single RX core.
+	parameter int USE_ADMIT = 0,
 
 	parameter int INSTANCE
 )
@@ -74,9 +76,49 @@ module prism_sp_rx_core #(
 	axi_write_channel.master				m_axi_dma_w,
 	axi_write_response_channel.master		m_axi_dma_b,
 
+	// Spill buffer in memory (see prism_sp_rx_spill)
+	axi_write_address_channel.master		m_axi_spill_aw,
+	axi_write_channel.master				m_axi_spill_w,
+	axi_write_response_channel.master		m_axi_spill_b,
+	axi_read_address_channel.master			m_axi_spill_ar,
+	axi_read_channel.master					m_axi_spill_r,
+
 	// Driven from the GEM receive module
 	fifo_write_interface.slave				rx_data_fifo_w,
 	fifo_write_interface.slave				rx_meta_fifo_w,
+	// Traffic generator (sent in the GEM RX clock domain)
+	output wire logic [31:0]				tgen_control,
+	output wire logic [31:0]				tgen_size,
+	output wire logic [31:0]				tgen_count,
+	input wire logic [31:0]					gem_tgen_sent,
+	// CRC32C data digest range (see prism_sp_gem_rx_single)
+	output wire logic [31:0]				rx_digest_range,
+	// ESP SA table (see prism_sp_esp_gcm)
+	output wire logic [127:0]				esp_sa_key,
+	output wire logic [31:0]				esp_sa_salt,
+	output wire logic [31:0]				esp_sa_spi,
+	output wire logic [31:0]				esp_sa_control,
+	// Tunnel offload (see REGOFF_TUNNEL_CONTROL)
+	output wire logic [31:0]				tunnel_control,
+	output wire logic [31:0]				tunnel_tmpl,
+	output wire logic [31:0]				tunnel_tmpl_addr,
+	// Flow telemetry (see prism_sp_flow_meter)
+	output wire logic						flow_enable,
+	output wire logic [31:0]				flow_timeout,
+	fifo_write_interface.slave				flow_fifo_w,
+	input wire logic [31:0]					gem_flow_drops,
+	// Packet capture (see prism_sp_capture)
+	output wire logic [31:0]				capture_control,
+	output wire logic [31:0]				capture_mask,
+	output wire logic [31:0]				capture_match,
+	fifo_write_interface.slave				capture_fifo_w,
+	input wire logic [31:0]					gem_capture_drops,
+	// Admission control (see prism_sp_gem_rx_single)
+	output wire logic [31:0]				admit_control,
+	output wire logic [31:0]				admit_thresh,
+	input wire logic [31:0]					gem_admit_drops,
+	output wire logic [31:0]				pause_control,
+	output wire logic [47:0]				pause_sa,
 
 	output wire logic channel_irq,
 
@@ -96,14 +138,77 @@ local_memory_interface data_bram_mmr();
 wire logic cpu_reset;
 wire logic [3:0] io_axi_axcache;
 wire logic [3:0] dma_axi_axcache;
-wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base [NRXQUEUES];
+wire logic [NRXQUEUES-1:0] rx_queue_enable;
+wire logic [31:0] rx_prio_map;
+wire logic [31:0] tgen_sent;
+wire logic rx_stride_enable;
+wire logic [4:0] rx_stride_shift;
+wire logic [4:0] rx_buf_shift;
+wire logic [15:0] rx_buf_reserve;
+wire logic bypass_enable;
+wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_word;
+wire logic [31:0] bypass_mask;
+wire logic [31:0] bypass_match;
+wire logic bypass_key_enable;
+wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_key_word;
+wire logic [4:0] bypass_key_shift;
+wire logic cq_enable;
+wire logic poll_enable;
+wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_min_shift;
+wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_max_shift;
+wire logic [CQ_CONTROL_SIZE_WIDTH-1:0] cq_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] cq_base;
+wire logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] virtq_event_addr;
+wire logic trace_arm;
+wire logic trace_force;
+wire logic [TRACE_CONTROL_WINDOW_WIDTH-1:0] trace_window;
+wire logic [TRACE_CONTROL_POST_WIDTH-1:0] trace_post;
+wire logic [31:0] trace_trig_mask;
+wire logic [31:0] trace_trig_match;
+wire logic [31:0] trace_addr;
+wire logic [31:0] trace_status;
+wire logic [31:0] trace_data;
+wire logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS];
+wire logic load_start;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] load_src;
+wire logic [31:0] load_dst;
+wire logic [31:0] load_size;
+wire logic [31:0] load_crc;
+wire logic [31:0] load_status;
+wire logic flow_export_enable;
+wire logic [FLOW_CONTROL_SIZE_WIDTH-1:0] flow_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] flow_base;
+wire logic [31:0] flow_drops;
+wire logic capture_enable;
+wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0] capture_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] capture_base;
+wire logic [31:0] capture_tail;
+wire logic [31:0] capture_head;
+wire logic [31:0] capture_drops;
+wire logic [31:0] axattr_desc_rd;
+wire logic [31:0] axattr_desc_wr;
+wire logic [31:0] axattr_hdr;
+wire logic [31:0] axattr_data;
+wire logic [31:0] axattr_flow;
+wire logic [31:0] axattr_capture;
+wire logic [31:0] admit_drops;
+wire logic spill_enable;
+wire logic [SPILL_CONTROL_SIZE_WIDTH-1:0] spill_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] spill_base;
+wire logic [31:0] spill_level;
+wire logic [31:0] spill_bursts;
+wire logic [31:0] axattr_spill;
 
 mmr_readwrite_interface #(.NREGS(MMR_RW_NREGS)) mmr_rw();
 mmr_read_interface #(.NREGS(MMR_R_NREGS)) mmr_r();
 
-mmr_trigger_interface #(.N(1),.WIDTH(2)) hw_mmr_t();
-mmr_trigger_interface #(.N(1),.WIDTH(2)) sw_mmr_t();
-mmr_trigger_interface #(.N(1),.WIDTH(2)) mmr_t();
+// One doorbell bit per ring
+localparam int MMR_T_WIDTH = NRXQUEUES > 2 ? NRXQUEUES : 2;
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) hw_mmr_t();
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) sw_mmr_t();
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) mmr_t();
 if (ENABLE_RX_SW_MMR_T) begin
 	mmr_trigger_interface_connect mmr_trigger_interface_connect_0(.m(mmr_t),.s(sw_mmr_t));
 end
@@ -132,7 +237,9 @@ axi_lite_mmr #(
 	.DBRAM_SIZE(DBRAM_SIZE),
 	.DATA_FIFO_SIZE(RX_DATA_FIFO_SIZE),
 	.DATA_FIFO_WIDTH(RX_DATA_FIFO_WIDTH),
-	.INSTANCE(INSTANCE)
+	.INSTANCE(INSTANCE),
+	.NQUEUES(NRXQUEUES),
+	.USE_ADMIT(USE_ADMIT)
 )
 axi_lite_mmr_inst(
 	.clock(clock),
@@ -152,19 +259,139 @@ axi_lite_mmr_inst(
 	.cpu_reset(cpu_reset),
 	.enable(rx_enable),
 	.dma_desc_base,
+	.queue_enable(rx_queue_enable),
+	.queue_weights(),
+	.queue_wrr(),
+	.rx_prio_map,
 	.io_axi_axcache,
 	.dma_axi_axcache,
 
+	.tx_ct_size(),
+	.tx_underflows('0),
+	.tx_queue_rate(),
+	.tx_queue_burst(),
+	.tx_port_rate(),
+	.tx_port_burst(),
+	.tx_time('0),
+
+	.bypass_enable,
+	.bypass_word,
+	.bypass_mask,
+	.bypass_match,
+	.bypass_key_enable,
+	.bypass_key_word,
+	.bypass_key_shift,
+
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.cq_size,
+	.cq_base,
+	.ring_size,
+	.virtq_event_addr,
+
+	.rx_stride_enable,
+	.rx_stride_shift,
+	.rx_buf_shift,
+	.rx_buf_reserve,
+
+	.tgen_control,
+	.tgen_size,
+	.tgen_count,
+	.tgen_sent,
+	.rx_digest_range,
+	.esp_sa_key,
+	.esp_sa_salt,
+	.esp_sa_spi,
+	.esp_sa_control,
+	.tunnel_control,
+	.tunnel_tmpl,
+	.tunnel_tmpl_addr,
+	.flow_enable,
+	.flow_export_enable,
+	.flow_size,
+	.flow_base,
+	.flow_timeout,
+	.flow_drops,
+	.admit_control,
+	.admit_thresh,
+	.admit_drops,
+	.pause_control,
+	.pause_sa,
+	.axattr_desc_rd,
+	.axattr_desc_wr,
+	.axattr_hdr,
+	.axattr_data,
+	.axattr_flow,
+	.axattr_capture,
+	.spill_enable,
+	.spill_size,
+	.spill_base,
+	.spill_level,
+	.spill_bursts,
+	.axattr_spill,
+	.capture_control,
+	.capture_mask,
+	.capture_match,
+	.capture_enable,
+	.capture_size,
+	.capture_base,
+	.capture_tail,
+	.capture_head,
+	.capture_drops,
+	.tchk_control(),
+	.tchk_results('0),
+
+	.trace_arm,
+	.trace_force,
+	.trace_window,
+	.trace_post,
+	.trace_trig_mask,
+	.trace_trig_match,
+	.trace_addr,
+	.trace_status,
+	.trace_data,
+
+	.perf_counters(sp_perf_counters),
+
+	.load_start,
+	.load_src,
+	.load_dst,
+	.load_size,
+	.load_crc,
+	.load_status,
+
 	.instruction_bram_mmr(instruction_bram_mmr),
 	.data_bram_mmr(data_bram_mmr)
 );
 
-// This is currently redundant.
-// But we might need it later in a transitional phase when both constants
-// are made independent of each other.
+/*
+ * AXI attributes of the descriptor streams
+ */
+wire axi_attr_t desc_rd_attr = axattr_desc_rd[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_desc_rd[$bits(axi_attr_t)-1:0]) : AXI_ATTR_DESC_RD;
+wire axi_attr_t desc_wr_attr = axattr_desc_wr[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_desc_wr[$bits(axi_attr_t)-1:0]) : AXI_ATTR_DESC_WR;
+
+/*
+ * AXI attributes of the flow records and the captured frames
+ */
+wire axi_attr_t flow_attr = axattr_flow[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_flow[$bits(axi_attr_t)-1:0]) : AXI_ATTR_FLOW;
+wire axi_attr_t capture_attr = axattr_capture[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_capture[$bits(axi_attr_t)-1:0]) : AXI_ATTR_CAPTURE;
+
+// A DMA data bus narrower than the RX data FIFO is served by
+// fifo_read_interface_downsize below.
 if (RX_DATA_FIFO_WIDTH != 0) begin
-	if (m_axi_dma_w.AXI_WDATA_WIDTH != RX_DATA_FIFO_WIDTH) begin
-		$error("We don't support m_axi_dma_w.AXI_WDATA_WIDTH != RX_DATA_FIFO_WIDTH)");
+	if (m_axi_dma_w.AXI_WDATA_WIDTH > RX_DATA_FIFO_WIDTH ||
+		RX_DATA_FIFO_WIDTH % m_axi_dma_w.AXI_WDATA_WIDTH != 0)
+	begin
+		$error("We don't support m_axi_dma_w.AXI_WDATA_WIDTH not dividing RX_DATA_FIFO_WIDTH)");
+	end
+	if (m_axi_dma_w.AXI_WDATA_WIDTH < 32) begin
+		$error("We don't support a DMA data width of less than 32.");
 	end
 	if (RX_DATA_FIFO_WIDTH < 32) begin
 		$error("We don't support a RX DATA FIFO width of less than 32.");
@@ -172,106 +399,31 @@ if (RX_DATA_FIFO_WIDTH != 0) begin
 end
 
 fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_hw_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_hw_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_hw_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_hw_fifo_r_3();
-
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_hw_fifo_w_0();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_hw_fifo_w_1();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_hw_fifo_r [NRXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_hw_fifo_w_2();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_hw_fifo_w_3();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_hw_fifo_w [NRXPUZZLEFIFOS] ();
 
 fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_sw_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_sw_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_sw_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_sw_fifo_r_3();
-
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_sw_fifo_w_0();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_sw_fifo_r [NRXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_sw_fifo_w_1();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_sw_fifo_w_2();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_sw_fifo_w_3();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_sw_fifo_w [NRXPUZZLEFIFOS] ();
 
 fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_fifo_r_3();
-
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_fifo_w_0();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_fifo_w_1();
-fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_fifo_w_2();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_fifo_r [NRXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_fifo_w_3();
+	.DATA_WIDTH(RX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_fifo_w [NRXPUZZLEFIFOS] ();
 
 /*
  * Interface used by the HW RX unit to read descriptors from the
@@ -296,12 +448,35 @@ fifo_read_interface #(
 	.DATA_WIDTH(RX_META_FIFO_WIDTH),
 	.DATA_COUNT_WIDTH(RX_META_FIFO_DATA_COUNT_WIDTH)
 ) rx_meta_fifo_r();
+/*
+ * Interface used to read descriptors behind the spill buffer.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(RX_META_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(RX_META_FIFO_DATA_COUNT_WIDTH)
+) spill_rx_meta_fifo_r();
+
+/*
+ * Interface used by the flow export to read flow records.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(FLOW_RECORD_WIDTH),
+	.DATA_COUNT_WIDTH(FLOW_FIFO_DATA_COUNT_WIDTH)
+) flow_fifo_r();
+
+/*
+ * Interface used by the capture writer to read slots.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.DATA_COUNT_WIDTH(CAPTURE_FIFO_DATA_COUNT_WIDTH)
+) capture_fifo_r();
 
 if (ENABLE_RX_SW_RX_META_FIFO_R) begin
-	fifo_read_interface_connect(.m(rx_meta_fifo_r), .s(sw_rx_meta_fifo_r));
+	fifo_read_interface_connect(.m(spill_rx_meta_fifo_r), .s(sw_rx_meta_fifo_r));
 end
 else begin
-	fifo_read_interface_connect(.m(rx_meta_fifo_r), .s(hw_rx_meta_fifo_r));
+	fifo_read_interface_connect(.m(spill_rx_meta_fifo_r), .s(hw_rx_meta_fifo_r));
 end
 
 /*
@@ -343,32 +518,22 @@ prism_sp_puzzle_fifo_mixer #(
 	.clock,
 	.resetn,
 
-	.puzzle_hw_fifo_r_0,
-	.puzzle_hw_fifo_w_0,
-	.puzzle_hw_fifo_r_1,
-	.puzzle_hw_fifo_w_1,
-	.puzzle_hw_fifo_r_2,
-	.puzzle_hw_fifo_w_2,
-	.puzzle_hw_fifo_r_3,
-	.puzzle_hw_fifo_w_3,
-
-	.puzzle_sw_fifo_r_0,
-	.puzzle_sw_fifo_w_0,
-	.puzzle_sw_fifo_r_1,
-	.puzzle_sw_fifo_w_1,
-	.puzzle_sw_fifo_r_2,
-	.puzzle_sw_fifo_w_2,
-	.puzzle_sw_fifo_r_3,
-	.puzzle_sw_fifo_w_3,
-
-	.puzzle_fifo_r_0,
-	.puzzle_fifo_w_0,
-	.puzzle_fifo_r_1,
-	.puzzle_fifo_w_1,
-	.puzzle_fifo_r_2,
-	.puzzle_fifo_w_2,
-	.puzzle_fifo_r_3,
-	.puzzle_fifo_w_3
+	.bypass_enable,
+	.bypass_word,
+	.bypass_mask,
+	.bypass_match,
+	.bypass_key_enable,
+	.bypass_key_word,
+	.bypass_key_shift,
+
+	.puzzle_hw_fifo_r,
+	.puzzle_hw_fifo_w,
+
+	.puzzle_sw_fifo_r,
+	.puzzle_sw_fifo_w,
+
+	.puzzle_fifo_r,
+	.puzzle_fifo_w
 );
 
 prism_sp_rx_puzzle_hw
@@ -376,24 +541,45 @@ prism_sp_rx_puzzle_hw_0 (
 	.clock,
 	.resetn,
 
-	.rx_enable,
+	.rx_queue_enable,
+	.rx_prio_map,
+	.rx_stride_enable,
+	.rx_stride_shift,
+	.rx_buf_shift,
+	.rx_buf_reserve,
 	.dma_desc_base,
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.cq_size,
+	.cq_base,
+	.ring_size,
+	.virtq_event_addr,
+	.flow_export_enable,
+	.flow_size,
+	.flow_base,
+	.capture_enable,
+	.capture_size,
+	.capture_base,
+	.capture_tail,
+	.capture_head,
+	.desc_rd_attr,
+	.desc_wr_attr,
+	.flow_attr,
+	.capture_attr,
 
 	.mmr_i(hw_mmr_i),
 	.mmr_t(hw_mmr_t),
 
-	.fifo_r_0(puzzle_hw_fifo_r_0),
-	.fifo_w_0(puzzle_hw_fifo_w_0),
-	.fifo_r_1(puzzle_hw_fifo_r_1),
-	.fifo_w_1(puzzle_hw_fifo_w_1),
-	.fifo_r_2(puzzle_hw_fifo_r_2),
-	.fifo_w_2(puzzle_hw_fifo_w_2),
-	.fifo_r_3(puzzle_hw_fifo_r_3),
-	.fifo_w_3(puzzle_hw_fifo_w_3),
+	.fifo_r(puzzle_hw_fifo_r),
+	.fifo_w(puzzle_hw_fifo_w),
 
 	// Interfaces used by the RX unit
 	.rx_data_mem_w(hw_rx_data_mem_w),
 	.rx_meta_fifo_r(hw_rx_meta_fifo_r),
+	.flow_fifo_r,
+	.capture_fifo_r,
 
 	.axi_ma_aw(m_axi_ma_aw),
 	.axi_ma_w(m_axi_ma_w),
@@ -422,63 +608,38 @@ prism_sp_rx_puzzle_hw_0 (
 
 prism_sp_puzzle_fifos #(
 	.NFIFOS(NRXPUZZLEFIFOS),
-	.FIFO_WRITE_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH)
+	.FIFO_WRITE_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH),
+	.FIFO_R_DATA_WIDTH(RX_PUZZLE_FIFO_R_DATA_WIDTH),
+	.FIFO_W_DATA_WIDTH(RX_PUZZLE_FIFO_W_DATA_WIDTH),
+	.FIFO_R_DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH),
+	.FIFO_W_DATA_COUNT_WIDTH(RX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH)
 ) prism_sp_puzzle_fifos_0 (
 	.clock,
 	.resetn,
 
-	.fifo_r_0(puzzle_fifo_r_0),
-	.fifo_w_0(puzzle_fifo_w_0),
-	.fifo_r_1(puzzle_fifo_r_1),
-	.fifo_w_1(puzzle_fifo_w_1),
-	.fifo_r_2(puzzle_fifo_r_2),
-	.fifo_w_2(puzzle_fifo_w_2),
-	.fifo_r_3(puzzle_fifo_r_3),
-	.fifo_w_3(puzzle_fifo_w_3)
+	.fifo_r(puzzle_fifo_r),
+	.fifo_w(puzzle_fifo_w)
 );
 
 assign trace_rx_puzzle.rx_enable = rx_enable;
 assign trace_rx_puzzle.rx_trigger = mmr_t.tsr[0][0];
 
-assign trace_rx_puzzle.puzzle_fifo_r_0_empty = puzzle_fifo_r_0.empty;
-assign trace_rx_puzzle.puzzle_fifo_r_0_rd_en = puzzle_fifo_r_0.rd_en;
-assign trace_rx_puzzle.puzzle_fifo_r_0_rd_data = puzzle_fifo_r_0.rd_data;
-assign trace_rx_puzzle.puzzle_fifo_r_0_rd_data_count = puzzle_fifo_r_0.rd_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_r_1_empty = puzzle_fifo_r_1.empty;
-assign trace_rx_puzzle.puzzle_fifo_r_1_rd_en = puzzle_fifo_r_1.rd_en;
-assign trace_rx_puzzle.puzzle_fifo_r_1_rd_data = puzzle_fifo_r_1.rd_data;
-assign trace_rx_puzzle.puzzle_fifo_r_1_rd_data_count = puzzle_fifo_r_1.rd_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_r_2_empty = puzzle_fifo_r_2.empty;
-assign trace_rx_puzzle.puzzle_fifo_r_2_rd_en = puzzle_fifo_r_2.rd_en;
-assign trace_rx_puzzle.puzzle_fifo_r_2_rd_data = puzzle_fifo_r_2.rd_data;
-assign trace_rx_puzzle.puzzle_fifo_r_2_rd_data_count = puzzle_fifo_r_2.rd_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_r_3_empty = puzzle_fifo_r_3.empty;
-assign trace_rx_puzzle.puzzle_fifo_r_3_rd_en = puzzle_fifo_r_3.rd_en;
-assign trace_rx_puzzle.puzzle_fifo_r_3_rd_data = puzzle_fifo_r_3.rd_data;
-assign trace_rx_puzzle.puzzle_fifo_r_3_rd_data_count = puzzle_fifo_r_3.rd_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_w_0_full = puzzle_fifo_w_0.full;
-assign trace_rx_puzzle.puzzle_fifo_w_0_wr_en = puzzle_fifo_w_0.wr_en;
-assign trace_rx_puzzle.puzzle_fifo_w_0_wr_data = puzzle_fifo_w_0.wr_data;
-assign trace_rx_puzzle.puzzle_fifo_w_0_wr_data_count = puzzle_fifo_w_0.wr_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_w_1_full = puzzle_fifo_w_1.full;
-assign trace_rx_puzzle.puzzle_fifo_w_1_wr_en = puzzle_fifo_w_1.wr_en;
-assign trace_rx_puzzle.puzzle_fifo_w_1_wr_data = puzzle_fifo_w_1.wr_data;
-assign trace_rx_puzzle.puzzle_fifo_w_1_wr_data_count = puzzle_fifo_w_1.wr_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_w_2_full = puzzle_fifo_w_2.full;
-assign trace_rx_puzzle.puzzle_fifo_w_2_wr_en = puzzle_fifo_w_2.wr_en;
-assign trace_rx_puzzle.puzzle_fifo_w_2_wr_data = puzzle_fifo_w_2.wr_data;
-assign trace_rx_puzzle.puzzle_fifo_w_2_wr_data_count = puzzle_fifo_w_2.wr_data_count;
-
-assign trace_rx_puzzle.puzzle_fifo_w_3_full = puzzle_fifo_w_3.full;
-assign trace_rx_puzzle.puzzle_fifo_w_3_wr_en = puzzle_fifo_w_3.wr_en;
-assign trace_rx_puzzle.puzzle_fifo_w_3_wr_data = puzzle_fifo_w_3.wr_data;
-assign trace_rx_puzzle.puzzle_fifo_w_3_wr_data_count = puzzle_fifo_w_3.wr_data_count;
+for (genvar i = 0; i < NRXPUZZLEFIFOS; i++) begin
+	assign trace_rx_puzzle.puzzle_fifo_r_empty[i] = puzzle_fifo_r[i].empty;
+	assign trace_rx_puzzle.puzzle_fifo_r_rd_en[i] = puzzle_fifo_r[i].rd_en;
+	assign trace_rx_puzzle.puzzle_fifo_r_rd_data[i] = puzzle_fifo_r[i].rd_data;
+	assign trace_rx_puzzle.puzzle_fifo_r_rd_data_count[i] = puzzle_fifo_r[i].rd_data_count;
+
+	assign trace_rx_puzzle.puzzle_fifo_w_full[i] = puzzle_fifo_w[i].full;
+	assign trace_rx_puzzle.puzzle_fifo_w_wr_en[i] = puzzle_fifo_w[i].wr_en;
+	assign trace_rx_puzzle.puzzle_fifo_w_wr_data[i] = puzzle_fifo_w[i].wr_data;
+	assign trace_rx_puzzle.puzzle_fifo_w_wr_data_count[i] = puzzle_fifo_w[i].wr_data_count;
+end
+
+/*
+ * Header window of the RX data stream (see prism_sp_unit_hdr).
+ */
+header_window_interface hdr_w();
 
 if (ENABLE_RX_RISCV_PROCESSOR) begin
 	fifo_write_interface #(
@@ -494,31 +655,64 @@ if (ENABLE_RX_RISCV_PROCESSOR) begin
 		.DATA_COUNT_WIDTH(0)
 	) dummy_tx_meta_fifo_w();
 
-	prism_sp_processor #(
+	/*
+	 * The BRAM loader sits between the MMRs, the IO bus and the processors.
+	 */
+	local_memory_interface instruction_bram_proc();
+	local_memory_interface data_bram_proc();
+	axi_interface #(
+		.C_M_AXI_ADDR_WIDTH(m_axi_mx.C_M_AXI_ADDR_WIDTH),
+		.C_M_AXI_DATA_WIDTH(m_axi_mx.C_M_AXI_DATA_WIDTH)
+	) proc_m_axi_io();
+
+	prism_sp_bram_loader #(
+		.IBRAM_SIZE(IBRAM_SIZE),
+		.DBRAM_SIZE(DBRAM_SIZE)
+	) prism_sp_bram_loader_0(
+		.clock,
+		.resetn,
+
+		.start(USE_BRAM_LOADER ? load_start : 1'b0),
+		.src(load_src),
+		.dst(load_dst),
+		.size(load_size),
+		.expected_crc(load_crc),
+		.axcache(io_axi_axcache),
+		.status(load_status),
+
+		.s_axi_io(proc_m_axi_io),
+		.m_axi_io(m_axi_mx),
+
+		.s_ibram(instruction_bram_mmr),
+		.s_dbram(data_bram_mmr),
+		.m_ibram(instruction_bram_proc),
+		.m_dbram(data_bram_proc)
+	);
+
+	prism_sp_processor_pool #(
 		.IBRAM_SIZE(IBRAM_SIZE),
 		.DBRAM_SIZE(DBRAM_SIZE),
 		.ACPBRAM_SIZE(ACPBRAM_SIZE),
 		.USE_SP_UNIT_RX(1),
 		.USE_SP_UNIT_TX(0),
-		.NPUZZLEFIFOS(NRXPUZZLEFIFOS)
-	) prism_sp_processor_0(
+		.NPUZZLEFIFOS(NRXPUZZLEFIFOS),
+		.NWORKERS(NRXWORKERS),
+		.WORKER_FIFO_R(RX_WORKER_FIFO_R),
+		.WORKER_FIFO_W(RX_WORKER_FIFO_W),
+		.DISPATCH_HASH_WORD(RX_WORKER_HASH_WORD),
+		.DISPATCH_EOF_BITN(RX_COOKIE_EOF_BITN)
+	) prism_sp_processor_pool_0(
 		.clock,
 		.resetn,
 		.cpu_reset,
 
 		.io_axi_axcache,
-		.m_axi_io(m_axi_mx),
-		.instruction_bram_mmr,
-		.data_bram_mmr,
-
-		.puzzle_sw_fifo_r_0,
-		.puzzle_sw_fifo_w_0,
-		.puzzle_sw_fifo_r_1,
-		.puzzle_sw_fifo_w_1,
-		.puzzle_sw_fifo_r_2,
-		.puzzle_sw_fifo_w_2,
-		.puzzle_sw_fifo_r_3,
-		.puzzle_sw_fifo_w_3,
+		.m_axi_io(proc_m_axi_io),
+		.instruction_bram_mmr(instruction_bram_proc),
+		.data_bram_mmr(data_bram_proc),
+
+		.puzzle_sw_fifo_r,
+		.puzzle_sw_fifo_w,
 
 		// Interfaces used by the RX unit
 		.rx_data_mem_w(sw_rx_data_mem_w),
@@ -534,6 +728,9 @@ if (ENABLE_RX_RISCV_PROCESSOR) begin
 		.mmr_i(sw_mmr_i),
 		.mmr_t(sw_mmr_t),
 
+		// Interface used by the HDR unit
+		.hdr_w,
+
 		// Interfaces used by the ACP unit
 		.m_axi_acp_aw,
 		.m_axi_acp_w,
@@ -543,9 +740,21 @@ if (ENABLE_RX_RISCV_PROCESSOR) begin
 
 		.trace_proc,
 		.trace_sp_unit,
-		.trace_sp_unit_rx
+		.trace_sp_unit_rx,
+		.sp_perf_counters
 	);
 end // ENABLE_RX_RISCV_PROCESSOR
+else begin
+	assign hdr_w.load = 1'b0;
+	assign hdr_w.len = '0;
+	assign hdr_w.peek_addr = '0;
+	assign hdr_w.poke = 1'b0;
+	assign hdr_w.poke_addr = '0;
+	assign hdr_w.poke_data = '0;
+	assign hdr_w.commit = 1'b0;
+	assign sp_perf_counters = '{default: '0};
+	assign load_status = '0;
+end
 
 /*
  * --------  --------  --------  --------
@@ -573,8 +782,8 @@ xpm_fifo_async #(
 	.USE_ADV_FEATURES("0707"),
 	.WAKEUP_TIME(0),
 	// GEM RX clock domain
-	//.WR_DATA_COUNT_WIDTH(rx_meta_fifo_w.DATA_COUNT_WIDTH),
-	.WR_DATA_COUNT_WIDTH(1),
+	// The fill level is used for the admission control.
+	.WR_DATA_COUNT_WIDTH(rx_meta_fifo_w.DATA_COUNT_WIDTH),
 	.WRITE_DATA_WIDTH(rx_meta_fifo_w.DATA_WIDTH)
 ) rx_meta_fifo (
 	// reset is synchronized to wr_clk!
@@ -621,6 +830,87 @@ assign trace_rx_fifo.meta_fifo_w_wr_en = rx_meta_fifo_w.wr_en;
 assign trace_rx_fifo.meta_fifo_w_wr_data = rx_meta_fifo_w.wr_data;
 assign trace_rx_fifo.meta_fifo_w_wr_data_count = rx_meta_fifo_w.wr_data_count;
 
+/*
+ * Flow records of the flow meter
+ */
+xpm_fifo_async #(
+	.CDC_SYNC_STAGES(2),
+	.DOUT_RESET_VALUE("0"),
+	.ECC_MODE("no_ecc"),
+	.FIFO_MEMORY_TYPE("auto"),
+	.FIFO_READ_LATENCY(0),
+	.FIFO_WRITE_DEPTH(FLOW_FIFO_DEPTH),
+	.FULL_RESET_VALUE(0),
+	.PROG_EMPTY_THRESH(10),
+	.PROG_FULL_THRESH(10),
+	// Processor clock domain
+	.RD_DATA_COUNT_WIDTH(flow_fifo_r.DATA_COUNT_WIDTH),
+	.READ_DATA_WIDTH(FLOW_RECORD_WIDTH),
+	.READ_MODE("fwft"),
+	.RELATED_CLOCKS(0),
+	.SIM_ASSERT_CHK(0),
+	.USE_ADV_FEATURES("0707"),
+	.WAKEUP_TIME(0),
+	// GEM RX clock domain
+	.WR_DATA_COUNT_WIDTH(1),
+	.WRITE_DATA_WIDTH(FLOW_RECORD_WIDTH)
+) flow_fifo (
+	// reset is synchronized to wr_clk!
+	.rst(flow_fifo_w.reset),
+
+	.rd_clk(clock),
+	.rd_en(flow_fifo_r.rd_en),
+	.dout(flow_fifo_r.rd_data),
+	.empty(flow_fifo_r.empty),
+	.rd_data_count(flow_fifo_r.rd_data_count),
+
+	.wr_clk(flow_fifo_w.clock),
+	.wr_en(flow_fifo_w.wr_en),
+	.din(flow_fifo_w.wr_data),
+	.full(flow_fifo_w.full)
+);
+
+/*
+ * Slots of the capture unit
+ */
+xpm_fifo_async #(
+	.CDC_SYNC_STAGES(2),
+	.DOUT_RESET_VALUE("0"),
+	.ECC_MODE("no_ecc"),
+	.FIFO_MEMORY_TYPE("auto"),
+	.FIFO_READ_LATENCY(0),
+	.FIFO_WRITE_DEPTH(CAPTURE_FIFO_DEPTH),
+	.FULL_RESET_VALUE(0),
+	.PROG_EMPTY_THRESH(10),
+	.PROG_FULL_THRESH(10),
+	// Processor clock domain
+	.RD_DATA_COUNT_WIDTH(capture_fifo_r.DATA_COUNT_WIDTH),
+	.READ_DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.READ_MODE("fwft"),
+	.RELATED_CLOCKS(0),
+	.SIM_ASSERT_CHK(0),
+	.USE_ADV_FEATURES("0707"),
+	.WAKEUP_TIME(0),
+	// GEM RX clock domain
+	.WR_DATA_COUNT_WIDTH(capture_fifo_w.DATA_COUNT_WIDTH),
+	.WRITE_DATA_WIDTH(CAPTURE_WORD_WIDTH)
+) capture_fifo (
+	// reset is synchronized to wr_clk!
+	.rst(capture_fifo_w.reset),
+
+	.rd_clk(clock),
+	.rd_en(capture_fifo_r.rd_en),
+	.dout(capture_fifo_r.rd_data),
+	.empty(capture_fifo_r.empty),
+	.rd_data_count(capture_fifo_r.rd_data_count),
+
+	.wr_clk(capture_fifo_w.clock),
+	.wr_en(capture_fifo_w.wr_en),
+	.din(capture_fifo_w.wr_data),
+	.full(capture_fifo_w.full),
+	.wr_data_count(capture_fifo_w.wr_data_count)
+);
+
 /*
  * Interface to connect the RX data FIFO with the FIFO-to-AXI module.
  */
@@ -665,18 +955,231 @@ xpm_fifo_async #(
 	.din(rx_data_fifo_w.wr_data),
 	.wr_data_count(rx_data_fifo_w.wr_data_count)
 );
+
+/*
+ * The counter of the traffic generator is incremented in the GEM RX
+ * clock domain.
+ */
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(tgen_sent))
+) tgen_sent_cdc (
+	.src_clk(rx_data_fifo_w.clock),
+	.src_in_bin(gem_tgen_sent),
+	.dest_clk(clock),
+	.dest_out_bin(tgen_sent)
+);
+
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(flow_drops))
+) flow_drops_cdc (
+	.src_clk(flow_fifo_w.clock),
+	.src_in_bin(gem_flow_drops),
+	.dest_clk(clock),
+	.dest_out_bin(flow_drops)
+);
+
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(capture_drops))
+) capture_drops_cdc (
+	.src_clk(capture_fifo_w.clock),
+	.src_in_bin(gem_capture_drops),
+	.dest_clk(clock),
+	.dest_out_bin(capture_drops)
+);
+
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(admit_drops))
+) admit_drops_cdc (
+	.src_clk(rx_data_fifo_w.clock),
+	.src_in_bin(gem_admit_drops),
+	.dest_clk(clock),
+	.dest_out_bin(admit_drops)
+);
+`else
+assign tgen_sent = gem_tgen_sent;
+assign flow_drops = gem_flow_drops;
+assign capture_drops = gem_capture_drops;
+assign admit_drops = gem_admit_drops;
 `endif
 
+/*
+ * The spill buffer sits between the RX FIFOs and their readers.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(RX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) spill_rx_data_fifo_r();
+
+if (USE_RX_SPILL) begin
+	wire axi_attr_t spill_attr = axattr_spill[AXATTR_OVERRIDE_BITN] ?
+		axi_attr_t'(axattr_spill[$bits(axi_attr_t)-1:0]) : AXI_ATTR_SPILL;
+
+	prism_sp_rx_spill prism_sp_rx_spill_0(
+		.clock,
+		.resetn,
+
+		.enable(spill_enable),
+		.size(spill_size),
+		.base(spill_base),
+		.level(spill_level),
+		.bursts(spill_bursts),
+		.axi_attr(spill_attr),
+
+		.m_data_fifo_r(rx_data_fifo_r),
+		.m_meta_fifo_r(rx_meta_fifo_r),
+		.s_data_fifo_r(spill_rx_data_fifo_r),
+		.s_meta_fifo_r(spill_rx_meta_fifo_r),
+
+		.axi_aw(m_axi_spill_aw),
+		.axi_w(m_axi_spill_w),
+		.axi_b(m_axi_spill_b),
+		.axi_ar(m_axi_spill_ar),
+		.axi_r(m_axi_spill_r)
+	);
+end
+else begin
+	fifo_read_interface_connect(.m(rx_data_fifo_r), .s(spill_rx_data_fifo_r));
+	fifo_read_interface_connect(.m(rx_meta_fifo_r), .s(spill_rx_meta_fifo_r));
+	assign spill_level = '0;
+	assign spill_bursts = '0;
+	assign m_axi_spill_aw.awvalid = 1'b0;
+	assign m_axi_spill_w.wvalid = 1'b0;
+	assign m_axi_spill_b.bready = 1'b1;
+	assign m_axi_spill_ar.arvalid = 1'b0;
+	assign m_axi_spill_r.rready = 1'b1;
+end
+
+/*
+ * The header window sits between the spill buffer and the DMA engine.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(RX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) hdr_rx_data_fifo_r();
+
+if (USE_HDR_WINDOW) begin
+	prism_sp_rx_header_window prism_sp_rx_header_window_0(
+		.clock,
+		.resetn,
+
+		.hdr_w,
+		.dma_busy(rx_data_mem_w.busy),
+
+		.m_fifo_r(spill_rx_data_fifo_r),
+		.s_fifo_r(hdr_rx_data_fifo_r)
+	);
+end
+else begin
+	fifo_read_interface_connect(.m(spill_rx_data_fifo_r), .s(hdr_rx_data_fifo_r));
+	assign hdr_w.busy = 1'b0;
+	assign hdr_w.loading = 1'b0;
+	assign hdr_w.peek_data = '0;
+end
+
+/*
+ * The DMA engine reads words of the DMA data bus width.
+ * Each DMA write consumes whole words of the RX data FIFO, so the rest
+ * of a partially read word is dropped when the write is done.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(m_axi_dma_w.AXI_WDATA_WIDTH),
+	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
+) dma_rx_data_fifo_r();
+
+if (m_axi_dma_w.AXI_WDATA_WIDTH == RX_DATA_FIFO_WIDTH) begin
+	fifo_read_interface_connect(.m(hdr_rx_data_fifo_r), .s(dma_rx_data_fifo_r));
+end
+else begin
+	fifo_read_interface_downsize fifo_read_interface_downsize_0(
+		.clock,
+		.resetn,
+		.s_flush(rx_data_mem_w.done),
+		.m(hdr_rx_data_fifo_r),
+		.s(dma_rx_data_fifo_r)
+	);
+end
+
+/*
+ * AXI attributes of the frame payloads and headers
+ */
+wire axi_attr_t dma_data_attr = axattr_data[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_data[$bits(axi_attr_t)-1:0]) :
+	'{ user: 2'b01, prot: 3'b000, cache: dma_axi_axcache };
+wire axi_attr_t dma_hdr_attr = axattr_hdr[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_hdr[$bits(axi_attr_t)-1:0]) : dma_data_attr;
+wire logic [15:0] dma_hdr_len = axattr_hdr[AXATTR_OVERRIDE_BITN] ?
+	16'(axattr_hdr[AXATTR_HDR_LEN_BITN +: AXATTR_HDR_LEN_WIDTH]) : '0;
+
 fifo_to_axi_v5
 fifo_to_axi_0(
 	.clock,
 	.resetn,
 	.mem_w(rx_data_mem_w),
-	.fifo_r(rx_data_fifo_r),
-	.axi_awcache(dma_axi_awcache),
+	.fifo_r(dma_rx_data_fifo_r),
+	.hdr_len(dma_hdr_len),
+	.axi_hdr_attr(dma_hdr_attr),
+	.axi_attr(dma_data_attr),
 	.axi_aw(m_axi_dma_aw),
 	.axi_w(m_axi_dma_w),
 	.axi_b(m_axi_dma_b)
 );
 
+/*
+ * Trace recorder
+ * The window of the recorder is taken from this vector, whose LSB is the
+ * LSB of trace_sp_unit.
+ */
+if (USE_TRACE_RECORDER) begin
+	localparam int TRACE_ALL_WIDTH =
+		$bits(trace_rx_fifo_t) +
+		$bits(trace_rx_puzzle_t) +
+		$bits(trace_sp_unit_rx_t) +
+		$bits(trace_sp_unit_t);
+	wire logic [TRACE_ALL_WIDTH-1:0] trace_all = { trace_rx_fifo, trace_rx_puzzle, trace_sp_unit_rx, trace_sp_unit };
+
+	prism_sp_trace_recorder #(
+		.TRACE_WIDTH(TRACE_ALL_WIDTH)
+	) prism_sp_trace_recorder_0 (
+		.clock,
+		.resetn,
+
+		.trace(trace_all),
+
+		.arm(trace_arm),
+		.force_trigger(trace_force),
+		.window(trace_window),
+		.post(trace_post),
+		.trig_mask(trace_trig_mask),
+		.trig_match(trace_trig_match),
+		.rd_addr(trace_addr),
+
+		.status(trace_status),
+		.rd_data(trace_data)
+	);
+end
+else begin
+	assign trace_status = '0;
+	assign trace_data = '0;
+end
+
 endmodule
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * ESP decryption between two GEM RX interfaces (see prism_sp_esp_gcm).
+ *
+ * The frames are delayed by ESP_RX_DELAY clock cycles. The undelayed
+ * frames are parsed and authenticated, the delayed ones are decrypted.
+ * esp and auth_err belong to the frame on gem_rx_out and are valid at
+ * its rx_w_eop.
+ * The delay relies on the GEM writing one byte per clock cycle and on
+ * the gap between two frames (inter-frame gap and preamble). Frames
+ * that follow each other more closely may be decrypted with the state
+ * of the next frame.
+ */
+module prism_sp_rx_esp (
+	input wire logic [127:0] sa_key,
+	input wire logic [31:0] sa_salt,
+	input wire logic [31:0] sa_spi,
+	input wire logic [31:0] sa_control,
+
+	output wire logic esp,
+	output wire logic auth_err,
+
+	gem_rx_interface.slave gem_rx_in,
+	gem_rx_interface.master gem_rx_out
+);
+
+assign gem_rx_out.rx_clock = gem_rx_in.rx_clock;
+assign gem_rx_out.rx_resetn = gem_rx_in.rx_resetn;
+
+if (USE_ESP_GCM) begin
+	wire logic clock = gem_rx_in.rx_clock;
+	wire logic resetn = gem_rx_in.rx_resetn;
+
+	var logic dly_wr [ESP_RX_DELAY];
+	var logic [31:0] dly_data [ESP_RX_DELAY];
+	var logic dly_sop [ESP_RX_DELAY];
+	var logic dly_eop [ESP_RX_DELAY];
+	var logic [44:0] dly_status [ESP_RX_DELAY];
+	var logic dly_err [ESP_RX_DELAY];
+	var logic dly_flush [ESP_RX_DELAY];
+
+	always_ff @(posedge clock) begin
+		if (!resetn) begin
+			for (int i = 0; i < ESP_RX_DELAY; i++) begin
+				dly_wr[i] <= 1'b0;
+				dly_sop[i] <= 1'b0;
+				dly_eop[i] <= 1'b0;
+				dly_err[i] <= 1'b0;
+				dly_flush[i] <= 1'b0;
+			end
+		end
+		else begin
+			dly_wr[0] <= gem_rx_in.rx_w_wr;
+			dly_sop[0] <= gem_rx_in.rx_w_sop;
+			dly_eop[0] <= gem_rx_in.rx_w_eop;
+			dly_err[0] <= gem_rx_in.rx_w_err;
+			dly_flush[0] <= gem_rx_in.rx_w_flush;
+			for (int i = 1; i < ESP_RX_DELAY; i++) begin
+				dly_wr[i] <= dly_wr[i-1];
+				dly_sop[i] <= dly_sop[i-1];
+				dly_eop[i] <= dly_eop[i-1];
+				dly_err[i] <= dly_err[i-1];
+				dly_flush[i] <= dly_flush[i-1];
+			end
+		end
+		dly_data[0] <= gem_rx_in.rx_w_data;
+		dly_status[0] <= gem_rx_in.rx_w_status;
+		for (int i = 1; i < ESP_RX_DELAY; i++) begin
+			dly_data[i] <= dly_data[i-1];
+			dly_status[i] <= dly_status[i-1];
+		end
+	end
+
+	wire logic [7:0] c_out;
+
+	prism_sp_esp_gcm #(
+		.ENCRYPT(0)
+	) prism_sp_esp_gcm_0 (
+		.clock,
+		.resetn,
+
+		.sa_key,
+		.sa_salt,
+		.sa_spi,
+		.sa_control,
+
+		.tx_sa('0),
+
+		.h_valid(gem_rx_in.rx_w_wr),
+		.h_sof(gem_rx_in.rx_w_sop),
+		.h_data(gem_rx_in.rx_w_data[7:0]),
+
+		.c_valid(dly_wr[ESP_RX_DELAY-1]),
+		.c_sof(dly_sop[ESP_RX_DELAY-1]),
+		.c_data(dly_data[ESP_RX_DELAY-1][7:0]),
+		.c_out,
+
+		.esp,
+		.auth_err
+	);
+
+	assign gem_rx_out.rx_w_wr = dly_wr[ESP_RX_DELAY-1];
+	assign gem_rx_out.rx_w_data = { dly_data[ESP_RX_DELAY-1][31:8], c_out };
+	assign gem_rx_out.rx_w_sop = dly_sop[ESP_RX_DELAY-1];
+	assign gem_rx_out.rx_w_eop = dly_eop[ESP_RX_DELAY-1];
+	assign gem_rx_out.rx_w_status = dly_status[ESP_RX_DELAY-1];
+	assign gem_rx_out.rx_w_err = dly_err[ESP_RX_DELAY-1];
+	assign gem_rx_out.rx_w_flush = dly_flush[ESP_RX_DELAY-1];
+	// The overflow of a frame is reported after its end.
+	assign gem_rx_in.rx_w_overflow = gem_rx_out.rx_w_overflow;
+end
+else begin
+	assign gem_rx_out.rx_w_wr = gem_rx_in.rx_w_wr;
+	assign gem_rx_out.rx_w_data = gem_rx_in.rx_w_data;
+	assign gem_rx_out.rx_w_sop = gem_rx_in.rx_w_sop;
+	assign gem_rx_out.rx_w_eop = gem_rx_in.rx_w_eop;
+	assign gem_rx_out.rx_w_status = gem_rx_in.rx_w_status;
+	assign gem_rx_out.rx_w_err = gem_rx_in.rx_w_err;
+	assign gem_rx_out.rx_w_flush = gem_rx_in.rx_w_flush;
+	assign gem_rx_in.rx_w_overflow = gem_rx_out.rx_w_overflow;
+	assign esp = 1'b0;
+	assign auth_err = 1'b0;
+end
+
+endmodule
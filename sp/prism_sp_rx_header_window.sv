@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Header window of the RX data stream (see prism_sp_unit_hdr).
+ *
+ * Sits between the RX data FIFO (m_fifo_r) and the DMA engine
+ * (s_fifo_r). Unless it is loaded, the window is transparent.
+ * A load pops the words that hold the first bytes of the frame at the
+ * head of the FIFO. Since frames start with a new word of the FIFO,
+ * these are the first min(len, HDR_WINDOW_SIZE) bytes, rounded up to
+ * whole words. The load waits until the DMA engine is idle, i.e., the
+ * DMA of all previous frames must have been started before.
+ * Until the window is committed, the DMA engine sees an empty FIFO and
+ * must not be started for the frame. After the commit, it reads the
+ * words of the window, followed by the rest of the frame from the FIFO.
+ */
+module prism_sp_rx_header_window (
+	input wire logic clock,
+	input wire logic resetn,
+
+	header_window_interface.slave hdr_w,
+	input wire logic dma_busy,
+
+	fifo_read_interface.master m_fifo_r,
+	fifo_read_interface.slave s_fifo_r
+);
+
+localparam int DATA_WIDTH = m_fifo_r.DATA_WIDTH;
+localparam int BYTES = DATA_WIDTH/8;
+localparam int WORDS = HDR_WINDOW_SIZE / BYTES;
+localparam int WORD_WIDTH = WORDS > 1 ? $clog2(WORDS) : 1;
+localparam int LANE_WIDTH = $clog2(BYTES/4);
+
+if (HDR_WINDOW_SIZE % BYTES != 0 || BYTES < 4) begin
+	$error("The header window (%d bytes) must be a multiple of the FIFO width (%d bits)\n",
+		HDR_WINDOW_SIZE, DATA_WIDTH);
+end
+
+typedef enum logic [2:0] {
+	STATE_IDLE,
+	STATE_WAIT,
+	STATE_LOAD,
+	STATE_HELD,
+	STATE_DRAIN
+} state_t;
+
+var state_t state;
+var logic [DATA_WIDTH-1:0] window [WORDS];
+var logic [WORD_WIDTH:0] nwords;
+var logic [WORD_WIDTH:0] idx;
+
+wire logic [15:0] len_words = (hdr_w.len + 16'(BYTES-1)) / 16'(BYTES);
+// The RX data FIFO only provides its data count.
+wire logic load_pop = state == STATE_LOAD && m_fifo_r.rd_data_count != '0;
+wire logic drain_pop = state == STATE_DRAIN && s_fifo_r.rd_en;
+
+assign m_fifo_r.clock = s_fifo_r.clock;
+assign m_fifo_r.reset = s_fifo_r.reset;
+
+always_comb begin
+	case (state)
+	STATE_IDLE: begin
+		m_fifo_r.rd_en = s_fifo_r.rd_en;
+		s_fifo_r.rd_data = m_fifo_r.rd_data;
+		s_fifo_r.empty = m_fifo_r.empty;
+		s_fifo_r.almost_empty = m_fifo_r.almost_empty;
+		s_fifo_r.rd_data_count = m_fifo_r.rd_data_count;
+	end
+	STATE_DRAIN: begin
+		m_fifo_r.rd_en = 1'b0;
+		s_fifo_r.rd_data = window[idx[WORD_WIDTH-1:0]];
+		s_fifo_r.empty = 1'b0;
+		s_fifo_r.almost_empty = 1'b0;
+		s_fifo_r.rd_data_count = m_fifo_r.rd_data_count + $bits(s_fifo_r.rd_data_count)'(nwords - idx);
+	end
+	default: begin
+		m_fifo_r.rd_en = load_pop;
+		s_fifo_r.rd_data = '0;
+		s_fifo_r.empty = 1'b1;
+		s_fifo_r.almost_empty = 1'b1;
+		s_fifo_r.rd_data_count = '0;
+	end
+	endcase
+end
+
+assign hdr_w.busy = hdr_w.load || state == STATE_WAIT || state == STATE_LOAD;
+assign hdr_w.loading = state == STATE_LOAD;
+
+wire logic [DATA_WIDTH-1:0] peek_word = window[hdr_w.peek_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]];
+if (BYTES > 4) begin
+	assign hdr_w.peek_data = peek_word[32*hdr_w.peek_addr[2 +: LANE_WIDTH] +: 32];
+end
+else begin
+	assign hdr_w.peek_data = peek_word;
+end
+
+always_ff @(posedge clock) begin
+	if (load_pop) begin
+		window[idx[WORD_WIDTH-1:0]] <= m_fifo_r.rd_data;
+	end
+	else if (hdr_w.poke) begin
+		if (BYTES > 4) begin
+			window[hdr_w.poke_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]]
+				[32*hdr_w.poke_addr[2 +: LANE_WIDTH] +: 32] <= hdr_w.poke_data;
+		end
+		else begin
+			window[hdr_w.poke_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]] <= hdr_w.poke_data;
+		end
+	end
+end
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			if (hdr_w.load && hdr_w.len != '0) begin
+				nwords <= len_words > 16'(WORDS) ? (WORD_WIDTH+1)'(WORDS) : (WORD_WIDTH+1)'(len_words);
+				idx <= '0;
+				state <= STATE_WAIT;
+			end
+		end
+		STATE_WAIT: begin
+			if (!dma_busy) begin
+				state <= STATE_LOAD;
+			end
+		end
+		STATE_LOAD: begin
+			if (load_pop) begin
+				idx <= idx + 1;
+				if (idx + 1 == nwords) begin
+					state <= STATE_HELD;
+				end
+			end
+		end
+		STATE_HELD: begin
+			if (hdr_w.commit) begin
+				idx <= '0;
+				state <= STATE_DRAIN;
+			end
+		end
+		STATE_DRAIN: begin
+			if (drain_pop) begin
+				idx <= idx + 1;
+				if (idx + 1 == nwords) begin
+					state <= STATE_IDLE;
+				end
+			end
+		end
+		default: begin
+			state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+endmodule
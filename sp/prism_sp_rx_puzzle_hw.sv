@@ -17,24 +17,45 @@ module prism_sp_rx_puzzle_hw (
 	input wire logic clock,
 	input wire logic resetn,
 
-	input wire logic rx_enable,
+	input wire logic [NRXQUEUES-1:0] rx_queue_enable,
+	input wire logic [31:0] rx_prio_map,
+	input wire logic rx_stride_enable,
+	input wire logic [4:0] rx_stride_shift,
+	input wire logic [4:0] rx_buf_shift,
+	input wire logic [15:0] rx_buf_reserve,
 
 	mmr_intr_interface.master			mmr_i,
 	mmr_trigger_interface.master		mmr_t,
 
-	fifo_read_interface.master			fifo_r_0,
-	fifo_write_interface.master			fifo_w_0,
-	fifo_read_interface.master			fifo_r_1,
-	fifo_write_interface.master			fifo_w_1,
-	fifo_read_interface.master			fifo_r_2,
-	fifo_write_interface.master			fifo_w_2,
-	fifo_read_interface.master			fifo_r_3,
-	fifo_write_interface.master			fifo_w_3,
+	fifo_read_interface.master			fifo_r [NRXPUZZLEFIFOS],
+	fifo_write_interface.master			fifo_w [NRXPUZZLEFIFOS],
 
-	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	dma_desc_base,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	dma_desc_base [NRXQUEUES],
+	input wire logic							cq_enable,
+	input wire logic							poll_enable,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0]	poll_min_shift,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0]	poll_max_shift,
+	input wire logic [CQ_CONTROL_SIZE_WIDTH-1:0]	cq_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	cq_base,
+	input wire logic [VIRTQ_RING_SIZE_WIDTH-1:0]	ring_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	virtq_event_addr,
+	input wire logic							flow_export_enable,
+	input wire logic [FLOW_CONTROL_SIZE_WIDTH-1:0]	flow_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	flow_base,
+	input wire logic							capture_enable,
+	input wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0]	capture_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]	capture_base,
+	input wire logic [31:0]						capture_tail,
+	output wire logic [31:0]					capture_head,
+	input wire axi_attr_t						desc_rd_attr,
+	input wire axi_attr_t						desc_wr_attr,
+	input wire axi_attr_t						flow_attr,
+	input wire axi_attr_t						capture_attr,
 
 	memory_write_interface.master		rx_data_mem_w,
 	fifo_read_interface.master			rx_meta_fifo_r,
+	fifo_read_interface.master			flow_fifo_r,
+	fifo_read_interface.master			capture_fifo_r,
 
 	axi_write_address_channel.master	axi_ma_aw,
 	axi_write_channel.master			axi_ma_w,
@@ -61,48 +82,145 @@ module prism_sp_rx_puzzle_hw (
 	axi_read_channel.slave				axi_sb_r
 );
 
+/*
+ * Ring 0 uses puzzle FIFO 0. All other rings get their own FIFO
+ * between the ring acquire and the DMA write module.
+ */
+fifo_write_interface #(
+	.DATA_WIDTH(fifo_w[0].DATA_WIDTH),
+	.DATA_COUNT_WIDTH(fifo_w[0].DATA_COUNT_WIDTH)
+) rxq_fifo_w [NRXQUEUES] ();
+fifo_read_interface #(
+	.DATA_WIDTH(fifo_r[0].DATA_WIDTH),
+	.DATA_COUNT_WIDTH(fifo_r[0].DATA_COUNT_WIDTH)
+) rxq_fifo_r [NRXQUEUES] ();
+
+fifo_read_interface_connect fifo_read_interface_connect_rxq_0(.m(fifo_r[0]), .s(rxq_fifo_r[0]));
+for (genvar q = 1; q < NRXQUEUES; q++) begin
+	prism_sp_fifo_sync #(
+		.FIFO_WRITE_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH[0])
+	) rxq_fifo (
+		.clock,
+		.resetn,
+
+		.fifo_r(rxq_fifo_r[q]),
+		.fifo_w(rxq_fifo_w[q])
+	);
+end
+
 if (USE_RX_RING_ACQUIRE) begin
 prism_sp_ring_acquire_cookie_convert_interface#(
 	.DATA_IN_WIDTH(axi_ma_r.AXI_RDATA_WIDTH),
-	.DATA_OUT_WIDTH(fifo_w_1.DATA_WIDTH)
+	.DATA_OUT_WIDTH(fifo_w[1].DATA_WIDTH)
 ) racc();
 
+if (USE_RX_VIRTQ) begin
+prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_rx_cookie
+prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_rx_cookie_inst(.conv(racc));
+
+prism_sp_puzzle_hw_gem_ring_acquire #(
+	.COOKIE_TYPE(rx_cookie_t),
+	.DESC_TYPE(virtq_packed_desc_t),
+	.FIFO_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH[0]),
+	.NQUEUES(NRXQUEUES)
+) prism_sp_puzzle_hw_gem_ring_acquire_0 (
+	.clock,
+	.resetn,
+
+	.mmr_t,
+	.enable(rx_queue_enable),
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.ring_size,
+	.dma_desc_base,
+
+	.axi_attr(desc_rd_attr),
+	.axi_ar(axi_ma_ar),
+	.axi_r(axi_ma_r),
+	.conv(racc),
+	.o_cookie_fifo_w(rxq_fifo_w)
+);
+end
+else begin
 prism_sp_ring_acquire_cc_gem_dma_rx_desc_2_dma_rx_cookie
 prism_sp_ring_acquire_cc_gem_dma_rx_desc_2_dma_rx_cookie_inst(.conv(racc));
 
 prism_sp_puzzle_hw_gem_ring_acquire #(
 	.COOKIE_TYPE(rx_cookie_t),
 	.DESC_TYPE(gem_dma_rx_desc_t),
-	.FIFO_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH[0])
+	.FIFO_DEPTH(RX_PUZZLE_FIFO_WRITE_DEPTH[0]),
+	.NQUEUES(NRXQUEUES)
 ) prism_sp_puzzle_hw_gem_ring_acquire_0 (
 	.clock,
 	.resetn,
 
 	.mmr_t,
-	.enable(rx_enable),
+	.enable(rx_queue_enable),
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.ring_size,
 	.dma_desc_base,
 
+	.axi_attr(desc_rd_attr),
 	.axi_ar(axi_ma_ar),
 	.axi_r(axi_ma_r),
 	.conv(racc),
-	.o_cookie_fifo_w(fifo_w_0)
+	.o_cookie_fifo_w(rxq_fifo_w)
 );
 end
 
-prism_sp_puzzle_hw_gem_dma_write
-prism_sp_puzzle_hw_gem_dma_write_0 (
+fifo_write_interface_connect fifo_write_interface_connect_rxq_0(.m(fifo_w[0]), .s(rxq_fifo_w[0]));
+end
+
+prism_sp_puzzle_hw_gem_dma_write #(
+	.NQUEUES(NRXQUEUES)
+) prism_sp_puzzle_hw_gem_dma_write_0 (
 	.clock,
 	.resetn,
 
-	.i_cookie_fifo_r(fifo_r_0),
+	.queue_enable(rx_queue_enable),
+	.prio_map(rx_prio_map),
+	.stride_enable(rx_stride_enable),
+	.stride_shift(rx_stride_shift),
+	.buf_shift(rx_buf_shift),
+	.buf_reserve(rx_buf_reserve),
+
+	.i_cookie_fifo_r(rxq_fifo_r),
 	.meta_desc_fifo_r(rx_meta_fifo_r),
-	.o_cookie_fifo_w(fifo_w_1),
+	.o_cookie_fifo_w(fifo_w[1]),
 
 	.rx_data_mem_w
 
 );
 
 if (USE_RX_RING_RELEASE) begin
+if (USE_RX_VIRTQ) begin
+prism_sp_puzzle_hw_gem_ring_release #(
+	.COOKIE_TYPE(rx_cookie_t),
+	.DESC_TYPE(virtq_packed_desc_t)
+) prism_sp_puzzle_hw_gem_ring_release_0 (
+	.clock,
+	.resetn,
+
+	.cq_enable,
+	.cq_size,
+	.cq_base,
+
+	.i_cookie_fifo_r(fifo_r[2]),
+
+	.axi_attr(desc_wr_attr),
+	.axi_aw(axi_ma_aw),
+	.axi_w(axi_ma_w),
+	.axi_b(axi_ma_b),
+
+	.fifo_w(fifo_w[3])
+);
+end
+else begin
 prism_sp_puzzle_hw_gem_ring_release #(
 	.COOKIE_TYPE(rx_cookie_t),
 	.DESC_TYPE(gem_dma_rx_desc_t)
@@ -110,26 +228,139 @@ prism_sp_puzzle_hw_gem_ring_release #(
 	.clock,
 	.resetn,
 
-	.i_cookie_fifo_r(fifo_r_2),
+	.cq_enable,
+	.cq_size,
+	.cq_base,
+
+	.i_cookie_fifo_r(fifo_r[2]),
 
+	.axi_attr(desc_wr_attr),
 	.axi_aw(axi_ma_aw),
 	.axi_w(axi_ma_w),
 	.axi_b(axi_ma_b),
 
-	.fifo_w(fifo_w_3)
+	.fifo_w(fifo_w[3])
 );
 end
+end
 
 if (USE_RX_IRQ) begin
+if (USE_RX_VIRTQ) begin
+prism_sp_puzzle_hw_virtq_irq
+prism_sp_puzzle_hw_virtq_irq_0 (
+	.clock,
+	.resetn,
+
+	.enable(rx_queue_enable[0]),
+	.ring_size,
+	.event_addr(virtq_event_addr),
+
+	.fifo_r(fifo_r[3]),
+
+	.axi_attr(desc_rd_attr),
+	.axi_ar(axi_mb_ar),
+	.axi_r(axi_mb_r),
+
+	.mmr_i
+);
+end
+else begin
 prism_sp_puzzle_hw_gem_irq
 prism_sp_puzzle_hw_gem_irq_0 (
 	.clock,
 	.resetn,
 
-	.fifo_r(fifo_r_3),
+	.fifo_r(fifo_r[3]),
 
 	.mmr_i
 );
 end
+end
+
+/*
+ * The write channels of port mb are otherwise unused.
+ * The flow exporter (0) and the capture writer (1) share them.
+ */
+axi_write_address_channel #(
+	.AXI_AWID_WIDTH(axi_mb_aw.AXI_AWID_WIDTH),
+	.AXI_AWADDR_WIDTH(axi_mb_aw.AXI_AWADDR_WIDTH),
+	.AXI_AWUSER_WIDTH(axi_mb_aw.AXI_AWUSER_WIDTH)
+) mb_aw [2] ();
+axi_write_channel #(
+	.AXI_WDATA_WIDTH(axi_mb_w.AXI_WDATA_WIDTH),
+	.AXI_WUSER_WIDTH(axi_mb_w.AXI_WUSER_WIDTH)
+) mb_w [2] ();
+axi_write_response_channel #(
+	.AXI_BID_WIDTH(axi_mb_b.AXI_BID_WIDTH),
+	.AXI_BUSER_WIDTH(axi_mb_b.AXI_BUSER_WIDTH)
+) mb_b [2] ();
+
+prism_sp_axi_write_arbiter #(
+	.NPORTS(2)
+) prism_sp_axi_write_arbiter_mb (
+	.clock,
+	.resetn,
+
+	.s_axi_aw(mb_aw),
+	.s_axi_w(mb_w),
+	.s_axi_b(mb_b),
+
+	.m_axi_aw(axi_mb_aw),
+	.m_axi_w(axi_mb_w),
+	.m_axi_b(axi_mb_b)
+);
+
+if (USE_FLOW_METER) begin
+prism_sp_puzzle_hw_flow_export
+prism_sp_puzzle_hw_flow_export_0 (
+	.clock,
+	.resetn,
+
+	.enable(flow_export_enable),
+	.size(flow_size),
+	.base(flow_base),
+
+	.record_fifo_r(flow_fifo_r),
+
+	.axi_attr(flow_attr),
+	.axi_aw(mb_aw[0]),
+	.axi_w(mb_w[0]),
+	.axi_b(mb_b[0])
+);
+end
+else begin
+assign flow_fifo_r.rd_en = 1'b0;
+assign mb_aw[0].awvalid = 1'b0;
+assign mb_w[0].wvalid = 1'b0;
+assign mb_b[0].bready = 1'b1;
+end
+
+if (USE_CAPTURE) begin
+prism_sp_puzzle_hw_capture_write
+prism_sp_puzzle_hw_capture_write_0 (
+	.clock,
+	.resetn,
+
+	.enable(capture_enable),
+	.size(capture_size),
+	.base(capture_base),
+	.tail(capture_tail),
+	.head(capture_head),
+
+	.slot_fifo_r(capture_fifo_r),
+
+	.axi_attr(capture_attr),
+	.axi_aw(mb_aw[1]),
+	.axi_w(mb_w[1]),
+	.axi_b(mb_b[1])
+);
+end
+else begin
+assign capture_fifo_r.rd_en = 1'b0;
+assign capture_head = '0;
+assign mb_aw[1].awvalid = 1'b0;
+assign mb_w[1].wvalid = 1'b0;
+assign mb_b[1].bready = 1'b1;
+end
 
 endmodule
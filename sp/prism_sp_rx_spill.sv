@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Spill buffer of the RX data stream.
+ *
+ * Sits between the RX data and meta FIFOs (m_data_fifo_r, m_meta_fifo_r)
+ * and their readers (s_data_fifo_r, s_meta_fifo_r). The readers see a
+ * staging FIFO of SPILL_FIFO_DEPTH words. Normally, words are moved
+ * from the RX data FIFO into the staging FIFO directly.
+ * When the staging FIFO is full and at least SPILL_START_WORDS words
+ * wait in the RX data FIFO, spilling starts: from then on, all words go
+ * through a ring of 2**size bytes at base in bursts of SPILL_BURST_LEN
+ * words and are read back into the staging FIFO in order. Writing and
+ * reading bursts alternate. Only whole bursts are spilled. Once the ring
+ * is empty and the staging FIFO has room again, words are moved
+ * directly again.
+ *
+ * The DMA engine expects all words of a frame to be readable once it
+ * has seen the meta descriptor of the frame. Hence, a descriptor is only
+ * passed on when the staging FIFO has received all words of its frame.
+ *
+ * Clearing enable stops further spilling. Words that are already in the
+ * ring are still read back.
+ *
+ * While enable is clear, the staging FIFO is bypassed once it and the
+ * ring have run empty: the readers read the RX FIFOs directly, as if
+ * there were no spill buffer. When enable is set, descriptors are held
+ * back until the readers have read all words of the passed ones, so
+ * the switch to the staging FIFO never happens inside a frame.
+ */
+module prism_sp_rx_spill (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+	input wire logic [SPILL_CONTROL_SIZE_WIDTH-1:0] size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0] base,
+	// Number of bytes in the ring
+	output wire logic [31:0] level,
+	// Number of bursts written to the ring
+	output var logic [31:0] bursts,
+	input wire axi_attr_t axi_attr,
+
+	fifo_read_interface.master m_data_fifo_r,
+	fifo_read_interface.master m_meta_fifo_r,
+	fifo_read_interface.slave s_data_fifo_r,
+	fifo_read_interface.slave s_meta_fifo_r,
+
+	axi_write_address_channel.master axi_aw,
+	axi_write_channel.master axi_w,
+	axi_write_response_channel.master axi_b,
+	axi_read_address_channel.master axi_ar,
+	axi_read_channel.master axi_r
+);
+
+localparam int DATA_WIDTH = m_data_fifo_r.DATA_WIDTH;
+localparam int BYTES = DATA_WIDTH/8;
+localparam int BURST_SHIFT = $clog2(SPILL_BURST_LEN * BYTES);
+localparam int BEAT_WIDTH = $clog2(SPILL_BURST_LEN);
+// Words that may still be on their way into the staging FIFO when its
+// fill level is checked.
+localparam int FIFO_MARGIN = 4;
+// The staging FIFO shows a word a few cycles after it was written.
+localparam int STAGE_DELAY = 3;
+
+if ($bits(axi_w.wdata) != DATA_WIDTH || $bits(axi_r.rdata) != DATA_WIDTH) begin
+	$error("The width of the spill port (%d bits) must be the width of the RX data FIFO (%d bits)\n",
+		$bits(axi_w.wdata), DATA_WIDTH);
+end
+if (SPILL_FIFO_DEPTH * BYTES < 2**RX_META_DESC_SIZE_WIDTH + (SPILL_BURST_LEN + FIFO_MARGIN) * BYTES) begin
+	$error("The staging FIFO (%d words) cannot hold the largest frame\n", SPILL_FIFO_DEPTH);
+end
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_WRITE,
+	STATE_WRITE_RESP,
+	STATE_READ
+} state_t;
+
+fifo_write_interface #(
+	.DATA_WIDTH(DATA_WIDTH),
+	.DATA_COUNT_WIDTH(SPILL_FIFO_DATA_COUNT_WIDTH)
+) stage_fifo_w();
+fifo_read_interface #(
+	.DATA_WIDTH(DATA_WIDTH),
+	.DATA_COUNT_WIDTH(SPILL_FIFO_DATA_COUNT_WIDTH)
+) stage_fifo_r();
+
+prism_sp_fifo_sync #(
+	.FIFO_WRITE_DEPTH(SPILL_FIFO_DEPTH)
+) stage_fifo (
+	.clock,
+	.resetn,
+	.fifo_r(stage_fifo_r),
+	.fifo_w(stage_fifo_w)
+);
+
+assign m_data_fifo_r.clock = s_data_fifo_r.clock;
+assign m_data_fifo_r.reset = s_data_fifo_r.reset;
+assign m_meta_fifo_r.clock = s_meta_fifo_r.clock;
+assign m_meta_fifo_r.reset = s_meta_fifo_r.reset;
+
+var logic bypass;
+
+assign s_data_fifo_r.rd_data = bypass ? m_data_fifo_r.rd_data : stage_fifo_r.rd_data;
+assign s_data_fifo_r.empty = bypass ? m_data_fifo_r.empty : stage_fifo_r.empty;
+assign s_data_fifo_r.almost_empty = bypass ? m_data_fifo_r.almost_empty : stage_fifo_r.almost_empty;
+assign s_data_fifo_r.rd_data_count = bypass ? s_data_fifo_r.DATA_COUNT_WIDTH'(m_data_fifo_r.rd_data_count) :
+	s_data_fifo_r.DATA_COUNT_WIDTH'(stage_fifo_r.rd_data_count);
+assign stage_fifo_r.rd_en = !bypass && s_data_fifo_r.rd_en;
+
+var state_t state;
+var logic spilling;
+// Write the next burst if both a write and a read are possible.
+var logic prefer_write;
+var logic [BEAT_WIDTH-1:0] beat;
+// Bursts written to and read from the ring
+var logic [31:0] wr_ptr;
+var logic [31:0] rd_ptr;
+// Words written to the staging FIFO or read in bypass and words of the
+// passed descriptors
+var logic [31:0] staged;
+var logic [31:0] staged_q [STAGE_DELAY];
+var logic [31:0] claimed;
+// Direct pops and pops in bypass of the last two cycles, which the data
+// count may not show yet
+var logic [1:0] popped;
+
+/*
+ * Ring
+ */
+wire logic ring_valid = 32'(size) > BURST_SHIFT;
+wire logic [31:0] ring_bursts = 32'd1 << (size - BURST_SHIFT);
+wire logic [SYSTEM_ADDR_WIDTH-1:0] ring_mask = SYSTEM_ADDR_WIDTH'((64'd1 << size) - 1);
+wire logic ring_empty = wr_ptr == rd_ptr;
+wire logic ring_full = wr_ptr - rd_ptr >= ring_bursts;
+
+assign level = (wr_ptr - rd_ptr) << BURST_SHIFT;
+
+function automatic logic [SYSTEM_ADDR_WIDTH-1:0] ring_addr(
+	input logic [SYSTEM_ADDR_WIDTH-1:0] ring_base,
+	input logic [SYSTEM_ADDR_WIDTH-1:0] mask,
+	input logic [31:0] ptr
+);
+	return ring_base + ((SYSTEM_ADDR_WIDTH'(ptr) << BURST_SHIFT) & mask);
+endfunction
+
+/*
+ * Flow control
+ */
+wire logic [31:0] in_count = 32'(m_data_fifo_r.rd_data_count);
+wire logic [31:0] stage_count = 32'(stage_fifo_w.wr_data_count);
+wire logic stage_room = stage_count + FIFO_MARGIN < SPILL_FIFO_DEPTH;
+wire logic stage_room_burst = stage_count + FIFO_MARGIN + SPILL_BURST_LEN <= SPILL_FIFO_DEPTH;
+
+/*
+ * The staging FIFO is empty if nothing was written to it for
+ * STAGE_DELAY cycles and the readers have taken all words that were.
+ * Then, all words of the passed descriptors have been read.
+ */
+wire logic enter_bypass = !bypass && !enable && state == STATE_IDLE && !spilling && ring_empty &&
+	popped == '0 && !stage_fifo_w.wr_en && staged == claimed && staged_q[STAGE_DELAY-1] == staged &&
+	stage_fifo_r.empty;
+// The readers have read all words of the descriptors passed in bypass.
+wire logic leave_bypass = bypass && enable && staged == claimed;
+
+wire logic start_spill = state == STATE_IDLE && !bypass && !spilling && enable && ring_valid &&
+	!stage_room && in_count >= SPILL_START_WORDS;
+// rd_data_count may include words that are not at the output yet.
+wire logic direct_pop = state == STATE_IDLE && !bypass && !enter_bypass && !spilling && !start_spill &&
+	stage_room && !m_data_fifo_r.empty && in_count > 32'(popped[0]) + 32'(popped[1]);
+wire logic can_write = !ring_full && in_count >= SPILL_BURST_LEN + 2;
+wire logic can_read = !ring_empty && stage_room_burst;
+
+wire logic aw_hshake = axi_aw.awvalid && axi_aw.awready;
+wire logic w_hshake = axi_w.wvalid && axi_w.wready;
+wire logic b_hshake = axi_b.bvalid && axi_b.bready;
+wire logic ar_hshake = axi_ar.arvalid && axi_ar.arready;
+wire logic r_hshake = axi_r.rvalid && axi_r.rready;
+
+assign m_data_fifo_r.rd_en = bypass ? s_data_fifo_r.rd_en : direct_pop || w_hshake;
+
+/*
+ * AXI
+ */
+assign axi_aw.awid = '0;
+assign axi_aw.awlen = 8'(SPILL_BURST_LEN - 1);
+assign axi_aw.awsize = 3'($clog2(BYTES));
+assign axi_aw.awburst = 2'b01;
+assign axi_aw.awlock = 1'b0;
+assign axi_aw.awcache = axi_attr.cache;
+assign axi_aw.awprot = axi_attr.prot;
+assign axi_aw.awqos = 4'b0000;
+assign axi_aw.awregion = 4'b0000;
+assign axi_aw.awuser = axi_attr.user;
+
+assign axi_w.wdata = m_data_fifo_r.rd_data;
+assign axi_w.wstrb = '1;
+assign axi_w.wuser = '0;
+assign axi_w.wlast = beat == BEAT_WIDTH'(SPILL_BURST_LEN - 1);
+assign axi_w.wvalid = state == STATE_WRITE;
+
+assign axi_b.bready = state == STATE_WRITE_RESP;
+
+assign axi_ar.arid = '0;
+assign axi_ar.arlen = 8'(SPILL_BURST_LEN - 1);
+assign axi_ar.arsize = 3'($clog2(BYTES));
+assign axi_ar.arburst = 2'b01;
+assign axi_ar.arlock = 1'b0;
+assign axi_ar.arcache = axi_attr.cache;
+assign axi_ar.arprot = axi_attr.prot;
+assign axi_ar.arqos = 4'b0000;
+assign axi_ar.arregion = 4'b0000;
+assign axi_ar.aruser = axi_attr.user;
+
+assign axi_r.rready = state == STATE_READ;
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	stage_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		state <= STATE_IDLE;
+		bypass <= 1'b1;
+		spilling <= 1'b0;
+		prefer_write <= 1'b0;
+		wr_ptr <= '0;
+		rd_ptr <= '0;
+		bursts <= '0;
+		popped <= '0;
+		axi_aw.awvalid <= 1'b0;
+		axi_ar.arvalid <= 1'b0;
+	end
+	else begin
+		popped <= { popped[0], bypass ? s_data_fifo_r.rd_en : direct_pop };
+
+		if (enter_bypass) begin
+			bypass <= 1'b1;
+		end
+		else if (leave_bypass) begin
+			bypass <= 1'b0;
+		end
+
+		if (direct_pop || r_hshake) begin
+			stage_fifo_w.wr_data <= r_hshake ? axi_r.rdata : m_data_fifo_r.rd_data;
+			stage_fifo_w.wr_en <= 1'b1;
+		end
+		if (aw_hshake) begin
+			axi_aw.awvalid <= 1'b0;
+		end
+		if (ar_hshake) begin
+			axi_ar.arvalid <= 1'b0;
+		end
+
+		case (state)
+		STATE_IDLE: begin
+			if (!spilling) begin
+				if (start_spill) begin
+					spilling <= 1'b1;
+				end
+			end
+			else if (ring_empty && stage_room) begin
+				spilling <= 1'b0;
+			end
+			else if (can_write && (prefer_write || !can_read)) begin
+				axi_aw.awaddr <= ring_addr(base, ring_mask, wr_ptr);
+				axi_aw.awvalid <= 1'b1;
+				beat <= '0;
+				prefer_write <= 1'b0;
+				state <= STATE_WRITE;
+			end
+			else if (can_read) begin
+				axi_ar.araddr <= ring_addr(base, ring_mask, rd_ptr);
+				axi_ar.arvalid <= 1'b1;
+				prefer_write <= 1'b1;
+				state <= STATE_READ;
+			end
+		end
+		STATE_WRITE: begin
+			if (w_hshake) begin
+				beat <= beat + 1;
+				if (axi_w.wlast) begin
+					state <= STATE_WRITE_RESP;
+				end
+			end
+		end
+		STATE_WRITE_RESP: begin
+			// The burst is only read back after it has been written.
+			if (b_hshake) begin
+				wr_ptr <= wr_ptr + 1;
+				bursts <= bursts + 1;
+				state <= STATE_IDLE;
+			end
+		end
+		STATE_READ: begin
+			if (r_hshake && axi_r.rlast) begin
+				rd_ptr <= rd_ptr + 1;
+				state <= STATE_IDLE;
+			end
+		end
+		endcase
+	end
+end
+
+/*
+ * Descriptors
+ */
+wire rx_meta_desc_t meta = m_meta_fifo_r.rd_data;
+wire logic [31:0] meta_words = (32'(meta.size) + BYTES - 1) / BYTES;
+// In bypass, descriptors are passed directly unless bypass is about to
+// be left.
+wire logic meta_ready = !m_meta_fifo_r.empty && (bypass ? !enable :
+	staged_q[STAGE_DELAY-1] - claimed >= meta_words);
+
+assign s_meta_fifo_r.rd_data = m_meta_fifo_r.rd_data;
+assign s_meta_fifo_r.empty = !meta_ready;
+assign s_meta_fifo_r.almost_empty = !meta_ready;
+assign s_meta_fifo_r.rd_data_count = meta_ready ? m_meta_fifo_r.rd_data_count : '0;
+assign m_meta_fifo_r.rd_en = s_meta_fifo_r.rd_en;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		staged <= '0;
+		staged_q <= '{default: '0};
+		claimed <= '0;
+	end
+	else begin
+		if (stage_fifo_w.wr_en || (bypass && s_data_fifo_r.rd_en)) begin
+			staged <= staged + 1;
+		end
+		staged_q[0] <= staged;
+		for (int i = 1; i < STAGE_DELAY; i++) begin
+			staged_q[i] <= staged_q[i-1];
+		end
+		if (s_meta_fifo_r.rd_en) begin
+			claimed <= claimed + meta_words;
+		end
+	end
+end
+
+endmodule
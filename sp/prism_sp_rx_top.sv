@@ -20,7 +20,7 @@ import prism_sp_config::*;
 module prism_sp_rx_top #(
 	parameter int IBRAM_SIZE = 2**15,
 	parameter int DBRAM_SIZE = 2**15,
-	parameter int ACPBRAM_SIZE = 2*64*8,
+	parameter int ACPBRAM_SIZE = 4096*8,
 	parameter int NRXCORES = 1,
 
 	parameter int RX_DATA_FIFO_SIZE,
@@ -75,7 +75,20 @@ module prism_sp_rx_top #(
 	axi_write_channel.master				m_axi_dma_w [NRXCORES],
 	axi_write_response_channel.master		m_axi_dma_b [NRXCORES],
 
+	axi_write_address_channel.master		m_axi_spill_aw [NRXCORES],
+	axi_write_channel.master				m_axi_spill_w [NRXCORES],
+	axi_write_response_channel.master		m_axi_spill_b [NRXCORES],
+	axi_read_address_channel.master			m_axi_spill_ar [NRXCORES],
+	axi_read_channel.master					m_axi_spill_r [NRXCORES],
+
 	gem_rx_interface.slave gem_rx,
+	// Time base of the traffic generator (GEM RX clock domain)
+	output wire logic [31:0] tgen_now,
+	// Priorities to be paused (GEM RX clock domain) and the configuration
+	// of the PAUSE frames (see prism_sp_tx_pause)
+	output wire logic [7:0] pause_xoff,
+	output wire logic [31:0] pause_control,
+	output wire logic [47:0] pause_sa,
 
 	output trace_outputs_t					trace_proc [NRXCORES],
 	output trace_sp_unit_t					trace_sp_unit [NRXCORES],
@@ -99,25 +112,199 @@ fifo_write_interface #(
 	.DATA_COUNT_WIDTH(RX_DATA_FIFO_DATA_COUNT_WIDTH)
 ) rx_data_fifo_w[NRXCORES]();
 
+/*
+ * The traffic generator is configured by the first core.
+ */
+wire logic [31:0] tgen_control [NRXCORES];
+wire logic [31:0] tgen_size [NRXCORES];
+wire logic [31:0] tgen_count [NRXCORES];
+// GEM RX clock domain
+wire logic [31:0] tgen_sent;
+// The data digest is configured by the first core as well.
+wire logic [31:0] rx_digest_range [NRXCORES];
+// And so is the ESP SA table.
+wire logic [127:0] esp_sa_key [NRXCORES];
+wire logic [31:0] esp_sa_salt [NRXCORES];
+wire logic [31:0] esp_sa_spi [NRXCORES];
+wire logic [31:0] esp_sa_control [NRXCORES];
+// ESP status of the frame on gem_rx_esp
+wire logic [1:0] esp_status;
+// Tunnel offload, also configured by the first core
+wire logic [31:0] tunnel_control [NRXCORES];
+wire logic [31:0] tunnel_tmpl [NRXCORES];
+wire logic [31:0] tunnel_tmpl_addr [NRXCORES];
+wire rx_tunnel_status_t tunnel_status;
+// Flow telemetry of the first core
+wire logic flow_enable [NRXCORES];
+wire logic [31:0] flow_timeout [NRXCORES];
+// GEM RX clock domain
+wire logic [31:0] flow_drops;
+
+fifo_write_interface #(
+	.DATA_WIDTH(FLOW_RECORD_WIDTH),
+	.DATA_COUNT_WIDTH(FLOW_FIFO_DATA_COUNT_WIDTH)
+) flow_fifo_w[NRXCORES]();
+// Packet capture of the first core
+wire logic [31:0] capture_control [NRXCORES];
+wire logic [31:0] capture_mask [NRXCORES];
+wire logic [31:0] capture_match [NRXCORES];
+// GEM RX clock domain
+wire logic [31:0] capture_drops;
+// Admission control of the first core
+wire logic [31:0] admit_control [NRXCORES];
+wire logic [31:0] admit_thresh [NRXCORES];
+wire logic [31:0] rx_pause_control [NRXCORES];
+wire logic [47:0] rx_pause_sa [NRXCORES];
+// GEM RX clock domain
+wire logic [31:0] admit_drops;
+
+assign pause_control = rx_pause_control[0];
+assign pause_sa = rx_pause_sa[0];
+
+fifo_write_interface #(
+	.DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.DATA_COUNT_WIDTH(CAPTURE_FIFO_DATA_COUNT_WIDTH)
+) capture_fifo_w[NRXCORES]();
+
+gem_rx_interface gem_rx_sp();
+gem_rx_interface gem_rx_tunnel();
+gem_rx_interface gem_rx_esp();
+
+prism_sp_traffic_gen prism_sp_traffic_gen_0 (
+	.control(USE_TRAFFIC_GEN ? tgen_control[0] : '0),
+	.size(tgen_size[0]),
+	.count(tgen_count[0]),
+
+	.sent(tgen_sent),
+	.now(tgen_now),
+
+	.gem_rx_in(gem_rx),
+	.gem_rx_out(gem_rx_sp)
+);
+
+/*
+ * The flow meter sees the frames as they are received.
+ */
+if (USE_FLOW_METER) begin
+	prism_sp_flow_meter prism_sp_flow_meter_0 (
+		.clock(gem_rx.rx_clock),
+		.resetn(gem_rx.rx_resetn),
+
+		.enable(flow_enable[0]),
+		.timeout(flow_timeout[0]),
+
+		.valid(gem_rx_sp.rx_w_wr),
+		.data(gem_rx_sp.rx_w_data[7:0]),
+		.sop(gem_rx_sp.rx_w_sop),
+		.eop(gem_rx_sp.rx_w_eop),
+		.err(gem_rx_sp.rx_w_err),
+
+		.record_fifo_w(flow_fifo_w[0]),
+		.drops(flow_drops)
+	);
+end
+else begin
+	assign flow_fifo_w[0].clock = gem_rx.rx_clock;
+	assign flow_fifo_w[0].reset = ~gem_rx.rx_resetn;
+	assign flow_fifo_w[0].wr_en = 1'b0;
+	assign flow_drops = '0;
+end
+for (genvar i = 1; i < NRXCORES; i++) begin
+	assign flow_fifo_w[i].clock = gem_rx.rx_clock;
+	assign flow_fifo_w[i].reset = ~gem_rx.rx_resetn;
+	assign flow_fifo_w[i].wr_en = 1'b0;
+end
+
+/*
+ * So does the capture unit.
+ */
+if (USE_CAPTURE) begin
+	prism_sp_capture prism_sp_capture_0 (
+		.clock(gem_rx.rx_clock),
+		.resetn(gem_rx.rx_resetn),
+
+		.control(capture_control[0]),
+		.filter_mask(capture_mask[0]),
+		.filter_match(capture_match[0]),
+
+		.valid(gem_rx_sp.rx_w_wr),
+		.data(gem_rx_sp.rx_w_data[7:0]),
+		.sop(gem_rx_sp.rx_w_sop),
+		.eop(gem_rx_sp.rx_w_eop),
+		.err(gem_rx_sp.rx_w_err),
+
+		.slot_fifo_w(capture_fifo_w[0]),
+		.drops(capture_drops)
+	);
+end
+else begin
+	assign capture_fifo_w[0].clock = gem_rx.rx_clock;
+	assign capture_fifo_w[0].reset = ~gem_rx.rx_resetn;
+	assign capture_fifo_w[0].wr_en = 1'b0;
+	assign capture_drops = '0;
+end
+for (genvar i = 1; i < NRXCORES; i++) begin
+	assign capture_fifo_w[i].clock = gem_rx.rx_clock;
+	assign capture_fifo_w[i].reset = ~gem_rx.rx_resetn;
+	assign capture_fifo_w[i].wr_en = 1'b0;
+end
+
+prism_sp_rx_tunnel prism_sp_rx_tunnel_0 (
+	.control(tunnel_control[0]),
+
+	.status(tunnel_status),
+
+	.gem_rx_in(gem_rx_sp),
+	.gem_rx_out(gem_rx_tunnel)
+);
+
 if (NRXCORES == 1) begin
+	prism_sp_rx_esp prism_sp_rx_esp_0 (
+		.sa_key(esp_sa_key[0]),
+		.sa_salt(esp_sa_salt[0]),
+		.sa_spi(esp_sa_spi[0]),
+		.sa_control(esp_sa_control[0]),
+
+		.esp(esp_status[0]),
+		.auth_err(esp_status[1]),
+
+		.gem_rx_in(gem_rx_tunnel),
+		.gem_rx_out(gem_rx_esp)
+	);
+
 	prism_sp_gem_rx_single #(
 		.NRXCORES(NRXCORES),
 		.RX_DATA_FIFO_SIZE(RX_DATA_FIFO_SIZE)
 	) prism_sp_gem_rx_0(
 		.rx_meta_fifo_w,
 		.rx_data_fifo_w,
-		.gem_rx
+		.digest_range(rx_digest_range[0]),
+		.esp_status,
+		.tunnel_status,
+		.admit_control(admit_control[0]),
+		.admit_thresh(admit_thresh[0]),
+		.pause_control(rx_pause_control[0]),
+		.admit_drops,
+		.pause_xoff,
+		.gem_rx(gem_rx_esp)
 	);
 end
 else begin
+	/*
+	 * prism_sp_gem_rx has no RX cookie flags for the ESP status.
+	 * ESP frames are therefore not decrypted but passed on as they are.
+	 */
 	prism_sp_gem_rx #(
 		.NRXCORES(NRXCORES),
 		.RX_DATA_FIFO_SIZE(RX_DATA_FIFO_SIZE)
 	) prism_sp_gem_rx_0(
 		.rx_meta_fifo_w,
 		.rx_data_fifo_w,
-		.gem_rx
+		.gem_rx(gem_rx_tunnel)
 	);
+	assign esp_status = '0;
+	assign admit_drops = '0;
+	assign pause_xoff = '0;
 end
 
 generate
@@ -128,6 +315,7 @@ for (genvar i = 0; i < NRXCORES; i++) begin
 		.ACPBRAM_SIZE(ACPBRAM_SIZE),
 		.RX_DATA_FIFO_SIZE(RX_DATA_FIFO_SIZE),
 		.RX_DATA_FIFO_WIDTH(RX_DATA_FIFO_WIDTH),
+		.USE_ADMIT(NRXCORES == 1),
 		.INSTANCE(i)
 	) prism_sp_rx_core_0 (
 		.clock(clock),
@@ -175,9 +363,42 @@ for (genvar i = 0; i < NRXCORES; i++) begin
 		.m_axi_dma_w(m_axi_dma_w[i]),
 		.m_axi_dma_b(m_axi_dma_b[i]),
 
+		.m_axi_spill_aw(m_axi_spill_aw[i]),
+		.m_axi_spill_w(m_axi_spill_w[i]),
+		.m_axi_spill_b(m_axi_spill_b[i]),
+		.m_axi_spill_ar(m_axi_spill_ar[i]),
+		.m_axi_spill_r(m_axi_spill_r[i]),
+
 		.rx_meta_fifo_w(rx_meta_fifo_w[i]),
 		.rx_data_fifo_w(rx_data_fifo_w[i]),
 
+		.tgen_control(tgen_control[i]),
+		.tgen_size(tgen_size[i]),
+		.tgen_count(tgen_count[i]),
+		.gem_tgen_sent(tgen_sent),
+		.rx_digest_range(rx_digest_range[i]),
+		.esp_sa_key(esp_sa_key[i]),
+		.esp_sa_salt(esp_sa_salt[i]),
+		.esp_sa_spi(esp_sa_spi[i]),
+		.esp_sa_control(esp_sa_control[i]),
+		.tunnel_control(tunnel_control[i]),
+		.tunnel_tmpl(tunnel_tmpl[i]),
+		.tunnel_tmpl_addr(tunnel_tmpl_addr[i]),
+		.flow_enable(flow_enable[i]),
+		.flow_timeout(flow_timeout[i]),
+		.flow_fifo_w(flow_fifo_w[i]),
+		.gem_flow_drops(flow_drops),
+		.capture_control(capture_control[i]),
+		.capture_mask(capture_mask[i]),
+		.capture_match(capture_match[i]),
+		.capture_fifo_w(capture_fifo_w[i]),
+		.gem_capture_drops(capture_drops),
+		.admit_control(admit_control[i]),
+		.admit_thresh(admit_thresh[i]),
+		.gem_admit_drops(admit_drops),
+		.pause_control(rx_pause_control[i]),
+		.pause_sa(rx_pause_sa[i]),
+
 		.channel_irq(channel_irqs[i]),
 
 		.trace_proc(trace_proc[i]),
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Recognizes VXLAN and GENEVE frames between two GEM RX interfaces.
+ *
+ * A frame is a tunnel frame if it is an untagged IPv4 frame (20-byte
+ * header) to UDP port TUNNEL_VXLAN_PORT with the I flag set or to UDP
+ * port TUNNEL_GENEVE_PORT with version 0 and an Ethernet payload.
+ * Frames are only recognized while control[16] is set. If control[17]
+ * is set, the outer headers of these frames are not passed on, i.e.,
+ * the frame on gem_rx_out starts with the inner Ethernet header.
+ * The IPv4 header and TCP/UDP checksums of the inner frame are checked
+ * and a hash over its flow is computed (see rx_tunnel_status_t).
+ *
+ * The frames are delayed by TUNNEL_RX_DELAY clock cycles so that the
+ * inner frame is found before the first byte is passed on. Like
+ * prism_sp_rx_esp, this relies on one byte per clock cycle and on the
+ * gap between two frames. status belongs to the frame on gem_rx_out. It
+ * is valid at its rx_w_eop and held until the next rx_w_eop.
+ */
+module prism_sp_rx_tunnel (
+	// Quasi-static, see REGOFF_TUNNEL_CONTROL
+	input wire logic [31:0] control,
+
+	output rx_tunnel_status_t status,
+
+	gem_rx_interface.slave gem_rx_in,
+	gem_rx_interface.master gem_rx_out
+);
+
+localparam int OFF_WIDTH = 14;
+localparam int RX_BITN = 16;
+localparam int STRIP_BITN = 17;
+
+assign gem_rx_out.rx_clock = gem_rx_in.rx_clock;
+assign gem_rx_out.rx_resetn = gem_rx_in.rx_resetn;
+
+if (USE_TUNNEL) begin
+	wire logic clock = gem_rx_in.rx_clock;
+	wire logic resetn = gem_rx_in.rx_resetn;
+
+	function automatic logic [15:0] fold(input logic [31:0] s);
+		logic [16:0] t;
+
+		t = s[15:0] + 16'(s[31:16]);
+		t = t[15:0] + 16'(t[16]);
+		return t[15:0];
+	endfunction
+
+	/*
+	 * Parse the undelayed frames.
+	 */
+	var logic [OFF_WIDTH-1:0] in_cnt;
+	wire logic [OFF_WIDTH-1:0] in_off = gem_rx_in.rx_w_sop ? '0 : in_cnt;
+	wire logic [7:0] in_data = gem_rx_in.rx_w_data[7:0];
+
+	var logic [15:0] o_ethertype;
+	var logic [7:0] o_vihl;
+	var logic [15:0] o_ip_len;
+	var logic [7:0] o_proto;
+	var logic [15:0] o_dport;
+	var logic [7:0] o_hdr0;
+	var logic [7:0] o_hdr2;
+
+	// The decision for the current frame
+	var logic in_tunnel;
+	var logic [OFF_WIDTH-1:0] in_inner_off;
+
+	// Inner frame
+	var logic [15:0] i_ethertype;
+	var logic [7:0] i_vihl;
+	var logic [15:0] i_ip_len;
+	var logic [7:0] i_proto;
+	var logic [15:0] i_l4_csum;
+	var logic [31:0] i_ip_sum;
+	var logic [31:0] i_l4_sum;
+	var logic [31:0] i_hash;
+	var logic i_l4_done;
+
+	wire logic [OFF_WIDTH-1:0] rel = in_off - in_inner_off;
+	wire logic in_inner = in_tunnel && in_off >= in_inner_off;
+	wire logic [15:0] in_word = rel[0] ? { 8'h00, in_data } : { in_data, 8'h00 };
+	wire logic i_ipv4 = i_ethertype == 16'h0800 && i_vihl == 8'h45;
+	wire logic [OFF_WIDTH-1:0] i_l4_end = OFF_WIDTH'(i_ip_len) + OFF_WIDTH'(14);
+
+	// Decision at the last byte of the tunnel header
+	wire logic [5:0] geneve_opt_len = o_hdr0[5:0];
+	wire logic [15:0] o_ip_len_min = 16'(20 + 8 + 8 + 14) + 16'({ geneve_opt_len, 2'b00 });
+	wire logic o_hdr_ok = o_ethertype == 16'h0800 && o_vihl == 8'h45 && o_proto == 8'd17 &&
+		o_ip_len[15:14] == 2'b00;
+	wire logic is_vxlan = o_dport == TUNNEL_VXLAN_PORT && o_hdr0[3] && o_ip_len >= 16'(20 + 8 + 8 + 14);
+	wire logic is_geneve = o_dport == TUNNEL_GENEVE_PORT && o_hdr0[7:6] == 2'b00 &&
+		{ o_hdr2, in_data } == 16'h6558 && o_ip_len >= o_ip_len_min;
+
+	// Results of the last frame that ended
+	var rx_tunnel_status_t in_status;
+	// The last byte has been added.
+	var logic in_done;
+
+	wire logic [15:0] l4_len = i_ip_len - 16'd20;
+	wire logic [1:0] chksum_enc_comb =
+		!i_ipv4 || fold(i_ip_sum) != 16'hffff ? 2'b00 :
+		!i_l4_done ? 2'b01 :
+		i_proto == 8'd6 && fold(i_l4_sum + 32'(i_proto) + 32'(l4_len)) == 16'hffff ? 2'b10 :
+		i_proto == 8'd17 && i_l4_csum != '0 && fold(i_l4_sum + 32'(i_proto) + 32'(l4_len)) == 16'hffff ? 2'b11 :
+		2'b01;
+
+	always_ff @(posedge clock) begin
+		// Unpulse
+		in_done <= 1'b0;
+
+		if (!resetn) begin
+			in_cnt <= '0;
+			in_tunnel <= 1'b0;
+			in_status <= '0;
+		end
+		else begin
+			if (in_done) begin
+				in_status.tunnel <= in_tunnel;
+				in_status.inner_chksum_enc <= in_tunnel ? chksum_enc_comb : 2'b00;
+				in_status.inner_hash <= in_tunnel && i_ipv4 ? ~i_hash : '0;
+			end
+
+			if (gem_rx_in.rx_w_wr) begin
+				in_cnt <= in_off + 1;
+
+				if (gem_rx_in.rx_w_sop) begin
+					in_tunnel <= 1'b0;
+					i_ethertype <= '0;
+					i_ip_sum <= '0;
+					i_l4_sum <= '0;
+					i_hash <= '1;
+					i_l4_done <= 1'b0;
+				end
+
+				case (in_off)
+				12: o_ethertype[15:8] <= in_data;
+				13: o_ethertype[7:0] <= in_data;
+				14: o_vihl <= in_data;
+				16: o_ip_len[15:8] <= in_data;
+				17: o_ip_len[7:0] <= in_data;
+				23: o_proto <= in_data;
+				36: o_dport[15:8] <= in_data;
+				37: o_dport[7:0] <= in_data;
+				42: o_hdr0 <= in_data;
+				44: o_hdr2 <= in_data;
+				45: begin
+					in_tunnel <= control[RX_BITN] && o_hdr_ok && (is_vxlan || is_geneve);
+					in_inner_off <= OFF_WIDTH'(50) + (is_geneve ? OFF_WIDTH'({ geneve_opt_len, 2'b00 }) : '0);
+				end
+				endcase
+
+				if (in_inner) begin
+					case (rel)
+					12: i_ethertype[15:8] <= in_data;
+					13: i_ethertype[7:0] <= in_data;
+					14: i_vihl <= in_data;
+					16: i_ip_len[15:8] <= in_data;
+					17: i_ip_len[7:0] <= in_data;
+					23: i_proto <= in_data;
+					endcase
+
+					if (rel == 23 || (rel >= 26 && rel < 38)) begin
+						i_hash <= crc32c_byte(i_hash, in_data);
+					end
+					if (rel >= 14 && rel < 34) begin
+						i_ip_sum <= i_ip_sum + 32'(in_word);
+					end
+					// The addresses of the pseudo header and the L4 segment
+					if (rel >= 26 && rel < i_l4_end) begin
+						i_l4_sum <= i_l4_sum + 32'(in_word);
+					end
+					if (rel == 40) begin
+						i_l4_csum[15:8] <= in_data;
+					end
+					if (rel == 41) begin
+						i_l4_csum[7:0] <= in_data;
+					end
+					if (rel >= 34 && rel == i_l4_end - 1) begin
+						i_l4_done <= 1'b1;
+					end
+				end
+
+				in_done <= gem_rx_in.rx_w_eop;
+			end
+		end
+	end
+
+	/*
+	 * Delay line
+	 */
+	var logic dly_wr [TUNNEL_RX_DELAY];
+	var logic [31:0] dly_data [TUNNEL_RX_DELAY];
+	var logic dly_sop [TUNNEL_RX_DELAY];
+	var logic dly_eop [TUNNEL_RX_DELAY];
+	var logic [44:0] dly_status [TUNNEL_RX_DELAY];
+	var logic dly_err [TUNNEL_RX_DELAY];
+	var logic dly_flush [TUNNEL_RX_DELAY];
+
+	always_ff @(posedge clock) begin
+		if (!resetn) begin
+			for (int i = 0; i < TUNNEL_RX_DELAY; i++) begin
+				dly_wr[i] <= 1'b0;
+				dly_sop[i] <= 1'b0;
+				dly_eop[i] <= 1'b0;
+				dly_err[i] <= 1'b0;
+				dly_flush[i] <= 1'b0;
+			end
+		end
+		else begin
+			dly_wr[0] <= gem_rx_in.rx_w_wr;
+			dly_sop[0] <= gem_rx_in.rx_w_sop;
+			dly_eop[0] <= gem_rx_in.rx_w_eop;
+			dly_err[0] <= gem_rx_in.rx_w_err;
+			dly_flush[0] <= gem_rx_in.rx_w_flush;
+			for (int i = 1; i < TUNNEL_RX_DELAY; i++) begin
+				dly_wr[i] <= dly_wr[i-1];
+				dly_sop[i] <= dly_sop[i-1];
+				dly_eop[i] <= dly_eop[i-1];
+				dly_err[i] <= dly_err[i-1];
+				dly_flush[i] <= dly_flush[i-1];
+			end
+		end
+		dly_data[0] <= gem_rx_in.rx_w_data;
+		dly_status[0] <= gem_rx_in.rx_w_status;
+		for (int i = 1; i < TUNNEL_RX_DELAY; i++) begin
+			dly_data[i] <= dly_data[i-1];
+			dly_status[i] <= dly_status[i-1];
+		end
+	end
+
+	/*
+	 * Pass on the delayed frames.
+	 */
+	wire logic d_wr = dly_wr[TUNNEL_RX_DELAY-1];
+	wire logic d_sop = dly_sop[TUNNEL_RX_DELAY-1];
+	wire logic d_eop = dly_eop[TUNNEL_RX_DELAY-1];
+	wire logic [44:0] d_status = dly_status[TUNNEL_RX_DELAY-1];
+
+	var logic [OFF_WIDTH-1:0] out_cnt;
+	wire logic [OFF_WIDTH-1:0] out_off = d_sop ? '0 : out_cnt;
+	// Number of bytes to strip from the current frame
+	var logic [OFF_WIDTH-1:0] out_strip;
+	wire logic [OFF_WIDTH-1:0] strip = d_sop ?
+		(in_tunnel && control[STRIP_BITN] ? in_inner_off : '0) : out_strip;
+	var logic [44:0] out_sop_status;
+	var rx_tunnel_status_t out_status;
+
+	always_ff @(posedge clock) begin
+		if (!resetn) begin
+			out_cnt <= '0;
+			out_strip <= '0;
+			out_status <= '0;
+		end
+		else begin
+			if (d_wr) begin
+				out_cnt <= out_off + 1;
+			end
+			if (d_sop) begin
+				out_strip <= strip;
+				out_sop_status <= d_status;
+			end
+			if (d_eop) begin
+				out_status <= in_status;
+			end
+		end
+	end
+
+	// Frames that end within the outer headers keep their last byte.
+	wire logic out_first = strip != '0 && (out_off == strip || (d_eop && out_off < strip));
+
+	assign gem_rx_out.rx_w_wr = d_wr && (out_off >= strip || out_first);
+	assign gem_rx_out.rx_w_data = dly_data[TUNNEL_RX_DELAY-1];
+	assign gem_rx_out.rx_w_sop = d_wr && (strip == '0 ? d_sop : out_first);
+	assign gem_rx_out.rx_w_eop = d_eop;
+	// The status that the GEM gave at the start of the frame
+	assign gem_rx_out.rx_w_status = out_first ? out_sop_status : d_status;
+	assign gem_rx_out.rx_w_err = dly_err[TUNNEL_RX_DELAY-1];
+	assign gem_rx_out.rx_w_flush = dly_flush[TUNNEL_RX_DELAY-1];
+	assign gem_rx_in.rx_w_overflow = gem_rx_out.rx_w_overflow;
+
+	assign status = d_eop ? in_status : out_status;
+end
+else begin
+	assign gem_rx_out.rx_w_wr = gem_rx_in.rx_w_wr;
+	assign gem_rx_out.rx_w_data = gem_rx_in.rx_w_data;
+	assign gem_rx_out.rx_w_sop = gem_rx_in.rx_w_sop;
+	assign gem_rx_out.rx_w_eop = gem_rx_in.rx_w_eop;
+	assign gem_rx_out.rx_w_status = gem_rx_in.rx_w_status;
+	assign gem_rx_out.rx_w_err = gem_rx_in.rx_w_err;
+	assign gem_rx_out.rx_w_flush = gem_rx_in.rx_w_flush;
+	assign gem_rx_in.rx_w_overflow = gem_rx_out.rx_w_overflow;
+	assign status = '0;
+end
+
+endmodule
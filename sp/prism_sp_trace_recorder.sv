@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Records a TRACE_RECORDER_SAMPLE_WIDTH-bit window of the trace vector
+ * into a BRAM ring buffer of TRACE_RECORDER_DEPTH entries.
+ *
+ * The window starts at bit 32 * window of the trace vector. A sample is
+ * only recorded when it differs from the previous one. Every entry holds
+ * the sample and the clock cycle it was taken in.
+ *
+ * Recording starts when arm is set and the buffer is cleared when it is
+ * reset. The trigger fires on the first sample whose lower 32 bits
+ * satisfy (sample & trig_mask) == trig_match, or when force_trigger is
+ * set. After the trigger entry, post further entries are recorded and
+ * the recorder stops. All entries before it are pre-trigger history.
+ *
+ * status:
+ *   [0]		armed
+ *   [1]		triggered
+ *   [2]		done
+ *   [3]		the buffer has wrapped, i.e., all entries are valid
+ *   [31:16]	index of the next entry, which is the oldest one if the
+ *				buffer has wrapped
+ *
+ * rd_addr selects the 32-bit word rd_data of an entry:
+ *   [1:0]		0: sample[31:0], 1: sample[63:32], 2: cycle, 3: zero
+ *   [17:2]		entry
+ * rd_data is valid two clock cycles after rd_addr has been written.
+ */
+module prism_sp_trace_recorder #(
+	parameter int TRACE_WIDTH
+) (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [TRACE_WIDTH-1:0] trace,
+
+	input wire logic arm,
+	input wire logic force_trigger,
+	input wire logic [TRACE_CONTROL_WINDOW_WIDTH-1:0] window,
+	input wire logic [TRACE_CONTROL_POST_WIDTH-1:0] post,
+	input wire logic [31:0] trig_mask,
+	input wire logic [31:0] trig_match,
+	input wire logic [31:0] rd_addr,
+
+	output wire logic [31:0] status,
+	output var logic [31:0] rd_data
+);
+
+localparam int SAMPLE_WIDTH = TRACE_RECORDER_SAMPLE_WIDTH;
+localparam int ENTRY_WIDTH = SAMPLE_WIDTH + 32;
+localparam int DEPTH = TRACE_RECORDER_DEPTH;
+localparam int ADDR_WIDTH = $clog2(DEPTH);
+localparam int NWINDOWS = (TRACE_WIDTH + 31) / 32;
+localparam int PADDED_WIDTH = 32 * NWINDOWS + SAMPLE_WIDTH;
+
+if (SAMPLE_WIDTH != 64) begin
+	$error("TRACE_RECORDER_SAMPLE_WIDTH (%d) has to be 64\n", SAMPLE_WIDTH);
+end
+if (ADDR_WIDTH > 16) begin
+	$error("TRACE_RECORDER_DEPTH (%d) must not exceed 65536\n", DEPTH);
+end
+
+wire logic [PADDED_WIDTH-1:0] trace_padded = PADDED_WIDTH'(trace);
+
+var logic [31:0] now;
+var logic [SAMPLE_WIDTH-1:0] sample;
+var logic [31:0] sample_cycle;
+var logic [SAMPLE_WIDTH-1:0] prev_sample;
+var logic prev_valid;
+
+var logic [ADDR_WIDTH-1:0] wr_idx;
+var logic wrapped;
+var logic triggered;
+var logic done;
+var logic [TRACE_CONTROL_POST_WIDTH-1:0] post_left;
+
+wire logic trig_cond = force_trigger || (sample[31:0] & trig_mask) == trig_match;
+wire logic active = arm && !done;
+// The trigger entry is written even if the sample has not changed.
+wire logic wr_en = active && (!prev_valid || sample != prev_sample || (trig_cond && !triggered));
+
+assign status = {
+	16'(wr_idx),
+	12'h000,
+	wrapped,
+	done,
+	triggered,
+	arm
+};
+
+/*
+ * Sample
+ */
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		now <= '0;
+		sample <= '0;
+		sample_cycle <= '0;
+	end
+	else begin
+		now <= now + 1;
+		sample_cycle <= now;
+		if (window < NWINDOWS) begin
+			sample <= trace_padded[32*window +: SAMPLE_WIDTH];
+		end
+		else begin
+			sample <= '0;
+		end
+	end
+end
+
+/*
+ * Record
+ */
+always_ff @(posedge clock) begin
+	if (!resetn || !arm) begin
+		prev_valid <= 1'b0;
+		wr_idx <= '0;
+		wrapped <= 1'b0;
+		triggered <= 1'b0;
+		done <= 1'b0;
+	end
+	else if (wr_en) begin
+		prev_sample <= sample;
+		prev_valid <= 1'b1;
+
+		wr_idx <= wr_idx + 1;
+		if (wr_idx == ADDR_WIDTH'(DEPTH-1)) begin
+			wrapped <= 1'b1;
+		end
+
+		if (triggered) begin
+			if (post_left == '0) begin
+				done <= 1'b1;
+			end
+			else begin
+				post_left <= post_left - 1;
+			end
+		end
+		else if (trig_cond) begin
+			triggered <= 1'b1;
+			if (post == '0) begin
+				done <= 1'b1;
+			end
+			else begin
+				post_left <= post - 1;
+			end
+		end
+	end
+end
+
+/*
+ * Read
+ */
+wire logic [ENTRY_WIDTH-1:0] rd_entry;
+var logic [1:0] rd_word;
+
+always_ff @(posedge clock) begin
+	rd_word <= rd_addr[1:0];
+
+	case (rd_word)
+	2'd0: rd_data <= rd_entry[31:0];
+	2'd1: rd_data <= rd_entry[63:32];
+	2'd2: rd_data <= rd_entry[SAMPLE_WIDTH +: 32];
+	default: rd_data <= '0;
+	endcase
+end
+
+xpm_memory_sdpram #(
+	.ADDR_WIDTH_A(ADDR_WIDTH),
+	.ADDR_WIDTH_B(ADDR_WIDTH),
+	.AUTO_SLEEP_TIME(0),
+	.BYTE_WRITE_WIDTH_A(ENTRY_WIDTH),
+	.CASCADE_HEIGHT(0),
+	.CLOCKING_MODE("common_clock"),
+	.ECC_MODE("no_ecc"),
+	.MEMORY_INIT_FILE("none"),
+	.MEMORY_INIT_PARAM("0"),
+	.MEMORY_OPTIMIZATION("true"),
+	.MEMORY_PRIMITIVE("block"),
+	.MEMORY_SIZE(DEPTH*ENTRY_WIDTH),
+	.MESSAGE_CONTROL(0),
+	.READ_DATA_WIDTH_B(ENTRY_WIDTH),
+	.READ_LATENCY_B(1),
+	.READ_RESET_VALUE_B("0"),
+	.RST_MODE_A("SYNC"),
+	.RST_MODE_B("SYNC"),
+	.SIM_ASSERT_CHK(0),
+	.USE_EMBEDDED_CONSTRAINT(0),
+	.USE_MEM_INIT(1),
+	.WAKEUP_TIME("disable_sleep"),
+	.WRITE_DATA_WIDTH_A(ENTRY_WIDTH),
+	.WRITE_MODE_B("read_first")
+)
+xpm_memory_sdpram_trace (
+	.clka(clock),
+	.clkb(clock),
+	.rstb(~resetn),
+	.ena(wr_en),
+	.wea(1'b1),
+	.addra(wr_idx),
+	.dina({ sample_cycle, sample }),
+	.enb(1'b1),
+	.regceb(1'b1),
+	.addrb(rd_addr[2 +: ADDR_WIDTH]),
+	.doutb(rd_entry),
+	.sleep(1'b0),
+	.injectsbiterra(1'b0),
+	.injectdbiterra(1'b0),
+	.sbiterrb(),
+	.dbiterrb()
+);
+
+endmodule
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Frame checker behind the GEM TX interface.
+ *
+ * The checker watches the bytes handed to the GEM. Frames with the
+ * EtherType TRAFFIC_ETHERTYPE were made by prism_sp_traffic_gen; all
+ * other frames are ignored. For every generated frame, it checks
+ * - the sequence number: a number above the expected one counts the
+ *   missing frames as lost, a number below it counts the frame as
+ *   reordered,
+ * - the payload against traffic_payload(); a mismatch or an aborted
+ *   frame counts the frame as corrupt and
+ * - the latency, i.e., the difference between the time the last byte
+ *   is sent and the timestamp of the frame.
+ * The timestamps are taken from gen_now in the clock domain of the
+ * generator (gen_clock).
+ *
+ * enable is written in another clock domain. Clearing it clears the
+ * results.
+ */
+module prism_sp_traffic_check (
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic enable,
+
+	input wire logic gen_clock,
+	input wire logic [31:0] gen_now,
+
+	input wire logic valid,
+	input wire logic [7:0] data,
+	input wire logic sop,
+	input wire logic eop,
+	input wire logic err,
+
+	output traffic_check_t results
+);
+
+localparam int SIZE_WIDTH = 14;
+
+var logic [1:0] enable_sync;
+
+/*
+ * The time of the generator in this clock domain
+ */
+wire logic [31:0] now;
+`ifdef VERILATOR
+assign now = gen_now;
+`else
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(gen_now))
+) gen_now_cdc (
+	.src_clk(gen_clock),
+	.src_in_bin(gen_now),
+	.dest_clk(clock),
+	.dest_out_bin(now)
+);
+`endif
+
+var logic [SIZE_WIDTH-1:0] offset;
+var logic [15:0] ethertype;
+var logic [31:0] seq;
+var logic [31:0] stamp;
+var logic [1:0] pattern;
+var logic bad;
+var logic [31:0] expected_seq;
+
+// The offset of the current byte
+wire logic [SIZE_WIDTH-1:0] cur_offset = sop ? '0 : offset;
+wire logic mismatch = cur_offset >= TRAFFIC_HDR_SIZE &&
+	data != traffic_payload(pattern, seq, cur_offset);
+wire logic [31:0] latency = now - stamp;
+
+always_ff @(posedge clock) begin
+	enable_sync <= { enable_sync[0], enable };
+
+	if (!resetn || !enable_sync[1]) begin
+		offset <= '0;
+		expected_seq <= '0;
+		results <= '0;
+		results.lat_min <= '1;
+	end
+	else if (valid) begin
+		offset <= cur_offset + 1;
+		if (sop) begin
+			bad <= 1'b0;
+			ethertype <= '0;
+		end
+		else if (mismatch) begin
+			bad <= 1'b1;
+		end
+
+		case (cur_offset)
+		12: ethertype[15:8] <= data;
+		13: ethertype[7:0] <= data;
+		14: seq[31:24] <= data;
+		15: seq[23:16] <= data;
+		16: seq[15:8] <= data;
+		17: seq[7:0] <= data;
+		18: stamp[31:24] <= data;
+		19: stamp[23:16] <= data;
+		20: stamp[15:8] <= data;
+		21: stamp[7:0] <= data;
+		24: pattern <= data[1:0];
+		default: begin
+		end
+		endcase
+
+		if (eop && ethertype == TRAFFIC_ETHERTYPE && cur_offset >= TRAFFIC_HDR_SIZE - 1) begin
+			results.frames <= results.frames + 1;
+
+			if (seq == expected_seq) begin
+				expected_seq <= seq + 1;
+			end
+			else if ($signed(seq - expected_seq) > 0) begin
+				results.lost <= results.lost + (seq - expected_seq);
+				expected_seq <= seq + 1;
+			end
+			else begin
+				results.reordered <= results.reordered + 1;
+			end
+
+			if (bad || mismatch || err) begin
+				results.corrupt <= results.corrupt + 1;
+			end
+
+			if (latency < results.lat_min) begin
+				results.lat_min <= latency;
+			end
+			if (latency > results.lat_max) begin
+				results.lat_max <= latency;
+			end
+		end
+	end
+end
+
+endmodule
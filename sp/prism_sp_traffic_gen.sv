@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Frame generator in front of the GEM RX interface.
+ *
+ * While control[0] is set, frames from gem_rx_in are dropped and
+ * generated frames are fed into gem_rx_out instead. The switch only
+ * happens between frames. Like the GEM, the generator writes one byte
+ * per clock cycle. Every frame is followed by control[31:16] idle cycles.
+ *   control[2:1]	payload pattern (see traffic_payload)
+ *   control[15:8]	number of flows - 1
+ *   size[13:0]		size of the first frame
+ *   size[29:16]	size of the last frame; the sizes go up in steps of
+ *					one byte and wrap around
+ *   count			number of frames to send, zero for no limit
+ * The header of a frame is described in prism_sp_config.
+ *
+ * control, size and count are written in another clock domain. They
+ * must only be changed while control[0] is clear. Clearing control[0]
+ * also resets the sequence number and sent.
+ * now is a free-running counter that provides the timestamps.
+ */
+module prism_sp_traffic_gen (
+	input wire logic [31:0] control,
+	input wire logic [31:0] size,
+	input wire logic [31:0] count,
+
+	output var logic [31:0] sent,
+	output var logic [31:0] now,
+
+	gem_rx_interface.slave gem_rx_in,
+	gem_rx_interface.master gem_rx_out
+);
+
+localparam int SIZE_WIDTH = 14;
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_FRAME,
+	STATE_GAP
+} state_t;
+
+wire logic clock = gem_rx_in.rx_clock;
+wire logic resetn = gem_rx_in.rx_resetn;
+
+var logic [1:0] enable_sync;
+wire logic enable = enable_sync[1];
+wire logic [1:0] pattern = control[2:1];
+wire logic [7:0] nflows_m1 = control[15:8];
+wire logic [15:0] gap = control[31:16];
+wire logic [SIZE_WIDTH-1:0] size_first = size[SIZE_WIDTH-1:0] < TRAFFIC_HDR_SIZE ?
+	SIZE_WIDTH'(TRAFFIC_HDR_SIZE) : size[SIZE_WIDTH-1:0];
+wire logic [SIZE_WIDTH-1:0] size_last = size[16 +: SIZE_WIDTH] < size_first ?
+	size_first : size[16 +: SIZE_WIDTH];
+
+var state_t state;
+// Set while the generator owns gem_rx_out.
+var logic active;
+// Set while the GEM is in the middle of a frame.
+var logic gem_in_frame;
+
+var logic [31:0] seq;
+var logic [31:0] stamp;
+var logic [7:0] flow;
+var logic [SIZE_WIDTH-1:0] frame_size;
+var logic [SIZE_WIDTH-1:0] offset;
+var logic [15:0] gap_left;
+
+var logic gen_wr;
+var logic [7:0] gen_data;
+var logic gen_sop;
+var logic gen_eop;
+var logic [SIZE_WIDTH-1:0] gen_size;
+
+var logic [7:0] frame_byte;
+always_comb begin
+	case (offset)
+	0: frame_byte = 8'h02;
+	5: frame_byte = 8'h01;
+	6: frame_byte = 8'h02;
+	1, 2, 3, 4, 7, 8, 9, 10, 11, 25: frame_byte = 8'h00;
+	12: frame_byte = TRAFFIC_ETHERTYPE[15:8];
+	13: frame_byte = TRAFFIC_ETHERTYPE[7:0];
+	14: frame_byte = seq[31:24];
+	15: frame_byte = seq[23:16];
+	16: frame_byte = seq[15:8];
+	17: frame_byte = seq[7:0];
+	18: frame_byte = stamp[31:24];
+	19: frame_byte = stamp[23:16];
+	20: frame_byte = stamp[15:8];
+	21: frame_byte = stamp[7:0];
+	22: frame_byte = 8'h00;
+	23: frame_byte = flow;
+	24: frame_byte = 8'(pattern);
+	default: frame_byte = traffic_payload(pattern, seq, offset);
+	endcase
+end
+
+assign gem_rx_out.rx_clock = gem_rx_in.rx_clock;
+assign gem_rx_out.rx_resetn = gem_rx_in.rx_resetn;
+assign gem_rx_out.rx_w_wr = active ? gen_wr : gem_rx_in.rx_w_wr;
+assign gem_rx_out.rx_w_data = active ? { 24'h000000, gen_data } : gem_rx_in.rx_w_data;
+assign gem_rx_out.rx_w_sop = active ? gen_sop : gem_rx_in.rx_w_sop;
+assign gem_rx_out.rx_w_eop = active ? gen_eop : gem_rx_in.rx_w_eop;
+// Only the frame length is reported.
+assign gem_rx_out.rx_w_status = active ? 45'(gen_size) : gem_rx_in.rx_w_status;
+assign gem_rx_out.rx_w_err = active ? 1'b0 : gem_rx_in.rx_w_err;
+assign gem_rx_out.rx_w_flush = active ? 1'b0 : gem_rx_in.rx_w_flush;
+assign gem_rx_in.rx_w_overflow = !active && gem_rx_out.rx_w_overflow;
+
+always_ff @(posedge clock) begin
+	enable_sync <= { enable_sync[0], control[0] };
+
+	// Unpulse
+	gen_wr <= 1'b0;
+	gen_sop <= 1'b0;
+	gen_eop <= 1'b0;
+
+	if (!resetn) begin
+		now <= '0;
+		active <= 1'b0;
+		gem_in_frame <= 1'b0;
+		sent <= '0;
+		seq <= '0;
+		flow <= '0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		now <= now + 1;
+
+		if (gem_rx_in.rx_w_eop) begin
+			gem_in_frame <= 1'b0;
+		end
+		else if (gem_rx_in.rx_w_sop) begin
+			gem_in_frame <= 1'b1;
+		end
+
+		case (state)
+		STATE_IDLE: begin
+			if (!gem_in_frame && !gem_rx_in.rx_w_sop) begin
+				active <= enable;
+			end
+			if (!enable) begin
+				sent <= '0;
+				seq <= '0;
+				flow <= '0;
+				frame_size <= size_first;
+			end
+			else if (active && (count == '0 || sent != count)) begin
+				offset <= '0;
+				stamp <= now;
+				state <= STATE_FRAME;
+			end
+		end
+		STATE_FRAME: begin
+			gen_wr <= 1'b1;
+			gen_data <= frame_byte;
+			gen_sop <= offset == '0;
+			gen_eop <= offset == frame_size - 1;
+			gen_size <= frame_size;
+			offset <= offset + 1;
+
+			if (offset == frame_size - 1) begin
+				sent <= sent + 1;
+				seq <= seq + 1;
+				flow <= flow == nflows_m1 ? '0 : flow + 1;
+				frame_size <= frame_size >= size_last ? size_first : frame_size + 1;
+				gap_left <= gap;
+				state <= STATE_GAP;
+			end
+		end
+		STATE_GAP: begin
+			if (gap_left == '0) begin
+				state <= STATE_IDLE;
+			end
+			else begin
+				gap_left <= gap_left - 1;
+			end
+		end
+		endcase
+	end
+end
+
+endmodule
@@ -181,6 +181,21 @@ always_ff @(posedge clock) begin
 	tcp_cyc3_lev1_ff <= ($bits(tcp_cyc3_lev1_ff))'(tcp_cyc3_lev0_ff) + lev0_add_ff[1];
 	tcp_cyc3_lev2_ff <= ($bits(tcp_cyc3_lev2_ff))'(tcp_cyc3_lev1_ff) + lev1_add_ff[1];
 end
+/*
+ * -------------------------------------------------------------------
+ * This process handles the lanes that may hold checksum fields.
+ * They are left out of the sum over the whole frame.
+ */
+var logic [15:0] pipe_lane1 [NSTAGES];
+var logic [15:0] pipe_lane4 [NSTAGES];
+always_ff @(posedge clock) begin
+	for (int i = 1; i < NSTAGES; i++) begin
+		pipe_lane1[i] <= pipe_lane1[i - 1];
+		pipe_lane4[i] <= pipe_lane4[i - 1];
+	end
+	pipe_lane1[0] <= reverse(i_data[1*16 +: 16]);
+	pipe_lane4[0] <= reverse(i_data[4*16 +: 16]);
+end
 /*
  * -------------------------------------------------------------------
  */
@@ -230,14 +245,53 @@ var logic [SP_CSUM_L4_SUM_WIDTH-1:0] l4_sum;
 var logic [1:0] eth_type;
 var logic [1:0] ip_proto;
 var logic commit_checksum;
+var logic commit_none;
+var logic csum_committed;
+// Sum over the whole frame without the checksum fields
+var logic [31:0] frame_sum;
+var logic [2:0] frame_word;
 
 wire logic p_valid = pipe_valid[NSTAGES-1];
 wire logic p_sof = pipe_sof[NSTAGES-1];
 wire logic p_eof = pipe_eof[NSTAGES-1];
 
+/*
+ * Frames other than IPv4 need no checksum insertion.
+ * We commit an empty checksum entry for these right at the start of
+ * the frame so that the GEM TX interface does not have to wait for the
+ * end of the frame (cut-through).
+ */
+wire logic p_no_csum = p_sof && pipe_eth_type[NSTAGES-1] == 2'b00;
+
 // 17 bits because these might have one carry bit still.
 wire logic [16:0] folded_ip_sum = ip_sum[15:0] + 16'(ip_sum[$bits(ip_sum)-1:16]);
 wire logic [16:0] folded_l4_sum = l4_sum[15:0] + 16'(l4_sum[$bits(l4_sum)-1:16]);
+wire logic [15:0] ip_csum = ~(folded_ip_sum[15:0] + 16'(folded_ip_sum[16]));
+wire logic [15:0] l4_csum = ~(folded_l4_sum[15:0] + 16'(folded_l4_sum[16]));
+
+function automatic logic [15:0] fold(input logic [31:0] s);
+	logic [16:0] t;
+
+	t = s[15:0] + 16'(s[31:16]);
+	t = t[15:0] + 16'(t[16]);
+	return t[15:0];
+endfunction
+
+wire logic [2:0] p_word = p_sof ? '0 : frame_word;
+var logic [15:0] p_csum_lane;
+always_comb begin
+	p_csum_lane = '0;
+	case (p_word)
+	// IPv4 header checksum
+	3'd1: p_csum_lane = pipe_lane4[NSTAGES-1];
+	// UDP checksum (ip_proto is known from the 1st word)
+	3'd2: if (ip_proto == 2'b10) p_csum_lane = pipe_lane4[NSTAGES-1];
+	// TCP checksum
+	3'd3: if (ip_proto == 2'b01) p_csum_lane = pipe_lane1[NSTAGES-1];
+	default: begin
+	end
+	endcase
+end
 
 always_ff @(posedge clock) begin
 	tx_csum_fifo_w.wr_en <= 1'b0;
@@ -246,6 +300,8 @@ always_ff @(posedge clock) begin
 		ip_state <= IP_STATE_IDLE;
 		l4_state <= L4_STATE_IDLE;
 		commit_checksum <= 1'b0;
+		commit_none <= 1'b0;
+		csum_committed <= 1'b0;
 	end
 	else begin
 		// This will be executed in the same clock cycle as
@@ -259,18 +315,41 @@ always_ff @(posedge clock) begin
 			// 00: None
 			// 01: IPv4
 			tx_csum_fifo_w.wr_data[0 +: 2] <= eth_type;
-			tx_csum_fifo_w.wr_data[2 +: 16] <= ~(folded_ip_sum[15:0] + 16'(folded_ip_sum[16]));
+			tx_csum_fifo_w.wr_data[2 +: 16] <= ip_csum;
 
 			// Set the layer 4 checksum type.
 			// 00: None
 			// 01: TCP
 			// 10: UDP
 			tx_csum_fifo_w.wr_data[2+16 +: 2] <= ip_proto;
-			tx_csum_fifo_w.wr_data[2+16+2 +: 16] <= ~(folded_l4_sum[15:0] + 16'(folded_l4_sum[16]));
+			tx_csum_fifo_w.wr_data[2+16+2 +: 16] <= l4_csum;
+
+			// Sum over the frame as it is sent
+			tx_csum_fifo_w.wr_data[2+16+2+16 +: 16] <= fold(frame_sum +
+				32'(eth_type == 2'b01 ? ip_csum : 16'h0000) +
+				32'(ip_proto != 2'b00 ? l4_csum : 16'h0000));
+		end
+
+		// This cannot coincide with commit_checksum because
+		// it is set for the start of frame.
+		if (commit_none) begin
+			commit_none <= 1'b0;
+			tx_csum_fifo_w.wr_en <= 1'b1;
+			tx_csum_fifo_w.wr_data <= '0;
 		end
 
 		if (p_valid) begin
-			if (p_eof) begin
+			frame_sum <= (p_sof ? '0 : frame_sum) + 32'(lev2_add_ff[0]) - 32'(p_csum_lane);
+			if (p_word != 3'd4) begin
+				frame_word <= p_word + 1;
+			end
+
+			if (p_sof) begin
+				commit_none <= p_no_csum;
+				csum_committed <= p_no_csum;
+			end
+
+			if (p_eof && !(p_sof ? p_no_csum : csum_committed)) begin
 				// Commit checksum.
 				commit_checksum <= 1'b1;
 			end
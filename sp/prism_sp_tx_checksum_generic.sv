@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2023-2024 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Width-generic variant of prism_sp_tx_checksum.
+ *
+ * prism_sp_tx_checksum is hand-tuned for 128-bit words. This unit
+ * computes the same checksums for any data width of at least 32 bits
+ * by classifying every 16-bit lane of a word by its byte offset in the
+ * frame. Like prism_sp_tx_checksum, it expects an untagged Ethernet II
+ * frame with an IPv4 header of 20 bytes.
+ *
+ * The fields of the pseudo header that are not part of the frame
+ * (protocol and L4 length) are added when the checksum is committed.
+ */
+module prism_sp_tx_checksum_generic #(
+	parameter int DATA_WIDTH
+)
+(
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic i_valid,
+	input wire logic [DATA_WIDTH-1:0] i_data,
+	input wire logic i_sof,
+	input wire logic i_eof,
+
+	fifo_write_interface.master tx_csum_fifo_w,
+
+	output trace_checksum_t trace_csum
+);
+
+localparam int NBYTES = DATA_WIDTH / 8;
+localparam int NLANES = NBYTES / 2;
+localparam int PACKET_ETH_TYPE_OFF = 12;
+localparam int PACKET_IPV4_HDR_OFF = 14;
+localparam int PACKET_IPV4_LEN_OFF = 16;
+localparam int PACKET_IPV4_PROTO_OFF = 23;
+localparam int PACKET_IPV4_CSUM_OFF = 24;
+localparam int PACKET_IPV4_SADDR_OFF = 26;
+localparam int PACKET_L4_OFF = 34;
+localparam int PACKET_UDP_CSUM_OFF = PACKET_L4_OFF + 6;
+localparam int PACKET_TCP_CSUM_OFF = PACKET_L4_OFF + 16;
+localparam logic [15:0] ETH_TYPE_IPV4 = 16'h0800;
+localparam logic [7:0] IP_PROTO_TCP = 8'h06;
+localparam logic [7:0] IP_PROTO_UDP = 8'h11;
+
+// Words beyond the TCP checksum contain nothing but L4 data.
+localparam int HDR_WORDS = (PACKET_TCP_CSUM_OFF + 2 + NBYTES - 1) / NBYTES;
+localparam int WORD_WIDTH = $clog2(HDR_WORDS + 1);
+localparam int ETH_TYPE_WORD = PACKET_ETH_TYPE_OFF / NBYTES;
+localparam int IPV4_HDR_WORD = PACKET_IPV4_HDR_OFF / NBYTES;
+localparam int IPV4_LEN_WORD = PACKET_IPV4_LEN_OFF / NBYTES;
+localparam int IPV4_PROTO_WORD = PACKET_IPV4_PROTO_OFF / NBYTES;
+localparam int LANE_SUM_WIDTH = 16 + $clog2(NLANES) + 1;
+
+if (DATA_WIDTH < 32) begin
+	$error("prism_sp_tx_checksum_generic needs a data width of at least 32 bits.");
+end
+
+function logic [15:0] reverse(input logic [15:0] data);
+	return { data[7:0], data[15:8] };
+endfunction
+
+// Extract the big-endian 16-bit field at frame offset off from a word.
+function logic [15:0] field16(input logic [DATA_WIDTH-1:0] data, input int off);
+	return reverse(data[(off % NBYTES)*8 +: 16]);
+endfunction
+
+/*
+ * -------------------------------------------------------------------
+ * Stage 0: Classify the lanes of the input word.
+ */
+var logic [WORD_WIDTH-1:0] word_cnt;
+wire logic [WORD_WIDTH-1:0] word = i_sof ? '0 : word_cnt;
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		word_cnt <= '0;
+	end
+	else if (i_valid) begin
+		if (word != HDR_WORDS) begin
+			word_cnt <= word + 1;
+		end
+		else begin
+			word_cnt <= word;
+		end
+	end
+end
+
+// The protocol is needed to skip the L4 checksum field.
+var logic [7:0] s0_proto;
+wire logic [7:0] proto = word == IPV4_PROTO_WORD ?
+	i_data[(PACKET_IPV4_PROTO_OFF % NBYTES)*8 +: 8] : s0_proto;
+
+always_ff @(posedge clock) begin
+	if (i_valid && word == IPV4_PROTO_WORD) begin
+		s0_proto <= proto;
+	end
+end
+
+var logic s1_valid;
+var logic s1_sof;
+var logic s1_eof;
+var logic [WORD_WIDTH-1:0] s1_word;
+var logic [15:0] s1_ip_lanes [NLANES];
+var logic [15:0] s1_l4_lanes [NLANES];
+// All lanes but the checksum fields
+var logic [15:0] s1_frame_lanes [NLANES];
+var logic [15:0] s1_eth_type;
+var logic [15:0] s1_ipv4_hdr;
+var logic [15:0] s1_ipv4_len;
+var logic [7:0] s1_proto;
+
+always_ff @(posedge clock) begin
+	s1_valid <= i_valid;
+	s1_sof <= i_sof;
+	s1_eof <= i_eof;
+	s1_word <= word;
+	s1_eth_type <= field16(i_data, PACKET_ETH_TYPE_OFF);
+	s1_ipv4_hdr <= field16(i_data, PACKET_IPV4_HDR_OFF);
+	s1_ipv4_len <= field16(i_data, PACKET_IPV4_LEN_OFF);
+	s1_proto <= proto;
+
+	for (int l = 0; l < NLANES; l++) begin
+		automatic int pos = int'(word) * NBYTES + l * 2;
+		automatic logic [15:0] lane = reverse(i_data[l*16 +: 16]);
+
+		s1_ip_lanes[l] <= '0;
+		s1_l4_lanes[l] <= '0;
+		s1_frame_lanes[l] <= lane;
+
+		if (pos >= PACKET_IPV4_HDR_OFF && pos < PACKET_L4_OFF && pos != PACKET_IPV4_CSUM_OFF) begin
+			s1_ip_lanes[l] <= lane;
+		end
+		if (pos >= PACKET_IPV4_SADDR_OFF &&
+			!(proto == IP_PROTO_UDP && pos == PACKET_UDP_CSUM_OFF) &&
+			!(proto == IP_PROTO_TCP && pos == PACKET_TCP_CSUM_OFF))
+		begin
+			s1_l4_lanes[l] <= lane;
+		end
+		if (pos == PACKET_IPV4_CSUM_OFF ||
+			(proto == IP_PROTO_UDP && pos == PACKET_UDP_CSUM_OFF) ||
+			(proto == IP_PROTO_TCP && pos == PACKET_TCP_CSUM_OFF))
+		begin
+			s1_frame_lanes[l] <= '0;
+		end
+	end
+end
+
+/*
+ * -------------------------------------------------------------------
+ * Stage 1: Add up the lanes.
+ */
+var logic s2_valid;
+var logic s2_sof;
+var logic s2_eof;
+var logic [WORD_WIDTH-1:0] s2_word;
+var logic [LANE_SUM_WIDTH-1:0] s2_ip_sum;
+var logic [LANE_SUM_WIDTH-1:0] s2_l4_sum;
+var logic [LANE_SUM_WIDTH-1:0] s2_frame_sum;
+var logic [15:0] s2_eth_type;
+var logic [15:0] s2_ipv4_hdr;
+var logic [15:0] s2_ipv4_len;
+var logic [7:0] s2_proto;
+
+always_ff @(posedge clock) begin
+	automatic logic [LANE_SUM_WIDTH-1:0] ip_lane_sum = '0;
+	automatic logic [LANE_SUM_WIDTH-1:0] l4_lane_sum = '0;
+	automatic logic [LANE_SUM_WIDTH-1:0] frame_lane_sum = '0;
+
+	for (int l = 0; l < NLANES; l++) begin
+		ip_lane_sum += LANE_SUM_WIDTH'(s1_ip_lanes[l]);
+		l4_lane_sum += LANE_SUM_WIDTH'(s1_l4_lanes[l]);
+		frame_lane_sum += LANE_SUM_WIDTH'(s1_frame_lanes[l]);
+	end
+
+	s2_valid <= s1_valid;
+	s2_sof <= s1_sof;
+	s2_eof <= s1_eof;
+	s2_word <= s1_word;
+	s2_ip_sum <= ip_lane_sum;
+	s2_l4_sum <= l4_lane_sum;
+	s2_frame_sum <= frame_lane_sum;
+	s2_eth_type <= s1_eth_type;
+	s2_ipv4_hdr <= s1_ipv4_hdr;
+	s2_ipv4_len <= s1_ipv4_len;
+	s2_proto <= s1_proto;
+end
+
+/*
+ * -------------------------------------------------------------------
+ * Stage 2: Accumulate and commit.
+ */
+var logic [SP_CSUM_IP_SUM_WIDTH-1:0] ip_sum;
+var logic [SP_CSUM_L4_SUM_WIDTH-1:0] l4_sum;
+var logic [1:0] eth_type;
+var logic [1:0] ip_proto;
+var logic [3:0] ihl;
+var logic [15:0] ipv4_len;
+var logic [7:0] proto_byte;
+var logic commit_checksum;
+var logic commit_none;
+var logic csum_committed;
+// Sum over the whole frame without the checksum fields
+var logic [31:0] frame_sum;
+
+/*
+ * Frames other than IPv4 need no checksum insertion.
+ * We commit an empty checksum entry as soon as the Ethernet type is known
+ * so that the GEM TX interface does not have to wait for the end of the
+ * frame (cut-through).
+ */
+wire logic p_no_csum = s2_word == ETH_TYPE_WORD && s2_eth_type != ETH_TYPE_IPV4;
+wire logic p_committed = s2_sof ? 1'b0 : csum_committed;
+
+// Add the protocol and the L4 length of the pseudo header.
+wire logic [SP_CSUM_L4_SUM_WIDTH-1:0] l4_total_sum = l4_sum +
+	SP_CSUM_L4_SUM_WIDTH'(proto_byte) + SP_CSUM_L4_SUM_WIDTH'(ipv4_len - { ihl, 2'b00 });
+// 17 bits because these might have one carry bit still.
+wire logic [16:0] folded_ip_sum = ip_sum[15:0] + 16'(ip_sum[$bits(ip_sum)-1:16]);
+wire logic [16:0] folded_l4_sum = l4_total_sum[15:0] + 16'(l4_total_sum[$bits(l4_total_sum)-1:16]);
+wire logic [15:0] ip_csum = ~(folded_ip_sum[15:0] + 16'(folded_ip_sum[16]));
+wire logic [15:0] l4_csum = ~(folded_l4_sum[15:0] + 16'(folded_l4_sum[16]));
+
+function automatic logic [15:0] fold(input logic [31:0] s);
+	logic [16:0] t;
+
+	t = s[15:0] + 16'(s[31:16]);
+	t = t[15:0] + 16'(t[16]);
+	return t[15:0];
+endfunction
+
+always_ff @(posedge clock) begin
+	tx_csum_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		commit_checksum <= 1'b0;
+		commit_none <= 1'b0;
+		csum_committed <= 1'b0;
+	end
+	else begin
+		// This will be executed in the same clock cycle as
+		// the next start of frame when data is presented
+		// with 0 cycle delay.
+		if (commit_checksum) begin
+			commit_checksum <= 1'b0;
+			tx_csum_fifo_w.wr_en <= 1'b1;
+
+			// Set the layer 3 checksum type.
+			// 00: None
+			// 01: IPv4
+			tx_csum_fifo_w.wr_data[0 +: 2] <= eth_type;
+			tx_csum_fifo_w.wr_data[2 +: 16] <= ip_csum;
+
+			// Set the layer 4 checksum type.
+			// 00: None
+			// 01: TCP
+			// 10: UDP
+			tx_csum_fifo_w.wr_data[2+16 +: 2] <= ip_proto;
+			tx_csum_fifo_w.wr_data[2+16+2 +: 16] <= l4_csum;
+
+			// Sum over the frame as it is sent
+			tx_csum_fifo_w.wr_data[2+16+2+16 +: 16] <= fold(frame_sum +
+				32'(eth_type == 2'b01 ? ip_csum : 16'h0000) +
+				32'(ip_proto != 2'b00 ? l4_csum : 16'h0000));
+		end
+
+		if (commit_none) begin
+			commit_none <= 1'b0;
+			tx_csum_fifo_w.wr_en <= 1'b1;
+			tx_csum_fifo_w.wr_data <= '0;
+		end
+
+		if (s2_valid) begin
+			frame_sum <= (s2_sof ? '0 : frame_sum) + 32'(s2_frame_sum);
+
+			if (s2_sof) begin
+				ip_sum <= SP_CSUM_IP_SUM_WIDTH'(s2_ip_sum);
+				l4_sum <= SP_CSUM_L4_SUM_WIDTH'(s2_l4_sum);
+				eth_type <= 2'b00;
+				ip_proto <= 2'b00;
+			end
+			else begin
+				ip_sum <= ip_sum + SP_CSUM_IP_SUM_WIDTH'(s2_ip_sum);
+				l4_sum <= l4_sum + SP_CSUM_L4_SUM_WIDTH'(s2_l4_sum);
+			end
+
+			if (s2_word == ETH_TYPE_WORD) begin
+				eth_type <= s2_eth_type == ETH_TYPE_IPV4 ? 2'b01 : 2'b00;
+			end
+			if (s2_word == IPV4_HDR_WORD) begin
+				ihl <= s2_ipv4_hdr[8 +: 4];
+			end
+			if (s2_word == IPV4_LEN_WORD) begin
+				ipv4_len <= s2_ipv4_len;
+			end
+			if (s2_word == IPV4_PROTO_WORD) begin
+				proto_byte <= s2_proto;
+				case (s2_proto)
+				IP_PROTO_TCP: ip_proto <= 2'b01;
+				IP_PROTO_UDP: ip_proto <= 2'b10;
+				default: ip_proto <= 2'b00;
+				endcase
+			end
+
+			csum_committed <= p_committed;
+			if (!p_committed) begin
+				if (p_no_csum) begin
+					commit_none <= 1'b1;
+					csum_committed <= 1'b1;
+				end
+				else if (s2_eof) begin
+					// Frames that end before their Ethernet type
+					// do not get a checksum either.
+					if (s2_word < ETH_TYPE_WORD) begin
+						commit_none <= 1'b1;
+					end
+					else begin
+						commit_checksum <= 1'b1;
+					end
+				end
+			end
+		end
+	end
+end
+
+endmodule
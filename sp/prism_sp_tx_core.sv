@@ -77,6 +77,27 @@ module prism_sp_tx_core #(
 	fifo_read_interface.slave				tx_meta_fifo_r,
 	fifo_read_interface.slave				tx_data_fifo_r,
 	fifo_read_interface.slave				tx_csum_fifo_r,
+	fifo_read_interface.slave				tx_digest_fifo_r,
+	// Driven from the GEM send module (in the GEM TX clock domain)
+	input wire logic [31:0]					gem_tx_underflows,
+	// Traffic checker (results in the GEM TX clock domain)
+	output wire logic [31:0]				tchk_control,
+	input traffic_check_t					gem_tchk_results,
+	// ESP SA table (see prism_sp_esp_gcm)
+	output wire logic [127:0]				esp_sa_key,
+	output wire logic [31:0]				esp_sa_salt,
+	output wire logic [31:0]				esp_sa_spi,
+	output wire logic [31:0]				esp_sa_control,
+	// Tunnel offload (see REGOFF_TUNNEL_CONTROL)
+	output wire logic [31:0]				tunnel_control,
+	output wire logic [31:0]				tunnel_tmpl,
+	output wire logic [31:0]				tunnel_tmpl_addr,
+	// Packet capture (see prism_sp_capture)
+	output wire logic [31:0]				capture_control,
+	output wire logic [31:0]				capture_mask,
+	output wire logic [31:0]				capture_match,
+	fifo_write_interface.slave				capture_fifo_w,
+	input wire logic [31:0]					gem_capture_drops,
 
 	output wire logic channel_irq,
 
@@ -99,14 +120,72 @@ local_memory_interface data_bram_mmr();
 wire logic cpu_reset;
 wire logic [3:0] io_axi_axcache;
 wire logic [3:0] dma_axi_axcache;
-wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] dma_desc_base [NTXQUEUES];
+wire logic [NTXQUEUES-1:0] tx_queue_enable;
+wire logic [31:0] queue_weights;
+wire logic queue_wrr;
+wire logic [TX_META_DESC_SIZE_WIDTH-1:0] tx_ct_size;
+wire logic [31:0] tx_underflows;
+wire traffic_check_t tchk_results;
+wire logic [31:0] tx_queue_rate [NTXQUEUES];
+wire logic [31:0] tx_queue_burst [NTXQUEUES];
+wire logic [31:0] tx_port_rate;
+wire logic [31:0] tx_port_burst;
+wire logic [31:0] tx_time;
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_start;
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_end;
+wire logic puzzle_hw_dma_idle;
+wire logic capture_enable;
+wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0] capture_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] capture_base;
+wire logic [31:0] capture_tail;
+wire logic [31:0] capture_head;
+wire logic [31:0] capture_drops;
+wire logic [31:0] axattr_desc_rd;
+wire logic [31:0] axattr_desc_wr;
+wire logic [31:0] axattr_hdr;
+wire logic [31:0] axattr_data;
+wire logic [31:0] axattr_capture;
+wire logic bypass_enable;
+wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_word;
+wire logic [31:0] bypass_mask;
+wire logic [31:0] bypass_match;
+wire logic bypass_key_enable;
+wire logic [BYPASS_CONTROL_WORD_WIDTH-1:0] bypass_key_word;
+wire logic [4:0] bypass_key_shift;
+wire logic cq_enable;
+wire logic poll_enable;
+wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_min_shift;
+wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0] poll_max_shift;
+wire logic [CQ_CONTROL_SIZE_WIDTH-1:0] cq_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] cq_base;
+wire logic [VIRTQ_RING_SIZE_WIDTH-1:0] ring_size;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] virtq_event_addr;
+wire logic trace_arm;
+wire logic trace_force;
+wire logic [TRACE_CONTROL_WINDOW_WIDTH-1:0] trace_window;
+wire logic [TRACE_CONTROL_POST_WIDTH-1:0] trace_post;
+wire logic [31:0] trace_trig_mask;
+wire logic [31:0] trace_trig_match;
+wire logic [31:0] trace_addr;
+wire logic [31:0] trace_status;
+wire logic [31:0] trace_data;
+wire logic [COUNTER_W-1:0] sp_perf_counters [SP_NPERF_EVENTS];
+wire logic load_start;
+wire logic [SYSTEM_ADDR_WIDTH-1:0] load_src;
+wire logic [31:0] load_dst;
+wire logic [31:0] load_size;
+wire logic [31:0] load_crc;
+wire logic [31:0] load_status;
 
 mmr_readwrite_interface #(.NREGS(MMR_RW_NREGS)) mmr_rw();
 mmr_read_interface #(.NREGS(MMR_R_NREGS)) mmr_r();
 
-mmr_trigger_interface #(.N(1),.WIDTH(2)) hw_mmr_t();
-mmr_trigger_interface #(.N(1),.WIDTH(2)) sw_mmr_t();
-mmr_trigger_interface #(.N(1),.WIDTH(2)) mmr_t();
+// One doorbell bit per ring
+localparam int MMR_T_WIDTH = NTXQUEUES > 2 ? NTXQUEUES : 2;
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) hw_mmr_t();
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) sw_mmr_t();
+mmr_trigger_interface #(.N(1),.WIDTH(MMR_T_WIDTH)) mmr_t();
 if (ENABLE_TX_SW_MMR_T) begin
 	mmr_trigger_interface_connect mmr_trigger_interface_connect_0(.m(mmr_t),.s(sw_mmr_t));
 end
@@ -135,7 +214,8 @@ axi_lite_mmr #(
 	.DBRAM_SIZE(DBRAM_SIZE),
 	.DATA_FIFO_SIZE(TX_DATA_FIFO_SIZE),
 	.DATA_FIFO_WIDTH(TX_DATA_FIFO_WIDTH),
-	.INSTANCE(INSTANCE)
+	.INSTANCE(INSTANCE),
+	.NQUEUES(NTXQUEUES)
 )
 axi_lite_mmr_inst(
 	.clock(clock),
@@ -155,19 +235,137 @@ axi_lite_mmr_inst(
 	.cpu_reset(cpu_reset),
 	.enable(tx_enable),
 	.dma_desc_base,
+	.queue_enable(tx_queue_enable),
+	.queue_weights,
+	.queue_wrr,
+	.rx_prio_map(),
 	.io_axi_axcache,
 	.dma_axi_axcache,
 
+	.tx_ct_size,
+	.tx_underflows,
+	.tx_queue_rate,
+	.tx_queue_burst,
+	.tx_port_rate,
+	.tx_port_burst,
+	.tx_time,
+
+	.bypass_enable,
+	.bypass_word,
+	.bypass_mask,
+	.bypass_match,
+	.bypass_key_enable,
+	.bypass_key_word,
+	.bypass_key_shift,
+
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.cq_size,
+	.cq_base,
+	.ring_size,
+	.virtq_event_addr,
+
+	.rx_stride_enable(),
+	.rx_stride_shift(),
+	.rx_buf_shift(),
+	.rx_buf_reserve(),
+
+	.tgen_control(),
+	.tgen_size(),
+	.tgen_count(),
+	.rx_digest_range(),
+	.flow_enable(),
+	.flow_export_enable(),
+	.flow_size(),
+	.flow_base(),
+	.flow_timeout(),
+	.flow_drops('0),
+	.admit_control(),
+	.admit_thresh(),
+	.admit_drops('0),
+	.pause_control(),
+	.pause_sa(),
+	.axattr_desc_rd,
+	.axattr_desc_wr,
+	.axattr_hdr,
+	.axattr_data,
+	.axattr_flow(),
+	.axattr_capture,
+	.spill_enable(),
+	.spill_size(),
+	.spill_base(),
+	.spill_level('0),
+	.spill_bursts('0),
+	.axattr_spill(),
+	.esp_sa_key,
+	.esp_sa_salt,
+	.esp_sa_spi,
+	.esp_sa_control,
+	.tunnel_control,
+	.tunnel_tmpl,
+	.tunnel_tmpl_addr,
+	.capture_control,
+	.capture_mask,
+	.capture_match,
+	.capture_enable,
+	.capture_size,
+	.capture_base,
+	.capture_tail,
+	.capture_head,
+	.capture_drops,
+	.tgen_sent('0),
+	.tchk_control,
+	.tchk_results,
+
+	.trace_arm,
+	.trace_force,
+	.trace_window,
+	.trace_post,
+	.trace_trig_mask,
+	.trace_trig_match,
+	.trace_addr,
+	.trace_status,
+	.trace_data,
+
+	.perf_counters(sp_perf_counters),
+
+	.load_start,
+	.load_src,
+	.load_dst,
+	.load_size,
+	.load_crc,
+	.load_status,
+
 	.instruction_bram_mmr,
 	.data_bram_mmr
 );
 
-// This is currently redundant.
-// But we might need it later in a transitional phase when both constants
-// are made independent of each other.
+/*
+ * AXI attributes of the descriptor streams
+ */
+wire axi_attr_t desc_rd_attr = axattr_desc_rd[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_desc_rd[$bits(axi_attr_t)-1:0]) : AXI_ATTR_DESC_RD;
+wire axi_attr_t desc_wr_attr = axattr_desc_wr[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_desc_wr[$bits(axi_attr_t)-1:0]) : AXI_ATTR_DESC_WR;
+
+/*
+ * AXI attributes of the captured frames
+ */
+wire axi_attr_t capture_attr = axattr_capture[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_capture[$bits(axi_attr_t)-1:0]) : AXI_ATTR_CAPTURE;
+
+// A DMA data bus narrower than the TX data FIFO is widened by
+// fifo_write_interface_upsize below.
 if (TX_DATA_FIFO_WIDTH != 0) begin
-	if (m_axi_dma_r.AXI_RDATA_WIDTH != TX_DATA_FIFO_WIDTH) begin
-		$error("We don't support m_axi_dma_r.AXI_RDATA_WIDTH != TX_DATA_FIFO_WIDTH)");
+	if (m_axi_dma_r.AXI_RDATA_WIDTH > TX_DATA_FIFO_WIDTH ||
+		TX_DATA_FIFO_WIDTH % m_axi_dma_r.AXI_RDATA_WIDTH != 0)
+	begin
+		$error("We don't support m_axi_dma_r.AXI_RDATA_WIDTH not dividing TX_DATA_FIFO_WIDTH)");
+	end
+	if (m_axi_dma_r.AXI_RDATA_WIDTH < 32) begin
+		$error("We don't support a DMA data width of less than 32.");
 	end
 	if (TX_DATA_FIFO_WIDTH < 32) begin
 		$error("We don't support a TX DATA FIFO width of less than 32.");
@@ -175,106 +373,31 @@ if (TX_DATA_FIFO_WIDTH != 0) begin
 end
 
 fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_hw_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_hw_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_hw_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_hw_fifo_r_3();
-
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_hw_fifo_w_0();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_hw_fifo_w_1();
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_hw_fifo_r [NTXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_hw_fifo_w_2();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_hw_fifo_w_3();
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_hw_fifo_w [NTXPUZZLEFIFOS] ();
 
 fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_sw_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_sw_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_sw_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_sw_fifo_r_3();
-
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_sw_fifo_w_0();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_sw_fifo_w_1();
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_sw_fifo_r [NTXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_sw_fifo_w_2();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_sw_fifo_w_3();
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_sw_fifo_w [NTXPUZZLEFIFOS] ();
 
 fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[0])
-) puzzle_fifo_r_0();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[1])
-) puzzle_fifo_r_1();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[2])
-) puzzle_fifo_r_2();
-fifo_read_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH[3])
-) puzzle_fifo_r_3();
-
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_fifo_r [NTXPUZZLEFIFOS] ();
 fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[0]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[0])
-) puzzle_fifo_w_0();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[1]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[1])
-) puzzle_fifo_w_1();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[2]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[2])
-) puzzle_fifo_w_2();
-fifo_write_interface #(
-	.DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH[3]),
-	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH[3])
-) puzzle_fifo_w_3();
+	.DATA_WIDTH(TX_PUZZLE_FIFO_DATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_DATA_COUNT_WIDTH)
+) puzzle_fifo_w [NTXPUZZLEFIFOS] ();
 
 /*
  * Interface used by the HW TX unit to start reading data from RAM
@@ -380,58 +503,78 @@ prism_sp_puzzle_fifo_mixer #(
 	.clock,
 	.resetn,
 
-	.puzzle_hw_fifo_r_0,
-	.puzzle_hw_fifo_w_0,
-	.puzzle_hw_fifo_r_1,
-	.puzzle_hw_fifo_w_1,
-	.puzzle_hw_fifo_r_2,
-	.puzzle_hw_fifo_w_2,
-	.puzzle_hw_fifo_r_3,
-	.puzzle_hw_fifo_w_3,
-
-	.puzzle_sw_fifo_r_0,
-	.puzzle_sw_fifo_w_0,
-	.puzzle_sw_fifo_r_1,
-	.puzzle_sw_fifo_w_1,
-	.puzzle_sw_fifo_r_2,
-	.puzzle_sw_fifo_w_2,
-	.puzzle_sw_fifo_r_3,
-	.puzzle_sw_fifo_w_3,
-
-	.puzzle_fifo_r_0,
-	.puzzle_fifo_w_0,
-	.puzzle_fifo_r_1,
-	.puzzle_fifo_w_1,
-	.puzzle_fifo_r_2,
-	.puzzle_fifo_w_2,
-	.puzzle_fifo_r_3,
-	.puzzle_fifo_w_3
+	.bypass_enable,
+	.bypass_word,
+	.bypass_mask,
+	.bypass_match,
+	.bypass_key_enable,
+	.bypass_key_word,
+	.bypass_key_shift,
+
+	.puzzle_hw_fifo_r,
+	.puzzle_hw_fifo_w,
+
+	.puzzle_sw_fifo_r,
+	.puzzle_sw_fifo_w,
+
+	.puzzle_fifo_r,
+	.puzzle_fifo_w
 );
 
+/*
+ * Interface used by the capture writer to read slots.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.DATA_COUNT_WIDTH(CAPTURE_FIFO_DATA_COUNT_WIDTH)
+) capture_fifo_r();
+
 prism_sp_tx_puzzle_hw
 prism_sp_tx_puzzle_hw_0 (
 	.clock,
 	.resetn,
 
-	.tx_enable,
+	.tx_queue_enable,
+	.tx_queue_wrr(queue_wrr),
+	.tx_queue_weights(queue_weights),
 	.dma_desc_base,
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.cq_size,
+	.cq_base,
+	.ring_size,
+	.virtq_event_addr,
+	.tx_ct_size,
+	.tx_queue_rate,
+	.tx_queue_burst,
+	.tx_port_rate,
+	.tx_port_burst,
+	.tx_time,
+	.digest_start,
+	.digest_end,
+	.dma_idle(puzzle_hw_dma_idle),
+	.capture_enable,
+	.capture_size,
+	.capture_base,
+	.capture_tail,
+	.capture_head,
+	.desc_rd_attr,
+	.desc_wr_attr,
+	.capture_attr,
 
 	.mmr_i(hw_mmr_i),
 	.mmr_t(hw_mmr_t),
 
-	.fifo_r_0(puzzle_hw_fifo_r_0),
-	.fifo_w_0(puzzle_hw_fifo_w_0),
-	.fifo_r_1(puzzle_hw_fifo_r_1),
-	.fifo_w_1(puzzle_hw_fifo_w_1),
-	.fifo_r_2(puzzle_hw_fifo_r_2),
-	.fifo_w_2(puzzle_hw_fifo_w_2),
-	.fifo_r_3(puzzle_hw_fifo_r_3),
-	.fifo_w_3(puzzle_hw_fifo_w_3),
+	.fifo_r(puzzle_hw_fifo_r),
+	.fifo_w(puzzle_hw_fifo_w),
 
 	// Interfaces used by the TX unit
 	.tx_data_fifo_w(hw_tx_data_fifo_w),
 	.tx_data_mem_r(hw_tx_data_mem_r),
 	.tx_meta_fifo_w(hw_tx_meta_fifo_w),
+	.capture_fifo_r,
 
 	.axi_ma_aw(m_axi_ma_aw),
 	.axi_ma_w(m_axi_ma_w),
@@ -460,63 +603,38 @@ prism_sp_tx_puzzle_hw_0 (
 
 prism_sp_puzzle_fifos #(
 	.NFIFOS(NTXPUZZLEFIFOS),
-	.FIFO_WRITE_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH)
+	.FIFO_WRITE_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH),
+	.FIFO_R_DATA_WIDTH(TX_PUZZLE_FIFO_R_DATA_WIDTH),
+	.FIFO_W_DATA_WIDTH(TX_PUZZLE_FIFO_W_DATA_WIDTH),
+	.FIFO_R_DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_R_DATA_COUNT_WIDTH),
+	.FIFO_W_DATA_COUNT_WIDTH(TX_PUZZLE_FIFO_W_DATA_COUNT_WIDTH)
 ) prism_sp_puzzle_fifos_0 (
 	.clock,
 	.resetn,
 
-	.fifo_r_0(puzzle_fifo_r_0),
-	.fifo_w_0(puzzle_fifo_w_0),
-	.fifo_r_1(puzzle_fifo_r_1),
-	.fifo_w_1(puzzle_fifo_w_1),
-	.fifo_r_2(puzzle_fifo_r_2),
-	.fifo_w_2(puzzle_fifo_w_2),
-	.fifo_r_3(puzzle_fifo_r_3),
-	.fifo_w_3(puzzle_fifo_w_3)
+	.fifo_r(puzzle_fifo_r),
+	.fifo_w(puzzle_fifo_w)
 );
 
 assign trace_tx_puzzle.tx_enable = tx_enable;
 assign trace_tx_puzzle.tx_trigger = mmr_t.tsr[0][0];
 
-assign trace_tx_puzzle.puzzle_fifo_r_0_empty = puzzle_fifo_r_0.empty;
-assign trace_tx_puzzle.puzzle_fifo_r_0_rd_en = puzzle_fifo_r_0.rd_en;
-assign trace_tx_puzzle.puzzle_fifo_r_0_rd_data = puzzle_fifo_r_0.rd_data;
-assign trace_tx_puzzle.puzzle_fifo_r_0_rd_data_count = puzzle_fifo_r_0.rd_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_r_1_empty = puzzle_fifo_r_1.empty;
-assign trace_tx_puzzle.puzzle_fifo_r_1_rd_en = puzzle_fifo_r_1.rd_en;
-assign trace_tx_puzzle.puzzle_fifo_r_1_rd_data = puzzle_fifo_r_1.rd_data;
-assign trace_tx_puzzle.puzzle_fifo_r_1_rd_data_count = puzzle_fifo_r_1.rd_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_r_2_empty = puzzle_fifo_r_2.empty;
-assign trace_tx_puzzle.puzzle_fifo_r_2_rd_en = puzzle_fifo_r_2.rd_en;
-assign trace_tx_puzzle.puzzle_fifo_r_2_rd_data = puzzle_fifo_r_2.rd_data;
-assign trace_tx_puzzle.puzzle_fifo_r_2_rd_data_count = puzzle_fifo_r_2.rd_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_r_3_empty = puzzle_fifo_r_3.empty;
-assign trace_tx_puzzle.puzzle_fifo_r_3_rd_en = puzzle_fifo_r_3.rd_en;
-assign trace_tx_puzzle.puzzle_fifo_r_3_rd_data = puzzle_fifo_r_3.rd_data;
-assign trace_tx_puzzle.puzzle_fifo_r_3_rd_data_count = puzzle_fifo_r_3.rd_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_w_0_full = puzzle_fifo_w_0.full;
-assign trace_tx_puzzle.puzzle_fifo_w_0_wr_en = puzzle_fifo_w_0.wr_en;
-assign trace_tx_puzzle.puzzle_fifo_w_0_wr_data = puzzle_fifo_w_0.wr_data;
-assign trace_tx_puzzle.puzzle_fifo_w_0_wr_data_count = puzzle_fifo_w_0.wr_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_w_1_full = puzzle_fifo_w_1.full;
-assign trace_tx_puzzle.puzzle_fifo_w_1_wr_en = puzzle_fifo_w_1.wr_en;
-assign trace_tx_puzzle.puzzle_fifo_w_1_wr_data = puzzle_fifo_w_1.wr_data;
-assign trace_tx_puzzle.puzzle_fifo_w_1_wr_data_count = puzzle_fifo_w_1.wr_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_w_2_full = puzzle_fifo_w_2.full;
-assign trace_tx_puzzle.puzzle_fifo_w_2_wr_en = puzzle_fifo_w_2.wr_en;
-assign trace_tx_puzzle.puzzle_fifo_w_2_wr_data = puzzle_fifo_w_2.wr_data;
-assign trace_tx_puzzle.puzzle_fifo_w_2_wr_data_count = puzzle_fifo_w_2.wr_data_count;
-
-assign trace_tx_puzzle.puzzle_fifo_w_3_full = puzzle_fifo_w_3.full;
-assign trace_tx_puzzle.puzzle_fifo_w_3_wr_en = puzzle_fifo_w_3.wr_en;
-assign trace_tx_puzzle.puzzle_fifo_w_3_wr_data = puzzle_fifo_w_3.wr_data;
-assign trace_tx_puzzle.puzzle_fifo_w_3_wr_data_count = puzzle_fifo_w_3.wr_data_count;
+for (genvar i = 0; i < NTXPUZZLEFIFOS; i++) begin
+	assign trace_tx_puzzle.puzzle_fifo_r_empty[i] = puzzle_fifo_r[i].empty;
+	assign trace_tx_puzzle.puzzle_fifo_r_rd_en[i] = puzzle_fifo_r[i].rd_en;
+	assign trace_tx_puzzle.puzzle_fifo_r_rd_data[i] = puzzle_fifo_r[i].rd_data;
+	assign trace_tx_puzzle.puzzle_fifo_r_rd_data_count[i] = puzzle_fifo_r[i].rd_data_count;
+
+	assign trace_tx_puzzle.puzzle_fifo_w_full[i] = puzzle_fifo_w[i].full;
+	assign trace_tx_puzzle.puzzle_fifo_w_wr_en[i] = puzzle_fifo_w[i].wr_en;
+	assign trace_tx_puzzle.puzzle_fifo_w_wr_data[i] = puzzle_fifo_w[i].wr_data;
+	assign trace_tx_puzzle.puzzle_fifo_w_wr_data_count[i] = puzzle_fifo_w[i].wr_data_count;
+end
+
+/*
+ * Header window of the TX data stream (see prism_sp_unit_hdr).
+ */
+header_window_interface hdr_w();
 
 if (ENABLE_TX_RISCV_PROCESSOR) begin
 	memory_write_interface #(
@@ -528,31 +646,64 @@ if (ENABLE_TX_RISCV_PROCESSOR) begin
 		.DATA_COUNT_WIDTH(0)
 	) dummy_rx_meta_fifo_r();
 
-	prism_sp_processor #(
+	/*
+	 * The BRAM loader sits between the MMRs, the IO bus and the processors.
+	 */
+	local_memory_interface instruction_bram_proc();
+	local_memory_interface data_bram_proc();
+	axi_interface #(
+		.C_M_AXI_ADDR_WIDTH(m_axi_mx.C_M_AXI_ADDR_WIDTH),
+		.C_M_AXI_DATA_WIDTH(m_axi_mx.C_M_AXI_DATA_WIDTH)
+	) proc_m_axi_io();
+
+	prism_sp_bram_loader #(
+		.IBRAM_SIZE(IBRAM_SIZE),
+		.DBRAM_SIZE(DBRAM_SIZE)
+	) prism_sp_bram_loader_0(
+		.clock,
+		.resetn,
+
+		.start(USE_BRAM_LOADER ? load_start : 1'b0),
+		.src(load_src),
+		.dst(load_dst),
+		.size(load_size),
+		.expected_crc(load_crc),
+		.axcache(io_axi_axcache),
+		.status(load_status),
+
+		.s_axi_io(proc_m_axi_io),
+		.m_axi_io(m_axi_mx),
+
+		.s_ibram(instruction_bram_mmr),
+		.s_dbram(data_bram_mmr),
+		.m_ibram(instruction_bram_proc),
+		.m_dbram(data_bram_proc)
+	);
+
+	prism_sp_processor_pool #(
 		.IBRAM_SIZE(IBRAM_SIZE),
 		.DBRAM_SIZE(DBRAM_SIZE),
 		.ACPBRAM_SIZE(ACPBRAM_SIZE),
 		.USE_SP_UNIT_RX(0),
 		.USE_SP_UNIT_TX(1),
-		.NPUZZLEFIFOS(NTXPUZZLEFIFOS)
-	) prism_sp_processor_0(
+		.NPUZZLEFIFOS(NTXPUZZLEFIFOS),
+		.NWORKERS(NTXWORKERS),
+		.WORKER_FIFO_R(TX_WORKER_FIFO_R),
+		.WORKER_FIFO_W(TX_WORKER_FIFO_W),
+		.DISPATCH_HASH_WORD(TX_WORKER_HASH_WORD),
+		.DISPATCH_EOF_BITN(TX_COOKIE_EOF_BITN)
+	) prism_sp_processor_pool_0(
 		.clock,
 		.resetn,
 		.cpu_reset,
 
 		.io_axi_axcache,
-		.m_axi_io(m_axi_mx),
-		.instruction_bram_mmr,
-		.data_bram_mmr,
-
-		.puzzle_sw_fifo_r_0,
-		.puzzle_sw_fifo_w_0,
-		.puzzle_sw_fifo_r_1,
-		.puzzle_sw_fifo_w_1,
-		.puzzle_sw_fifo_r_2,
-		.puzzle_sw_fifo_w_2,
-		.puzzle_sw_fifo_r_3,
-		.puzzle_sw_fifo_w_3,
+		.m_axi_io(proc_m_axi_io),
+		.instruction_bram_mmr(instruction_bram_proc),
+		.data_bram_mmr(data_bram_proc),
+
+		.puzzle_sw_fifo_r,
+		.puzzle_sw_fifo_w,
 
 		// Interfaces used by the RX unit
 		.rx_data_mem_w(dummy_rx_data_mem_w),
@@ -566,6 +717,9 @@ if (ENABLE_TX_RISCV_PROCESSOR) begin
 		.mmr_rw,
 		.mmr_r,
 		.mmr_t(sw_mmr_t),
+
+		// Interface used by the HDR unit
+		.hdr_w,
 		.mmr_i(sw_mmr_i),
 
 		// Interfaces used by the ACP unit
@@ -577,9 +731,21 @@ if (ENABLE_TX_RISCV_PROCESSOR) begin
 
 		.trace_proc,
 		.trace_sp_unit,
-		.trace_sp_unit_tx
+		.trace_sp_unit_tx,
+		.sp_perf_counters
 	);
 end // ENABLE_TX_RISCV_PROCESSOR
+else begin
+	assign hdr_w.load = 1'b0;
+	assign hdr_w.len = '0;
+	assign hdr_w.peek_addr = '0;
+	assign hdr_w.poke = 1'b0;
+	assign hdr_w.poke_addr = '0;
+	assign hdr_w.poke_data = '0;
+	assign hdr_w.commit = 1'b0;
+	assign sp_perf_counters = '{default: '0};
+	assign load_status = '0;
+end
 
 /*
  * --------  --------  --------  --------
@@ -628,6 +794,11 @@ fifo_write_interface #(
 	.DATA_COUNT_WIDTH(1)
 ) tx_csum_fifo_w();
 
+fifo_write_interface #(
+	.DATA_WIDTH(TX_DIGEST_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(1)
+) tx_digest_fifo_w();
+
 xpm_fifo_async #(
 	.CDC_SYNC_STAGES(2),
 	.DOUT_RESET_VALUE("0"),
@@ -700,6 +871,40 @@ xpm_fifo_async #(
 	.wr_data_count(tx_csum_fifo_w.wr_data_count)
 );
 
+xpm_fifo_async #(
+	.CDC_SYNC_STAGES(2),
+	.DOUT_RESET_VALUE("0"),
+	.ECC_MODE("no_ecc"),
+	.FIFO_MEMORY_TYPE("auto"),
+	.FIFO_READ_LATENCY(0),
+	.FIFO_WRITE_DEPTH(TX_DIGEST_FIFO_DEPTH),
+	.FULL_RESET_VALUE(0),
+	.RD_DATA_COUNT_WIDTH(1),
+	.READ_DATA_WIDTH(tx_digest_fifo_r.DATA_WIDTH),
+	.READ_MODE("fwft"),
+	.SIM_ASSERT_CHK(0),
+	.USE_ADV_FEATURES("0204"),
+	.WAKEUP_TIME(0),
+	.WR_DATA_COUNT_WIDTH(tx_digest_fifo_w.DATA_COUNT_WIDTH),
+	.WRITE_DATA_WIDTH(tx_digest_fifo_w.DATA_WIDTH)
+) tx_digest_fifo (
+	.rst(~resetn),
+
+	.rd_clk(tx_digest_fifo_r.clock),
+	.rd_en(tx_digest_fifo_r.rd_en),
+	.dout(tx_digest_fifo_r.rd_data),
+	.empty(tx_digest_fifo_r.empty),
+	.almost_empty(tx_digest_fifo_r.almost_empty),
+	.rd_data_count(tx_digest_fifo_r.rd_data_count),
+
+	.wr_clk(clock),
+	.wr_en(tx_digest_fifo_w.wr_en),
+	.din(tx_digest_fifo_w.wr_data),
+	.full(tx_digest_fifo_w.full),
+	.almost_full(tx_digest_fifo_w.almost_full),
+	.wr_data_count(tx_digest_fifo_w.wr_data_count)
+);
+
 xpm_fifo_async #(
 	.CDC_SYNC_STAGES(2),
 	.DOUT_RESET_VALUE("0"),
@@ -709,8 +914,8 @@ xpm_fifo_async #(
 	.FIFO_WRITE_DEPTH(TX_DATA_FIFO_DEPTH),
 	.FULL_RESET_VALUE(0),
 	// GEM TX clock domain
-	//.RD_DATA_COUNT_WIDTH(tx_data_fifo_r.DATA_COUNT_WIDTH),
-	.RD_DATA_COUNT_WIDTH(1),
+	// The GEM TX interface needs the read data count for cut-through.
+	.RD_DATA_COUNT_WIDTH(tx_data_fifo_r.DATA_COUNT_WIDTH),
 	.READ_DATA_WIDTH(tx_data_fifo_r.DATA_WIDTH),
 	.READ_MODE("fwft"),
 	.RELATED_CLOCKS(0),
@@ -727,6 +932,7 @@ xpm_fifo_async #(
 	.rd_clk(tx_data_fifo_r.clock),
 	.rd_en(tx_data_fifo_r.rd_en),
 	.dout(tx_data_fifo_r.rd_data),
+	.empty(tx_data_fifo_r.empty),
 	.rd_data_count(tx_data_fifo_r.rd_data_count),
 
 	.wr_clk(clock),
@@ -734,25 +940,152 @@ xpm_fifo_async #(
 	.din(tx_data_fifo_w.wr_data),
 	.wr_data_count(tx_data_fifo_w.wr_data_count)
 );
+
+/*
+ * Slots of the capture unit
+ */
+xpm_fifo_async #(
+	.CDC_SYNC_STAGES(2),
+	.DOUT_RESET_VALUE("0"),
+	.ECC_MODE("no_ecc"),
+	.FIFO_MEMORY_TYPE("auto"),
+	.FIFO_READ_LATENCY(0),
+	.FIFO_WRITE_DEPTH(CAPTURE_FIFO_DEPTH),
+	.FULL_RESET_VALUE(0),
+	.PROG_EMPTY_THRESH(10),
+	.PROG_FULL_THRESH(10),
+	// Processor clock domain
+	.RD_DATA_COUNT_WIDTH(capture_fifo_r.DATA_COUNT_WIDTH),
+	.READ_DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.READ_MODE("fwft"),
+	.RELATED_CLOCKS(0),
+	.SIM_ASSERT_CHK(0),
+	.USE_ADV_FEATURES("0707"),
+	.WAKEUP_TIME(0),
+	// GEM TX clock domain
+	.WR_DATA_COUNT_WIDTH(capture_fifo_w.DATA_COUNT_WIDTH),
+	.WRITE_DATA_WIDTH(CAPTURE_WORD_WIDTH)
+) capture_fifo (
+	// reset is synchronized to wr_clk!
+	.rst(capture_fifo_w.reset),
+
+	.rd_clk(clock),
+	.rd_en(capture_fifo_r.rd_en),
+	.dout(capture_fifo_r.rd_data),
+	.empty(capture_fifo_r.empty),
+	.rd_data_count(capture_fifo_r.rd_data_count),
+
+	.wr_clk(capture_fifo_w.clock),
+	.wr_en(capture_fifo_w.wr_en),
+	.din(capture_fifo_w.wr_data),
+	.full(capture_fifo_w.full),
+	.wr_data_count(capture_fifo_w.wr_data_count)
+);
+
+/*
+ * The underflow counter is incremented in the GEM TX clock domain.
+ */
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(tx_underflows))
+) tx_underflows_cdc (
+	.src_clk(tx_data_fifo_r.clock),
+	.src_in_bin(gem_tx_underflows),
+	.dest_clk(clock),
+	.dest_out_bin(tx_underflows)
+);
+
+/*
+ * So are the results of the traffic checker. The latencies are only
+ * consistent once the checker has seen the last frame.
+ */
+for (genvar i = 0; i < $bits(traffic_check_t)/32; i++) begin
+	xpm_cdc_gray #(
+		.DEST_SYNC_FF(2),
+		.INIT_SYNC_FF(0),
+		.REG_OUTPUT(0),
+		.SIM_ASSERT_CHK(0),
+		.SIM_LOSSLESS_GRAY_CHK(0),
+		.WIDTH(32)
+	) tchk_results_cdc (
+		.src_clk(tx_data_fifo_r.clock),
+		.src_in_bin(gem_tchk_results[32*i +: 32]),
+		.dest_clk(clock),
+		.dest_out_bin(tchk_results[32*i +: 32])
+	);
+end
+
+xpm_cdc_gray #(
+	.DEST_SYNC_FF(2),
+	.INIT_SYNC_FF(0),
+	.REG_OUTPUT(0),
+	.SIM_ASSERT_CHK(0),
+	.SIM_LOSSLESS_GRAY_CHK(0),
+	.WIDTH($bits(capture_drops))
+) capture_drops_cdc (
+	.src_clk(capture_fifo_w.clock),
+	.src_in_bin(gem_capture_drops),
+	.dest_clk(clock),
+	.dest_out_bin(capture_drops)
+);
+`else
+assign tx_underflows = gem_tx_underflows;
+assign tchk_results = gem_tchk_results;
+assign capture_drops = gem_capture_drops;
 `endif
 
 wire logic csum_i_valid;
-wire logic [tx_data_fifo_w.DATA_WIDTH-1:0] csum_i_data;
+wire logic [m_axi_dma_r.AXI_RDATA_WIDTH-1:0] csum_i_data;
 wire logic csum_i_sof;
 wire logic csum_i_eof;
 
-prism_sp_tx_checksum #(
+if ($bits(csum_i_data) == 128) begin
+	prism_sp_tx_checksum #(
+		.DATA_WIDTH($bits(csum_i_data))
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+else begin
+	prism_sp_tx_checksum_generic #(
+		.DATA_WIDTH($bits(csum_i_data))
+	) prism_sp_tx_checksum_0 (
+		.clock,
+		.resetn,
+		.i_valid(csum_i_valid),
+		.i_data(csum_i_data),
+		.i_sof(csum_i_sof),
+		.i_eof(csum_i_eof),
+		.tx_csum_fifo_w,
+
+		.trace_csum
+	);
+end
+
+prism_sp_tx_digest #(
 	.DATA_WIDTH($bits(csum_i_data))
-) prism_sp_tx_checksum_0 (
+) prism_sp_tx_digest_0 (
 	.clock,
 	.resetn,
+	.digest_start,
+	.digest_end,
 	.i_valid(csum_i_valid),
 	.i_data(csum_i_data),
 	.i_sof(csum_i_sof),
 	.i_eof(csum_i_eof),
-	.tx_csum_fifo_w,
-
-	.trace_csum
+	.tx_digest_fifo_w
 );
 
 wire logic [3:0] dma_axi_arcache;
@@ -762,20 +1095,81 @@ else
 	assign dma_axi_arcache[3:2] = 2'b00;
 assign dma_axi_arcache[1:0] = 2'b11;
 
+/*
+ * AXI attributes of the frame payloads and headers
+ */
+wire axi_attr_t dma_data_attr = axattr_data[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_data[$bits(axi_attr_t)-1:0]) :
+	'{ user: 2'b11, prot: 3'b010, cache: dma_axi_arcache };
+wire axi_attr_t dma_hdr_attr = axattr_hdr[AXATTR_OVERRIDE_BITN] ?
+	axi_attr_t'(axattr_hdr[$bits(axi_attr_t)-1:0]) : dma_data_attr;
+wire logic [15:0] dma_hdr_len = axattr_hdr[AXATTR_OVERRIDE_BITN] ?
+	16'(axattr_hdr[AXATTR_HDR_LEN_BITN +: AXATTR_HDR_LEN_WIDTH]) : '0;
+
+/*
+ * The header window sits between the DMA engine and the TX data FIFO.
+ */
+fifo_write_interface #(
+	.DATA_WIDTH(TX_DATA_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) hdr_tx_data_fifo_w();
+
+if (USE_HDR_WINDOW) begin
+	prism_sp_tx_header_window prism_sp_tx_header_window_0(
+		.clock,
+		.resetn,
+
+		.hdr_w,
+		.dma_busy(tx_data_mem_r.busy || !puzzle_hw_dma_idle),
+
+		.m_fifo_w(tx_data_fifo_w),
+		.s_fifo_w(hdr_tx_data_fifo_w)
+	);
+end
+else begin
+	fifo_write_interface_connect(.m(tx_data_fifo_w), .s(hdr_tx_data_fifo_w));
+	assign hdr_w.busy = 1'b0;
+	assign hdr_w.loading = 1'b0;
+	assign hdr_w.peek_data = '0;
+end
+
+/*
+ * The DMA engine writes words of the DMA data bus width.
+ */
+fifo_write_interface #(
+	.DATA_WIDTH(m_axi_dma_r.AXI_RDATA_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DATA_FIFO_DATA_COUNT_WIDTH)
+) dma_tx_data_fifo_w();
+
+if (m_axi_dma_r.AXI_RDATA_WIDTH == TX_DATA_FIFO_WIDTH) begin
+	fifo_write_interface_connect(.m(hdr_tx_data_fifo_w), .s(dma_tx_data_fifo_w));
+end
+else begin
+	fifo_write_interface_upsize fifo_write_interface_upsize_0(
+		.clock,
+		.resetn,
+		.s_last(csum_i_eof),
+		.m(hdr_tx_data_fifo_w),
+		.s(dma_tx_data_fifo_w)
+	);
+end
+
 axi_to_fifo_v5#(
 	.FIFO_SIZE(TX_DATA_FIFO_SIZE)
 ) axi_to_fifo_0(
 	.clock,
 	.resetn,
 	.mem_r(tx_data_mem_r),
-	.fifo_w(tx_data_fifo_w),
+	.fifo_w(dma_tx_data_fifo_w),
 
 	.ext_valid(csum_i_valid),
 	.ext_data(csum_i_data),
 	.ext_sof(csum_i_sof),
 	.ext_eof(csum_i_eof),
 
-	.axi_arcache(dma_axi_arcache),
+	.hdr_len(dma_hdr_len),
+	.axi_hdr_attr(dma_hdr_attr),
+	.axi_attr(dma_data_attr),
 	.axi_ar(m_axi_dma_ar),
 	.axi_r(m_axi_dma_r),
 
@@ -783,4 +1177,44 @@ axi_to_fifo_v5#(
 	.trace_atf_bds
 );
 
+/*
+ * Trace recorder
+ * The window of the recorder is taken from this vector, whose LSB is the
+ * LSB of trace_sp_unit.
+ */
+if (USE_TRACE_RECORDER) begin
+	localparam int TRACE_ALL_WIDTH =
+		$bits(trace_checksum_t) +
+		$bits(trace_atf_bds_t) +
+		$bits(trace_atf_t) +
+		$bits(trace_tx_puzzle_t) +
+		$bits(trace_sp_unit_tx_t) +
+		$bits(trace_sp_unit_t);
+	wire logic [TRACE_ALL_WIDTH-1:0] trace_all = { trace_csum, trace_atf_bds, trace_atf, trace_tx_puzzle, trace_sp_unit_tx, trace_sp_unit };
+
+	prism_sp_trace_recorder #(
+		.TRACE_WIDTH(TRACE_ALL_WIDTH)
+	) prism_sp_trace_recorder_0 (
+		.clock,
+		.resetn,
+
+		.trace(trace_all),
+
+		.arm(trace_arm),
+		.force_trigger(trace_force),
+		.window(trace_window),
+		.post(trace_post),
+		.trig_mask(trace_trig_mask),
+		.trig_match(trace_trig_match),
+		.rd_addr(trace_addr),
+
+		.status(trace_status),
+		.rd_data(trace_data)
+	);
+end
+else begin
+	assign trace_status = '0;
+	assign trace_data = '0;
+end
+
 endmodule
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * CRC32C data digest of outgoing frames.
+ *
+ * The unit watches the data stream that is written to the TX data FIFO
+ * and computes the CRC32C over the bytes [digest_start, digest_end) of
+ * every frame. The range is sampled at the start of a frame.
+ * At the end of a frame, the inverted CRC and digest_end are written to
+ * tx_digest_fifo_w. prism_sp_gem_tx_single inserts the digest at that
+ * offset. If digest_end is zero, an all-zero entry is written right at
+ * the start of the frame, so that a cut-through frame without a digest
+ * does not wait for its end. There is exactly one entry per frame.
+ */
+module prism_sp_tx_digest #(
+	parameter int DATA_WIDTH
+)
+(
+	input wire logic clock,
+	input wire logic resetn,
+
+	input wire logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_start,
+	input wire logic [TX_COOKIE_SIZE_WIDTH-1:0] digest_end,
+
+	input wire logic i_valid,
+	input wire logic [DATA_WIDTH-1:0] i_data,
+	input wire logic i_sof,
+	input wire logic i_eof,
+
+	fifo_write_interface.master tx_digest_fifo_w
+);
+
+localparam int NBYTES = DATA_WIDTH / 8;
+
+var logic [TX_COOKIE_SIZE_WIDTH-1:0] range_start;
+var logic [TX_COOKIE_SIZE_WIDTH-1:0] range_end;
+var logic [TX_COOKIE_SIZE_WIDTH-1:0] word_off;
+var logic [31:0] crc;
+
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] cur_start = i_sof ? digest_start : range_start;
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] cur_end = i_sof ? digest_end : range_end;
+wire logic [TX_COOKIE_SIZE_WIDTH-1:0] cur_off = i_sof ? '0 : word_off;
+
+var logic [31:0] crc_next;
+always_comb begin
+	logic [TX_COOKIE_SIZE_WIDTH-1:0] off;
+
+	crc_next = i_sof ? '1 : crc;
+	for (int b = 0; b < NBYTES; b++) begin
+		off = cur_off + TX_COOKIE_SIZE_WIDTH'(b);
+		if (off >= cur_start && off < cur_end) begin
+			crc_next = crc32c_byte(crc_next, i_data[b*8 +: 8]);
+		end
+	end
+end
+
+always_ff @(posedge clock) begin
+	// Unpulse
+	tx_digest_fifo_w.wr_en <= 1'b0;
+
+	if (!resetn) begin
+		range_start <= '0;
+		range_end <= '0;
+		word_off <= '0;
+		crc <= '1;
+	end
+	else if (i_valid) begin
+		range_start <= cur_start;
+		range_end <= cur_end;
+		word_off <= cur_off + TX_COOKIE_SIZE_WIDTH'(NBYTES);
+		crc <= crc_next;
+
+		if (i_sof && cur_end == '0) begin
+			tx_digest_fifo_w.wr_en <= 1'b1;
+			tx_digest_fifo_w.wr_data <= '0;
+		end
+		else if (i_eof && cur_end != '0) begin
+			tx_digest_fifo_w.wr_en <= 1'b1;
+			tx_digest_fifo_w.wr_data <= { ~crc_next, cur_end };
+		end
+	end
+end
+
+endmodule
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Header window of the TX data stream (see prism_sp_unit_hdr).
+ *
+ * Sits between the DMA engine (s_fifo_w) and the TX data FIFO
+ * (m_fifo_w). Unless it is loaded, the window is transparent.
+ * A load waits until the DMA engine is idle and no cookie waits for it
+ * (dma_busy), so that the words of the previous frames still go to the
+ * FIFO. After that, the window is loading: the next
+ * min(len, HDR_WINDOW_SIZE) bytes, rounded up to whole words, written by
+ * the DMA engine go to the window instead of the FIFO. Hence, the header
+ * must be read by a DMA of its own, whose length covers exactly these
+ * words, and which is only started once the window is loading.
+ * A commit writes the words of the window to the FIFO. The rest of the
+ * frame must not be read before the window is drained.
+ * The window is busy while it waits, while it is filled and while it
+ * is drained.
+ * The words held by the window are included in the data count, so the
+ * DMA engine does not overcommit the FIFO.
+ */
+module prism_sp_tx_header_window (
+	input wire logic clock,
+	input wire logic resetn,
+
+	header_window_interface.slave hdr_w,
+	input wire logic dma_busy,
+
+	fifo_write_interface.master m_fifo_w,
+	fifo_write_interface.slave s_fifo_w
+);
+
+localparam int DATA_WIDTH = m_fifo_w.DATA_WIDTH;
+localparam int BYTES = DATA_WIDTH/8;
+localparam int WORDS = HDR_WINDOW_SIZE / BYTES;
+localparam int WORD_WIDTH = WORDS > 1 ? $clog2(WORDS) : 1;
+localparam int LANE_WIDTH = $clog2(BYTES/4);
+
+if (HDR_WINDOW_SIZE % BYTES != 0 || BYTES < 4) begin
+	$error("The header window (%d bytes) must be a multiple of the FIFO width (%d bits)\n",
+		HDR_WINDOW_SIZE, DATA_WIDTH);
+end
+
+typedef enum logic [2:0] {
+	STATE_IDLE,
+	STATE_WAIT,
+	STATE_LOAD,
+	STATE_HELD,
+	STATE_DRAIN
+} state_t;
+
+var state_t state;
+var logic [DATA_WIDTH-1:0] window [WORDS];
+var logic [WORD_WIDTH:0] nwords;
+var logic [WORD_WIDTH:0] idx;
+
+wire logic [15:0] len_words = (hdr_w.len + 16'(BYTES-1)) / 16'(BYTES);
+wire logic load_push = state == STATE_LOAD && s_fifo_w.wr_en;
+wire logic [WORD_WIDTH:0] held = state == STATE_IDLE ? '0 : state == STATE_DRAIN ? nwords - idx : idx;
+
+assign m_fifo_w.clock = s_fifo_w.clock;
+assign m_fifo_w.reset = s_fifo_w.reset;
+
+always_comb begin
+	if (state == STATE_DRAIN) begin
+		m_fifo_w.wr_data = window[idx[WORD_WIDTH-1:0]];
+		m_fifo_w.wr_en = 1'b1;
+	end
+	else begin
+		m_fifo_w.wr_data = s_fifo_w.wr_data;
+		m_fifo_w.wr_en = s_fifo_w.wr_en && state != STATE_LOAD;
+	end
+end
+
+assign s_fifo_w.full = m_fifo_w.full;
+assign s_fifo_w.almost_full = m_fifo_w.almost_full;
+assign s_fifo_w.wr_data_count = m_fifo_w.wr_data_count + $bits(s_fifo_w.wr_data_count)'(held);
+
+assign hdr_w.busy = hdr_w.load || state == STATE_WAIT || state == STATE_LOAD || state == STATE_DRAIN;
+assign hdr_w.loading = state == STATE_LOAD;
+
+wire logic [DATA_WIDTH-1:0] peek_word = window[hdr_w.peek_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]];
+if (BYTES > 4) begin
+	assign hdr_w.peek_data = peek_word[32*hdr_w.peek_addr[2 +: LANE_WIDTH] +: 32];
+end
+else begin
+	assign hdr_w.peek_data = peek_word;
+end
+
+always_ff @(posedge clock) begin
+	if (load_push) begin
+		window[idx[WORD_WIDTH-1:0]] <= s_fifo_w.wr_data;
+	end
+	else if (hdr_w.poke) begin
+		if (BYTES > 4) begin
+			window[hdr_w.poke_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]]
+				[32*hdr_w.poke_addr[2 +: LANE_WIDTH] +: 32] <= hdr_w.poke_data;
+		end
+		else begin
+			window[hdr_w.poke_addr[HDR_WINDOW_ADDR_WIDTH-1 -: WORD_WIDTH]] <= hdr_w.poke_data;
+		end
+	end
+end
+
+always_ff @(posedge clock) begin
+	if (!resetn) begin
+		state <= STATE_IDLE;
+	end
+	else begin
+		case (state)
+		STATE_IDLE: begin
+			if (hdr_w.load && hdr_w.len != '0) begin
+				nwords <= len_words > 16'(WORDS) ? (WORD_WIDTH+1)'(WORDS) : (WORD_WIDTH+1)'(len_words);
+				idx <= '0;
+				state <= STATE_WAIT;
+			end
+		end
+		STATE_WAIT: begin
+			if (!dma_busy) begin
+				state <= STATE_LOAD;
+			end
+		end
+		STATE_LOAD: begin
+			if (load_push) begin
+				idx <= idx + 1;
+				if (idx + 1 == nwords) begin
+					state <= STATE_HELD;
+				end
+			end
+		end
+		STATE_HELD: begin
+			if (hdr_w.commit) begin
+				idx <= '0;
+				state <= STATE_DRAIN;
+			end
+		end
+		STATE_DRAIN: begin
+			idx <= idx + 1;
+			if (idx + 1 == nwords) begin
+				state <= STATE_IDLE;
+			end
+		end
+		endcase
+	end
+end
+
+endmodule
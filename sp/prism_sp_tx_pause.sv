@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Sends 802.3x PAUSE or 802.1Qbb PFC frames between the frames of
+ * s_gem_tx (see REGOFF_PAUSE_CONTROL).
+ *
+ * xoff holds the priorities that are to be paused. It comes from the
+ * GEM RX clock domain. A frame is sent whenever xoff changes, and it is
+ * repeated after half of the pause time while any priority is paused.
+ * A PFC frame enables all priorities and gives the pause time for the
+ * paused ones and 0 for the others. For 802.3x PAUSE frames, the link
+ * is paused if any priority is paused.
+ * The GEM appends the FCS.
+ */
+module prism_sp_tx_pause (
+	input wire logic [31:0] control,
+	input wire logic [47:0] sa,
+	input wire logic [7:0] xoff,
+
+	gem_tx_interface.slave s_gem_tx,
+	gem_tx_interface.master gem_tx
+);
+
+localparam int FRAME_SIZE = 60;
+
+typedef enum logic [1:0] {
+	STATE_IDLE,
+	STATE_SEND,
+	// The last byte is on the bus.
+	STATE_DONE
+} state_t;
+
+wire logic enable = control[0];
+wire logic pfc = control[PAUSE_CONTROL_PFC_BITN];
+wire logic [15:0] quanta = control[PAUSE_CONTROL_QUANTA_BITN +: 16];
+
+var state_t state;
+var logic [7:0] xoff_sync [2];
+var logic [7:0] sent_xoff;
+var logic [7:0] frame_xoff;
+var logic frame_pfc;
+var logic [5:0] idx;
+var logic [$clog2(PAUSE_QUANTUM_CYCLES)+15:0] refresh_cycles;
+// Set while s_gem_tx sends a frame.
+var logic s_busy;
+
+var logic p_data_rdy;
+var logic p_valid;
+var logic [7:0] p_data;
+var logic p_sop;
+var logic p_eop;
+
+wire logic [7:0] cur_xoff = pfc ? xoff_sync[1] : {8{|xoff_sync[1]}};
+wire logic refresh = |sent_xoff &&
+	refresh_cycles >= $bits(refresh_cycles)'(quanta) * (PAUSE_QUANTUM_CYCLES/2);
+wire logic pending = enable && (cur_xoff != sent_xoff || refresh);
+wire logic sel = state != STATE_IDLE;
+
+assign s_gem_tx.tx_clock = gem_tx.tx_clock;
+assign s_gem_tx.tx_resetn = gem_tx.tx_resetn;
+assign s_gem_tx.tx_r_status = gem_tx.tx_r_status;
+assign s_gem_tx.tx_r_fixed_lat = gem_tx.tx_r_fixed_lat;
+assign s_gem_tx.dma_tx_end_tog = gem_tx.dma_tx_end_tog;
+assign gem_tx.dma_tx_status_tog = s_gem_tx.dma_tx_status_tog;
+
+assign s_gem_tx.tx_r_rd = sel ? 1'b0 : gem_tx.tx_r_rd;
+assign gem_tx.tx_r_data_rdy = sel ? p_data_rdy : s_gem_tx.tx_r_data_rdy;
+assign gem_tx.tx_r_valid = sel ? p_valid : s_gem_tx.tx_r_valid;
+assign gem_tx.tx_r_data = sel ? p_data : s_gem_tx.tx_r_data;
+assign gem_tx.tx_r_sop = sel ? p_sop : s_gem_tx.tx_r_sop;
+assign gem_tx.tx_r_eop = sel ? p_eop : s_gem_tx.tx_r_eop;
+assign gem_tx.tx_r_err = sel ? 1'b0 : s_gem_tx.tx_r_err;
+assign gem_tx.tx_r_underflow = sel ? 1'b0 : s_gem_tx.tx_r_underflow;
+assign gem_tx.tx_r_flushed = sel ? 1'b0 : s_gem_tx.tx_r_flushed;
+// Let the GEM append the FCS.
+assign gem_tx.tx_r_control = sel ? 1'b0 : s_gem_tx.tx_r_control;
+
+function automatic logic [7:0] frame_byte(
+	input logic [5:0] i,
+	input logic is_pfc,
+	input logic [7:0] vec,
+	input logic [15:0] time_quanta,
+	input logic [47:0] src
+);
+	logic [15:0] t;
+
+	case (i)
+	// 01-80-c2-00-00-01
+	0: return 8'h01;
+	1: return 8'h80;
+	2: return 8'hc2;
+	3: return 8'h00;
+	4: return 8'h00;
+	5: return 8'h01;
+	6, 7, 8, 9, 10, 11: return src[8*(i-6) +: 8];
+	// MAC Control
+	12: return 8'h88;
+	13: return 8'h08;
+	14: return is_pfc ? 8'h01 : 8'h00;
+	15: return 8'h01;
+	default: begin end
+	endcase
+
+	if (!is_pfc) begin
+		t = |vec ? time_quanta : '0;
+		case (i)
+		16: return t[15:8];
+		17: return t[7:0];
+		default: return 8'h00;
+		endcase
+	end
+
+	// The class-enable vector, followed by the time of each class.
+	if (i == 16) begin
+		return 8'h00;
+	end
+	if (i == 17) begin
+		return 8'hff;
+	end
+	if (i >= 18 && i < 34) begin
+		t = vec[(i-18) >> 1] ? time_quanta : '0;
+		return i[0] ? t[7:0] : t[15:8];
+	end
+	return 8'h00;
+endfunction
+
+always_ff @(posedge gem_tx.tx_clock) begin
+	xoff_sync <= '{ xoff, xoff_sync[0] };
+end
+
+always_ff @(posedge gem_tx.tx_clock) begin
+	// Unpulse
+	p_valid <= 1'b0;
+
+	if (!gem_tx.tx_resetn) begin
+		p_data_rdy <= 1'b0;
+		sent_xoff <= '0;
+		refresh_cycles <= '0;
+		s_busy <= 1'b0;
+		state <= STATE_IDLE;
+	end
+	else begin
+		if (!refresh) begin
+			refresh_cycles <= refresh_cycles + 1;
+		end
+		if (!enable) begin
+			sent_xoff <= '0;
+		end
+
+		case (state)
+		STATE_IDLE: begin
+			if (gem_tx.tx_r_rd) begin
+				s_busy <= 1'b1;
+			end
+			if (s_gem_tx.tx_r_valid && s_gem_tx.tx_r_eop) begin
+				s_busy <= 1'b0;
+			end
+			// Only switch between the frames of s_gem_tx.
+			if (pending && !s_busy && !gem_tx.tx_r_rd) begin
+				frame_xoff <= cur_xoff;
+				frame_pfc <= pfc;
+				idx <= '0;
+				p_data_rdy <= 1'b1;
+				state <= STATE_SEND;
+			end
+		end
+		STATE_SEND: begin
+			if (gem_tx.tx_r_rd) begin
+				p_data_rdy <= 1'b0;
+				p_valid <= 1'b1;
+				p_data <= frame_byte(idx, frame_pfc, frame_xoff, quanta, sa);
+				p_sop <= idx == '0;
+				p_eop <= idx == 6'(FRAME_SIZE-1);
+				idx <= idx + 1;
+				if (idx == 6'(FRAME_SIZE-1)) begin
+					sent_xoff <= frame_xoff;
+					refresh_cycles <= '0;
+					state <= STATE_DONE;
+				end
+			end
+		end
+		STATE_DONE: begin
+			state <= STATE_IDLE;
+		end
+		default: begin
+			state <= STATE_IDLE;
+		end
+		endcase
+	end
+end
+
+endmodule
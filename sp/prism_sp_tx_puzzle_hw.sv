@@ -19,25 +19,49 @@ module prism_sp_tx_puzzle_hw (
 	input wire logic clock,
 	input wire logic resetn,
 
-	input wire logic tx_enable,
+	input wire logic [NTXQUEUES-1:0] tx_queue_enable,
+	input wire logic tx_queue_wrr,
+	input wire logic [31:0] tx_queue_weights,
 
 	mmr_intr_interface.master			mmr_i,
 	mmr_trigger_interface.master		mmr_t,
 
-	fifo_read_interface.master			fifo_r_0,
-	fifo_write_interface.master			fifo_w_0,
-	fifo_read_interface.master			fifo_r_1,
-	fifo_write_interface.master			fifo_w_1,
-	fifo_read_interface.master			fifo_r_2,
-	fifo_write_interface.master			fifo_w_2,
-	fifo_read_interface.master			fifo_r_3,
-	fifo_write_interface.master			fifo_w_3,
+	fifo_read_interface.master			fifo_r [NTXPUZZLEFIFOS],
+	fifo_write_interface.master			fifo_w [NTXPUZZLEFIFOS],
 
-	input wire logic [SYSTEM_ADDR_WIDTH-1:0]			dma_desc_base,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]			dma_desc_base [NTXQUEUES],
+	input wire logic									cq_enable,
+	input wire logic									poll_enable,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0]		poll_min_shift,
+	input wire logic [POLL_CONTROL_SHIFT_WIDTH-1:0]		poll_max_shift,
+	input wire logic [CQ_CONTROL_SIZE_WIDTH-1:0]		cq_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]			cq_base,
+	input wire logic [VIRTQ_RING_SIZE_WIDTH-1:0]		ring_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]			virtq_event_addr,
+	input wire logic [TX_META_DESC_SIZE_WIDTH-1:0]		tx_ct_size,
+	input wire logic [31:0]								tx_queue_rate [NTXQUEUES],
+	input wire logic [31:0]								tx_queue_burst [NTXQUEUES],
+	input wire logic [31:0]								tx_port_rate,
+	input wire logic [31:0]								tx_port_burst,
+	output wire logic [31:0]							tx_time,
+	// Digest range of the frame that is read by the DMA
+	output wire logic [TX_COOKIE_SIZE_WIDTH-1:0]		digest_start,
+	output wire logic [TX_COOKIE_SIZE_WIDTH-1:0]		digest_end,
+	// Set while the DMA stage neither reads nor holds a cookie
+	output wire logic									dma_idle,
+	input wire logic									capture_enable,
+	input wire logic [CAPTURE_CONTROL_SIZE_WIDTH-1:0]	capture_size,
+	input wire logic [SYSTEM_ADDR_WIDTH-1:0]			capture_base,
+	input wire logic [31:0]								capture_tail,
+	output wire logic [31:0]							capture_head,
+	input wire axi_attr_t								desc_rd_attr,
+	input wire axi_attr_t								desc_wr_attr,
+	input wire axi_attr_t								capture_attr,
 
 	fifo_write_interface.inputs			tx_data_fifo_w,
 	memory_read_interface.master		tx_data_mem_r,
 	fifo_write_interface.master			tx_meta_fifo_w,
+	fifo_read_interface.master			capture_fifo_r,
 
 	axi_write_address_channel.master	axi_ma_aw,
 	axi_write_channel.master			axi_ma_w,
@@ -67,46 +91,195 @@ module prism_sp_tx_puzzle_hw (
 if (USE_TX_RING_ACQUIRE) begin
 prism_sp_ring_acquire_cookie_convert_interface#(
 	.DATA_IN_WIDTH(axi_ma_r.AXI_RDATA_WIDTH),
-	.DATA_OUT_WIDTH(fifo_w_1.DATA_WIDTH)
+	.DATA_OUT_WIDTH(fifo_w[1].DATA_WIDTH)
 ) racc();
 
+fifo_write_interface #(
+	.DATA_WIDTH(fifo_w[0].DATA_WIDTH),
+	.DATA_COUNT_WIDTH(fifo_w[0].DATA_COUNT_WIDTH)
+) txq_fifo_w [NTXQUEUES] ();
+
+if (USE_TX_VIRTQ) begin
+prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_tx_cookie
+prism_sp_ring_acquire_cc_virtq_packed_desc_2_dma_tx_cookie_inst(.conv(racc));
+
+prism_sp_puzzle_hw_gem_ring_acquire #(
+	.COOKIE_TYPE(tx_cookie_t),
+	.DESC_TYPE(virtq_packed_desc_t),
+	.FIFO_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH[0]),
+	.NQUEUES(NTXQUEUES)
+) prism_sp_puzzle_hw_gem_ring_acquire_0 (
+	.clock,
+	.resetn,
+
+	.mmr_t,
+	.enable(tx_queue_enable),
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.ring_size,
+
+	.dma_desc_base,
+	.axi_attr(desc_rd_attr),
+	.axi_ar(axi_ma_ar),
+	.axi_r(axi_ma_r),
+
+	.conv(racc),
+
+	.o_cookie_fifo_w(txq_fifo_w)
+);
+end
+else begin
 prism_sp_ring_acquire_cc_gem_dma_tx_desc_2_dma_tx_cookie
 prism_sp_ring_acquire_cc_gem_dma_tx_desc_2_dma_tx_cookie_inst(.conv(racc));
 
 prism_sp_puzzle_hw_gem_ring_acquire #(
 	.COOKIE_TYPE(tx_cookie_t),
 	.DESC_TYPE(gem_dma_tx_desc_t),
-	.FIFO_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH[0])
+	.FIFO_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH[0]),
+	.NQUEUES(NTXQUEUES)
 ) prism_sp_puzzle_hw_gem_ring_acquire_0 (
 	.clock,
 	.resetn,
 
 	.mmr_t,
-	.enable(tx_enable),
+	.enable(tx_queue_enable),
+	.cq_enable,
+	.poll_enable,
+	.poll_min_shift,
+	.poll_max_shift,
+	.ring_size,
 
 	.dma_desc_base,
+	.axi_attr(desc_rd_attr),
 	.axi_ar(axi_ma_ar),
 	.axi_r(axi_ma_r),
 
 	.conv(racc),
 
-	.o_cookie_fifo_w(fifo_w_0)
+	.o_cookie_fifo_w(txq_fifo_w)
+);
+end
+
+if (NTXQUEUES == 1) begin
+	fifo_write_interface_connect fifo_write_interface_connect_txq_0(.m(fifo_w[0]), .s(txq_fifo_w[0]));
+end
+else begin
+	/*
+	 * Every ring gets its own FIFO. The scheduler forwards
+	 * whole frames from these into puzzle FIFO 0.
+	 */
+	fifo_read_interface #(
+		.DATA_WIDTH(fifo_r[0].DATA_WIDTH),
+		.DATA_COUNT_WIDTH(fifo_r[0].DATA_COUNT_WIDTH)
+	) txq_fifo_r [NTXQUEUES] ();
+
+	for (genvar q = 0; q < NTXQUEUES; q++) begin
+		prism_sp_fifo_sync #(
+			.FIFO_WRITE_DEPTH(TX_PUZZLE_FIFO_WRITE_DEPTH[0])
+		) txq_fifo (
+			.clock,
+			.resetn,
+
+			.fifo_r(txq_fifo_r[q]),
+			.fifo_w(txq_fifo_w[q])
+		);
+	end
+
+	prism_sp_puzzle_hw_gem_tx_sched #(
+		.NQUEUES(NTXQUEUES)
+	) prism_sp_puzzle_hw_gem_tx_sched_0 (
+		.clock,
+		.resetn,
+
+		.wrr(tx_queue_wrr),
+		.weights(tx_queue_weights),
+
+		.i_cookie_fifo_r(txq_fifo_r),
+		.o_cookie_fifo_w(fifo_w[0])
+	);
+end
+end
+
+/*
+ * The shaper sits between the RISC-V core and the DMA.
+ */
+fifo_read_interface #(
+	.DATA_WIDTH(fifo_r[1].DATA_WIDTH),
+	.DATA_COUNT_WIDTH(fifo_r[1].DATA_COUNT_WIDTH)
+) dma_read_fifo_r();
+
+if (USE_TX_SHAPER) begin
+prism_sp_puzzle_hw_gem_tx_shaper #(
+	.NQUEUES(NTXQUEUES)
+) prism_sp_puzzle_hw_gem_tx_shaper_0 (
+	.clock,
+	.resetn,
+
+	.queue_rate(tx_queue_rate),
+	.queue_burst(tx_queue_burst),
+	.port_rate(tx_port_rate),
+	.port_burst(tx_port_burst),
+	.now(tx_time),
+
+	.i_cookie_fifo_r(fifo_r[1]),
+	.o_cookie_fifo_r(dma_read_fifo_r)
 );
 end
+else begin
+assign tx_time = '0;
+fifo_read_interface_connect fifo_read_interface_connect_dma_read(.m(fifo_r[1]), .s(dma_read_fifo_r));
+end
+
+wire logic dma_read_idle;
 
 prism_sp_puzzle_hw_gem_dma_read
 prism_sp_puzzle_hw_gem_dma_read_0 (
 	.clock,
 	.resetn,
 
-	.i_cookie_fifo_r(fifo_r_1),
+	.ct_size(tx_ct_size),
+	.digest_start,
+	.digest_end,
+
+	.i_cookie_fifo_r(dma_read_fifo_r),
 	.meta_desc_fifo_w(tx_meta_fifo_w),
-	.o_cookie_fifo_w(fifo_w_2),
+	.o_cookie_fifo_w(fifo_w[2]),
 
-	.tx_data_mem_r
+	.tx_data_mem_r,
+	.idle(dma_read_idle)
 );
 
+/*
+ * The shaper may hold back a cookie, so look at the FIFO in front of it.
+ */
+assign dma_idle = dma_read_idle && fifo_r[1].empty;
+
 if (USE_TX_RING_RELEASE) begin
+if (USE_TX_VIRTQ) begin
+prism_sp_puzzle_hw_gem_ring_release #(
+	.COOKIE_TYPE(tx_cookie_t),
+	.DESC_TYPE(virtq_packed_desc_t)
+) prism_sp_puzzle_hw_gem_ring_release_0 (
+	.clock,
+	.resetn,
+
+	.cq_enable,
+	.cq_size,
+	.cq_base,
+
+	.i_cookie_fifo_r(fifo_r[2]),
+
+	.axi_attr(desc_wr_attr),
+	.axi_aw(axi_ma_aw),
+	.axi_w(axi_ma_w),
+	.axi_b(axi_ma_b),
+
+	.fifo_w(fifo_w[3])
+);
+end
+else begin
 prism_sp_puzzle_hw_gem_ring_release #(
 	.COOKIE_TYPE(tx_cookie_t),
 	.DESC_TYPE(gem_dma_tx_desc_t)
@@ -114,26 +287,81 @@ prism_sp_puzzle_hw_gem_ring_release #(
 	.clock,
 	.resetn,
 
-	.i_cookie_fifo_r(fifo_r_2),
+	.cq_enable,
+	.cq_size,
+	.cq_base,
+
+	.i_cookie_fifo_r(fifo_r[2]),
 
+	.axi_attr(desc_wr_attr),
 	.axi_aw(axi_ma_aw),
 	.axi_w(axi_ma_w),
 	.axi_b(axi_ma_b),
 
-	.fifo_w(fifo_w_3)
+	.fifo_w(fifo_w[3])
 );
 end
+end
 
 if (USE_TX_IRQ) begin
+if (USE_TX_VIRTQ) begin
+prism_sp_puzzle_hw_virtq_irq
+prism_sp_puzzle_hw_virtq_irq_0 (
+	.clock,
+	.resetn,
+
+	.enable(tx_queue_enable[0]),
+	.ring_size,
+	.event_addr(virtq_event_addr),
+
+	.fifo_r(fifo_r[3]),
+
+	.axi_attr(desc_rd_attr),
+	.axi_ar(axi_mb_ar),
+	.axi_r(axi_mb_r),
+
+	.mmr_i
+);
+end
+else begin
 prism_sp_puzzle_hw_gem_irq
 prism_sp_puzzle_hw_gem_irq_0 (
 	.clock,
 	.resetn,
 
-	.fifo_r(fifo_r_3),
+	.fifo_r(fifo_r[3]),
 
 	.mmr_i
 );
 end
+end
+
+/*
+ * The write channels of port mb are otherwise unused.
+ */
+if (USE_CAPTURE) begin
+prism_sp_puzzle_hw_capture_write
+prism_sp_puzzle_hw_capture_write_0 (
+	.clock,
+	.resetn,
+
+	.enable(capture_enable),
+	.size(capture_size),
+	.base(capture_base),
+	.tail(capture_tail),
+	.head(capture_head),
+
+	.slot_fifo_r(capture_fifo_r),
+
+	.axi_attr(capture_attr),
+	.axi_aw(axi_mb_aw),
+	.axi_w(axi_mb_w),
+	.axi_b(axi_mb_b)
+);
+end
+else begin
+assign capture_fifo_r.rd_en = 1'b0;
+assign capture_head = '0;
+end
 
 endmodule
@@ -20,7 +20,7 @@ import prism_sp_config::*;
 module prism_sp_tx_top #(
 	parameter int IBRAM_SIZE = 2**15,
 	parameter int DBRAM_SIZE = 2**15,
-	parameter int ACPBRAM_SIZE = 2*64*8,
+	parameter int ACPBRAM_SIZE = 4096*8,
 	parameter int NTXCORES = 1,
 
 	parameter int TX_DATA_FIFO_SIZE,
@@ -75,6 +75,14 @@ module prism_sp_tx_top #(
 	axi_read_channel.master					m_axi_dma_r [NTXCORES],
 
 	gem_tx_interface.master gem_tx,
+	// Time base of the traffic generator
+	input wire logic tgen_clock,
+	input wire logic [31:0] tgen_now,
+	// PAUSE frames requested by the RX admission control
+	// (see prism_sp_tx_pause)
+	input wire logic [7:0] pause_xoff,
+	input wire logic [31:0] pause_control,
+	input wire logic [47:0] pause_sa,
 
 	output trace_outputs_t			trace_proc [NTXCORES],
 	output trace_sp_unit_t			trace_sp_unit [NTXCORES],
@@ -106,14 +114,122 @@ fifo_read_interface #(
 	.DATA_COUNT_WIDTH(TX_CSUM_FIFO_DATA_COUNT_WIDTH)
 ) tx_csum_fifo_r[NTXCORES]();
 
+fifo_read_interface #(
+	.DATA_WIDTH(TX_DIGEST_FIFO_WIDTH),
+	.DATA_COUNT_WIDTH(TX_DIGEST_FIFO_DATA_COUNT_WIDTH)
+) tx_digest_fifo_r[NTXCORES]();
+
+// Number of frames aborted due to a TX data FIFO underflow
+// (GEM TX clock domain).
+wire logic [31:0] tx_underflows [NTXCORES];
+
+/*
+ * The traffic checker is configured by the first core.
+ */
+wire logic [31:0] tchk_control [NTXCORES];
+// GEM TX clock domain
+wire traffic_check_t tchk_results;
+// The ESP SA table is configured by the first core as well.
+wire logic [127:0] esp_sa_key [NTXCORES];
+wire logic [31:0] esp_sa_salt [NTXCORES];
+wire logic [31:0] esp_sa_spi [NTXCORES];
+wire logic [31:0] esp_sa_control [NTXCORES];
+// And so is the tunnel offload.
+wire logic [31:0] tunnel_control [NTXCORES];
+wire logic [31:0] tunnel_tmpl [NTXCORES];
+wire logic [31:0] tunnel_tmpl_addr [NTXCORES];
+// The capture unit sees the frames as they are sent.
+wire logic [31:0] capture_control [NTXCORES];
+wire logic [31:0] capture_mask [NTXCORES];
+wire logic [31:0] capture_match [NTXCORES];
+// GEM TX clock domain
+wire logic [31:0] capture_drops;
+
+fifo_write_interface #(
+	.DATA_WIDTH(CAPTURE_WORD_WIDTH),
+	.DATA_COUNT_WIDTH(CAPTURE_FIFO_DATA_COUNT_WIDTH)
+) capture_fifo_w[NTXCORES]();
+
+prism_sp_traffic_check prism_sp_traffic_check_0 (
+	.clock(gem_tx.tx_clock),
+	.resetn(gem_tx.tx_resetn),
+
+	.enable(USE_TRAFFIC_GEN ? tchk_control[0][0] : 1'b0),
+
+	.gen_clock(tgen_clock),
+	.gen_now(tgen_now),
+
+	.valid(gem_tx.tx_r_valid),
+	.data(gem_tx.tx_r_data),
+	.sop(gem_tx.tx_r_sop),
+	.eop(gem_tx.tx_r_eop),
+	.err(gem_tx.tx_r_err),
+
+	.results(tchk_results)
+);
+
+if (USE_CAPTURE) begin
+	prism_sp_capture prism_sp_capture_0 (
+		.clock(gem_tx.tx_clock),
+		.resetn(gem_tx.tx_resetn),
+
+		.control(capture_control[0]),
+		.filter_mask(capture_mask[0]),
+		.filter_match(capture_match[0]),
+
+		.valid(gem_tx.tx_r_valid),
+		.data(gem_tx.tx_r_data),
+		.sop(gem_tx.tx_r_sop),
+		.eop(gem_tx.tx_r_eop),
+		.err(gem_tx.tx_r_err),
+
+		.slot_fifo_w(capture_fifo_w[0]),
+		.drops(capture_drops)
+	);
+end
+else begin
+	assign capture_fifo_w[0].clock = gem_tx.tx_clock;
+	assign capture_fifo_w[0].reset = ~gem_tx.tx_resetn;
+	assign capture_fifo_w[0].wr_en = 1'b0;
+	assign capture_drops = '0;
+end
+for (genvar i = 1; i < NTXCORES; i++) begin
+	assign capture_fifo_w[i].clock = gem_tx.tx_clock;
+	assign capture_fifo_w[i].reset = ~gem_tx.tx_resetn;
+	assign capture_fifo_w[i].wr_en = 1'b0;
+end
+
+/*
+ * PAUSE frames are sent between the frames of the TX cores.
+ */
+gem_tx_interface gem_tx_sp();
+
+prism_sp_tx_pause prism_sp_tx_pause_0 (
+	.control(USE_TX_PAUSE ? pause_control : '0),
+	.sa(pause_sa),
+	.xoff(pause_xoff),
+
+	.s_gem_tx(gem_tx_sp),
+	.gem_tx
+);
+
 if (NTXCORES == 1) begin
 	prism_sp_gem_tx_single #(
 		.NTXCORES(NTXCORES)
 	) prism_sp_gem_tx_single_0(
 		.tx_meta_fifo_r,
 		.tx_csum_fifo_r,
+		.tx_digest_fifo_r,
 		.tx_data_fifo_r,
-		.gem_tx
+		.tx_underflows,
+		.esp_sa_key(esp_sa_key[0]),
+		.esp_sa_salt(esp_sa_salt[0]),
+		.esp_sa_spi(esp_sa_spi[0]),
+		.esp_sa_control(esp_sa_control[0]),
+		.tunnel_control(tunnel_control[0]),
+		.tunnel_tmpl(tunnel_tmpl[0]),
+		.tunnel_tmpl_addr(tunnel_tmpl_addr[0]),
+		.gem_tx(gem_tx_sp)
 	);
 end
 else begin
@@ -122,8 +238,9 @@ else begin
 	) prism_sp_gem_tx_0(
 		.tx_meta_fifo_r,
 		.tx_data_fifo_r,
+		.tx_underflows,
 
-		.gem_tx
+		.gem_tx(gem_tx_sp)
 	);
 end
 
@@ -184,6 +301,22 @@ for (genvar i = 0; i < NTXCORES; i++) begin
 		.tx_meta_fifo_r(tx_meta_fifo_r[i]),
 		.tx_data_fifo_r(tx_data_fifo_r[i]),
 		.tx_csum_fifo_r(tx_csum_fifo_r[i]),
+		.tx_digest_fifo_r(tx_digest_fifo_r[i]),
+		.gem_tx_underflows(tx_underflows[i]),
+		.tchk_control(tchk_control[i]),
+		.gem_tchk_results(tchk_results),
+		.esp_sa_key(esp_sa_key[i]),
+		.esp_sa_salt(esp_sa_salt[i]),
+		.esp_sa_spi(esp_sa_spi[i]),
+		.esp_sa_control(esp_sa_control[i]),
+		.tunnel_control(tunnel_control[i]),
+		.tunnel_tmpl(tunnel_tmpl[i]),
+		.tunnel_tmpl_addr(tunnel_tmpl_addr[i]),
+		.capture_control(capture_control[i]),
+		.capture_mask(capture_mask[i]),
+		.capture_match(capture_match[i]),
+		.capture_fifo_w(capture_fifo_w[i]),
+		.gem_capture_drops(capture_drops),
 
 		.trace_proc(trace_proc[i]),
 		.trace_sp_unit(trace_sp_unit[i]),
@@ -29,14 +29,8 @@ module prism_sp_unit #(
 	unit_writeback_interface.unit wb,
 
 	// Interfaces used by the puzzle unit
-	fifo_read_interface.master puzzle_sw_fifo_r_0,
-	fifo_write_interface.master puzzle_sw_fifo_w_0,
-	fifo_read_interface.master puzzle_sw_fifo_r_1,
-	fifo_write_interface.master puzzle_sw_fifo_w_1,
-	fifo_read_interface.master puzzle_sw_fifo_r_2,
-	fifo_write_interface.master puzzle_sw_fifo_w_2,
-	fifo_read_interface.master puzzle_sw_fifo_r_3,
-	fifo_write_interface.master puzzle_sw_fifo_w_3,
+	fifo_read_interface.master puzzle_sw_fifo_r [NPUZZLEFIFOS],
+	fifo_write_interface.master puzzle_sw_fifo_w [NPUZZLEFIFOS],
 
 	// Interfaces driven from the RX unit
 	memory_write_interface.master rx_data_mem_w,
@@ -52,6 +46,9 @@ module prism_sp_unit #(
 	mmr_trigger_interface.master mmr_t,
 	mmr_intr_interface.master mmr_i,
 
+	// For the HDR subunit
+	header_window_interface.master hdr_w,
+
 	// For the ACP subunit
 	axi_write_address_channel.master m_axi_acp_aw,
 	axi_write_channel.master m_axi_acp_w,
@@ -62,7 +59,10 @@ module prism_sp_unit #(
 
 	output trace_sp_unit_t trace_sp_unit,
 	output trace_sp_unit_rx_t trace_sp_unit_rx,
-	output trace_sp_unit_tx_t trace_sp_unit_tx
+	output trace_sp_unit_tx_t trace_sp_unit_tx,
+
+	// See SP_PERF_EVENT_*
+	output wire logic [SP_NPERF_EVENTS-1:0] sp_perf_events
 );
 
 localparam int SP_UNIT_ENABLE_TRACE = 1;
@@ -72,6 +72,7 @@ var logic [$bits(wb.rd)-1:0] puzzle_result;
 var logic [$bits(wb.rd)-1:0] specific_result;
 var logic [$bits(wb.rd)-1:0] common_result;
 var logic [$bits(wb.rd)-1:0] acp_result;
+var logic [$bits(wb.rd)-1:0] hdr_result;
 var logic [$bits(wb.rd)-1:0] result;
 
 /*
@@ -92,8 +93,18 @@ wire logic [SP_UNIT_ACP_NCMDS-1:0] acp_cmds_busy;
 wire logic [SP_UNIT_ACP_NCMDS-1:0] acp_cmds_done;
 var logic acp_issue_cmd_valid;
 
+var logic [SP_UNIT_HDR_NCMDS-1:0] hdr_issue_cmd;
+wire logic [SP_UNIT_HDR_NCMDS-1:0] hdr_cmds_busy;
+wire logic [SP_UNIT_HDR_NCMDS-1:0] hdr_cmds_done;
+var logic hdr_issue_cmd_valid;
+
 var logic specific_issue_cmd_valid;
 
+wire logic perf_dma_wait;
+
+assign sp_perf_events[SP_PERF_EVENT_UNIT_BUSY] = ~issue.ready;
+assign sp_perf_events[SP_PERF_EVENT_DMA_WAIT] = perf_dma_wait;
+
 if (USE_SP_UNIT_RX) begin
 	var logic [SP_UNIT_RX_NCMDS-1:0] rx_issue_cmd;
 	wire logic [SP_UNIT_RX_NCMDS-1:0] rx_cmds_busy;
@@ -111,8 +122,8 @@ if (USE_SP_UNIT_RX) begin
 	 *   Signal unoptimizable: Feedback to clock or circular logic:
 	 *   'taiga_sim.cpu.register_file_and_writeback_block.unit_ack'
 	 */
-	assign issue.ready = ~|{acp_cmds_busy, common_cmds_busy, rx_cmds_busy, puzzle_cmds_busy};
-	assign wb.done = |{acp_cmds_done, common_cmds_done, rx_cmds_done, puzzle_cmds_done};
+	assign issue.ready = ~|{hdr_cmds_busy, acp_cmds_busy, common_cmds_busy, rx_cmds_busy, puzzle_cmds_busy};
+	assign wb.done = |{hdr_cmds_done, acp_cmds_done, common_cmds_done, rx_cmds_done, puzzle_cmds_done};
 
 	always_comb begin
 		puzzle_issue_cmd = '0;
@@ -120,7 +131,7 @@ if (USE_SP_UNIT_RX) begin
 		common_issue_cmd = '0;
 		acp_issue_cmd = '0;
 
-		case (sp_inputs.fn7[4:0])
+		case (sp_inputs.fn7[5:0])
 		SP_FUNC7_PUZZLE_FIFO_R_EMPTY: puzzle_issue_cmd[CMD_PUZZLE_FIFO_R_EMPTY] = 1'b1;
 		SP_FUNC7_PUZZLE_FIFO_R_POP: puzzle_issue_cmd[CMD_PUZZLE_FIFO_R_POP] = 1'b1;
 		SP_FUNC7_PUZZLE_FIFO_W_FULL: puzzle_issue_cmd[CMD_PUZZLE_FIFO_W_FULL] = 1'b1;
@@ -143,6 +154,8 @@ if (USE_SP_UNIT_RX) begin
 		SP_FUNC7_ACP_WRITE_STATUS: acp_issue_cmd[CMD_ACP_WRITE_STATUS] = 1'b1;
 		SP_FUNC7_ACP_SET_LOCAL_WSTRB: acp_issue_cmd[CMD_ACP_SET_LOCAL_WSTRB] = 1'b1;
 		SP_FUNC7_ACP_SET_REMOTE_WSTRB: acp_issue_cmd[CMD_ACP_SET_REMOTE_WSTRB] = 1'b1;
+		SP_FUNC7_ACP_SUBMIT: acp_issue_cmd[CMD_ACP_SUBMIT] = 1'b1;
+		SP_FUNC7_ACP_COMPLETE: acp_issue_cmd[CMD_ACP_COMPLETE] = 1'b1;
 		default: begin end
 		endcase
 	end
@@ -165,7 +178,8 @@ if (USE_SP_UNIT_RX) begin
 		.rx_data_mem_w,
 		.rx_meta_fifo_r,
 
-		.trace_sp_unit_rx
+		.trace_sp_unit_rx,
+		.perf_dma_wait
 	);
 end
 
@@ -181,8 +195,8 @@ if (USE_SP_UNIT_TX) begin
 		assign trace_sp_unit_tx.tx_data_dma_status = tx_cmds_busy[CMD_TX_DATA_DMA_STATUS];
 	end
 
-	assign issue.ready = ~|{acp_cmds_busy, common_cmds_busy, tx_cmds_busy, puzzle_cmds_busy};
-	assign wb.done = |{acp_cmds_done, common_cmds_done, tx_cmds_done, puzzle_cmds_done};
+	assign issue.ready = ~|{hdr_cmds_busy, acp_cmds_busy, common_cmds_busy, tx_cmds_busy, puzzle_cmds_busy};
+	assign wb.done = |{hdr_cmds_done, acp_cmds_done, common_cmds_done, tx_cmds_done, puzzle_cmds_done};
 
 	always_comb begin
 		puzzle_issue_cmd = '0;
@@ -190,7 +204,7 @@ if (USE_SP_UNIT_TX) begin
 		common_issue_cmd = '0;
 		acp_issue_cmd = '0;
 
-		case (sp_inputs.fn7[4:0])
+		case (sp_inputs.fn7[5:0])
 		SP_FUNC7_PUZZLE_FIFO_R_EMPTY: puzzle_issue_cmd[CMD_PUZZLE_FIFO_R_EMPTY] = 1'b1;
 		SP_FUNC7_PUZZLE_FIFO_R_POP: puzzle_issue_cmd[CMD_PUZZLE_FIFO_R_POP] = 1'b1;
 		SP_FUNC7_PUZZLE_FIFO_W_FULL: puzzle_issue_cmd[CMD_PUZZLE_FIFO_W_FULL] = 1'b1;
@@ -214,6 +228,8 @@ if (USE_SP_UNIT_TX) begin
 		SP_FUNC7_ACP_WRITE_STATUS: acp_issue_cmd[CMD_ACP_WRITE_STATUS] = 1'b1;
 		SP_FUNC7_ACP_SET_LOCAL_WSTRB: acp_issue_cmd[CMD_ACP_SET_LOCAL_WSTRB] = 1'b1;
 		SP_FUNC7_ACP_SET_REMOTE_WSTRB: acp_issue_cmd[CMD_ACP_SET_REMOTE_WSTRB] = 1'b1;
+		SP_FUNC7_ACP_SUBMIT: acp_issue_cmd[CMD_ACP_SUBMIT] = 1'b1;
+		SP_FUNC7_ACP_COMPLETE: acp_issue_cmd[CMD_ACP_COMPLETE] = 1'b1;
 		default: begin end
 		endcase
 	end
@@ -237,21 +253,49 @@ if (USE_SP_UNIT_TX) begin
 		.tx_data_mem_r,
 		.tx_meta_fifo_w,
 
-		.trace_sp_unit_tx
+		.trace_sp_unit_tx,
+		.perf_dma_wait
 	);
 end
 
+// Processors without an RX or TX unit never wait for a DMA transfer.
+if (!USE_SP_UNIT_RX && !USE_SP_UNIT_TX) begin
+	assign perf_dma_wait = 1'b0;
+end
+
 always_comb begin
 	puzzle_issue_cmd_valid = 1'b0;
 	specific_issue_cmd_valid = 1'b0;
 	common_issue_cmd_valid = 1'b0;
 	acp_issue_cmd_valid = 1'b0;
+	hdr_issue_cmd_valid = 1'b0;
 
-	case (sp_inputs.fn7[4:3])
-	2'b00: puzzle_issue_cmd_valid = 1'b1;
-	2'b01: specific_issue_cmd_valid = 1'b1;
-	2'b10: common_issue_cmd_valid = 1'b1;
-	2'b11: acp_issue_cmd_valid = 1'b1;
+	if (sp_inputs.fn7[5]) begin
+		hdr_issue_cmd_valid = 1'b1;
+	end
+	else begin
+		case (sp_inputs.fn7[4:3])
+		2'b00: puzzle_issue_cmd_valid = 1'b1;
+		2'b01: specific_issue_cmd_valid = 1'b1;
+		2'b10: common_issue_cmd_valid = 1'b1;
+		2'b11: acp_issue_cmd_valid = 1'b1;
+		endcase
+	end
+end
+
+/*
+ * The HDR commands are the same for both the RX and the TX unit.
+ */
+always_comb begin
+	hdr_issue_cmd = '0;
+
+	case (sp_inputs.fn7[5:0])
+	SP_FUNC7_HDR_LOAD: hdr_issue_cmd[CMD_HDR_LOAD] = 1'b1;
+	SP_FUNC7_HDR_STATUS: hdr_issue_cmd[CMD_HDR_STATUS] = 1'b1;
+	SP_FUNC7_HDR_PEEK: hdr_issue_cmd[CMD_HDR_PEEK] = 1'b1;
+	SP_FUNC7_HDR_POKE: hdr_issue_cmd[CMD_HDR_POKE] = 1'b1;
+	SP_FUNC7_HDR_COMMIT: hdr_issue_cmd[CMD_HDR_COMMIT] = 1'b1;
+	default: begin end
 	endcase
 end
 
@@ -269,6 +313,7 @@ var logic cur_puzzle;
 var logic cur_specific;
 var logic cur_common;
 var logic cur_acp;
+var logic cur_hdr;
 
 assign wb.id = cur_id;
 assign wb.rd = result;
@@ -284,6 +329,7 @@ always_ff @(posedge clk) begin
 			cur_specific <= specific_issue_cmd_valid;
 			cur_common <= common_issue_cmd_valid;
 			cur_acp <= acp_issue_cmd_valid;
+			cur_hdr <= hdr_issue_cmd_valid;
 		end
 	end
 end
@@ -295,6 +341,7 @@ always_comb begin
 	cur_specific: result = specific_result;
 	cur_common: result = common_result;
 	cur_acp: result = acp_result;
+	cur_hdr: result = hdr_result;
 	endcase
 end
 
@@ -316,14 +363,12 @@ prism_sp_unit_puzzle#(
 	.cmds_done(puzzle_cmds_done),
 	.result(puzzle_result),
 
-	.puzzle_fifo_r_0(puzzle_sw_fifo_r_0),
-	.puzzle_fifo_w_0(puzzle_sw_fifo_w_0),
-	.puzzle_fifo_r_1(puzzle_sw_fifo_r_1),
-	.puzzle_fifo_w_1(puzzle_sw_fifo_w_1),
-	.puzzle_fifo_r_2(puzzle_sw_fifo_r_2),
-	.puzzle_fifo_w_2(puzzle_sw_fifo_w_2),
-	.puzzle_fifo_r_3(puzzle_sw_fifo_r_3),
-	.puzzle_fifo_w_3(puzzle_sw_fifo_w_3)
+	.puzzle_fifo_r(puzzle_sw_fifo_r),
+	.puzzle_fifo_w(puzzle_sw_fifo_w),
+
+	.perf_empty_wait(sp_perf_events[SP_PERF_EVENT_PUZZLE_EMPTY_WAIT]),
+	.perf_full_wait(sp_perf_events[SP_PERF_EVENT_PUZZLE_FULL_WAIT]),
+	.perf_pop(sp_perf_events[SP_PERF_EVENT_COOKIE_POP])
 );
 
 prism_sp_unit_common#(
@@ -367,7 +412,27 @@ prism_sp_unit_acp#(
 	.m_axi_acp_w,
 	.m_axi_acp_b,
 	.m_axi_acp_ar,
-	.m_axi_acp_r
+	.m_axi_acp_r,
+
+	.perf_acp_wait(sp_perf_events[SP_PERF_EVENT_ACP_WAIT])
+);
+
+prism_sp_unit_hdr#(
+	.RESULT_WIDTH($bits(wb.rd))
+) prism_sp_unit_hdr_0(
+	.clk,
+	.rst,
+
+	.sp_inputs,
+	.issue,
+	.wb,
+
+	.issue_cmd(hdr_issue_cmd),
+	.cmds_busy(hdr_cmds_busy),
+	.cmds_done(hdr_cmds_done),
+	.result(hdr_result),
+
+	.hdr_w
 );
 
 endmodule
@@ -37,7 +37,9 @@ module prism_sp_unit_acp#(
 	axi_write_channel.master m_axi_acp_w,
 	axi_write_response_channel.master m_axi_acp_b,
 	axi_read_address_channel.master m_axi_acp_ar,
-	axi_read_channel.master m_axi_acp_r
+	axi_read_channel.master m_axi_acp_r,
+
+	output wire logic perf_acp_wait
 );
 
 /*
@@ -97,6 +99,7 @@ end
  * Command "READ STATUS"
  */
 var logic acp_read_status_result_ff;
+var logic acp_read_wait;
 
 prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_read_status(
 	.clk(clk),
@@ -110,10 +113,12 @@ prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_read_status(
 
 always_ff @(posedge clk) begin
 	if (rst) begin
+		acp_read_wait <= 1'b0;
 	end
 	else begin
 		if (issue.new_request & issue.ready & issue_cmd[CMD_ACP_READ_STATUS]) begin
 			acp_read_status_result_ff <= acpram_axi_i.busy;
+			acp_read_wait <= acpram_axi_i.busy;
 		end
 	end
 end
@@ -137,6 +142,7 @@ prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_write_start(
  * Command "WRITE STATUS"
  */
 var logic acp_write_status_result_ff;
+var logic acp_write_wait;
 
 prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_write_status(
 	.clk(clk),
@@ -150,10 +156,12 @@ prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_write_status(
 
 always_ff @(posedge clk) begin
 	if (rst) begin
+		acp_write_wait <= 1'b0;
 	end
 	else begin
 		if (issue.new_request & issue.ready & issue_cmd[CMD_ACP_WRITE_STATUS]) begin
 			acp_write_status_result_ff <= acpram_axi_i.busy;
+			acp_write_wait <= acpram_axi_i.busy;
 		end
 	end
 end
@@ -220,6 +228,68 @@ always_ff @(posedge clk) begin
 	end
 end
 
+/*
+ * Command "SUBMIT"
+ */
+var logic [$clog2(SP_UNIT_ACP_NTAGS)-1:0] submit_tag;
+var logic [$clog2(SP_UNIT_ACP_NTAGS)-1:0] acp_submit_result_ff;
+
+prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_submit(
+	.clk(clk),
+	.rst(rst),
+	.issue(issue),
+	.wb(wb),
+	.issue_cmd(issue_cmd[CMD_ACP_SUBMIT]),
+	.cmd_done(cmds_done[CMD_ACP_SUBMIT]),
+	.cmd_busy(cmds_busy[CMD_ACP_SUBMIT])
+);
+
+wire logic acp_submit = issue.new_request & issue.ready & issue_cmd[CMD_ACP_SUBMIT];
+
+always_ff @(posedge clk) begin
+	if (rst) begin
+	end
+	else begin
+		if (acp_submit) begin
+			acp_submit_result_ff <= submit_tag;
+		end
+	end
+end
+
+/*
+ * Command "COMPLETE"
+ */
+var logic [$clog2(SP_UNIT_ACP_NTAGS)-1:0] complete_tag;
+wire logic complete_error;
+var logic [$clog2(SP_UNIT_ACP_NTAGS)-1:0] acp_complete_result_ff;
+var logic acp_complete_error_ff;
+var logic acp_complete_wait;
+
+prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_acp_complete(
+	.clk(clk),
+	.rst(rst),
+	.issue(issue),
+	.wb(wb),
+	.issue_cmd(issue_cmd[CMD_ACP_COMPLETE]),
+	.cmd_done(cmds_done[CMD_ACP_COMPLETE]),
+	.cmd_busy(cmds_busy[CMD_ACP_COMPLETE])
+);
+
+wire logic acp_complete = issue.new_request & issue.ready & issue_cmd[CMD_ACP_COMPLETE];
+
+always_ff @(posedge clk) begin
+	if (rst) begin
+		acp_complete_wait <= 1'b0;
+	end
+	else begin
+		if (acp_complete) begin
+			acp_complete_result_ff <= complete_tag;
+			acp_complete_error_ff <= complete_error;
+			acp_complete_wait <= complete_tag == '0;
+		end
+	end
+end
+
 /*
  * Remember current command
  */
@@ -242,10 +312,17 @@ always_comb begin
 	case (1'b1)
 	cur_cmd[CMD_ACP_READ_STATUS]: result[0] = acp_read_status_result_ff;
 	cur_cmd[CMD_ACP_WRITE_STATUS]: result[0] = acp_write_status_result_ff;
+	cur_cmd[CMD_ACP_SUBMIT]: result[$bits(acp_submit_result_ff)-1:0] = acp_submit_result_ff;
+	cur_cmd[CMD_ACP_COMPLETE]: begin
+		result[$bits(acp_complete_result_ff)-1:0] = acp_complete_result_ff;
+		result[RESULT_WIDTH-1] = acp_complete_error_ff;
+	end
 	endcase
 end
 
-acpram_axi acpram_axi_0(
+acpram_axi_queue #(
+	.NTAGS(SP_UNIT_ACP_NTAGS)
+) acpram_axi_queue_0(
 	.clock(clk),
 	.resetn(~rst),
 
@@ -254,6 +331,21 @@ acpram_axi acpram_axi_0(
 	.acp_remote_wstrb_0123,
 
 	.acpram_axi_i,
+
+	// rs1: [31:24] AXI address [39:32], [23:4] ACP memory address,
+	//      [3:0] (number of words - 1) [7:4]
+	// rs2: [31:4] AXI address [31:4], [3:0] (number of words - 1) [3:0]
+	.submit(acp_submit),
+	.submit_write(sp_inputs.fn3[0]),
+	.submit_len({ sp_inputs.rs1[3:0], sp_inputs.rs2[3:0] }),
+	.submit_acpram_addr($bits(acpram_port_i.addr)'(sp_inputs.rs1[23:4])),
+	.submit_axi_addr({ sp_inputs.rs1[31:24], sp_inputs.rs2[31:4], 4'b0000 }),
+	.submit_tag,
+
+	.complete(acp_complete),
+	.complete_tag,
+	.complete_error,
+
 	.acpram_port_i,
 
 	.axi_aw(m_axi_acp_aw),
@@ -263,4 +355,6 @@ acpram_axi acpram_axi_0(
 	.axi_r(m_axi_acp_r)
 );
 
+assign perf_acp_wait = acp_read_wait | acp_write_wait | acp_complete_wait;
+
 endmodule
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023 Robert Drehmel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+import prism_sp_config::*;
+
+/*
+ * Header window commands (see USE_HDR_WINDOW)
+ *
+ * HDR LOAD (rs1: length of the frame in bytes) takes up to
+ * HDR_WINDOW_SIZE bytes of the next frame out of the data stream.
+ * HDR STATUS returns 1 while the window is busy (see
+ * prism_sp_rx_header_window and prism_sp_tx_header_window).
+ * HDR PEEK (rs1: offset) returns and HDR POKE (rs1: offset, rs2: value)
+ * replaces the 32-bit word at the offset in the window. The first byte
+ * of the frame is in bits [7:0] of the word at offset 0.
+ * HDR COMMIT puts the window back into the data stream.
+ * PEEK and POKE complete in a single clock cycle.
+ */
+module prism_sp_unit_hdr#(
+	parameter int RESULT_WIDTH
+)
+(
+	input wire logic clk,
+	input wire logic rst,
+
+	input sp_inputs_t sp_inputs,
+	unit_issue_interface.unit issue,
+	unit_writeback_interface.unit wb,
+
+	input wire logic [SP_UNIT_HDR_NCMDS-1:0] issue_cmd,
+	output wire logic [SP_UNIT_HDR_NCMDS-1:0] cmds_busy,
+	output wire logic [SP_UNIT_HDR_NCMDS-1:0] cmds_done,
+	output var logic [RESULT_WIDTH-1:0] result,
+
+	header_window_interface.master hdr_w
+);
+
+for (genvar i = 0; i < SP_UNIT_HDR_NCMDS; i++) begin
+	prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_hdr(
+		.clk(clk),
+		.rst(rst),
+		.issue(issue),
+		.wb(wb),
+		.issue_cmd(issue_cmd[i]),
+		.cmd_done(cmds_done[i]),
+		.cmd_busy(cmds_busy[i])
+	);
+end
+
+var logic [1:0] status_result_ff;
+var logic [31:0] peek_result_ff;
+
+assign hdr_w.peek_addr = sp_inputs.rs1[HDR_WINDOW_ADDR_WIDTH-1:0];
+
+always_ff @(posedge clk) begin
+	// Unpulse
+	hdr_w.load <= 1'b0;
+	hdr_w.poke <= 1'b0;
+	hdr_w.commit <= 1'b0;
+
+	if (rst) begin
+	end
+	else if (issue.new_request & issue.ready) begin
+		if (issue_cmd[CMD_HDR_LOAD]) begin
+			hdr_w.load <= 1'b1;
+			hdr_w.len <= sp_inputs.rs1[15:0];
+		end
+		if (issue_cmd[CMD_HDR_STATUS]) begin
+			status_result_ff <= { hdr_w.loading, hdr_w.busy };
+		end
+		if (issue_cmd[CMD_HDR_PEEK]) begin
+			peek_result_ff <= hdr_w.peek_data;
+		end
+		if (issue_cmd[CMD_HDR_POKE]) begin
+			hdr_w.poke <= 1'b1;
+			hdr_w.poke_addr <= sp_inputs.rs1[HDR_WINDOW_ADDR_WIDTH-1:0];
+			hdr_w.poke_data <= sp_inputs.rs2;
+		end
+		if (issue_cmd[CMD_HDR_COMMIT]) begin
+			hdr_w.commit <= 1'b1;
+		end
+	end
+end
+
+var logic [SP_UNIT_HDR_NCMDS-1:0] cur_cmd;
+
+always_ff @(posedge clk) begin
+	if (rst) begin
+	end
+	else begin
+		if (issue.new_request & issue.ready) begin
+			cur_cmd <= issue_cmd;
+		end
+	end
+end
+
+always_comb begin
+	result = '0;
+
+	// "Reverse case" statement for one-hot encoding.
+	case (1'b1)
+	cur_cmd[CMD_HDR_STATUS]: result[1:0] = status_result_ff;
+	cur_cmd[CMD_HDR_PEEK]: result = RESULT_WIDTH'(peek_result_ff);
+	endcase
+end
+
+endmodule
@@ -34,27 +34,30 @@ module prism_sp_unit_puzzle #(
 	output wire logic [SP_UNIT_PUZZLE_NCMDS-1:0] cmds_done,
 	output var logic [RESULT_WIDTH-1:0] result,
 
-	fifo_read_interface.master puzzle_fifo_r_0,
-	fifo_write_interface.master puzzle_fifo_w_0,
-	fifo_read_interface.master puzzle_fifo_r_1,
-	fifo_write_interface.master puzzle_fifo_w_1,
-	fifo_read_interface.master puzzle_fifo_r_2,
-	fifo_write_interface.master puzzle_fifo_w_2,
-	fifo_read_interface.master puzzle_fifo_r_3,
-	fifo_write_interface.master puzzle_fifo_w_3
+	fifo_read_interface.master puzzle_fifo_r [NFIFOS],
+	fifo_write_interface.master puzzle_fifo_w [NFIFOS],
+
+	output var logic perf_empty_wait,
+	output var logic perf_full_wait,
+	output wire logic perf_pop
 );
 
+/*
+ * The FIFO is selected by funct3.
+ */
+if (NFIFOS > 8) begin
+	$fatal("NFIFOS=%d is not supported (funct3 selects the FIFO).\n", NFIFOS);
+end
+
 wire logic puzzle_fifo_r_empty [NFIFOS];
 wire logic puzzle_fifo_w_full [NFIFOS];
 
-assign puzzle_fifo_r_empty[0] = puzzle_fifo_r_0.empty;
-assign puzzle_fifo_r_empty[1] = puzzle_fifo_r_1.empty;
-assign puzzle_fifo_r_empty[2] = puzzle_fifo_r_2.empty;
-assign puzzle_fifo_r_empty[3] = puzzle_fifo_r_3.empty;
-assign puzzle_fifo_w_full[0] = puzzle_fifo_w_0.full;
-assign puzzle_fifo_w_full[1] = puzzle_fifo_w_1.full;
-assign puzzle_fifo_w_full[2] = puzzle_fifo_w_2.full;
-assign puzzle_fifo_w_full[3] = puzzle_fifo_w_3.full;
+for (genvar i = 0; i < NFIFOS; i++) begin
+	assign puzzle_fifo_r_empty[i] = puzzle_fifo_r[i].empty;
+	assign puzzle_fifo_w_full[i] = puzzle_fifo_w[i].full;
+end
+
+wire logic fifo_sel_valid = sp_inputs.fn3 < NFIFOS;
 
 /*
  * Command "puzzle FIFO empty"
@@ -73,12 +76,14 @@ var logic fifo_r_empty_result;
 
 always_ff @(posedge clk) begin
 	if (rst) begin
+		perf_empty_wait <= 1'b0;
 	end
 	else begin
 		// Unpulse
 
 		if (issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_R_EMPTY]) begin
-			fifo_r_empty_result <= puzzle_fifo_r_empty[sp_inputs.fn3[1:0]];
+			fifo_r_empty_result <= fifo_sel_valid ? puzzle_fifo_r_empty[sp_inputs.fn3] : 1'b1;
+			perf_empty_wait <= fifo_sel_valid ? puzzle_fifo_r_empty[sp_inputs.fn3] : 1'b1;
 		end
 	end
 end
@@ -97,67 +102,30 @@ prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_puzzle_fifo_r_pop(
 );
 
 var logic [31:0] fifo_r_pop_result;
-wire logic [31:0] prism_sp_unit_puzzle_fifo_r_pop_0_out;
-wire logic [31:0] prism_sp_unit_puzzle_fifo_r_pop_1_out;
-wire logic [31:0] prism_sp_unit_puzzle_fifo_r_pop_2_out;
-wire logic [31:0] prism_sp_unit_puzzle_fifo_r_pop_3_out;
-
-wire logic fifo_r_pulse = issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_R_POP];
-
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_R[0] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_R[0]) begin
-prism_sp_unit_puzzle_fifo_r_pop prism_sp_unit_puzzle_fifo_r_pop_0(
-	.clk,
-	.rst,
-	.pulse(fifo_r_pulse & sp_inputs.fn3[1:0] == 2'b00),
-	.fifo_r(puzzle_fifo_r_0),
-	.out(prism_sp_unit_puzzle_fifo_r_pop_0_out)
-);
-end
-else begin
-assign prism_sp_unit_puzzle_fifo_r_pop_0_out = '0;
-end
+wire logic [31:0] prism_sp_unit_puzzle_fifo_r_pop_out [NFIFOS];
+wire logic [NFIFOS-1:0] fifo_r_popped;
 
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_R[1] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_R[1]) begin
-prism_sp_unit_puzzle_fifo_r_pop prism_sp_unit_puzzle_fifo_r_pop_1(
-	.clk,
-	.rst,
-	.pulse(fifo_r_pulse & sp_inputs.fn3[1:0] == 2'b01),
-	.fifo_r(puzzle_fifo_r_1),
-	.out(prism_sp_unit_puzzle_fifo_r_pop_1_out)
-);
-end
-else begin
-assign prism_sp_unit_puzzle_fifo_r_pop_1_out = '0;
-end
+assign perf_pop = |fifo_r_popped;
 
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_R[2] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_R[2]) begin
-prism_sp_unit_puzzle_fifo_r_pop prism_sp_unit_puzzle_fifo_r_pop_2(
-	.clk,
-	.rst,
-	.pulse(fifo_r_pulse & sp_inputs.fn3[1:0] == 2'b10),
-	.fifo_r(puzzle_fifo_r_2),
-	.out(prism_sp_unit_puzzle_fifo_r_pop_2_out)
-);
-end
-else begin
-assign prism_sp_unit_puzzle_fifo_r_pop_2_out = '0;
-end
+wire logic fifo_r_pulse = issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_R_POP];
 
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_R[3] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_R[3]) begin
-prism_sp_unit_puzzle_fifo_r_pop prism_sp_unit_puzzle_fifo_r_pop_3(
-	.clk,
-	.rst,
-	.pulse(fifo_r_pulse & sp_inputs.fn3[1:0] == 2'b11),
-	.fifo_r(puzzle_fifo_r_3),
-	.out(prism_sp_unit_puzzle_fifo_r_pop_3_out)
-);
-end
-else begin
-assign prism_sp_unit_puzzle_fifo_r_pop_3_out = '0;
+for (genvar i = 0; i < NFIFOS; i++) begin : fifo_r_pop
+	if ((RX_INSTANCE || TX_INSTANCE) && puzzle_sw_fifo_r_enabled(RX_INSTANCE, i)) begin
+		prism_sp_unit_puzzle_fifo_r_pop #(
+			.DATA_WIDTH(puzzle_fifo_r_data_width(RX_INSTANCE, i))
+		) prism_sp_unit_puzzle_fifo_r_pop_0 (
+			.clk,
+			.rst,
+			.pulse(fifo_r_pulse & sp_inputs.fn3 == i),
+			.fifo_r(puzzle_fifo_r[i]),
+			.out(prism_sp_unit_puzzle_fifo_r_pop_out[i])
+		);
+		assign fifo_r_popped[i] = puzzle_fifo_r[i].rd_en;
+	end
+	else begin
+		assign prism_sp_unit_puzzle_fifo_r_pop_out[i] = '0;
+		assign fifo_r_popped[i] = 1'b0;
+	end
 end
 
 always_ff @(posedge clk) begin
@@ -165,12 +133,7 @@ always_ff @(posedge clk) begin
 	end
 	else begin
 		if (issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_R_POP]) begin
-			case (sp_inputs.fn3[1:0])
-			2'b00: fifo_r_pop_result <= prism_sp_unit_puzzle_fifo_r_pop_0_out;
-			2'b01: fifo_r_pop_result <= prism_sp_unit_puzzle_fifo_r_pop_1_out;
-			2'b10: fifo_r_pop_result <= prism_sp_unit_puzzle_fifo_r_pop_2_out;
-			2'b11: fifo_r_pop_result <= prism_sp_unit_puzzle_fifo_r_pop_3_out;
-			endcase
+			fifo_r_pop_result <= fifo_sel_valid ? prism_sp_unit_puzzle_fifo_r_pop_out[sp_inputs.fn3] : '0;
 		end
 	end
 end
@@ -192,12 +155,14 @@ var logic fifo_w_full_result;
 
 always_ff @(posedge clk) begin
 	if (rst) begin
+		perf_full_wait <= 1'b0;
 	end
 	else begin
 		// Unpulse
 
 		if (issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_W_FULL]) begin
-			fifo_w_full_result <= puzzle_fifo_w_full[sp_inputs.fn3[1:0]];
+			fifo_w_full_result <= fifo_sel_valid ? puzzle_fifo_w_full[sp_inputs.fn3] : 1'b1;
+			perf_full_wait <= fifo_sel_valid ? puzzle_fifo_w_full[sp_inputs.fn3] : 1'b1;
 		end
 	end
 end
@@ -217,52 +182,19 @@ prism_sp_unit_basic_cmd prism_sp_unit_basic_cmd_puzzle_fifo_w_push(
 
 wire logic fifo_w_pulse = issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_W_PUSH];
 
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_W[0] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_W[0]) begin
-prism_sp_unit_puzzle_fifo_w_push prism_sp_unit_puzzle_fifo_w_push_0 (
-	.clk,
-	.rst,
-
-	.pulse(fifo_w_pulse & (sp_inputs.fn3[1:0] == 2'b00)),
-	.fifo_w(puzzle_fifo_w_0),
-	.in(sp_inputs.rs1)
-);
-end
-
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_W[1] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_W[1]) begin
-prism_sp_unit_puzzle_fifo_w_push prism_sp_unit_puzzle_fifo_w_push_1 (
-	.clk,
-	.rst,
-
-	.pulse(fifo_w_pulse & (sp_inputs.fn3[1:0] == 2'b01)),
-	.fifo_w(puzzle_fifo_w_1),
-	.in(sp_inputs.rs1)
-);
-end
-
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_W[2] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_W[2]) begin
-prism_sp_unit_puzzle_fifo_w_push prism_sp_unit_puzzle_fifo_w_push_2 (
-	.clk,
-	.rst,
-
-	.pulse(fifo_w_pulse & (sp_inputs.fn3[1:0] == 2'b10)),
-	.fifo_w(puzzle_fifo_w_2),
-	.in(sp_inputs.rs1)
-);
-end
-
-if (RX_INSTANCE && ENABLE_RX_PUZZLE_SW_FIFO_W[3] ||
-	TX_INSTANCE && ENABLE_TX_PUZZLE_SW_FIFO_W[3]) begin
-prism_sp_unit_puzzle_fifo_w_push prism_sp_unit_puzzle_fifo_w_push_3 (
-	.clk,
-	.rst,
-
-	.pulse(fifo_w_pulse & (sp_inputs.fn3[1:0] == 2'b11)),
-	.fifo_w(puzzle_fifo_w_3),
-	.in(sp_inputs.rs1)
-);
+for (genvar i = 0; i < NFIFOS; i++) begin : fifo_w_push
+	if ((RX_INSTANCE || TX_INSTANCE) && puzzle_sw_fifo_w_enabled(RX_INSTANCE, i)) begin
+		prism_sp_unit_puzzle_fifo_w_push #(
+			.DATA_WIDTH(puzzle_fifo_w_data_width(RX_INSTANCE, i))
+		) prism_sp_unit_puzzle_fifo_w_push_0 (
+			.clk,
+			.rst,
+
+			.pulse(fifo_w_pulse & (sp_inputs.fn3 == i)),
+			.fifo_w(puzzle_fifo_w[i]),
+			.in(sp_inputs.rs1)
+		);
+	end
 end
 
 `ifdef EASY_POPPUSH_IMPL
@@ -270,34 +202,19 @@ end
  * This implementation suffices for FIFOs with a write width of
  * $bits(sp_inputs.rs1) (i.e., 32).
  */
-always_ff @(posedge clk) begin
-	puzzle_fifo_w_0.wr_en <= 1'b0;
-	puzzle_fifo_w_1.wr_en <= 1'b0;
-	puzzle_fifo_w_2.wr_en <= 1'b0;
-	puzzle_fifo_w_3.wr_en <= 1'b0;
+for (genvar i = 0; i < NFIFOS; i++) begin
+	always_ff @(posedge clk) begin
+		puzzle_fifo_w[i].wr_en <= 1'b0;
 
-	if (rst) begin
-	end
-	else begin
-		if (issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_W_PUSH]) begin
-			unique case (sp_inputs.fn3[1:0])
-			2'b00: begin
-				puzzle_fifo_w_0.wr_en <= 1'b1;
-				puzzle_fifo_w_0.wr_data <= sp_inputs.rs1;
-			end
-			2'b01: begin
-				puzzle_fifo_w_1.wr_en <= 1'b1;
-				puzzle_fifo_w_1.wr_data <= sp_inputs.rs1;
-			end
-			2'b10: begin
-				puzzle_fifo_w_2.wr_en <= 1'b1;
-				puzzle_fifo_w_2.wr_data <= sp_inputs.rs1;
-			end
-			2'b11: begin
-				puzzle_fifo_w_3.wr_en <= 1'b1;
-				puzzle_fifo_w_3.wr_data <= sp_inputs.rs1;
+		if (rst) begin
+		end
+		else begin
+			if (issue.new_request & issue.ready & issue_cmd[CMD_PUZZLE_FIFO_W_PUSH] &&
+				sp_inputs.fn3 == i)
+			begin
+				puzzle_fifo_w[i].wr_en <= 1'b1;
+				puzzle_fifo_w[i].wr_data <= sp_inputs.rs1;
 			end
-			endcase
 		end
 	end
 end
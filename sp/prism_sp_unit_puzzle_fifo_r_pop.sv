@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 module prism_sp_unit_puzzle_fifo_r_pop#(
+	// The width of the FIFO, which may be less than fifo_r.DATA_WIDTH
+	parameter int DATA_WIDTH,
 	parameter int OUT_WIDTH = 32
 )
 (
@@ -25,8 +27,8 @@ module prism_sp_unit_puzzle_fifo_r_pop#(
 	output var logic [OUT_WIDTH-1:0] out
 );
 
-localparam int nwords = fifo_r.DATA_WIDTH / OUT_WIDTH;
-localparam int remnbits = fifo_r.DATA_WIDTH % OUT_WIDTH;
+localparam int nwords = DATA_WIDTH / OUT_WIDTH;
+localparam int remnbits = DATA_WIDTH % OUT_WIDTH;
 localparam int lastnbits = remnbits ? remnbits : OUT_WIDTH;
 localparam int lastidx = remnbits ? nwords : nwords - 1;
 
@@ -48,53 +50,13 @@ always_ff @(posedge clk) begin
 	end
 end
 
-if (lastidx == 0) begin
-	assign out = fifo_r.rd_data;
-end
-else if (lastidx == 1) begin
-	always_comb begin
-		out = '0;
-		unique case (sel)
-		2'b01: out = fifo_r.rd_data[(0*OUT_WIDTH) +: OUT_WIDTH];
-		2'b10: out = OUT_WIDTH'(fifo_r.rd_data[(1*OUT_WIDTH) +: lastnbits]);
-		endcase
-	end
-end
-else if (lastidx == 2) begin
-	always_comb begin
-		out = '0;
-		unique case (sel)
-		3'b001: out = fifo_r.rd_data[(0*OUT_WIDTH) +: OUT_WIDTH];
-		3'b010: out = fifo_r.rd_data[(1*OUT_WIDTH) +: OUT_WIDTH];
-		3'b100: out = OUT_WIDTH'(fifo_r.rd_data[(2*OUT_WIDTH) +: lastnbits]);
-		endcase
-	end
-end
-else if (lastidx == 3) begin
-	always_comb begin
-		out = '0;
-		unique case (sel)
-		4'b0001: out = fifo_r.rd_data[(0*OUT_WIDTH) +: OUT_WIDTH];
-		4'b0010: out = fifo_r.rd_data[(1*OUT_WIDTH) +: OUT_WIDTH];
-		4'b0100: out = fifo_r.rd_data[(2*OUT_WIDTH) +: OUT_WIDTH];
-		4'b1000: out = OUT_WIDTH'(fifo_r.rd_data[(3*OUT_WIDTH) +: lastnbits]);
-		endcase
-	end
-end
-else if (lastidx == 4) begin
-	always_comb begin
-		out = '0;
-		unique case (sel)
-		5'b00001: out = fifo_r.rd_data[(0*OUT_WIDTH) +: OUT_WIDTH];
-		5'b00010: out = fifo_r.rd_data[(1*OUT_WIDTH) +: OUT_WIDTH];
-		5'b00100: out = fifo_r.rd_data[(2*OUT_WIDTH) +: OUT_WIDTH];
-		5'b01000: out = fifo_r.rd_data[(3*OUT_WIDTH) +: OUT_WIDTH];
-		5'b10000: out = OUT_WIDTH'(fifo_r.rd_data[(4*OUT_WIDTH) +: lastnbits]);
-		endcase
+always_comb begin
+	out = '0;
+	for (int i = 0; i < lastidx; i++) begin
+		if (sel[i])
+			out = fifo_r.rd_data[i*OUT_WIDTH +: OUT_WIDTH];
 	end
-end
-else begin
-	$fatal("fifo_r.DATA_WIDTH=%d OUT_WIDTH=%d lastidx=%d is not supported.\n",
-		fifo_r.DATA_WIDTH, OUT_WIDTH, lastidx);
+	if (sel[lastidx])
+		out = OUT_WIDTH'(fifo_r.rd_data[lastidx*OUT_WIDTH +: lastnbits]);
 end
 endmodule
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 module prism_sp_unit_puzzle_fifo_w_push#(
+	// The width of the FIFO, which may be less than fifo_w.DATA_WIDTH
+	parameter int DATA_WIDTH,
 	parameter int IN_WIDTH = 32
 )
 (
@@ -25,8 +27,8 @@ module prism_sp_unit_puzzle_fifo_w_push#(
 	input wire logic [IN_WIDTH-1:0] in
 );
 
-localparam int nwords = fifo_w.DATA_WIDTH / IN_WIDTH;
-localparam int remnbits = fifo_w.DATA_WIDTH % IN_WIDTH;
+localparam int nwords = DATA_WIDTH / IN_WIDTH;
+localparam int remnbits = DATA_WIDTH % IN_WIDTH;
 localparam int lastnbits = remnbits ? remnbits : IN_WIDTH;
 localparam int lastidx = remnbits ? nwords : nwords - 1;
 
@@ -42,14 +44,12 @@ always_ff @(posedge clk) begin
 	else begin
 		if (pulse) begin
 			fifo_w.wr_en <= sel[lastidx];
-			for (int i = 0; i <= lastidx; i++) begin
-				if (sel[i]) begin
-					if (i == lastidx)
-						fifo_w.wr_data[i*IN_WIDTH +: lastnbits] <= in;
-					else
-						fifo_w.wr_data[i*IN_WIDTH +: IN_WIDTH] <= in;
-				end
+			for (int i = 0; i < lastidx; i++) begin
+				if (sel[i])
+					fifo_w.wr_data[i*IN_WIDTH +: IN_WIDTH] <= in;
 			end
+			if (sel[lastidx])
+				fifo_w.wr_data[lastidx*IN_WIDTH +: lastnbits] <= in[lastnbits-1:0];
 			if (lastidx > 0)
 				sel <= { sel[lastidx-1:0], sel[lastidx] };
 		end
@@ -34,7 +34,9 @@ module prism_sp_unit_rx#(
 	memory_write_interface.master rx_data_mem_w,
 	fifo_read_interface.master rx_meta_fifo_r,
 
-	output trace_sp_unit_rx_t trace_sp_unit_rx
+	output trace_sp_unit_rx_t trace_sp_unit_rx,
+
+	output var logic perf_dma_wait
 );
 
 localparam int SP_UNIT_ENABLE_TRACE = 1;
@@ -137,14 +139,19 @@ if (ENABLE_RX_SW_RX_DATA_MEM_W) begin
 
 	always_ff @(posedge clk) begin
 		if (rst) begin
+			perf_dma_wait <= 1'b0;
 		end
 		else begin
 			if (issue.new_request & issue.ready & issue_cmd[CMD_RX_DATA_DMA_STATUS]) begin
 				rx_data_dma_status_result_ff <= rx_data_mem_w.busy;
+				perf_dma_wait <= rx_data_mem_w.busy;
 			end
 		end
 	end
 end
+else begin
+	assign perf_dma_wait = 1'b0;
+end
 
 var logic [SP_UNIT_RX_NCMDS-1:0] cur_cmd;
 
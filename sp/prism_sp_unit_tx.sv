@@ -35,7 +35,9 @@ module prism_sp_unit_tx#(
 	memory_read_interface.master tx_data_mem_r,
 	fifo_write_interface.master tx_meta_fifo_w,
 
-	output trace_sp_unit_tx_t trace_sp_unit_tx
+	output trace_sp_unit_tx_t trace_sp_unit_tx,
+
+	output var logic perf_dma_wait
 );
 
 localparam int SP_UNIT_ENABLE_TRACE = 1;
@@ -167,14 +169,19 @@ if (ENABLE_TX_SW_TX_DATA_MEM_R) begin
 
 	always_ff @(posedge clk) begin
 		if (rst) begin
+			perf_dma_wait <= 1'b0;
 		end
 		else begin
 			if (issue.new_request & issue.ready & issue_cmd[CMD_TX_DATA_DMA_STATUS]) begin
 				tx_data_dma_status_result_ff <= tx_data_mem_r.busy;
+				perf_dma_wait <= tx_data_mem_r.busy;
 			end
 		end
 	end
 end
+else begin
+	assign perf_dma_wait = 1'b0;
+end
 
 var logic [SP_UNIT_TX_NCMDS-1:0] cur_cmd;
 